@@ -0,0 +1,445 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <algorithm>
+#include "atlas_resize.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void AtlasShelfPacker::Reset(uint32_t canvas_width, uint32_t canvas_height, uint32_t max_canvases)
+{
+    canvas_width_ = canvas_width;
+    canvas_height_ = canvas_height;
+    max_canvases_ = max_canvases;
+    shelves_.clear();
+    canvas_heights_.clear();
+}
+
+int AtlasShelfPacker::Insert(uint32_t width, uint32_t height, int &canvas, uint32_t &x, uint32_t &y)
+{
+    if (width > canvas_width_ || height > canvas_height_)
+    {
+        return 0;
+    }
+    // best fit: the open shelf wasting the least height
+    int best = -1;
+    for (size_t idx = 0; idx < shelves_.size(); ++idx)
+    {
+        const Shelf& shelf = shelves_[idx];
+        if (shelf.height >= height && shelf.used_width + width <= canvas_width_ &&
+            (best < 0 || shelf.height < shelves_[best].height))
+        {
+            best = static_cast<int>(idx);
+        }
+    }
+    if (best < 0)
+    {
+        int target = -1;
+        for (size_t idx = 0; idx < canvas_heights_.size(); ++idx)
+        {
+            if (canvas_heights_[idx] + height <= canvas_height_)
+            {
+                target = static_cast<int>(idx);
+                break;
+            }
+        }
+        if (target < 0)
+        {
+            if (canvas_heights_.size() >= max_canvases_)
+            {
+                return 0;
+            }
+            target = static_cast<int>(canvas_heights_.size());
+            canvas_heights_.push_back(0);
+        }
+        Shelf shelf;
+        shelf.canvas = target;
+        shelf.y = canvas_heights_[target];
+        shelf.height = height;
+        shelf.used_width = 0;
+        canvas_heights_[target] += height;
+        shelves_.push_back(shelf);
+        best = static_cast<int>(shelves_.size()) - 1;
+    }
+    Shelf& shelf = shelves_[best];
+    canvas = shelf.canvas;
+    x = shelf.used_width;
+    y = shelf.y;
+    shelf.used_width += width;
+    return 1;
+}
+
+AtlasResize::AtlasResize() : format_(PIXEL_FORMAT_YUV_SEMIPLANAR_420), channel_desc_(nullptr), resize_config_(nullptr),
+                             input_desc_(nullptr), output_desc_(nullptr), canvas_dev_(nullptr), canvas_stride_(0),
+                             canvas_size_(0), has_init_over_(false)
+{
+
+}
+
+AtlasResize::~AtlasResize()
+{
+    DestroyResource();
+}
+
+void AtlasResize::Init(const DVPPAtlasConfig *config)
+{
+    config_ = *config;
+    if (0 != config_.canvas_width % 16 || 0 != config_.canvas_height % 2 || 0 == config_.canvas_width ||
+        0 == config_.canvas_height || 0 == config_.max_canvases || 0 == config_.max_frames ||
+        0 == config_.max_crops || config_.max_crops > DVPP_ATLAS_MAX_CROPS)
+    {
+        AIALG_ERROR("bad atlas config, canvas %dx%d(width 16 aligned, height even), max_canvases %d, max_frames %d, "
+                    "max_crops %d(<= %d)\n", config_.canvas_width, config_.canvas_height, config_.max_canvases,
+                    config_.max_frames, config_.max_crops, DVPP_ATLAS_MAX_CROPS);
+        return;
+    }
+    format_ = static_cast<acldvppPixelFormat>(config_.input_format);
+
+    aclError aclRet = aclrtSetCurrentContext(config_.context);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", aclRet);
+        return;
+    }
+    channel_desc_ = acldvppCreateChannelDesc();
+    if (!channel_desc_ || ACL_SUCCESS != acldvppCreateChannel(channel_desc_))
+    {
+        AIALG_ERROR("create dvpp channel failed\n");
+        return;
+    }
+    resize_config_ = acldvppCreateResizeConfig();
+    if (!resize_config_ || ACL_SUCCESS != acldvppSetResizeConfigInterpolation(resize_config_, config_.interpolation))
+    {
+        AIALG_ERROR("create resize config failed\n");
+        return;
+    }
+    input_desc_ = acldvppCreateBatchPicDesc(config_.max_frames);
+    output_desc_ = acldvppCreateBatchPicDesc(config_.max_crops);
+    if (!input_desc_ || !output_desc_)
+    {
+        AIALG_ERROR("acldvppCreateBatchPicDesc failed\n");
+        return;
+    }
+
+    canvas_stride_ = config_.canvas_width * 3;
+    canvas_size_ = canvas_stride_ * config_.canvas_height;
+    aclRet = acldvppMalloc(&canvas_dev_, static_cast<size_t>(canvas_size_) * config_.max_canvases);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc canvases failed, aclRet = %d\n", aclRet);
+        canvas_dev_ = nullptr;
+        return;
+    }
+    // every output desc is a whole canvas, only its data changes between calls
+    for (uint32_t idx = 0; idx < config_.max_crops; ++idx)
+    {
+        acldvppPicDesc* desc = acldvppGetPicDesc(output_desc_, idx);
+        acldvppSetPicDescFormat(desc, PIXEL_FORMAT_BGR_888);
+        acldvppSetPicDescWidth(desc, config_.canvas_width);
+        acldvppSetPicDescHeight(desc, config_.canvas_height);
+        acldvppSetPicDescWidthStride(desc, canvas_stride_);
+        acldvppSetPicDescHeightStride(desc, config_.canvas_height);
+        acldvppSetPicDescSize(desc, canvas_size_);
+    }
+    output_canvas_.assign(config_.max_crops, -1);
+
+    // roi configs are created once and updated by acldvppSetRoiConfig
+    crop_area_.assign(config_.max_crops, nullptr);
+    paste_area_.assign(config_.max_crops, nullptr);
+    for (uint32_t idx = 0; idx < config_.max_crops; ++idx)
+    {
+        crop_area_[idx] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        paste_area_[idx] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        if (!crop_area_[idx] || !paste_area_[idx])
+        {
+            AIALG_ERROR("acldvppCreateRoiConfig failed\n");
+            return;
+        }
+    }
+    roi_nums_.reserve(config_.max_frames);
+    order_.reserve(config_.max_crops);
+    packed_.reserve(config_.max_crops);
+    has_init_over_ = true;
+}
+
+void AtlasResize::DestroyResource()
+{
+    for (size_t idx = 0; idx < crop_area_.size(); ++idx)
+    {
+        if (crop_area_[idx])
+        {
+            acldvppDestroyRoiConfig(crop_area_[idx]);
+        }
+        if (paste_area_[idx])
+        {
+            acldvppDestroyRoiConfig(paste_area_[idx]);
+        }
+    }
+    crop_area_.clear();
+    paste_area_.clear();
+    if (input_desc_)
+    {
+        acldvppDestroyBatchPicDesc(input_desc_);
+        input_desc_ = nullptr;
+    }
+    if (output_desc_)
+    {
+        acldvppDestroyBatchPicDesc(output_desc_);
+        output_desc_ = nullptr;
+    }
+    if (canvas_dev_)
+    {
+        acldvppFree(canvas_dev_);
+        canvas_dev_ = nullptr;
+    }
+    if (resize_config_)
+    {
+        acldvppDestroyResizeConfig(resize_config_);
+        resize_config_ = nullptr;
+    }
+    if (channel_desc_)
+    {
+        aclrtSetCurrentContext(config_.context);
+        acldvppDestroyChannel(channel_desc_);
+        acldvppDestroyChannelDesc(channel_desc_);
+        channel_desc_ = nullptr;
+    }
+    packer_.Reset(0, 0, 0);
+    has_init_over_ = false;
+}
+
+int AtlasResize::PackCrops(const DVPPImageData *frames, int frame_num, const DVPPAtlasCrop *crops, int crop_num,
+                           DVPPAtlasView *views)
+{
+    // crops the vpc can not take in a single pass are rejected up front(CheckDvppImage: frame size, strides and
+    // alignment, crop at least DVPP_INPUT_MIN_WIDTH x DVPP_INPUT_MIN_HEIGHT), cascades need DvppResize
+    DVPPResizeInitConfig range;
+    range.input_format = config_.input_format;
+    range.is_fix_scale_resize = 0;
+    range.is_symmetry_padding = 0;
+    range.resize_scale_factor = 1.0f;
+
+    order_.clear();
+    for (int idx = 0; idx < crop_num; ++idx)
+    {
+        const DVPPAtlasCrop& crop = crops[idx];
+        DVPPAtlasView& view = views[idx];
+        view = DVPPAtlasView();
+        view.width = ALIGN_UP2(crop.width ? crop.width : config_.crop_width);
+        view.height = ALIGN_UP2(crop.height ? crop.height : config_.crop_height);
+        if (crop.frame < 0 || crop.frame >= frame_num || !frames[crop.frame].data)
+        {
+            AIALG_ERROR("crop %d: bad frame %d\n", idx, crop.frame);
+            view.status = -1;
+            stats_.invalid_count++;
+            continue;
+        }
+        range.resized_width = view.width;
+        range.resized_height = view.height;
+        RectInt roi = crop.roi;
+        roi.width = roi.xmax - roi.xmin + 1;
+        roi.height = roi.ymax - roi.ymin + 1;
+        if (crop.roi.xmin < 0 || crop.roi.ymin < 0 || crop.roi.xmax < crop.roi.xmin || crop.roi.ymax < crop.roi.ymin ||
+            (crop.roi.xmax | 1) >= static_cast<int>(frames[crop.frame].width & ~1u) ||
+            (crop.roi.ymax | 1) >= static_cast<int>(frames[crop.frame].height & ~1u) ||
+            view.width < DVPP_INPUT_MIN_WIDTH || view.height < DVPP_INPUT_MIN_HEIGHT ||
+            view.width > config_.canvas_width || view.height > config_.canvas_height ||
+            DVPP_IMAGE_OK != CheckDvppImage(range, frames[crop.frame], &roi))
+        {
+            AIALG_ERROR("crop %d: roi (%d, %d, %d, %d) of frame %d -> %dx%d is out of range\n", idx, crop.roi.xmin,
+                        crop.roi.ymin, crop.roi.xmax, crop.roi.ymax, crop.frame, view.width, view.height);
+            view.status = -1;
+            stats_.invalid_count++;
+            continue;
+        }
+        order_.push_back(idx);
+    }
+    std::stable_sort(order_.begin(), order_.end(), [views](int a, int b) {
+        return views[a].height > views[b].height;
+    });
+
+    packer_.Reset(config_.canvas_width, config_.canvas_height, config_.max_canvases);
+    packed_.clear();
+    for (size_t pos = 0; pos < order_.size(); ++pos)
+    {
+        DVPPAtlasView& view = views[order_[pos]];
+        if (packed_.size() >= config_.max_crops ||
+            1 != packer_.Insert(ALIGN_UP16(view.width), view.height, view.canvas, view.x, view.y))
+        {
+            view.canvas = -1;
+            stats_.deferred_count++;
+            continue;
+        }
+        view.status = 1;
+        view.width_stride = canvas_stride_;
+        view.data = CanvasData(view.canvas) + view.y * canvas_stride_ + view.x * 3;
+        packed_.push_back(order_[pos]);
+    }
+    // vpc takes the rois of one input picture together
+    std::stable_sort(packed_.begin(), packed_.end(), [crops](int a, int b) {
+        return crops[a].frame < crops[b].frame;
+    });
+    return static_cast<int>(packed_.size());
+}
+
+int AtlasResize::SetupDescs(const DVPPImageData *frames, const DVPPAtlasCrop *crops, const DVPPAtlasView *views)
+{
+    roi_nums_.clear();
+    int last_frame = -1;
+    for (size_t pos = 0; pos < packed_.size(); ++pos)
+    {
+        const DVPPAtlasCrop& crop = crops[packed_[pos]];
+        const DVPPAtlasView& view = views[packed_[pos]];
+        if (crop.frame != last_frame)
+        {
+            const DVPPImageData& frame = frames[crop.frame];
+            uint32_t width_stride, height_stride, buffer_size;
+            GetDvppInputStride(config_.input_format, frame, width_stride, height_stride, buffer_size);
+            acldvppPicDesc* desc = acldvppGetPicDesc(input_desc_, static_cast<uint32_t>(roi_nums_.size()));
+            acldvppSetPicDescData(desc, frame.data);
+            acldvppSetPicDescFormat(desc, format_);
+            acldvppSetPicDescWidth(desc, frame.width & ~1u);
+            acldvppSetPicDescHeight(desc, frame.height & ~1u);
+            acldvppSetPicDescWidthStride(desc, width_stride);
+            acldvppSetPicDescHeightStride(desc, height_stride);
+            acldvppSetPicDescSize(desc, buffer_size);
+            roi_nums_.push_back(0);
+            last_frame = crop.frame;
+        }
+        roi_nums_.back()++;
+
+        // the same even crop as GetDvppRoiArea, paste right/bottom are odd as the sizes are even
+        aclError aclRet = acldvppSetRoiConfig(crop_area_[pos], crop.roi.xmin & ~1, crop.roi.xmax | 1,
+                                              crop.roi.ymin & ~1, crop.roi.ymax | 1);
+        if (aclRet == ACL_SUCCESS)
+        {
+            aclRet = acldvppSetRoiConfig(paste_area_[pos], view.x, view.x + view.width - 1, view.y,
+                                         view.y + view.height - 1);
+        }
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("set the roi configs of crop %d failed, aclRet = %d\n", packed_[pos], aclRet);
+            return 0;
+        }
+        if (output_canvas_[pos] != view.canvas)
+        {
+            acldvppSetPicDescData(acldvppGetPicDesc(output_desc_, static_cast<uint32_t>(pos)), CanvasData(view.canvas));
+            output_canvas_[pos] = view.canvas;
+        }
+    }
+    return 1;
+}
+
+int AtlasResize::Process(const DVPPImageData *frames, int frame_num, const DVPPAtlasCrop *crops, int crop_num,
+                         DVPPAtlasView *views)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("AtlasResize has not init\n");
+        return -1;
+    }
+    stats_.process_count++;
+    if (frame_num <= 0 || frame_num > static_cast<int>(config_.max_frames) || crop_num < 0)
+    {
+        AIALG_ERROR("frame_num must be in [1, max_frames], frame_num = %d, max_frames = %d\n", frame_num, config_.max_frames);
+        stats_.failed_count++;
+        return -1;
+    }
+    uint64_t start_ns = SteadyNowNs();
+    int packed = 0;
+    int setup = 0;
+    {
+        DVPP_TIMELINE_SCOPE("atlas_resize", "pack", crop_num);
+        packed = PackCrops(frames, frame_num, crops, crop_num, views);
+        setup = SetupDescs(frames, crops, views);
+    }
+    if (0 == packed)
+    {
+        return 0;
+    }
+    uint64_t setup_ns = SteadyNowNs();
+    DvppTimeline::Record("atlas_resize", "setup", start_ns, setup_ns, packed);
+
+    bool launched = false;
+    aclError aclRet = aclrtSetCurrentContext(config_.context);
+    if (1 == setup && aclRet == ACL_SUCCESS)
+    {
+        launched = true;
+        aclRet = acldvppVpcBatchCropResizePasteAsync(channel_desc_, input_desc_, roi_nums_.data(),
+                                                     static_cast<uint32_t>(roi_nums_.size()), output_desc_,
+                                                     crop_area_.data(), paste_area_.data(), resize_config_,
+                                                     config_.stream);
+    }
+    uint64_t launch_ns = SteadyNowNs();
+    DvppTimeline::Record("atlas_resize", "vpc_launch", setup_ns, launch_ns, packed);
+    if (launched && aclRet == ACL_SUCCESS)
+    {
+        aclRet = aclrtSynchronizeStream(config_.stream);
+    }
+    uint64_t sync_ns = SteadyNowNs();
+    DvppTimeline::Record("atlas_resize", "vpc_sync", launch_ns, sync_ns, packed);
+    stats_.setup_us += (setup_ns - start_ns) / 1000;
+    stats_.launch_us += (launch_ns - setup_ns) / 1000;
+    stats_.sync_us += (sync_ns - launch_ns) / 1000;
+    if (!launched || aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("atlas vpc batch of %d crops in %zu frames failed, aclRet = %d\n", packed, roi_nums_.size(), aclRet);
+        // not 0: the same crops would fail the same way if they were submitted again
+        for (size_t pos = 0; pos < packed_.size(); ++pos)
+        {
+            views[packed_[pos]].status = -2;
+            views[packed_[pos]].data = nullptr;
+        }
+        stats_.failed_count++;
+        return -1;
+    }
+    stats_.crop_count += packed;
+    stats_.canvas_count += packer_.CanvasCount();
+    for (size_t pos = 0; pos < packed_.size(); ++pos)
+    {
+        stats_.packed_area += static_cast<uint64_t>(views[packed_[pos]].width) * views[packed_[pos]].height;
+    }
+    return packed;
+}
+
+int AtlasResize::GetCanvas(DVPPImageData &canvas, int index) const
+{
+    if (index < 0 || index >= packer_.CanvasCount())
+    {
+        return -1;
+    }
+    canvas.width = config_.canvas_width;
+    canvas.height = config_.canvas_height;
+    canvas.alignWidth = canvas_stride_;
+    canvas.alignHeight = config_.canvas_height;
+    canvas.size = canvas_size_;
+    canvas.data = CanvasData(index);
+    return 1;
+}
+
+int AtlasResize::GetHostCanvas(DVPPImageData &canvas, int index)
+{
+    if (1 != GetCanvas(canvas, index))
+    {
+        AIALG_ERROR("canvas %d was not filled by the last Process\n", index);
+        return -1;
+    }
+    canvas_host_.resize(canvas_size_);
+    DVPP_TIMELINE_SCOPE("atlas_resize", "readback", index);
+    aclError aclRet = aclrtMemcpy(canvas_host_.data(), canvas_size_, CanvasData(index), canvas_size_,
+                                  ACL_MEMCPY_DEVICE_TO_HOST);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("copy canvas to host failed, aclRet is %d\n", aclRet);
+        return -1;
+    }
+    canvas.data = canvas_host_.data();
+    return 1;
+}
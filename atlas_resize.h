@@ -0,0 +1,187 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_ATLAS_RESIZE_H
+#define _PICTURE_INC_ATLAS_RESIZE_H
+
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+
+// total rois of one acldvppVpcBatchCropResizePasteAsync
+#define DVPP_ATLAS_MAX_CROPS 256
+
+typedef struct{
+    aclrtContext context;
+    aclrtStream stream;
+    uint32_t input_format;
+    uint32_t canvas_width = 1024;   // BGR_888 canvas, multiple of 16
+    uint32_t canvas_height = 1024;  // even
+    uint32_t max_canvases = 4;      // canvases filled by one Process call
+    uint32_t max_frames = 16;       // source frames of one Process call
+    uint32_t max_crops = DVPP_ATLAS_MAX_CROPS;  // crops of one Process call
+    uint32_t crop_width = 112;      // resized size of a crop whose width/height is 0
+    uint32_t crop_height = 112;
+    uint32_t interpolation = 2;     // acldvppSetResizeConfigInterpolation
+    char reserve[8];
+}DVPPAtlasConfig;
+
+typedef struct{
+    int frame = 0;        // index into the frames of Process
+    RectInt roi;          // source area, inclusive
+    uint32_t width = 0;   // resized size, 0: crop_width/crop_height of the config
+    uint32_t height = 0;
+}DVPPAtlasCrop;
+
+typedef struct{
+    int status = 0;             // 1 resized, 0 did not fit into this call(submit it again),
+                                // -1 invalid(bad frame, roi or size), submitting it again fails the same way,
+                                // -2 packed but the vpc call failed(Process returned -1), not to be submitted again
+    int canvas = -1;
+    uint32_t x = 0;             // top left of the crop in the canvas, x is 16 aligned
+    uint32_t y = 0;
+    uint32_t width = 0;         // resized size, rounded up to even
+    uint32_t height = 0;
+    uint32_t width_stride = 0;  // bytes per canvas row
+    uint8_t* data = nullptr;    // device memory of the first pixel, valid until the next Process
+}DVPPAtlasView;
+
+typedef struct{
+    uint64_t process_count = 0;
+    uint64_t failed_count = 0;
+    uint64_t crop_count = 0;      // crops resized
+    uint64_t deferred_count = 0;  // valid crops that did not fit and were returned with status 0
+    uint64_t invalid_count = 0;   // crops returned with status -1
+    uint64_t canvas_count = 0;    // canvases filled
+    uint64_t packed_area = 0;     // pixels of resized crops, packed_area / canvas area is the fill rate
+    uint64_t setup_us = 0;
+    uint64_t launch_us = 0;
+    uint64_t sync_us = 0;
+}DVPPAtlasStats;
+
+/**
+* @brief shelf packing of 16 aligned rectangles into fixed size canvases, items are expected in
+*        decreasing height order, each one goes to the best fitting open shelf or a new shelf
+*/
+class AtlasShelfPacker {
+public:
+    void Reset(uint32_t canvas_width, uint32_t canvas_height, uint32_t max_canvases);
+
+    /**
+    * @return 1 placed at (canvas, x, y), 0 no room left
+    */
+    int Insert(uint32_t width, uint32_t height, int& canvas, uint32_t& x, uint32_t& y);
+
+    inline int CanvasCount() const
+    {
+        return static_cast<int>(canvas_heights_.size());
+    }
+
+private:
+    struct Shelf {
+        int canvas;
+        uint32_t y;
+        uint32_t height;
+        uint32_t used_width;
+    };
+
+    uint32_t canvas_width_ = 0;
+    uint32_t canvas_height_ = 0;
+    uint32_t max_canvases_ = 0;
+    std::vector<Shelf> shelves_;
+    std::vector<uint32_t> canvas_heights_;  // used height of every opened canvas
+};
+
+/**
+* @brief resize many small crops of a few frames into shared canvases with one vpc call:
+*        n = atlas.Process(frames, 2, crops, 300, views); crops with views[i].status 0 go into the next call,
+*        the ones with status -1/-2 are dropped,
+*        the fixed cost per picture of DvppResize(a descriptor and an output slot per crop) is paid per canvas
+*/
+class AtlasResize {
+public:
+    AtlasResize();
+
+    ~AtlasResize();
+
+    void Init(const DVPPAtlasConfig* config);
+
+    /**
+    * @param [in] frames: frame_num <= max_frames device images
+    * @param [in] crops: any number, larger crops are packed first, crops that do not fit are deferred
+    * @param [out] views: crop_num views, one per crop
+    * @return crops resized, -1 failed
+    */
+    int Process(const DVPPImageData* frames, int frame_num, const DVPPAtlasCrop* crops, int crop_num,
+                DVPPAtlasView* views);
+
+    /**
+    * @brief canvas of the last Process, data is device memory
+    */
+    int GetCanvas(DVPPImageData& canvas, int index) const;
+
+    /**
+    * @brief copy a canvas of the last Process to host, views map into it by x * 3 + y * alignWidth
+    * @return 1 success, -1 failed
+    */
+    int GetHostCanvas(DVPPImageData& canvas, int index);
+
+    inline int CanvasCount() const
+    {
+        return packer_.CanvasCount();
+    }
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPAtlasStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    void DestroyResource();
+
+private:
+    int PackCrops(const DVPPImageData* frames, int frame_num, const DVPPAtlasCrop* crops, int crop_num,
+                  DVPPAtlasView* views);
+
+    /**
+    * @return 1 success, 0 a roi config could not be set
+    */
+    int SetupDescs(const DVPPImageData* frames, const DVPPAtlasCrop* crops, const DVPPAtlasView* views);
+
+    inline uint8_t* CanvasData(int canvas) const
+    {
+        return static_cast<uint8_t*>(canvas_dev_) + static_cast<size_t>(canvas) * canvas_size_;
+    }
+
+private:
+    DVPPAtlasConfig config_;
+    acldvppPixelFormat format_;
+
+    acldvppChannelDesc* channel_desc_;
+    acldvppResizeConfig* resize_config_;
+    acldvppBatchPicDesc* input_desc_;   // one per frame with packed crops
+    acldvppBatchPicDesc* output_desc_;  // one per crop, all pointing into the canvases
+    std::vector<acldvppRoiConfig*> crop_area_;
+    std::vector<acldvppRoiConfig*> paste_area_;
+    std::vector<int> output_canvas_;    // canvas of every output desc, -1: not set yet
+    std::vector<uint32_t> roi_nums_;
+
+    void* canvas_dev_;
+    uint32_t canvas_stride_;
+    uint32_t canvas_size_;
+    std::vector<uint8_t> canvas_host_;
+
+    AtlasShelfPacker packer_;
+    std::vector<int> order_;     // valid crops by decreasing height
+    std::vector<int> packed_;    // packed crops grouped by frame
+
+    DVPPAtlasStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_ATLAS_RESIZE_H
@@ -0,0 +1,254 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <algorithm>
+#include "batch_aggregator.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::future<DVPPBatchResult> FailedFuture()
+{
+    std::promise<DVPPBatchResult> promise;
+    DVPPBatchResult result;
+    result.resized.data = nullptr;
+    promise.set_value(result);
+    return promise.get_future();
+}
+
+BatchAggregator::BatchAggregator() : stop_(false), slots_dev_(nullptr), slot_size_(0), has_init_over_(false)
+{
+
+}
+
+BatchAggregator::~BatchAggregator()
+{
+    DestroyResource();
+}
+
+void BatchAggregator::Init(const DVPPBatchAggregatorConfig *config)
+{
+    config_ = *config;
+    config_.resize_config.use_external_output = 1;
+    config_.resize_config.drop_bad_images = 1;
+    // the slots are sized by the resolved(tuned) batch_size, not only the inner DvppResize
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    resize_.Init(&config_.resize_config);
+    if (!resize_.HasInit())
+    {
+        return;
+    }
+
+    uint32_t batch_size = config_.resize_config.batch_size;
+    config_.num_slots = config_.num_slots ? config_.num_slots : 4 * batch_size;
+    if (config_.num_slots < batch_size)
+    {
+        AIALG_ERROR("num_slots must be >= batch_size, num_slots = %d, batch_size = %d\n", config_.num_slots, batch_size);
+        return;
+    }
+    slot_size_ = ALIGN_UP16(config_.resize_config.resized_width) * 3 * ALIGN_UP2(config_.resize_config.resized_height);
+    aclError aclRet = acldvppMalloc(&slots_dev_, static_cast<size_t>(slot_size_) * config_.num_slots);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc output slots failed, aclRet = %d\n", aclRet);
+        slots_dev_ = nullptr;
+        return;
+    }
+    free_slots_.clear();
+    for (int slot = static_cast<int>(config_.num_slots) - 1; slot >= 0; --slot)
+    {
+        free_slots_.push_back(slot);
+    }
+    batch_images_.reserve(batch_size);
+    batch_rois_.reserve(batch_size);
+    batch_slots_.reserve(batch_size);
+
+    stop_ = false;
+    dispatcher_ = std::thread(&BatchAggregator::DispatchLoop, this);
+    has_init_over_ = true;
+}
+
+void BatchAggregator::DestroyResource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    pending_cv_.notify_all();
+    slot_cv_.notify_all();
+    if (dispatcher_.joinable())
+    {
+        dispatcher_.join();
+    }
+    resize_.DestroyResource();
+    if (slots_dev_)
+    {
+        acldvppFree(slots_dev_);
+        slots_dev_ = nullptr;
+    }
+    free_slots_.clear();
+    has_init_over_ = false;
+}
+
+std::future<DVPPBatchResult> BatchAggregator::Submit(const DVPPImageData &image, const RectInt *roi)
+{
+    if (!has_init_over_ || !image.data)
+    {
+        AIALG_ERROR("BatchAggregator has not init or image.data is nullptr\n");
+        return FailedFuture();
+    }
+    Request request;
+    request.image = image;
+    if (roi)
+    {
+        request.roi = *roi;
+    }
+    else
+    {
+        request.roi.xmin = 0;
+        request.roi.ymin = 0;
+        request.roi.xmax = static_cast<int>(image.width) - 1;
+        request.roi.ymax = static_cast<int>(image.height) - 1;
+        request.roi.width = image.width;
+        request.roi.height = image.height;
+    }
+    std::future<DVPPBatchResult> future = request.promise.get_future();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    slot_cv_.wait(lock, [this] { return stop_ || !free_slots_.empty(); });
+    if (stop_)
+    {
+        return FailedFuture();
+    }
+    request.slot = free_slots_.back();
+    free_slots_.pop_back();
+    request.submit_ns = SteadyNowNs();
+    pending_.push_back(std::move(request));
+    stats_.submit_count++;
+    bool notify = 1 == pending_.size() || pending_.size() >= config_.resize_config.batch_size;
+    lock.unlock();
+    // the dispatcher only cares about the first request(deadline) and a full batch
+    if (notify)
+    {
+        pending_cv_.notify_one();
+    }
+    return future;
+}
+
+void BatchAggregator::Release(int slot)
+{
+    if (slot < 0 || slot >= static_cast<int>(config_.num_slots))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(slot);
+    }
+    slot_cv_.notify_one();
+}
+
+DVPPBatchAggregatorStats BatchAggregator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void BatchAggregator::DispatchLoop()
+{
+    DvppTimeline::SetThreadName("dvpp_aggregator");
+    uint32_t batch_size = config_.resize_config.batch_size;
+    std::chrono::nanoseconds max_delay(static_cast<uint64_t>(config_.max_delay_us) * 1000);
+    std::vector<Request> batch;
+    batch.reserve(batch_size);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        if (pending_.empty())
+        {
+            if (stop_)
+            {
+                break;
+            }
+            pending_cv_.wait(lock);
+            continue;
+        }
+        bool full = pending_.size() >= batch_size;
+        std::chrono::steady_clock::time_point deadline(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(pending_.front().submit_ns) + max_delay));
+        if (!full && !stop_ && std::chrono::steady_clock::now() < deadline)
+        {
+            pending_cv_.wait_until(lock, deadline);
+            continue;
+        }
+
+        size_t img_num = std::min<size_t>(pending_.size(), batch_size);
+        for (size_t idx = 0; idx < img_num; ++idx)
+        {
+            batch.push_back(std::move(pending_.front()));
+            pending_.pop_front();
+        }
+        lock.unlock();
+        RunBatch(batch, !full);
+        batch.clear();
+        lock.lock();
+    }
+}
+
+void BatchAggregator::RunBatch(std::vector<Request> &batch, bool by_deadline)
+{
+    batch_images_.clear();
+    batch_rois_.clear();
+    batch_slots_.clear();
+    for (size_t idx = 0; idx < batch.size(); ++idx)
+    {
+        batch_images_.push_back(batch[idx].image);
+        batch_rois_.push_back(batch[idx].roi);
+        batch_slots_.push_back(SlotData(batch[idx].slot));
+    }
+    int img_num = static_cast<int>(batch.size());
+    uint64_t launch_ns = SteadyNowNs();
+    DVPP_TIMELINE_SCOPE("batch_aggregator", by_deadline ? "deadline_batch" : "full_batch", img_num);
+
+    DVPPOutputBinding output;
+    output.size = slot_size_;
+    output.slot_data = batch_slots_.data();
+    int ret = resize_.Process(batch_images_.data(), batch_rois_.data(), img_num, &output);
+
+    uint64_t max_wait_us = 0;
+    uint64_t failed_num = 0;
+    for (size_t idx = 0; idx < batch.size(); ++idx)
+    {
+        DVPPBatchResult result;
+        result.image_status = resize_.GetImageStatus(static_cast<int>(idx));
+        result.status = 1 == ret && DVPP_IMAGE_OK == result.image_status ? 1 : 0;
+        failed_num += result.status ? 0 : 1;
+        result.slot = batch[idx].slot;
+        result.batch_img_num = img_num;
+        result.wait_us = (launch_ns - batch[idx].submit_ns) / 1000;
+        resize_.Get(result.resized, static_cast<int>(idx));
+        if (!result.status)
+        {
+            result.resized.size = 0;
+            result.resized.data = nullptr;
+        }
+        max_wait_us = std::max(max_wait_us, result.wait_us);
+        batch[idx].promise.set_value(result);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.batch_count++;
+    stats_.full_batch_count += img_num == static_cast<int>(config_.resize_config.batch_size) ? 1 : 0;
+    stats_.deadline_batch_count += by_deadline ? 1 : 0;
+    stats_.failed_count += failed_num;
+    stats_.max_wait_us = std::max(stats_.max_wait_us, max_wait_us);
+}
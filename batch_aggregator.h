@@ -0,0 +1,123 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_BATCH_AGGREGATOR_H
+#define _PICTURE_INC_BATCH_AGGREGATOR_H
+
+#include <deque>
+#include <mutex>
+#include <future>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include "dvpp_resize.h"
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // output is owned by the aggregator
+    uint32_t max_delay_us = 2000;        // a partial batch is run when its oldest request waited this long
+    uint32_t num_slots = 0;              // output slots, 0: 4 * batch_size, Submit blocks while all are in use
+    char reserve[8];
+} DVPPBatchAggregatorConfig;
+
+typedef struct{
+    int status = 0;             // 1 success, 0 failed
+    int image_status = 0;       // DvppImageStatus, why this request failed
+    int slot = -1;              // output slot, give it back by Release once resized is consumed
+    DVPPImageData resized;      // device memory of the slot, resized.data is nullptr if failed
+    uint32_t batch_img_num = 0; // images of the vpc batch this request was in
+    uint64_t wait_us = 0;       // Submit -> batch launch
+} DVPPBatchResult;
+
+typedef struct{
+    uint64_t submit_count = 0;
+    uint64_t batch_count = 0;
+    uint64_t full_batch_count = 0;      // run because batch_size requests were pending
+    uint64_t deadline_batch_count = 0;  // run because the oldest request hit max_delay_us
+    uint64_t failed_count = 0;          // failed requests, a bad image fails only its own request
+    uint64_t max_wait_us = 0;
+} DVPPBatchAggregatorStats;
+
+/**
+* @brief many threads submit single images, one dispatcher thread forms batches of DvppResize,
+*        a batch is run when batch_size requests are pending or the oldest one waited max_delay_us:
+*        std::future<DVPPBatchResult> f = aggregator.Submit(image, &roi); ... aggregator.Release(f.get().slot);
+*/
+class BatchAggregator {
+public:
+    BatchAggregator();
+
+    ~BatchAggregator();
+
+    void Init(const DVPPBatchAggregatorConfig* config);
+
+    /**
+    * @brief queue one image, thread safe, blocks while every output slot is in use
+    * @param [in] image: image.data must stay valid until the future is ready
+    * @param [in] roi: nullptr resizes the full image
+    * @return future of the result, a failed result(status 0) at once if not init or shutting down
+    */
+    std::future<DVPPBatchResult> Submit(const DVPPImageData& image, const RectInt* roi = nullptr);
+
+    /**
+    * @brief give the output slot of a result back, slot -1 is ignored
+    */
+    void Release(int slot);
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    DVPPBatchAggregatorStats GetStats() const;
+
+    /**
+    * @brief run the pending requests, stop the dispatcher and free the slots,
+    *        outputs of results not released yet become invalid
+    */
+    void DestroyResource();
+
+private:
+    struct Request {
+        DVPPImageData image;
+        RectInt roi;
+        int slot;
+        uint64_t submit_ns;
+        std::promise<DVPPBatchResult> promise;
+    };
+
+    void DispatchLoop();
+
+    void RunBatch(std::vector<Request>& batch, bool by_deadline);
+
+    inline uint8_t* SlotData(int slot) const
+    {
+        return static_cast<uint8_t*>(slots_dev_) + static_cast<size_t>(slot) * slot_size_;
+    }
+
+private:
+    DVPPBatchAggregatorConfig config_;
+    DvppResize resize_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable pending_cv_;  // dispatcher: new request or stop
+    std::condition_variable slot_cv_;     // submitters: a slot was released
+    std::deque<Request> pending_;
+    std::vector<int> free_slots_;
+    bool stop_;
+    std::thread dispatcher_;
+
+    void* slots_dev_;
+    uint32_t slot_size_;
+
+    // used by the dispatcher only
+    std::vector<DVPPImageData> batch_images_;
+    std::vector<RectInt> batch_rois_;
+    std::vector<uint8_t*> batch_slots_;
+
+    DVPPBatchAggregatorStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_BATCH_AGGREGATOR_H
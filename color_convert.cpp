@@ -0,0 +1,514 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include "color_convert.h"
+#include "alg_define.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CVT_HAS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include "common/utils/simd_shuffle.hpp"
+#define CVT_HAS_AVX2 1
+#endif
+
+/*
+* BT.601 limited range, the integer math below is shared by all kernels so that they are bit-exact:
+*   Y = ((66R + 129G + 25B + 128) >> 8) + 16
+*   U = ((-38R - 74G + 112B + 128) >> 8) + 128, V = ((112R - 94G - 18B + 128) >> 8) + 128, RGB of 2x2 averaged
+*   C = 74(Y - 16), D = U - 128, E = V - 128
+*   R = (C + 102E + 32) >> 6, G = (C - 25D - 52E + 32) >> 6, B = (C + 129D + 32) >> 6, saturated to [0, 255]
+*/
+
+typedef struct{
+    uint8_t* data;       // packed pixels or luma
+    uint32_t stride;
+    uint8_t* u;
+    uint8_t* v;
+    uint32_t uv_stride;
+    uint32_t uv_step;    // 2 for semi-planar, 1 for planar
+    uint32_t size;       // bytes needed
+} ColorPlanes;
+
+// kernels convert one row pair [x_begin, width), SIMD ones return the pixels they converted
+typedef int (*PackedToYuvFunc)(const uint8_t* src0, const uint8_t* src1, uint8_t* y0, uint8_t* y1,
+                               uint8_t* u, uint8_t* v, int uv_step, int width, int rgb);
+typedef int (*YuvToPackedFunc)(const uint8_t* y0, const uint8_t* y1, const uint8_t* u, const uint8_t* v,
+                               int uv_step, uint8_t* dst0, uint8_t* dst1, int width, int rgb);
+
+static inline bool IsPackedFormat(uint32_t format)
+{
+    return CVT_FORMAT_BGR == format || CVT_FORMAT_RGB == format;
+}
+
+static inline uint8_t ClampU8(int val)
+{
+    return static_cast<uint8_t>(val < 0 ? 0 : (val > 255 ? 255 : val));
+}
+
+static int GetColorPlanes(const DVPPImageData& image, uint32_t format, ColorPlanes& planes)
+{
+    planes.data = image.data;
+    if (IsPackedFormat(format))
+    {
+        planes.stride = image.alignWidth ? image.alignWidth : image.width * 3;
+        planes.u = planes.v = nullptr;
+        planes.uv_stride = planes.uv_step = 0;
+        planes.size = planes.stride * image.height;
+        return planes.stride >= image.width * 3 ? 1 : 0;
+    }
+    if (CVT_FORMAT_NV12 != format && CVT_FORMAT_NV21 != format && CVT_FORMAT_I420 != format)
+    {
+        return 0;
+    }
+    planes.stride = image.alignWidth ? image.alignWidth : image.width;
+    uint32_t rows = image.alignHeight ? image.alignHeight : image.height;
+    if (planes.stride < image.width || rows < image.height || 0 != planes.stride % 2 || 0 != rows % 2)
+    {
+        return 0;
+    }
+    uint8_t* chroma = image.data + planes.stride * rows;
+    if (CVT_FORMAT_I420 == format)
+    {
+        planes.uv_stride = planes.stride / 2;
+        planes.uv_step = 1;
+        planes.u = chroma;
+        planes.v = chroma + planes.uv_stride * (rows / 2);
+    }
+    else
+    {
+        planes.uv_stride = planes.stride;
+        planes.uv_step = 2;
+        planes.u = CVT_FORMAT_NV12 == format ? chroma : chroma + 1;
+        planes.v = CVT_FORMAT_NV12 == format ? chroma + 1 : chroma;
+    }
+    planes.size = YUV420SP_SIZE(planes.stride, rows);
+    return 1;
+}
+
+uint32_t ColorImageSize(const DVPPImageData& image, uint32_t format)
+{
+    ColorPlanes planes;
+    return 1 == GetColorPlanes(image, format, planes) ? planes.size : 0;
+}
+
+static void PackedToYuvScalar(const uint8_t* src0, const uint8_t* src1, uint8_t* y0, uint8_t* y1,
+                              uint8_t* u, uint8_t* v, int uv_step, int x_begin, int width, int rgb)
+{
+    int ib = rgb ? 2 : 0;
+    int ir = rgb ? 0 : 2;
+    for (int x = x_begin; x < width; x += 2)
+    {
+        const uint8_t* p00 = src0 + x * 3;
+        const uint8_t* p01 = p00 + 3;
+        const uint8_t* p10 = src1 + x * 3;
+        const uint8_t* p11 = p10 + 3;
+        y0[x] = static_cast<uint8_t>(((66 * p00[ir] + 129 * p00[1] + 25 * p00[ib] + 128) >> 8) + 16);
+        y0[x + 1] = static_cast<uint8_t>(((66 * p01[ir] + 129 * p01[1] + 25 * p01[ib] + 128) >> 8) + 16);
+        y1[x] = static_cast<uint8_t>(((66 * p10[ir] + 129 * p10[1] + 25 * p10[ib] + 128) >> 8) + 16);
+        y1[x + 1] = static_cast<uint8_t>(((66 * p11[ir] + 129 * p11[1] + 25 * p11[ib] + 128) >> 8) + 16);
+
+        int b = (p00[ib] + p01[ib] + p10[ib] + p11[ib] + 2) >> 2;
+        int g = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+        int r = (p00[ir] + p01[ir] + p10[ir] + p11[ir] + 2) >> 2;
+        u[(x / 2) * uv_step] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        v[(x / 2) * uv_step] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+static void YuvToPackedScalar(const uint8_t* y0, const uint8_t* y1, const uint8_t* u, const uint8_t* v,
+                              int uv_step, uint8_t* dst0, uint8_t* dst1, int x_begin, int width, int rgb)
+{
+    int ib = rgb ? 2 : 0;
+    int ir = rgb ? 0 : 2;
+    for (int x = x_begin; x < width; x += 2)
+    {
+        int d = u[(x / 2) * uv_step] - 128;
+        int e = v[(x / 2) * uv_step] - 128;
+        int rc = 102 * e + 32;
+        int gc = -25 * d - 52 * e + 32;
+        int bc = 129 * d + 32;
+        const uint8_t* ys[4] = {y0 + x, y0 + x + 1, y1 + x, y1 + x + 1};
+        uint8_t* ds[4] = {dst0 + x * 3, dst0 + x * 3 + 3, dst1 + x * 3, dst1 + x * 3 + 3};
+        for (int idx = 0; idx < 4; ++idx)
+        {
+            int c = 74 * (*ys[idx] - 16);
+            ds[idx][ib] = ClampU8((c + bc) >> 6);
+            ds[idx][1] = ClampU8((c + gc) >> 6);
+            ds[idx][ir] = ClampU8((c + rc) >> 6);
+        }
+    }
+}
+
+#if defined(CVT_HAS_NEON)
+static int PackedToYuvNeon(const uint8_t* src0, const uint8_t* src1, uint8_t* y0, uint8_t* y1,
+                           uint8_t* u, uint8_t* v, int uv_step, int width, int rgb)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t p0 = vld3q_u8(src0 + x * 3);
+        uint8x16x3_t p1 = vld3q_u8(src1 + x * 3);
+        uint8x16_t b[2] = {rgb ? p0.val[2] : p0.val[0], rgb ? p1.val[2] : p1.val[0]};
+        uint8x16_t g[2] = {p0.val[1], p1.val[1]};
+        uint8x16_t r[2] = {rgb ? p0.val[0] : p0.val[2], rgb ? p1.val[0] : p1.val[2]};
+        uint8_t* ys[2] = {y0 + x, y1 + x};
+        for (int row = 0; row < 2; ++row)
+        {
+            uint16x8_t lo = vmull_u8(vget_low_u8(r[row]), vdup_n_u8(66));
+            lo = vmlal_u8(lo, vget_low_u8(g[row]), vdup_n_u8(129));
+            lo = vmlal_u8(lo, vget_low_u8(b[row]), vdup_n_u8(25));
+            uint16x8_t hi = vmull_u8(vget_high_u8(r[row]), vdup_n_u8(66));
+            hi = vmlal_u8(hi, vget_high_u8(g[row]), vdup_n_u8(129));
+            hi = vmlal_u8(hi, vget_high_u8(b[row]), vdup_n_u8(25));
+            uint8x16_t luma = vcombine_u8(vshrn_n_u16(vaddq_u16(lo, vdupq_n_u16(128)), 8),
+                                          vshrn_n_u16(vaddq_u16(hi, vdupq_n_u16(128)), 8));
+            vst1q_u8(ys[row], vaddq_u8(luma, vdupq_n_u8(16)));
+        }
+
+        // 2x2 sums: pairwise horizontal add of both rows
+        int16x8_t sb = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(vaddq_u16(vpaddlq_u8(b[0]), vpaddlq_u8(b[1])),
+                                                                   vdupq_n_u16(2)), 2));
+        int16x8_t sg = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(vaddq_u16(vpaddlq_u8(g[0]), vpaddlq_u8(g[1])),
+                                                                   vdupq_n_u16(2)), 2));
+        int16x8_t sr = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(vaddq_u16(vpaddlq_u8(r[0]), vpaddlq_u8(r[1])),
+                                                                   vdupq_n_u16(2)), 2));
+        int16x8_t uu = vmlaq_n_s16(vmlaq_n_s16(vmulq_n_s16(sr, -38), sg, -74), sb, 112);
+        int16x8_t vv = vmlaq_n_s16(vmlaq_n_s16(vmulq_n_s16(sr, 112), sg, -94), sb, -18);
+        uu = vaddq_s16(vshrq_n_s16(vaddq_s16(uu, vdupq_n_s16(128)), 8), vdupq_n_s16(128));
+        vv = vaddq_s16(vshrq_n_s16(vaddq_s16(vv, vdupq_n_s16(128)), 8), vdupq_n_s16(128));
+        uint8x8_t u8 = vqmovun_s16(uu);
+        uint8x8_t v8 = vqmovun_s16(vv);
+        if (2 == uv_step)
+        {
+            uint8x8x2_t uv;
+            uv.val[0] = u < v ? u8 : v8;
+            uv.val[1] = u < v ? v8 : u8;
+            vst2_u8((u < v ? u : v) + x, uv);
+        }
+        else
+        {
+            vst1_u8(u + x / 2, u8);
+            vst1_u8(v + x / 2, v8);
+        }
+    }
+    return x;
+}
+
+static int YuvToPackedNeon(const uint8_t* y0, const uint8_t* y1, const uint8_t* u, const uint8_t* v,
+                           int uv_step, uint8_t* dst0, uint8_t* dst1, int width, int rgb)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x8_t u8, v8;
+        if (2 == uv_step)
+        {
+            uint8x8x2_t uv = vld2_u8((u < v ? u : v) + x);
+            u8 = u < v ? uv.val[0] : uv.val[1];
+            v8 = u < v ? uv.val[1] : uv.val[0];
+        }
+        else
+        {
+            u8 = vld1_u8(u + x / 2);
+            v8 = vld1_u8(v + x / 2);
+        }
+        int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+        int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+        // one chroma sample per two pixels
+        int16x8x2_t rc = vzipq_s16(vmlaq_n_s16(vdupq_n_s16(32), e, 102), vmlaq_n_s16(vdupq_n_s16(32), e, 102));
+        int16x8_t gc8 = vmlaq_n_s16(vmlaq_n_s16(vdupq_n_s16(32), d, -25), e, -52);
+        int16x8x2_t gc = vzipq_s16(gc8, gc8);
+        int16x8x2_t bc = vzipq_s16(vmlaq_n_s16(vdupq_n_s16(32), d, 129), vmlaq_n_s16(vdupq_n_s16(32), d, 129));
+
+        const uint8_t* ys[2] = {y0 + x, y1 + x};
+        uint8_t* ds[2] = {dst0 + x * 3, dst1 + x * 3};
+        for (int row = 0; row < 2; ++row)
+        {
+            uint8x16_t luma = vld1q_u8(ys[row]);
+            int16x8_t c[2] = {
+                    vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(luma))), vdupq_n_s16(16)), 74),
+                    vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(luma))), vdupq_n_s16(16)), 74)};
+            uint8x16_t bb = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[0], bc.val[0]), 6)),
+                                        vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[1], bc.val[1]), 6)));
+            uint8x16_t gg = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[0], gc.val[0]), 6)),
+                                        vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[1], gc.val[1]), 6)));
+            uint8x16_t rr = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[0], rc.val[0]), 6)),
+                                        vqmovun_s16(vshrq_n_s16(vqaddq_s16(c[1], rc.val[1]), 6)));
+            uint8x16x3_t px;
+            px.val[0] = rgb ? rr : bb;
+            px.val[1] = gg;
+            px.val[2] = rgb ? bb : rr;
+            vst3q_u8(ds[row], px);
+        }
+    }
+    return x;
+}
+#endif
+
+#if defined(CVT_HAS_AVX2)
+__attribute__((target("avx2")))
+static inline __m128i PackU16ToU8Avx2(__m256i val)
+{
+    // 16 lanes [0..7 | 8..15] -> 16 bytes
+    __m256i packed = _mm256_packus_epi16(val, val);
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, 0x08));
+}
+
+__attribute__((target("avx2")))
+static inline __m128i PackChromaAvx2(__m256i val)
+{
+    // hadd layout [c0..c3 c0..c3 | c4..c7 c4..c7] -> 8 bytes c0..c7
+    __m128i lanes = _mm256_castsi256_si128(_mm256_permute4x64_epi64(val, 0x08));
+    return _mm_packus_epi16(lanes, lanes);
+}
+
+__attribute__((target("avx2")))
+static int PackedToYuvAvx2(const uint8_t* src0, const uint8_t* src1, uint8_t* y0, uint8_t* y1,
+                           uint8_t* u, uint8_t* v, int uv_step, int width, int rgb)
+{
+    const alg_utils::ShuffleTables& tables = alg_utils::GetShuffleTables();
+    __m128i split[3][3];
+    for (int k = 0; k < 3; ++k)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            split[k][m] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.split[k][m]));
+        }
+    }
+    int ib = rgb ? 2 : 0;
+    int ir = rgb ? 0 : 2;
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8_t* srcs[2] = {src0 + x * 3, src1 + x * 3};
+        uint8_t* ys[2] = {y0 + x, y1 + x};
+        __m256i b[2], g[2], r[2];
+        for (int row = 0; row < 2; ++row)
+        {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[row]));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[row] + 16));
+            __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcs[row] + 32));
+            __m256i ch[3];
+            for (int k = 0; k < 3; ++k)
+            {
+                __m128i bytes = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, split[k][0]),
+                                                          _mm_shuffle_epi8(a1, split[k][1])),
+                                             _mm_shuffle_epi8(a2, split[k][2]));
+                ch[k] = _mm256_cvtepu8_epi16(bytes);
+            }
+            b[row] = ch[ib];
+            g[row] = ch[1];
+            r[row] = ch[ir];
+            __m256i luma = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(r[row], _mm256_set1_epi16(66)),
+                                                             _mm256_mullo_epi16(g[row], _mm256_set1_epi16(129))),
+                                            _mm256_add_epi16(_mm256_mullo_epi16(b[row], _mm256_set1_epi16(25)),
+                                                             _mm256_set1_epi16(128)));
+            luma = _mm256_add_epi16(_mm256_srli_epi16(luma, 8), _mm256_set1_epi16(16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(ys[row]), PackU16ToU8Avx2(luma));
+        }
+
+        __m256i two = _mm256_set1_epi16(2);
+        __m256i sb = _mm256_add_epi16(b[0], b[1]);
+        __m256i sg = _mm256_add_epi16(g[0], g[1]);
+        __m256i sr = _mm256_add_epi16(r[0], r[1]);
+        sb = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(sb, sb), two), 2);
+        sg = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(sg, sg), two), 2);
+        sr = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(sr, sr), two), 2);
+        __m256i bias = _mm256_set1_epi16(128);
+        __m256i uu = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sr, _mm256_set1_epi16(-38)),
+                                                       _mm256_mullo_epi16(sg, _mm256_set1_epi16(-74))),
+                                      _mm256_add_epi16(_mm256_mullo_epi16(sb, _mm256_set1_epi16(112)), bias));
+        __m256i vv = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(sr, _mm256_set1_epi16(112)),
+                                                       _mm256_mullo_epi16(sg, _mm256_set1_epi16(-94))),
+                                      _mm256_add_epi16(_mm256_mullo_epi16(sb, _mm256_set1_epi16(-18)), bias));
+        __m128i u8 = PackChromaAvx2(_mm256_add_epi16(_mm256_srai_epi16(uu, 8), bias));
+        __m128i v8 = PackChromaAvx2(_mm256_add_epi16(_mm256_srai_epi16(vv, 8), bias));
+        if (2 == uv_step)
+        {
+            __m128i uv = u < v ? _mm_unpacklo_epi8(u8, v8) : _mm_unpacklo_epi8(v8, u8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>((u < v ? u : v) + x), uv);
+        }
+        else
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), u8);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), v8);
+        }
+    }
+    return x;
+}
+
+__attribute__((target("avx2")))
+static int YuvToPackedAvx2(const uint8_t* y0, const uint8_t* y1, const uint8_t* u, const uint8_t* v,
+                           int uv_step, uint8_t* dst0, uint8_t* dst1, int width, int rgb)
+{
+    const alg_utils::ShuffleTables& tables = alg_utils::GetShuffleTables();
+    __m128i merge[3][3];
+    for (int k = 0; k < 3; ++k)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            merge[k][m] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.merge[k][m]));
+        }
+    }
+    const __m128i even = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -128, -128, -128, -128, -128, -128, -128, -128);
+    const __m128i odd = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -128, -128, -128, -128, -128, -128, -128, -128);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i u8, v8;
+        if (2 == uv_step)
+        {
+            __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i*>((u < v ? u : v) + x));
+            u8 = _mm_shuffle_epi8(uv, u < v ? even : odd);
+            v8 = _mm_shuffle_epi8(uv, u < v ? odd : even);
+        }
+        else
+        {
+            u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+            v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+        }
+        // one chroma sample per two pixels
+        __m256i d = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), _mm256_set1_epi16(128));
+        __m256i e = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), _mm256_set1_epi16(128));
+        __m256i round = _mm256_set1_epi16(32);
+        __m256i rc = _mm256_add_epi16(_mm256_mullo_epi16(e, _mm256_set1_epi16(102)), round);
+        __m256i gc = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(-25)),
+                                                       _mm256_mullo_epi16(e, _mm256_set1_epi16(-52))), round);
+        __m256i bc = _mm256_add_epi16(_mm256_mullo_epi16(d, _mm256_set1_epi16(129)), round);
+
+        const uint8_t* ys[2] = {y0 + x, y1 + x};
+        uint8_t* ds[2] = {dst0 + x * 3, dst1 + x * 3};
+        for (int row = 0; row < 2; ++row)
+        {
+            __m256i luma = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys[row])));
+            __m256i c = _mm256_mullo_epi16(_mm256_sub_epi16(luma, _mm256_set1_epi16(16)), _mm256_set1_epi16(74));
+            __m128i ch[3];
+            ch[rgb ? 2 : 0] = PackU16ToU8Avx2(_mm256_srai_epi16(_mm256_adds_epi16(c, bc), 6));
+            ch[1] = PackU16ToU8Avx2(_mm256_srai_epi16(_mm256_adds_epi16(c, gc), 6));
+            ch[rgb ? 0 : 2] = PackU16ToU8Avx2(_mm256_srai_epi16(_mm256_adds_epi16(c, rc), 6));
+            for (int k = 0; k < 3; ++k)
+            {
+                __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(ch[0], merge[k][0]),
+                                                        _mm_shuffle_epi8(ch[1], merge[k][1])),
+                                           _mm_shuffle_epi8(ch[2], merge[k][2]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ds[row] + 16 * k), out);
+            }
+        }
+    }
+    return x;
+}
+#endif
+
+typedef struct{
+    PackedToYuvFunc packed_to_yuv;
+    YuvToPackedFunc yuv_to_packed;
+    const char* isa;
+} CvtKernels;
+
+static CvtKernels PickKernels()
+{
+    CvtKernels kernels = {nullptr, nullptr, "scalar"};
+#if defined(CVT_HAS_NEON)
+    kernels.packed_to_yuv = PackedToYuvNeon;
+    kernels.yuv_to_packed = YuvToPackedNeon;
+    kernels.isa = "neon";
+#elif defined(CVT_HAS_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.packed_to_yuv = PackedToYuvAvx2;
+        kernels.yuv_to_packed = YuvToPackedAvx2;
+        kernels.isa = "avx2";
+    }
+#endif
+    return kernels;
+}
+
+static const CvtKernels& SimdKernels()
+{
+    static const CvtKernels kernels = PickKernels();
+    return kernels;
+}
+
+const char* ConvertColorIsa()
+{
+    return SimdKernels().isa;
+}
+
+int ConvertColor(const DVPPImageData& src, uint32_t src_format, DVPPImageData& dst, uint32_t dst_format,
+                 WorkerPool* pool, bool use_simd)
+{
+    bool to_yuv = IsPackedFormat(src_format);
+    if (to_yuv == IsPackedFormat(dst_format))
+    {
+        AIALG_ERROR("unsupported conversion %d -> %d\n", src_format, dst_format);
+        return 0;
+    }
+    if (!src.data || !dst.data || 0 == src.width || 0 == src.height || 0 != src.width % 2 || 0 != src.height % 2)
+    {
+        AIALG_ERROR("bad image, %dx%d, width and height must be even\n", src.width, src.height);
+        return 0;
+    }
+    dst.width = src.width;
+    dst.height = src.height;
+    ColorPlanes src_planes, dst_planes;
+    if (1 != GetColorPlanes(src, src_format, src_planes) || 1 != GetColorPlanes(dst, dst_format, dst_planes))
+    {
+        AIALG_ERROR("bad stride of src or dst\n");
+        return 0;
+    }
+    if ((src.size && src.size < src_planes.size) || (dst.size && dst.size < dst_planes.size))
+    {
+        AIALG_ERROR("buffer too small, src %d < %d or dst %d < %d\n", src.size, src_planes.size, dst.size, dst_planes.size);
+        return 0;
+    }
+
+    DVPP_TIMELINE_SCOPE("color_convert", to_yuv ? "packed_to_yuv" : "yuv_to_packed", src.height);
+    const CvtKernels& kernels = SimdKernels();
+    int rgb = CVT_FORMAT_RGB == src_format || CVT_FORMAT_RGB == dst_format;
+    int width = src.width;
+    const ColorPlanes& packed = to_yuv ? src_planes : dst_planes;
+    const ColorPlanes& yuv = to_yuv ? dst_planes : src_planes;
+    auto convert_rows = [&](int begin, int end, int)
+    {
+        for (int pair = begin; pair < end; ++pair)
+        {
+            uint8_t* p0 = packed.data + (2 * pair) * packed.stride;
+            uint8_t* p1 = p0 + packed.stride;
+            uint8_t* y0 = yuv.data + (2 * pair) * yuv.stride;
+            uint8_t* y1 = y0 + yuv.stride;
+            uint8_t* u = yuv.u + pair * yuv.uv_stride;
+            uint8_t* v = yuv.v + pair * yuv.uv_stride;
+            int x = 0;
+            if (to_yuv)
+            {
+                if (use_simd && kernels.packed_to_yuv)
+                {
+                    x = kernels.packed_to_yuv(p0, p1, y0, y1, u, v, yuv.uv_step, width, rgb);
+                }
+                PackedToYuvScalar(p0, p1, y0, y1, u, v, yuv.uv_step, x, width, rgb);
+            }
+            else
+            {
+                if (use_simd && kernels.yuv_to_packed)
+                {
+                    x = kernels.yuv_to_packed(y0, y1, u, v, yuv.uv_step, p0, p1, width, rgb);
+                }
+                YuvToPackedScalar(y0, y1, u, v, yuv.uv_step, p0, p1, x, width, rgb);
+            }
+        }
+    };
+
+    int pairs = src.height / 2;
+    if (pool && pool->NumWorkers() > 1 && src.height >= CVT_PARALLEL_MIN_ROWS)
+    {
+        pool->ParallelFor(0, pairs, convert_rows, CVT_BAND_ROWS / 2);
+    }
+    else
+    {
+        convert_rows(0, pairs, 0);
+    }
+    return 1;
+}
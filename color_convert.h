@@ -0,0 +1,48 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_COLOR_CONVERT_H
+#define _PICTURE_INC_COLOR_CONVERT_H
+
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "worker_pool.h"
+
+enum CvtColorFormat {
+    CVT_FORMAT_BGR = 0,  // packed, alignWidth is the row stride in bytes, 0: width * 3
+    CVT_FORMAT_RGB,
+    CVT_FORMAT_NV12,     // alignWidth/alignHeight are the luma width/height stride, 0: width/height
+    CVT_FORMAT_NV21,
+    CVT_FORMAT_I420,     // u and v planes have half of the luma width stride
+};
+
+// frames with at least this many rows are split into row bands over the worker pool
+#define CVT_PARALLEL_MIN_ROWS 256
+#define CVT_BAND_ROWS 32
+
+/**
+* @brief single pass BGR/RGB <-> NV12/NV21/I420 conversion(BT.601 limited range, 2x2 averaged chroma),
+*        src and dst are host memory laid out like DVPPImageData, nothing is allocated,
+*        NEON/AVX2 kernels give the same bytes as the scalar ones
+* @param [in] src: width and height must be even
+* @param [in] dst: dst.data, and optionally dst.alignWidth/alignHeight/size, are set by caller,
+*                  dst.width/dst.height are set to the src ones
+* @param [in] pool: nullptr converts on the calling thread
+* @param [in] use_simd: false runs the scalar reference kernels
+* @return 1 success, 0 failed(unsupported pair, odd size or buffer too small)
+*/
+int ConvertColor(const DVPPImageData& src, uint32_t src_format, DVPPImageData& dst, uint32_t dst_format,
+                 WorkerPool* pool = nullptr, bool use_simd = true);
+
+/**
+* @brief bytes of a width x height image of format, alignWidth/alignHeight are used when not 0
+*/
+uint32_t ColorImageSize(const DVPPImageData& image, uint32_t format);
+
+/**
+* @brief "neon", "avx2" or "scalar", the kernels ConvertColor uses with use_simd
+*/
+const char* ConvertColorIsa();
+
+#endif // _PICTURE_INC_COLOR_CONVERT_H
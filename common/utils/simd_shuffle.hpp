@@ -0,0 +1,42 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef ALG_UTILS_SIMD_SHUFFLE_HPP
+#define ALG_UTILS_SIMD_SHUFFLE_HPP
+
+#include <cstdint>
+
+namespace alg_utils
+{
+    // pshufb masks between 48 packed 3-channel bytes and 16 bytes of each channel
+    struct ShuffleTables
+    {
+        uint8_t split[3][3][16];  // [channel][source vector]
+        uint8_t merge[3][3][16];  // [output vector][channel]
+        ShuffleTables()
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                for (int j = 0; j < 16; ++j)
+                {
+                    for (int m = 0; m < 3; ++m)
+                    {
+                        int byte = 3 * j + k;  // byte of channel k of pixel j
+                        split[k][m][j] = byte / 16 == m ? byte % 16 : 0x80;
+                        int out = 16 * k + j;  // output byte j of vector k
+                        merge[k][m][j] = out % 3 == m ? out / 3 : 0x80;
+                    }
+                }
+            }
+        }
+    };
+
+    inline const ShuffleTables& GetShuffleTables()
+    {
+        static const ShuffleTables tables;
+        return tables;
+    }
+}
+
+#endif //ALG_UTILS_SIMD_SHUFFLE_HPP
@@ -0,0 +1,599 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include "cpu_resize.h"
+#include "alg_define.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CPU_RESIZE_HAS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RESIZE_HAS_AVX2 1
+#endif
+
+static inline uint8_t SaturateU8(float val)
+{
+    int v = static_cast<int>(val + 0.5f);
+    return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// dst[i] = s0[i] * w0 + s1[i] * w1 of n bytes, Q RESIZE_COEF_BITS
+static inline int VResizeRowScalar(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst,
+                                   int begin, int n)
+{
+    for (int i = begin; i < n; ++i)
+    {
+        dst[i] = s0[i] * w0 + s1[i] * w1;
+    }
+    return n;
+}
+
+#if defined(CPU_RESIZE_HAS_NEON)
+static int VResizeRowSimd(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst, int n)
+{
+    uint16_t uw0 = static_cast<uint16_t>(w0);
+    uint16_t uw1 = static_cast<uint16_t>(w1);
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        uint16x8_t a = vmovl_u8(vld1_u8(s0 + i));
+        uint16x8_t b = vmovl_u8(vld1_u8(s1 + i));
+        uint32x4_t lo = vmlal_n_u16(vmull_n_u16(vget_low_u16(a), uw0), vget_low_u16(b), uw1);
+        uint32x4_t hi = vmlal_n_u16(vmull_n_u16(vget_high_u16(a), uw0), vget_high_u16(b), uw1);
+        vst1q_s32(dst + i, vreinterpretq_s32_u32(lo));
+        vst1q_s32(dst + i + 4, vreinterpretq_s32_u32(hi));
+    }
+    return i;
+}
+#elif defined(CPU_RESIZE_HAS_AVX2)
+__attribute__((target("avx2")))
+static int VResizeRowAvx2(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst, int n)
+{
+    // (s0, s1) int16 pairs madd (w0, w1) pairs is s0 * w0 + s1 * w1 in int32
+    __m256i weights = _mm256_set1_epi32((w1 << 16) | (w0 & 0xFFFF));
+    int i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + i)));
+        __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)));
+        // lane-wise: lo = [0-3 | 8-11], hi = [4-7 | 12-15]
+        __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights);
+        __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    return i;
+}
+
+static int VResizeRowSimd(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst, int n)
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2 ? VResizeRowAvx2(s0, s1, w0, w1, dst, n) : 0;
+}
+#else
+static int VResizeRowSimd(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst, int n)
+{
+    return 0;
+}
+#endif
+
+static inline void VResizeRow(const uint8_t* s0, const uint8_t* s1, int w0, int w1, int32_t* dst, int n)
+{
+    VResizeRowScalar(s0, s1, w0, w1, dst, VResizeRowSimd(s0, s1, w0, w1, dst, n), n);
+}
+
+// horizontal pass of the vertically interpolated row, Q 2 * RESIZE_COEF_BITS
+static inline int32_t HResize(const int32_t* row, int a, int b, int wa, int wb)
+{
+    return row[a] * wa + row[b] * wb;
+}
+
+#define CPU_RESIZE_SHIFT (2 * RESIZE_COEF_BITS)
+#define CPU_RESIZE_ROUND (1 << (CPU_RESIZE_SHIFT - 1))
+
+// rows of one row tile, large images are split so that all workers stay busy on small batches
+#define CPU_RESIZE_TILE_ROWS 32
+
+CpuResize::CpuResize() : out_width_stride_(0), out_buffer_size_(0), max_row_bytes_(0), pool_(nullptr),
+                         has_init_over_(false)
+{
+
+}
+
+CpuResize::~CpuResize()
+{
+
+}
+
+void CpuResize::Init(const DVPPResizeInitConfig *dvppResizeInitConfig)
+{
+    dvppResizeInitConfig_ = *dvppResizeInitConfig;
+    if (PIXEL_FORMAT_BGR_888 != dvppResizeInitConfig_.input_format &&
+        PIXEL_FORMAT_YUV_SEMIPLANAR_420 != dvppResizeInitConfig_.input_format)
+    {
+        AIALG_ERROR("CpuResize only support BGR_888 and YUV_SEMIPLANAR_420, input_format = %d\n",
+                    dvppResizeInitConfig_.input_format);
+        return;
+    }
+    if (1 != ResolveDvppBatchSize(dvppResizeInitConfig_))
+    {
+        return;
+    }
+    out_width_stride_ = ALIGN_UP16(dvppResizeInitConfig_.resized_width) * 3;
+    out_buffer_size_ = out_width_stride_ * ALIGN_UP2(dvppResizeInitConfig_.resized_height);
+    out_data_.assign(static_cast<size_t>(out_buffer_size_) * dvppResizeInitConfig_.batch_size, 0);
+    cascade_bufs_[0].resize(dvppResizeInitConfig_.batch_size);
+    cascade_bufs_[1].resize(dvppResizeInitConfig_.batch_size);
+    has_init_over_ = true;
+}
+
+void CpuResize::DestroyResource()
+{
+    std::vector<uint8_t>().swap(out_data_);
+    std::vector<CropTask>().swap(tasks_);
+    for (int buffer = 0; buffer < 2; ++buffer)
+    {
+        std::vector<CascadeBuffer>().swap(cascade_bufs_[buffer]);
+    }
+    std::vector<std::vector<int32_t> >().swap(row_bufs_);
+    std::vector<DVPPImageStats>().swap(image_stats_);
+    has_init_over_ = false;
+}
+
+void CpuResize::ResizeRows(const CropTask &task, int row_begin, int row_end, int col_begin, int col_end,
+                           int32_t* row_buf)
+{
+    const DVPPImageData& srcImage = *task.src;
+    const ResizeTables& tables = *task.tables;
+    const ResizeTableKey& key = tables.key;
+    uint8_t* dst = task.dst;
+
+    bool is_bgr = PIXEL_FORMAT_BGR_888 == task.format;
+    uint32_t width_stride, height_stride, buffer_size;
+    GetDvppInputStride(task.format, srcImage, width_stride, height_stride, buffer_size);
+    const uint8_t* src_crop = srcImage.data + key.left * key.pixel_step;
+    const uint8_t* src_uv = srcImage.data + width_stride * height_stride;
+    row_begin = row_begin > key.out_top ? row_begin : key.out_top;
+    row_end = row_end < key.out_bottom + 1 ? row_end : key.out_bottom + 1;
+    col_begin = (col_begin > key.out_left ? col_begin : key.out_left) - key.out_left;
+    col_end = (col_end < key.out_right + 1 ? col_end : key.out_right + 1) - key.out_left;
+    if (col_begin >= col_end)
+    {
+        return;
+    }
+    // the vertical pass is per byte, only the bytes the columns read are interpolated
+    int byte_begin = tables.xofs[2 * col_begin];
+    int row_bytes = tables.xofs[2 * (col_end - 1) + 1] + key.pixel_step - byte_begin;
+    for (int dy = row_begin; dy < row_end; ++dy)
+    {
+        int ty = 2 * (dy - key.out_top);
+        VResizeRow(src_crop + tables.yofs[ty] * width_stride + byte_begin,
+                   src_crop + tables.yofs[ty + 1] * width_stride + byte_begin,
+                   tables.yw[ty], tables.yw[ty + 1], row_buf + byte_begin, row_bytes);
+        uint8_t* out = dst + dy * task.dst_stride + key.out_left * 3;
+        const int32_t* xofs = tables.xofs;
+        const int16_t* xw = tables.xw;
+        if (is_bgr)
+        {
+            for (int dx = col_begin; dx < col_end; ++dx)
+            {
+                int a = xofs[2 * dx];
+                int b = xofs[2 * dx + 1];
+                int wa = xw[2 * dx];
+                int wb = xw[2 * dx + 1];
+                out[dx * 3 + 0] = static_cast<uint8_t>((HResize(row_buf, a, b, wa, wb) + CPU_RESIZE_ROUND) >> CPU_RESIZE_SHIFT);
+                out[dx * 3 + 1] = static_cast<uint8_t>((HResize(row_buf + 1, a, b, wa, wb) + CPU_RESIZE_ROUND) >> CPU_RESIZE_SHIFT);
+                out[dx * 3 + 2] = static_cast<uint8_t>((HResize(row_buf + 2, a, b, wa, wb) + CPU_RESIZE_ROUND) >> CPU_RESIZE_SHIFT);
+            }
+        }
+        else
+        {
+            // BT.601 limited range, the same as vpc csc of yuv420sp -> bgr888
+            const uint8_t* uv_row = src_uv + tables.uv_yofs[dy - key.out_top] * width_stride;
+            for (int dx = col_begin; dx < col_end; ++dx)
+            {
+                float Y = HResize(row_buf, xofs[2 * dx], xofs[2 * dx + 1], xw[2 * dx], xw[2 * dx + 1]) *
+                          (1.0f / (1 << CPU_RESIZE_SHIFT)) - 16.0f;
+                float U = uv_row[tables.uv_xofs[dx]] - 128.0f;
+                float V = uv_row[tables.uv_xofs[dx] + 1] - 128.0f;
+                out[dx * 3 + 0] = SaturateU8(1.164f * Y + 2.018f * U);
+                out[dx * 3 + 1] = SaturateU8(1.164f * Y - 0.391f * U - 0.813f * V);
+                out[dx * 3 + 2] = SaturateU8(1.164f * Y + 1.596f * V);
+            }
+        }
+    }
+}
+
+int CpuResize::MakeTask(CropTask &task, const DVPPImageData *src, uint32_t format, const RectInt &crop,
+                        int out_left, int out_right, int out_top, int out_bottom, uint8_t *dst, uint32_t dst_stride)
+{
+    task.src = src;
+    task.format = format;
+    task.dst = dst;
+    task.dst_stride = dst_stride;
+    task.out_bottom = out_bottom;
+
+    ResizeTableKey key;
+    key.src_width = src->width;
+    key.src_height = src->height;
+    key.left = crop.xmin;
+    key.top = crop.ymin;
+    key.right = crop.xmax;
+    key.bottom = crop.ymax;
+    key.out_left = out_left;
+    key.out_right = out_right;
+    key.out_top = out_top;
+    key.out_bottom = out_bottom;
+    key.pixel_step = PIXEL_FORMAT_BGR_888 == format ? 3 : 1;
+    key.interpolation = RESIZE_INTER_NEAREST == dvppResizeInitConfig_.interpolation ?
+                        RESIZE_INTER_NEAREST : RESIZE_INTER_BILINEAR;
+    task.tables.reset();
+    if (key.out_right < key.out_left || key.out_bottom < key.out_top)
+    {
+        return 1;
+    }
+    task.tables = ResizeTableCache::Instance().Acquire(key);
+    if (!task.tables)
+    {
+        return 0;
+    }
+    max_row_bytes_ = std::max(max_row_bytes_, (crop.xmax - crop.xmin + 1) * key.pixel_step);
+    return 1;
+}
+
+void CpuResize::ReserveRowBufs()
+{
+    int num_bufs = pool_ && pool_->NumWorkers() > 0 ? pool_->NumWorkers() : 1;
+    row_bufs_.resize(std::max<size_t>(row_bufs_.size(), num_bufs));
+    for (int buf = 0; buf < num_bufs; ++buf)
+    {
+        if (static_cast<int>(row_bufs_[buf].size()) < max_row_bytes_)
+        {
+            row_bufs_[buf].resize(max_row_bytes_);
+        }
+    }
+}
+
+void CpuResize::RunTasks(int num_tasks)
+{
+    int out_height = 0;
+    for (int idx = 0; idx < num_tasks; ++idx)
+    {
+        out_height = std::max(out_height, tasks_[idx].out_bottom + 1);
+    }
+    ReserveRowBufs();
+
+    int num_tiles = (out_height + CPU_RESIZE_TILE_ROWS - 1) / CPU_RESIZE_TILE_ROWS;
+    WorkerPool::RangeFunc run = [&](int begin, int end, int worker) {
+        for (int job = begin; job < end; ++job)
+        {
+            int tile = job % num_tiles;
+            const CropTask& task = tasks_[job / num_tiles];
+            if (task.tables)
+            {
+                ResizeRows(task, tile * CPU_RESIZE_TILE_ROWS, (tile + 1) * CPU_RESIZE_TILE_ROWS, 0, INT_MAX,
+                           row_bufs_[worker].data());
+            }
+        }
+    };
+    if (pool_)
+    {
+        pool_->ParallelFor(0, num_tasks * num_tiles, run);
+    }
+    else
+    {
+        run(0, num_tasks * num_tiles, 0);
+    }
+}
+
+int CpuResize::Process(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("CpuResize has not init\n");
+        return 0;
+    }
+    if (img_num <= 0 || img_num > static_cast<int>(dvppResizeInitConfig_.batch_size))
+    {
+        AIALG_ERROR("img_num must be in [1, batch_size], img_num = %d, batch_size = %d\n", img_num, dvppResizeInitConfig_.batch_size);
+        stats_.failed_count++;
+        return 0;
+    }
+
+    DVPP_TIMELINE_SCOPE("cpu_resize", "process", img_num);
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    stats_.process_count++;
+    image_stats_.clear();
+    tasks_.resize(img_num);
+    crops_.resize(img_num);
+    paste_areas_.resize(img_num);
+    fill_borders_.resize(img_num);
+    passes_.resize(img_num);
+    cascade_sizes_.resize(img_num);
+    max_row_bytes_ = 0;
+    int max_passes = 1;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        int src_width = srcImage[idx].width;
+        int src_height = srcImage[idx].height;
+        RectInt roi;
+        roi.xmin = 0;
+        roi.ymin = 0;
+        roi.xmax = src_width - 1;
+        roi.ymax = src_height - 1;
+        if (rois)
+        {
+            roi = rois[idx];
+        }
+        // the same crop and paste area as DvppResize, also for a roi past the image edge
+        RectInt& crop = crops_[idx];
+        RectInt& paste = paste_areas_[idx];
+        if (!srcImage[idx].data || 1 != GetDvppRoiArea(dvppResizeInitConfig_, src_width, src_height, roi, crop, paste))
+        {
+            AIALG_ERROR("invalid image or roi, index = %d\n", idx);
+            stats_.failed_count++;
+            return 0;
+        }
+        fill_borders_[idx] = roi.xmin < 0 || roi.ymin < 0 || roi.xmax >= src_width || roi.ymax >= src_height;
+        // the same passes and intermediate sizes as the vpc cascade of DvppResize
+        passes_[idx] = PlanDvppCascade(dvppResizeInitConfig_, crop.width, crop.height,
+                                       paste.width, paste.height, cascade_sizes_[idx]);
+        if (0 == passes_[idx])
+        {
+            AIALG_ERROR("image %d needs more than %d passes\n", idx, DVPP_CASCADE_MAX_PASSES);
+            stats_.failed_count++;
+            return 0;
+        }
+        max_passes = std::max(max_passes, passes_[idx]);
+    }
+
+    // intermediates are BGR_888 on the host, the csc of yuv420sp input is done by the first pass
+    cascade_images_.resize(img_num);
+    for (int round = 0; round < max_passes - 1; ++round)
+    {
+        int num = 0;
+        for (int idx = 0; idx < img_num; ++idx)
+        {
+            int step = round - (max_passes - passes_[idx]);
+            if (step < 0)
+            {
+                continue;
+            }
+            const DVPPImageData* input = 0 == step ? srcImage + idx : &cascade_bufs_[(step + 1) % 2][idx].image;
+            RectInt crop = crops_[idx];
+            if (step > 0)
+            {
+                crop.xmin = 0;
+                crop.ymin = 0;
+                crop.xmax = input->width - 1;
+                crop.ymax = input->height - 1;
+            }
+            CascadeBuffer& buffer = cascade_bufs_[step % 2][idx];
+            DVPPImageData& image = buffer.image;
+            image.width = cascade_sizes_[idx][step].first;
+            image.height = cascade_sizes_[idx][step].second;
+            image.alignWidth = ALIGN_UP16(image.width) * 3;
+            image.alignHeight = image.height;
+            image.size = image.alignWidth * image.alignHeight;
+            buffer.data.resize(image.size);
+            image.data = buffer.data.data();
+            if (1 != MakeTask(tasks_[num], input, 0 == step ? dvppResizeInitConfig_.input_format : static_cast<uint32_t>(PIXEL_FORMAT_BGR_888),
+                              crop, 0, image.width - 1, 0, image.height - 1, image.data, image.alignWidth))
+            {
+                stats_.failed_count++;
+                return 0;
+            }
+            cascade_images_[idx] = &image;
+            num++;
+        }
+        RunTasks(num);
+        stats_.cascade_pass_count += num;
+    }
+
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        const DVPPImageData* input = srcImage + idx;
+        uint32_t format = dvppResizeInitConfig_.input_format;
+        RectInt crop = crops_[idx];
+        if (passes_[idx] > 1)
+        {
+            input = cascade_images_[idx];
+            format = PIXEL_FORMAT_BGR_888;
+            crop.xmin = 0;
+            crop.ymin = 0;
+            crop.xmax = input->width - 1;
+            crop.ymax = input->height - 1;
+            stats_.cascade_image_count++;
+        }
+        const RectInt& paste = paste_areas_[idx];
+        uint8_t* output = out_data_.data() + static_cast<size_t>(idx) * out_buffer_size_;
+        if (fill_borders_[idx])
+        {
+            std::memset(output, dvppResizeInitConfig_.border_value & 0xff, out_buffer_size_);
+        }
+        if (1 != MakeTask(tasks_[idx], input, format, crop, paste.xmin, paste.xmax, paste.ymin, paste.ymax,
+                          output, out_width_stride_))
+        {
+            stats_.failed_count++;
+            return 0;
+        }
+    }
+    RunTasks(img_num);
+    if (dvppResizeInitConfig_.compute_stats)
+    {
+        image_stats_.resize(img_num);
+        WorkerPool::RangeFunc run = [&](int begin, int end, int) {
+            for (int idx = begin; idx < end; ++idx)
+            {
+                ComputeImageStats(out_data_.data() + static_cast<size_t>(idx) * out_buffer_size_, out_width_stride_,
+                                  paste_areas_[idx], image_stats_[idx]);
+            }
+        };
+        if (pool_)
+        {
+            pool_->ParallelFor(0, img_num, run);
+        }
+        else
+        {
+            run(0, img_num, 0);
+        }
+    }
+    stats_.image_count += img_num;
+    stats_.sync_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return 1;
+}
+
+int CpuResize::ProcessDirty(const DVPPImageData &srcImage, const RectInt *dirty, int dirty_num, uint8_t *output)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("CpuResize has not init\n");
+        return -1;
+    }
+    if (!srcImage.data || !output || dirty_num < 0 || (dirty_num > 0 && !dirty))
+    {
+        AIALG_ERROR("invalid image, output or dirty rectangles\n");
+        stats_.failed_count++;
+        return -1;
+    }
+
+    DVPP_TIMELINE_SCOPE("cpu_resize", "process_dirty", dirty_num);
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    stats_.process_count++;
+    RectInt roi;
+    roi.xmin = 0;
+    roi.ymin = 0;
+    roi.xmax = static_cast<int>(srcImage.width) - 1;
+    roi.ymax = static_cast<int>(srcImage.height) - 1;
+    RectInt crop, paste;
+    std::vector<std::pair<int, int> > sizes;
+    if (1 != GetDvppRoiArea(dvppResizeInitConfig_, srcImage.width, srcImage.height, roi, crop, paste) ||
+        1 != PlanDvppCascade(dvppResizeInitConfig_, crop.width, crop.height, paste.width, paste.height, sizes))
+    {
+        // an intermediate would have to be redone whole
+        AIALG_ERROR("ProcessDirty does not support images that need a cascade, use Process\n");
+        stats_.failed_count++;
+        return -1;
+    }
+    max_row_bytes_ = 0;
+    tasks_.resize(1);
+    CropTask& task = tasks_[0];
+    if (1 != MakeTask(task, &srcImage, dvppResizeInitConfig_.input_format, crop, paste.xmin, paste.xmax,
+                      paste.ymin, paste.ymax, output, out_width_stride_))
+    {
+        stats_.failed_count++;
+        return -1;
+    }
+    if (!task.tables || 0 == dirty_num)
+    {
+        stats_.image_count++;
+        return 0;
+    }
+
+    // source pixels every output column/row reads, including the chroma pair of yuv420sp
+    const ResizeTables& tables = *task.tables;
+    const ResizeTableKey& key = tables.key;
+    bool has_uv = PIXEL_FORMAT_YUV_SEMIPLANAR_420 == dvppResizeInitConfig_.input_format;
+    int num_cols = key.out_right - key.out_left + 1;
+    int num_rows = key.out_bottom - key.out_top + 1;
+    dep_x_lo_.resize(num_cols);
+    dep_x_hi_.resize(num_cols);
+    dep_y_lo_.resize(num_rows);
+    dep_y_hi_.resize(num_rows);
+    for (int dx = 0; dx < num_cols; ++dx)
+    {
+        dep_x_lo_[dx] = key.left + tables.xofs[2 * dx] / key.pixel_step;
+        dep_x_hi_[dx] = key.left + tables.xofs[2 * dx + 1] / key.pixel_step;
+        if (has_uv)
+        {
+            dep_x_lo_[dx] = std::min(dep_x_lo_[dx], tables.uv_xofs[dx]);
+            dep_x_hi_[dx] = std::max(dep_x_hi_[dx], tables.uv_xofs[dx] + 1);
+        }
+    }
+    for (int dy = 0; dy < num_rows; ++dy)
+    {
+        dep_y_lo_[dy] = tables.yofs[2 * dy];
+        dep_y_hi_[dy] = tables.yofs[2 * dy + 1];
+        if (has_uv)
+        {
+            dep_y_lo_[dy] = std::min(dep_y_lo_[dy], 2 * tables.uv_yofs[dy]);
+            dep_y_hi_[dy] = std::max(dep_y_hi_[dy], 2 * tables.uv_yofs[dy] + 1);
+        }
+    }
+
+    // outputs reading a dirty rectangle form a rectangle too, split into row tiles for the pool
+    dirty_areas_.clear();
+    int64_t pixels = 0;
+    for (int idx = 0; idx < dirty_num; ++idx)
+    {
+        const RectInt& rect = dirty[idx];
+        int col_begin = std::lower_bound(dep_x_hi_.begin(), dep_x_hi_.end(), rect.xmin) - dep_x_hi_.begin();
+        int col_end = std::upper_bound(dep_x_lo_.begin(), dep_x_lo_.end(), rect.xmax) - dep_x_lo_.begin();
+        int row_begin = std::lower_bound(dep_y_hi_.begin(), dep_y_hi_.end(), rect.ymin) - dep_y_hi_.begin();
+        int row_end = std::upper_bound(dep_y_lo_.begin(), dep_y_lo_.end(), rect.ymax) - dep_y_lo_.begin();
+        if (col_begin >= col_end || row_begin >= row_end)
+        {
+            continue;
+        }
+        pixels += static_cast<int64_t>(col_end - col_begin) * (row_end - row_begin);
+        for (int row = row_begin; row < row_end; row += CPU_RESIZE_TILE_ROWS)
+        {
+            RectInt area;
+            area.xmin = key.out_left + col_begin;
+            area.xmax = key.out_left + col_end - 1;
+            area.ymin = key.out_top + row;
+            area.ymax = key.out_top + std::min(row + CPU_RESIZE_TILE_ROWS, row_end) - 1;
+            area.width = area.xmax - area.xmin + 1;
+            area.height = area.ymax - area.ymin + 1;
+            dirty_areas_.push_back(area);
+        }
+    }
+    ReserveRowBufs();
+    WorkerPool::RangeFunc run = [&](int begin, int end, int worker) {
+        for (int job = begin; job < end; ++job)
+        {
+            const RectInt& area = dirty_areas_[job];
+            ResizeRows(task, area.ymin, area.ymax + 1, area.xmin, area.xmax + 1, row_bufs_[worker].data());
+        }
+    };
+    int num_jobs = static_cast<int>(dirty_areas_.size());
+    if (pool_)
+    {
+        pool_->ParallelFor(0, num_jobs, run);
+    }
+    else
+    {
+        run(0, num_jobs, 0);
+    }
+    stats_.image_count++;
+    stats_.sync_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<int>(pixels);
+}
+
+int CpuResize::Get(DVPPImageData &resizedImage, int index) const
+{
+    resizedImage.width = dvppResizeInitConfig_.resized_width;
+    resizedImage.height = dvppResizeInitConfig_.resized_height;
+    resizedImage.alignWidth = out_width_stride_;
+    resizedImage.alignHeight = ALIGN_UP2(dvppResizeInitConfig_.resized_height);
+    resizedImage.size = out_buffer_size_;
+    resizedImage.data = const_cast<uint8_t*>(out_data_.data()) + static_cast<size_t>(index) * out_buffer_size_;
+    return 1;
+}
+
+int CpuResize::GetImageStats(DVPPImageStats &stats, int index) const
+{
+    if (index < 0 || index >= static_cast<int>(image_stats_.size()))
+    {
+        AIALG_ERROR("no statistics of image %d, compute_stats = %d\n", index, dvppResizeInitConfig_.compute_stats);
+        return 0;
+    }
+    stats = image_stats_[index];
+    return 1;
+}
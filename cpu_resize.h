@@ -0,0 +1,131 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_CPU_RESIZE_H
+#define _PICTURE_INC_CPU_RESIZE_H
+
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "worker_pool.h"
+#include "resize_table_cache.h"
+#include "image_stats.h"
+
+/**
+* @brief host side stand-in of DvppResize, same Init/Process/Get interface and the same
+*        crop/paste geometry, srcImage[i].data and the outputs are host memory,
+*        coordinates and weights of a geometry come from the shared ResizeTableCache
+*/
+class CpuResize {
+public:
+    CpuResize();
+
+    ~CpuResize();
+
+    void Init(const DVPPResizeInitConfig* dvppResizeInitConfig);
+
+    int Process(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    int Get(DVPPImageData& resizedImage, int index) const;
+
+    /**
+    * @brief incremental update of the full image resize: only the outputs that read a changed source rectangle are
+    *        recomputed, straight into the caller's slot holding the result of the previous image of the same size,
+    *        the pixels are the ones Process writes, images that need a cascade are refused
+    * @param [in] dirty: dirty_num changed rectangles(inclusive) of srcImage
+    * @param [in, out] output: host slot of the Get layout
+    * @return output pixels recomputed, -1 failed
+    */
+    int ProcessDirty(const DVPPImageData& srcImage, const RectInt* dirty, int dirty_num, uint8_t* output);
+
+    /**
+    * @brief statistics of the paste area of output index, computed by Process while the output is cache hot
+    * @return 1 success, 0 compute_stats is off or index out of the last batch
+    */
+    int GetImageStats(DVPPImageStats& stats, int index) const;
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPResizeStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    /**
+    * @brief hit/miss of the coordinate/weight tables, shared by all CpuResize instances
+    */
+    inline static ResizeTableCacheStats GetTableCacheStats()
+    {
+        return ResizeTableCache::Instance().GetStats();
+    }
+
+    void DestroyResource();
+
+    /**
+    * @brief spread the batch over images and row tiles of the pool, nullptr runs on the calling thread
+    */
+    inline void SetWorkerPool(WorkerPool* pool)
+    {
+        pool_ = pool;
+    }
+
+private:
+    struct CropTask {
+        const DVPPImageData* src;
+        uint32_t format;       // BGR_888 or YUV_SEMIPLANAR_420 of src
+        uint8_t* dst;
+        uint32_t dst_stride;
+        int out_bottom;
+        std::shared_ptr<const ResizeTables> tables;  // crop and paste area, nullptr if the paste area is empty
+    };
+
+    struct CascadeBuffer {
+        DVPPImageData image;
+        std::vector<uint8_t> data;
+    };
+
+    int MakeTask(CropTask& task, const DVPPImageData* src, uint32_t format, const RectInt& crop,
+                 int out_left, int out_right, int out_top, int out_bottom, uint8_t* dst, uint32_t dst_stride);
+
+    /**
+    * @brief run tasks_[0, num_tasks) over images and row tiles of the pool
+    */
+    void RunTasks(int num_tasks);
+
+    void ReserveRowBufs();
+
+    /**
+    * @brief output rows [row_begin, row_end) x columns [col_begin, col_end) of task, clipped to its paste area
+    */
+    void ResizeRows(const CropTask& task, int row_begin, int row_end, int col_begin, int col_end, int32_t* row_buf);
+
+private:
+    DVPPResizeInitConfig dvppResizeInitConfig_;
+    uint32_t out_width_stride_;
+    uint32_t out_buffer_size_;
+    std::vector<uint8_t> out_data_;
+    std::vector<CropTask> tasks_;
+    std::vector<std::vector<int32_t> > row_bufs_;  // vertically interpolated src row, one per worker
+    int max_row_bytes_;
+    // cascade of out of range scale ratios, the same plan as DvppResize with BGR_888 intermediates
+    std::vector<RectInt> crops_;
+    std::vector<RectInt> paste_areas_;  // xmin/xmax/ymin/ymax of the paste area
+    std::vector<uint8_t> fill_borders_;  // roi of the image extends past it, its slot is filled with border_value
+    std::vector<int> passes_;
+    std::vector<std::vector<std::pair<int, int> > > cascade_sizes_;
+    std::vector<CascadeBuffer> cascade_bufs_[2];
+    std::vector<const DVPPImageData*> cascade_images_;
+    std::vector<DVPPImageStats> image_stats_;
+    // ProcessDirty: source columns/rows read by every output column/row, all non-decreasing
+    std::vector<int> dep_x_lo_, dep_x_hi_, dep_y_lo_, dep_y_hi_;
+    std::vector<RectInt> dirty_areas_;  // output rectangles to redo, at most one row tile high
+    WorkerPool* pool_;
+    DVPPResizeStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_CPU_RESIZE_H
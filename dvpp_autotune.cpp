@@ -0,0 +1,351 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include "dvpp_autotune.h"
+#include "alg_define.h"
+
+int LoadTuneProfile(const std::string &path, std::vector<DVPPTuneEntry> &entries)
+{
+    entries.clear();
+    FILE* fp = std::fopen(path.c_str(), "r");
+    if (!fp)
+    {
+        return 0;
+    }
+    char line[512];
+    int line_num = 0;
+    while (std::fgets(line, sizeof(line), fp))
+    {
+        line_num++;
+        if ('#' == line[0] || '\n' == line[0] || '\r' == line[0])
+        {
+            continue;
+        }
+        DVPPTuneEntry entry;
+        if (9 != std::sscanf(line, "%u %u %u %u %u %u %u %f %f", &entry.src_width, &entry.src_height,
+                             &entry.input_format, &entry.resized_width, &entry.resized_height, &entry.batch_size,
+                             &entry.channels, &entry.images_per_second, &entry.p99_latency_us) ||
+            0 == entry.batch_size || 0 == entry.channels)
+        {
+            AIALG_ERROR("bad line %d of tuning profile %s\n", line_num, path.c_str());
+            std::fclose(fp);
+            entries.clear();
+            return 0;
+        }
+        entries.push_back(entry);
+    }
+    std::fclose(fp);
+    return 1;
+}
+
+int SaveTuneProfile(const std::string &path, const std::vector<DVPPTuneEntry> &entries)
+{
+    // written aside and renamed, a reader never sees a half written profile
+    std::string tmp_path = path + ".tmp";
+    FILE* fp = std::fopen(tmp_path.c_str(), "w");
+    if (!fp)
+    {
+        AIALG_ERROR("open tuning profile %s failed\n", tmp_path.c_str());
+        return 0;
+    }
+    bool ok = std::fprintf(fp, "%s\n", DVPP_TUNE_PROFILE_HEADER) > 0;
+    for (size_t idx = 0; ok && idx < entries.size(); ++idx)
+    {
+        const DVPPTuneEntry& entry = entries[idx];
+        ok = std::fprintf(fp, "%u %u %u %u %u %u %u %.1f %.1f\n", entry.src_width, entry.src_height,
+                          entry.input_format, entry.resized_width, entry.resized_height, entry.batch_size,
+                          entry.channels, entry.images_per_second, entry.p99_latency_us) > 0;
+    }
+    ok = (0 == std::fclose(fp)) && ok;
+    if (!ok || 0 != std::rename(tmp_path.c_str(), path.c_str()))
+    {
+        AIALG_ERROR("write tuning profile %s failed\n", path.c_str());
+        std::remove(tmp_path.c_str());
+        return 0;
+    }
+    return 1;
+}
+
+const DVPPTuneEntry* FindTuneEntry(const std::vector<DVPPTuneEntry> &entries, uint32_t src_width, uint32_t src_height,
+                                   uint32_t input_format, uint32_t resized_width, uint32_t resized_height)
+{
+    for (size_t idx = 0; idx < entries.size(); ++idx)
+    {
+        const DVPPTuneEntry& entry = entries[idx];
+        if (entry.input_format == input_format && entry.resized_width == resized_width &&
+            entry.resized_height == resized_height && (0 == src_width || entry.src_width == src_width) &&
+            (0 == src_height || entry.src_height == src_height))
+        {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+int UpdateTuneProfile(const std::string &path, const DVPPTuneEntry &entry)
+{
+    std::vector<DVPPTuneEntry> entries;
+    // a missing profile is created, a broken one is rewritten
+    LoadTuneProfile(path, entries);
+    const DVPPTuneEntry* old = FindTuneEntry(entries, entry.src_width, entry.src_height, entry.input_format,
+                                             entry.resized_width, entry.resized_height);
+    if (old)
+    {
+        entries[old - entries.data()] = entry;
+    }
+    else
+    {
+        entries.push_back(entry);
+    }
+    return SaveTuneProfile(path, entries);
+}
+
+static int CreateSyntheticFrame(const DVPPAutotuneConfig& config, DVPPImageData& frame)
+{
+    frame.width = config.src_width;
+    frame.height = config.src_height;
+    frame.alignWidth = 0;
+    frame.alignHeight = 0;
+    uint32_t width_stride = 0;
+    uint32_t height_stride = 0;
+    uint32_t buffer_size = 0;
+    GetDvppInputStride(config.resize_config.input_format, frame, width_stride, height_stride, buffer_size);
+    frame.alignWidth = width_stride;
+    frame.alignHeight = height_stride;
+    frame.size = buffer_size;
+
+    // a gradient, flat frames may be cheaper than real ones
+    std::vector<uint8_t> host_frame(buffer_size);
+    for (uint32_t idx = 0; idx < buffer_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>((idx % width_stride) / 8 + (idx / width_stride) / 8);
+    }
+    void* dev_frame = nullptr;
+    aclError aclRet = acldvppMalloc(&dev_frame, buffer_size);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc synthetic frame failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    aclRet = aclrtMemcpy(dev_frame, buffer_size, host_frame.data(), buffer_size, ACL_MEMCPY_HOST_TO_DEVICE);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("upload synthetic frame failed, aclRet = %d\n", aclRet);
+        acldvppFree(dev_frame);
+        return 0;
+    }
+    frame.data = static_cast<uint8_t*>(dev_frame);
+    return 1;
+}
+
+namespace
+{
+    struct TrialStart {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint32_t ready = 0;
+        bool go = false;
+    };
+}
+
+static void RunTrialChannel(const DVPPAutotuneConfig& config, const DVPPImageData& frame, uint32_t batch_size,
+                            TrialStart& start, std::vector<uint64_t>& latencies, int& ret)
+{
+    ret = 0;
+    aclrtStream stream = nullptr;
+    DvppResize resize;
+    std::vector<DVPPImageData> frames(batch_size, frame);
+    if (ACL_SUCCESS == aclrtSetCurrentContext(config.resize_config.context) &&
+        ACL_SUCCESS == aclrtCreateStream(&stream))
+    {
+        DVPPResizeInitConfig resize_config = config.resize_config;
+        resize_config.stream = stream;
+        resize_config.batch_size = batch_size;
+        resize_config.tune_profile = nullptr;
+        resize.Init(&resize_config);
+        // warm up, the first batch pays for lazy allocations
+        if (resize.HasInit() && 1 == resize.Process(frames.data(), nullptr, batch_size))
+        {
+            ret = 1;
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(start.mutex);
+        start.ready++;
+        start.cv.notify_all();
+        start.cv.wait(lock, [&start]() { return start.go; });
+    }
+    for (uint32_t batch = 0; 1 == ret && batch < config.batches_per_trial; ++batch)
+    {
+        std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+        if (1 != resize.Process(frames.data(), nullptr, batch_size))
+        {
+            ret = 0;
+            break;
+        }
+        latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - startTP).count());
+    }
+    resize.DestroyResource();
+    if (stream)
+    {
+        aclrtDestroyStream(stream);
+    }
+}
+
+static int RunTrial(const DVPPAutotuneConfig& config, const DVPPImageData& frame, uint32_t batch_size,
+                    uint32_t channels, DVPPTuneEntry& entry)
+{
+    TrialStart start;
+    std::vector<std::vector<uint64_t> > latencies(channels);
+    std::vector<int> rets(channels, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t channel = 0; channel < channels; ++channel)
+    {
+        threads.emplace_back(RunTrialChannel, std::cref(config), std::cref(frame), batch_size, std::ref(start),
+                             std::ref(latencies[channel]), std::ref(rets[channel]));
+    }
+    std::chrono::time_point<std::chrono::steady_clock> startTP;
+    {
+        std::unique_lock<std::mutex> lock(start.mutex);
+        start.cv.wait(lock, [&start, channels]() { return start.ready == channels; });
+        startTP = std::chrono::steady_clock::now();
+        start.go = true;
+    }
+    start.cv.notify_all();
+    for (size_t idx = 0; idx < threads.size(); ++idx)
+    {
+        threads[idx].join();
+    }
+    uint64_t total_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - startTP).count();
+
+    std::vector<uint64_t> all;
+    for (uint32_t channel = 0; channel < channels; ++channel)
+    {
+        if (1 != rets[channel])
+        {
+            return 0;
+        }
+        all.insert(all.end(), latencies[channel].begin(), latencies[channel].end());
+    }
+    if (all.empty())
+    {
+        return 0;
+    }
+    std::sort(all.begin(), all.end());
+    entry.src_width = config.src_width;
+    entry.src_height = config.src_height;
+    entry.input_format = config.resize_config.input_format;
+    entry.resized_width = config.resize_config.resized_width;
+    entry.resized_height = config.resize_config.resized_height;
+    entry.batch_size = batch_size;
+    entry.channels = channels;
+    entry.images_per_second = total_us > 0 ? 1e6f * all.size() * batch_size / total_us : 0.0f;
+    entry.p99_latency_us = static_cast<float>(all[std::min(all.size() - 1, all.size() * 99 / 100)]);
+    return 1;
+}
+
+int RunDvppAutotune(const DVPPAutotuneConfig &config, DVPPTuneEntry &best, std::vector<DVPPTuneEntry> *trials)
+{
+    if (0 == config.src_width || 0 == config.src_height || 0 == config.max_batch_size || 0 == config.max_channels ||
+        0 == config.batches_per_trial)
+    {
+        AIALG_ERROR("bad autotune config\n");
+        return 0;
+    }
+    if (ACL_SUCCESS != aclrtSetCurrentContext(config.resize_config.context))
+    {
+        AIALG_ERROR("set current context failed\n");
+        return 0;
+    }
+    DVPPImageData frame;
+    if (1 != CreateSyntheticFrame(config, frame))
+    {
+        return 0;
+    }
+
+    std::vector<uint32_t> batch_sizes;
+    for (uint32_t batch_size = 1; batch_size < config.max_batch_size; batch_size *= 2)
+    {
+        batch_sizes.push_back(batch_size);
+    }
+    batch_sizes.push_back(config.max_batch_size);
+
+    bool found = false;
+    bool within_cap = false;
+    for (uint32_t channels = 1; channels <= config.max_channels; ++channels)
+    {
+        for (size_t idx = 0; idx < batch_sizes.size(); ++idx)
+        {
+            DVPPTuneEntry entry;
+            if (1 != RunTrial(config, frame, batch_sizes[idx], channels, entry))
+            {
+                AIALG_ERROR("trial batch_size = %u, channels = %u failed\n", batch_sizes[idx], channels);
+                continue;
+            }
+            if (trials)
+            {
+                trials->push_back(entry);
+            }
+            bool fits = config.latency_cap_us <= 0.0f || entry.p99_latency_us <= config.latency_cap_us;
+            if (!found || (fits && (!within_cap || entry.images_per_second > best.images_per_second)) ||
+                (!fits && !within_cap && entry.p99_latency_us < best.p99_latency_us))
+            {
+                best = entry;
+                within_cap = fits;
+            }
+            found = true;
+            // latency only grows with the batch size
+            if (!fits)
+            {
+                break;
+            }
+        }
+    }
+    acldvppFree(frame.data);
+    if (!found)
+    {
+        AIALG_ERROR("no setting of the autotune sweep could run\n");
+        return 0;
+    }
+    if (!within_cap)
+    {
+        AIALG_ERROR("no setting meets the latency cap %.1f us, p99 of the fastest one is %.1f us\n",
+                    config.latency_cap_us, best.p99_latency_us);
+    }
+    return 1;
+}
+
+int DvppAutotune(const DVPPAutotuneConfig &config, const std::string &profile_path, DVPPTuneEntry &entry)
+{
+    std::vector<DVPPTuneEntry> entries;
+    if (1 == LoadTuneProfile(profile_path, entries))
+    {
+        const DVPPTuneEntry* tuned = FindTuneEntry(entries, config.src_width, config.src_height,
+                                                   config.resize_config.input_format,
+                                                   config.resize_config.resized_width,
+                                                   config.resize_config.resized_height);
+        if (tuned)
+        {
+            entry = *tuned;
+            return 1;
+        }
+    }
+    if (1 != RunDvppAutotune(config, entry))
+    {
+        return 0;
+    }
+    AIALG_PRINT("autotuned %ux%u -> %ux%u: batch_size = %u, channels = %u, %.1f images/s, p99 %.1f us\n",
+                entry.src_width, entry.src_height, entry.resized_width, entry.resized_height, entry.batch_size,
+                entry.channels, entry.images_per_second, entry.p99_latency_us);
+    return UpdateTuneProfile(profile_path, entry);
+}
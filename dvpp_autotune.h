@@ -0,0 +1,80 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_AUTOTUNE_H
+#define _PICTURE_INC_DVPP_AUTOTUNE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+
+// first line of a tuning profile, one DVPPTuneEntry per following line
+#define DVPP_TUNE_PROFILE_HEADER "# dvpp_tune_profile v1: src_width src_height input_format resized_width resized_height batch_size channels images_per_second p99_latency_us"
+
+typedef struct{
+    uint32_t src_width = 0;
+    uint32_t src_height = 0;
+    uint32_t input_format = 0;
+    uint32_t resized_width = 0;
+    uint32_t resized_height = 0;
+    uint32_t batch_size = 0;
+    uint32_t channels = 0;            // DvppResize instances running in parallel, each on its own stream
+    float images_per_second = 0.0f;   // of all channels together
+    float p99_latency_us = 0.0f;      // of one Process
+} DVPPTuneEntry;
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // context, input_format, resized size and resize options of the workload,
+                                         // batch_size and stream are set by every trial
+    uint32_t src_width = 1920;           // synthetic source frames
+    uint32_t src_height = 1080;
+    uint32_t max_batch_size = 32;        // batch sizes 1, 2, 4, ... and this one are swept
+    uint32_t max_channels = 4;           // 1 .. max_channels are swept
+    float latency_cap_us = 0.0f;         // largest p99 latency of one Process, 0: no cap
+    uint32_t batches_per_trial = 50;     // per channel, after one warm-up batch
+    char reserve[8];
+} DVPPAutotuneConfig;
+
+/**
+* @brief read a tuning profile written by SaveTuneProfile
+* @return 1 success, 0 failed(missing file or bad line)
+*/
+int LoadTuneProfile(const std::string& path, std::vector<DVPPTuneEntry>& entries);
+
+/**
+* @return 1 success, 0 failed
+*/
+int SaveTuneProfile(const std::string& path, const std::vector<DVPPTuneEntry>& entries);
+
+/**
+* @brief entry of the geometry, src_width/src_height 0 match any source size
+* @return nullptr if there is none
+*/
+const DVPPTuneEntry* FindTuneEntry(const std::vector<DVPPTuneEntry>& entries, uint32_t src_width, uint32_t src_height,
+                                   uint32_t input_format, uint32_t resized_width, uint32_t resized_height);
+
+/**
+* @brief replace the entry of the same geometry in the profile at path(created if missing) or append it
+* @return 1 success, 0 failed
+*/
+int UpdateTuneProfile(const std::string& path, const DVPPTuneEntry& entry);
+
+/**
+* @brief sweep batch size x channels over synthetic frames of the configured geometry, every channel runs
+*        batches_per_trial Process calls on its own stream and DvppResize, all channels start together
+* @param [out] best: the highest throughput whose p99 latency is within latency_cap_us, the lowest latency if none is
+* @param [out] trials: every measured setting, nullptr to skip
+* @return 1 success, 0 failed(no setting could run)
+*/
+int RunDvppAutotune(const DVPPAutotuneConfig& config, DVPPTuneEntry& best, std::vector<DVPPTuneEntry>* trials = nullptr);
+
+/**
+* @brief the entry of profile_path for the geometry if there is one, else RunDvppAutotune and save its result,
+*        so only the first start of a deployment pays for the sweep
+* @return 1 success, 0 failed
+*/
+int DvppAutotune(const DVPPAutotuneConfig& config, const std::string& profile_path, DVPPTuneEntry& entry);
+
+#endif // _PICTURE_INC_DVPP_AUTOTUNE_H
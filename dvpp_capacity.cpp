@@ -0,0 +1,492 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <algorithm>
+#include "dvpp_capacity.h"
+#include "dvpp_trace.h"
+#include "alg_define.h"
+
+// a scenario larger than this is surely a typo(fps or duration_s)
+#define DVPP_CAPACITY_MAX_IMAGES 50000000
+#define DVPP_CAPACITY_MAX_CAMERAS 65536
+
+typedef struct{
+    double arrival_us;
+    double in_mpixels;
+} SimImage;
+
+/**
+* @brief least squares over the columns of rows by the normal equations, a column the previous ones already
+*        explain(e.g. output mpixels of traces with a single output size) gets 0
+*/
+static void SolveLeastSquares(const std::vector<std::vector<double> >& rows, const std::vector<double>& y,
+                              std::vector<double>& coef)
+{
+    size_t cols = rows[0].size();
+    std::vector<std::vector<double> > a(cols, std::vector<double>(cols, 0.0));
+    std::vector<double> b(cols, 0.0);
+    for (size_t row = 0; row < rows.size(); ++row)
+    {
+        for (size_t i = 0; i < cols; ++i)
+        {
+            for (size_t j = 0; j < cols; ++j)
+            {
+                a[i][j] += rows[row][i] * rows[row][j];
+            }
+            b[i] += rows[row][i] * y[row];
+        }
+    }
+    std::vector<double> diag(cols);
+    for (size_t k = 0; k < cols; ++k)
+    {
+        diag[k] = a[k][k];
+    }
+    std::vector<int> dropped(cols, 0);
+    for (size_t k = 0; k < cols; ++k)
+    {
+        // what is left of a column after the previous ones is its unexplained part
+        if (a[k][k] <= 1e-9 * diag[k] || diag[k] <= 0.0)
+        {
+            dropped[k] = 1;
+            continue;
+        }
+        for (size_t i = k + 1; i < cols; ++i)
+        {
+            double factor = a[i][k] / a[k][k];
+            for (size_t j = k; j < cols; ++j)
+            {
+                a[i][j] -= factor * a[k][j];
+            }
+            b[i] -= factor * b[k];
+        }
+    }
+    coef.assign(cols, 0.0);
+    for (size_t k = cols; k-- > 0;)
+    {
+        if (dropped[k])
+        {
+            continue;
+        }
+        double sum = b[k];
+        for (size_t j = k + 1; j < cols; ++j)
+        {
+            sum -= a[k][j] * coef[j];
+        }
+        coef[k] = sum / a[k][k];
+    }
+}
+
+static double CroppedMpixels(const DVPPTraceImage& image)
+{
+    // rois past the image edge only read the part inside
+    int32_t xmin = std::max<int32_t>(image.xmin, 0);
+    int32_t ymin = std::max<int32_t>(image.ymin, 0);
+    int32_t xmax = std::min<int32_t>(image.xmax, static_cast<int32_t>(image.width) - 1);
+    int32_t ymax = std::min<int32_t>(image.ymax, static_cast<int32_t>(image.height) - 1);
+    if (xmax < xmin || ymax < ymin)
+    {
+        return 0.0;
+    }
+    return 1e-6 * (xmax - xmin + 1) * (ymax - ymin + 1);
+}
+
+int FitCostModel(const std::vector<std::string> &trace_paths, DVPPCostModel &model)
+{
+    std::vector<std::vector<double> > setup_rows;
+    std::vector<double> setup_y;
+    std::vector<std::vector<double> > vpc_rows;
+    std::vector<double> vpc_y;
+    double launch_sum = 0.0;
+    for (size_t path = 0; path < trace_paths.size(); ++path)
+    {
+        DvppTraceReader reader;
+        if (1 != reader.Open(trace_paths[path]))
+        {
+            return 0;
+        }
+        const DVPPTraceHeader& header = reader.Header();
+        double out_mpixels = 1e-6 * header.resized_width * header.resized_height;
+        DVPPTraceRecord record;
+        std::vector<DVPPTraceImage> images;
+        // the first batch pays for lazily allocated buffers
+        bool first = true;
+        while (reader.Next(record, images))
+        {
+            if (first || 1 != record.status || 0 == record.img_num)
+            {
+                first = false;
+                continue;
+            }
+            double img_num = record.img_num;
+            setup_rows.push_back({1.0, img_num});
+            setup_y.push_back(record.setup_us);
+            launch_sum += record.launch_us;
+            if (0 == record.sync_us)
+            {
+                // ProcessAsync, the vpc time is not known
+                continue;
+            }
+            double in_mpixels = 0.0;
+            for (size_t idx = 0; idx < images.size(); ++idx)
+            {
+                in_mpixels += CroppedMpixels(images[idx]);
+            }
+            vpc_rows.push_back({1.0, img_num, in_mpixels, img_num * out_mpixels});
+            vpc_y.push_back(record.sync_us);
+        }
+    }
+    if (setup_rows.size() < 2 || vpc_rows.size() < 2)
+    {
+        AIALG_ERROR("traces hold %zu successful batches, %zu of them synchronized, at least 2 of each are needed\n",
+                    setup_rows.size(), vpc_rows.size());
+        return 0;
+    }
+
+    std::vector<double> coef;
+    SolveLeastSquares(setup_rows, setup_y, coef);
+    model.setup_fixed_us = static_cast<float>(coef[0]);
+    model.setup_per_image_us = static_cast<float>(coef[1]);
+    model.launch_us = static_cast<float>(launch_sum / setup_rows.size());
+    SolveLeastSquares(vpc_rows, vpc_y, coef);
+    model.vpc_fixed_us = static_cast<float>(coef[0]);
+    model.vpc_per_image_us = static_cast<float>(coef[1]);
+    model.vpc_per_mpixel_in_us = static_cast<float>(coef[2]);
+    model.vpc_per_mpixel_out_us = static_cast<float>(coef[3]);
+    double square_sum = 0.0;
+    for (size_t row = 0; row < vpc_rows.size(); ++row)
+    {
+        double error = vpc_y[row];
+        for (size_t col = 0; col < coef.size(); ++col)
+        {
+            error -= coef[col] * vpc_rows[row][col];
+        }
+        square_sum += error * error;
+    }
+    model.fitted_batches = static_cast<uint32_t>(vpc_rows.size());
+    model.vpc_rmse_us = static_cast<float>(std::sqrt(square_sum / vpc_rows.size()));
+    return 1;
+}
+
+int LoadCostModel(const std::string &path, DVPPCostModel &model)
+{
+    FILE* fp = std::fopen(path.c_str(), "r");
+    if (!fp)
+    {
+        AIALG_ERROR("open cost model %s failed\n", path.c_str());
+        return 0;
+    }
+    DVPPCostModel loaded;
+    char line[512];
+    int line_num = 0;
+    int ret = 1;
+    while (1 == ret && std::fgets(line, sizeof(line), fp))
+    {
+        line_num++;
+        if ('#' == line[0] || '\n' == line[0] || '\r' == line[0])
+        {
+            continue;
+        }
+        char key[64];
+        float value = 0.0f;
+        if (2 != std::sscanf(line, "%63s %f", key, &value))
+        {
+            ret = 0;
+        }
+        else if (0 == std::strcmp(key, "setup_fixed_us")) loaded.setup_fixed_us = value;
+        else if (0 == std::strcmp(key, "setup_per_image_us")) loaded.setup_per_image_us = value;
+        else if (0 == std::strcmp(key, "launch_us")) loaded.launch_us = value;
+        else if (0 == std::strcmp(key, "vpc_fixed_us")) loaded.vpc_fixed_us = value;
+        else if (0 == std::strcmp(key, "vpc_per_image_us")) loaded.vpc_per_image_us = value;
+        else if (0 == std::strcmp(key, "vpc_per_mpixel_in_us")) loaded.vpc_per_mpixel_in_us = value;
+        else if (0 == std::strcmp(key, "vpc_per_mpixel_out_us")) loaded.vpc_per_mpixel_out_us = value;
+        else if (0 == std::strcmp(key, "copy_us_per_mb")) loaded.copy_us_per_mb = value;
+        else if (0 == std::strcmp(key, "fitted_batches")) loaded.fitted_batches = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "vpc_rmse_us")) loaded.vpc_rmse_us = value;
+        else ret = 0;
+    }
+    std::fclose(fp);
+    if (1 != ret)
+    {
+        AIALG_ERROR("bad line %d of cost model %s\n", line_num, path.c_str());
+        return 0;
+    }
+    model = loaded;
+    return 1;
+}
+
+int SaveCostModel(const std::string &path, const DVPPCostModel &model)
+{
+    // written aside and renamed like the tuning profile
+    std::string tmp_path = path + ".tmp";
+    FILE* fp = std::fopen(tmp_path.c_str(), "w");
+    if (!fp)
+    {
+        AIALG_ERROR("open cost model %s failed\n", tmp_path.c_str());
+        return 0;
+    }
+    bool ok = std::fprintf(fp, "%s\nsetup_fixed_us %.3f\nsetup_per_image_us %.3f\nlaunch_us %.3f\nvpc_fixed_us %.3f\n"
+                               "vpc_per_image_us %.3f\nvpc_per_mpixel_in_us %.3f\nvpc_per_mpixel_out_us %.3f\n"
+                               "copy_us_per_mb %.3f\nfitted_batches %u\nvpc_rmse_us %.3f\n",
+                           DVPP_COST_MODEL_HEADER, model.setup_fixed_us, model.setup_per_image_us, model.launch_us,
+                           model.vpc_fixed_us, model.vpc_per_image_us, model.vpc_per_mpixel_in_us,
+                           model.vpc_per_mpixel_out_us, model.copy_us_per_mb, model.fitted_batches,
+                           model.vpc_rmse_us) > 0;
+    ok = (0 == std::fclose(fp)) && ok;
+    if (!ok || 0 != std::rename(tmp_path.c_str(), path.c_str()))
+    {
+        AIALG_ERROR("write cost model %s failed\n", path.c_str());
+        std::remove(tmp_path.c_str());
+        return 0;
+    }
+    return 1;
+}
+
+int LoadCapacityScenario(const std::string &path, std::vector<DVPPCameraGroup> &cameras, DVPPCapacityConfig &config)
+{
+    FILE* fp = std::fopen(path.c_str(), "r");
+    if (!fp)
+    {
+        AIALG_ERROR("open scenario %s failed\n", path.c_str());
+        return 0;
+    }
+    cameras.clear();
+    char line[512];
+    int line_num = 0;
+    int ret = 1;
+    while (1 == ret && std::fgets(line, sizeof(line), fp))
+    {
+        line_num++;
+        char key[64];
+        float value = 0.0f;
+        if ('#' == line[0] || 1 != std::sscanf(line, "%63s", key))
+        {
+            continue;
+        }
+        if (0 == std::strcmp(key, "camera"))
+        {
+            DVPPCameraGroup group;
+            ret = 7 == std::sscanf(line, "%*s %u %f %u %u %u %u %u", &group.count, &group.fps, &group.src_width,
+                                   &group.src_height, &group.crops_per_frame, &group.crop_width, &group.crop_height);
+            cameras.push_back(group);
+            continue;
+        }
+        if (2 != std::sscanf(line, "%63s %f", key, &value))
+        {
+            ret = 0;
+        }
+        else if (0 == std::strcmp(key, "resized_width")) config.resized_width = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "resized_height")) config.resized_height = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "batch_size")) config.batch_size = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "max_delay_us")) config.max_delay_us = value;
+        else if (0 == std::strcmp(key, "channels")) config.channels = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "vpc_engines")) config.vpc_engines = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "duration_s")) config.duration_s = value;
+        else if (0 == std::strcmp(key, "jitter")) config.jitter = value;
+        else if (0 == std::strcmp(key, "seed")) config.seed = static_cast<uint32_t>(value);
+        else if (0 == std::strcmp(key, "latency_cap_us")) config.latency_cap_us = value;
+        else ret = 0;
+    }
+    std::fclose(fp);
+    if (1 != ret || cameras.empty())
+    {
+        AIALG_ERROR("bad line %d of scenario %s or no camera line\n", line_num, path.c_str());
+        return 0;
+    }
+    return 1;
+}
+
+static int GenerateArrivals(const std::vector<DVPPCameraGroup>& cameras, const DVPPCapacityConfig& config,
+                            std::vector<SimImage>& images)
+{
+    double duration_us = 1e6 * config.duration_s;
+    double expected = 0.0;
+    for (size_t group = 0; group < cameras.size(); ++group)
+    {
+        const DVPPCameraGroup& camera = cameras[group];
+        if (camera.fps <= 0.0f || 0 == camera.src_width || 0 == camera.src_height)
+        {
+            AIALG_ERROR("camera group %zu needs fps > 0 and a source size\n", group);
+            return 0;
+        }
+        expected += 1.0 * camera.count * camera.fps * config.duration_s * std::max<uint32_t>(camera.crops_per_frame, 1);
+    }
+    if (expected > DVPP_CAPACITY_MAX_IMAGES)
+    {
+        AIALG_ERROR("scenario makes %.0f images, shorten duration_s\n", expected);
+        return 0;
+    }
+
+    images.clear();
+    images.reserve(static_cast<size_t>(expected) + cameras.size());
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t group = 0; group < cameras.size(); ++group)
+    {
+        const DVPPCameraGroup& camera = cameras[group];
+        double interval_us = 1e6 / camera.fps;
+        uint32_t images_per_frame = std::max<uint32_t>(camera.crops_per_frame, 1);
+        double in_mpixels = camera.crops_per_frame ?
+                1e-6 * std::min(camera.crop_width, camera.src_width) * std::min(camera.crop_height, camera.src_height) :
+                1e-6 * camera.src_width * camera.src_height;
+        for (uint32_t cam = 0; cam < camera.count; ++cam)
+        {
+            // cameras are not in phase with each other
+            double phase_us = interval_us * unit(rng);
+            for (uint64_t frame = 0; ; ++frame)
+            {
+                double frame_us = phase_us + frame * interval_us;
+                if (frame_us >= duration_us)
+                {
+                    break;
+                }
+                SimImage image;
+                image.arrival_us = std::max(frame_us + config.jitter * interval_us * (unit(rng) - 0.5), 0.0);
+                image.in_mpixels = in_mpixels;
+                images.insert(images.end(), images_per_frame, image);
+            }
+        }
+    }
+    std::stable_sort(images.begin(), images.end(), [](const SimImage& a, const SimImage& b) {
+        return a.arrival_us < b.arrival_us;
+    });
+    return 1;
+}
+
+static float Percentile(const std::vector<float>& sorted, double p)
+{
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+int RunCapacitySimulation(const DVPPCostModel &model, const std::vector<DVPPCameraGroup> &cameras,
+                          const DVPPCapacityConfig &config, DVPPCapacityResult &result)
+{
+    result = DVPPCapacityResult();
+    if (0 == config.batch_size || 0 == config.channels || 0 == config.vpc_engines || config.duration_s <= 0.0f)
+    {
+        AIALG_ERROR("batch_size, channels, vpc_engines and duration_s must be > 0\n");
+        return 0;
+    }
+    std::vector<SimImage> images;
+    if (1 != GenerateArrivals(cameras, config, images))
+    {
+        return 0;
+    }
+    if (images.empty())
+    {
+        AIALG_ERROR("the scenario has no images\n");
+        return 0;
+    }
+
+    double out_mpixels = 1e-6 * config.resized_width * config.resized_height;
+    std::vector<double> channel_free(config.channels, 0.0);
+    std::vector<double> engine_free(config.vpc_engines, 0.0);
+    double channel_busy = 0.0;
+    double vpc_busy = 0.0;
+    double last_done = 0.0;
+    std::vector<float> latencies(images.size());
+    size_t head = 0;
+    while (head < images.size())
+    {
+        // the next batch runs on the first free channel once it is full or its oldest image waited max_delay_us,
+        // whatever arrived by then goes with it, up to batch_size
+        size_t channel = std::min_element(channel_free.begin(), channel_free.end()) - channel_free.begin();
+        double ready = images[head].arrival_us + config.max_delay_us;
+        if (head + config.batch_size <= images.size())
+        {
+            ready = std::min(ready, images[head + config.batch_size - 1].arrival_us);
+        }
+        double start = std::max(channel_free[channel], ready);
+        size_t end = head;
+        double in_mpixels = 0.0;
+        while (end < images.size() && end - head < config.batch_size && images[end].arrival_us <= start)
+        {
+            in_mpixels += images[end].in_mpixels;
+            end++;
+        }
+        double img_num = static_cast<double>(end - head);
+
+        double host_us = model.setup_fixed_us + model.setup_per_image_us * img_num + model.launch_us;
+        double vpc_us = model.vpc_fixed_us + model.vpc_per_image_us * img_num + model.vpc_per_mpixel_in_us * in_mpixels +
+                        model.vpc_per_mpixel_out_us * img_num * out_mpixels;
+        // BGR_888 results, 3 bytes per pixel
+        double copy_us = model.copy_us_per_mb * img_num * out_mpixels * 3.0;
+        double host_end = start + std::max(host_us, 0.0);
+        size_t engine = std::min_element(engine_free.begin(), engine_free.end()) - engine_free.begin();
+        double vpc_end = std::max(host_end, engine_free[engine]) + std::max(vpc_us, 0.0);
+        engine_free[engine] = vpc_end;
+        double done = vpc_end + std::max(copy_us, 0.0);
+        channel_free[channel] = done;
+        channel_busy += done - start;
+        vpc_busy += std::max(vpc_us, 0.0);
+        last_done = std::max(last_done, done);
+        for (size_t idx = head; idx < end; ++idx)
+        {
+            latencies[idx] = static_cast<float>(done - images[idx].arrival_us);
+        }
+        result.batches++;
+        head = end;
+    }
+
+    double duration_us = 1e6 * config.duration_s;
+    double span_us = std::max(last_done, duration_us);
+    result.images = images.size();
+    result.mean_batch_size = static_cast<float>(1.0 * result.images / result.batches);
+    result.offered_images_per_second = static_cast<float>(1e6 * result.images / duration_us);
+    result.images_per_second = static_cast<float>(1e6 * result.images / span_us);
+    result.channel_utilization = static_cast<float>(channel_busy / (config.channels * span_us));
+    result.vpc_utilization = static_cast<float>(vpc_busy / (config.vpc_engines * span_us));
+    // busier than the arrival window allows: the queue only grows
+    result.overloaded = (channel_busy > 0.98 * config.channels * duration_us ||
+                         vpc_busy > 0.98 * config.vpc_engines * duration_us) ? 1 : 0;
+    std::sort(latencies.begin(), latencies.end());
+    result.p50_latency_us = Percentile(latencies, 0.5);
+    result.p99_latency_us = Percentile(latencies, 0.99);
+    result.p999_latency_us = Percentile(latencies, 0.999);
+    result.max_latency_us = latencies.back();
+    return 1;
+}
+
+uint32_t FindMaxCameras(const DVPPCostModel &model, std::vector<DVPPCameraGroup> cameras, size_t group,
+                        const DVPPCapacityConfig &config, DVPPCapacityResult &result)
+{
+    result = DVPPCapacityResult();
+    if (group >= cameras.size())
+    {
+        AIALG_ERROR("camera group %zu out of %zu groups\n", group, cameras.size());
+        return 0;
+    }
+    DVPPCapacityResult trial;
+    auto fits = [&](uint32_t count) {
+        cameras[group].count = count;
+        return 1 == RunCapacitySimulation(model, cameras, config, trial) && !trial.overloaded &&
+               (config.latency_cap_us <= 0.0f || trial.p99_latency_us <= config.latency_cap_us);
+    };
+    // double until it does not fit, then bisect, more cameras never make it easier
+    uint32_t good = 0;
+    uint32_t bad = 1;
+    while (bad <= DVPP_CAPACITY_MAX_CAMERAS && fits(bad))
+    {
+        good = bad;
+        result = trial;
+        bad *= 2;
+    }
+    while (bad - good > 1)
+    {
+        uint32_t mid = good + (bad - good) / 2;
+        if (fits(mid))
+        {
+            good = mid;
+            result = trial;
+        }
+        else
+        {
+            bad = mid;
+        }
+    }
+    return good;
+}
@@ -0,0 +1,119 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_CAPACITY_H
+#define _PICTURE_INC_DVPP_CAPACITY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// first line of a cost model file, one "key value" per following line
+#define DVPP_COST_MODEL_HEADER "# dvpp_cost_model v1"
+
+/**
+* @brief cost of one Process of img_num images, fitted from dvpp traces(DvppResize::EnableTrace):
+*        setup = setup_fixed_us + setup_per_image_us * img_num                    (roi && pic desc update)
+*        vpc   = vpc_fixed_us + vpc_per_image_us * img_num
+*                + vpc_per_mpixel_in_us * cropped mpixels + vpc_per_mpixel_out_us * output mpixels
+*        copy  = copy_us_per_mb * output MB                                        (Get, not traced, measured aside)
+*/
+typedef struct{
+    float setup_fixed_us = 0.0f;
+    float setup_per_image_us = 0.0f;
+    float launch_us = 0.0f;                // acldvppVpcBatchCropResizePasteAsync
+    float vpc_fixed_us = 0.0f;
+    float vpc_per_image_us = 0.0f;
+    float vpc_per_mpixel_in_us = 0.0f;
+    float vpc_per_mpixel_out_us = 0.0f;    // 0 if the traces have one output size only, then it is in vpc_per_image_us
+    float copy_us_per_mb = 0.0f;           // of the BGR_888 results, 0: they stay on the device
+    uint32_t fitted_batches = 0;           // synchronized batches behind the vpc terms
+    float vpc_rmse_us = 0.0f;              // residual of the vpc fit
+    char reserve[8];
+} DVPPCostModel;
+
+/**
+* @brief cameras of one kind, every frame is resized whole(crops_per_frame = 0) or as crops_per_frame rois
+*/
+typedef struct{
+    uint32_t count = 1;
+    float fps = 25.0f;
+    uint32_t src_width = 1920;
+    uint32_t src_height = 1080;
+    uint32_t crops_per_frame = 0;
+    uint32_t crop_width = 0;
+    uint32_t crop_height = 0;
+} DVPPCameraGroup;
+
+typedef struct{
+    uint32_t resized_width = 640;     // output of every image
+    uint32_t resized_height = 640;
+    uint32_t batch_size = 8;
+    float max_delay_us = 2000.0f;     // a partial batch is run when its oldest image waited this long
+    uint32_t channels = 1;            // DvppResize instances, each runs one batch at a time
+    uint32_t vpc_engines = 1;         // batches on the vpc at once, the host part of the channels overlaps
+    float duration_s = 60.0f;         // simulated arrivals
+    float jitter = 0.1f;              // arrival jitter, fraction of the frame interval
+    uint32_t seed = 20261019;
+    float latency_cap_us = 0.0f;      // FindMaxCameras: largest p99 latency, 0: only no overload
+    char reserve[8];
+} DVPPCapacityConfig;
+
+typedef struct{
+    uint64_t images = 0;
+    uint64_t batches = 0;
+    float mean_batch_size = 0.0f;
+    float offered_images_per_second = 0.0f;
+    float images_per_second = 0.0f;
+    float channel_utilization = 0.0f;  // busy time / (channels * simulated time)
+    float vpc_utilization = 0.0f;      // busy time / (vpc_engines * simulated time)
+    float p50_latency_us = 0.0f;       // frame arrival -> result ready
+    float p99_latency_us = 0.0f;
+    float p999_latency_us = 0.0f;
+    float max_latency_us = 0.0f;
+    int overloaded = 0;                // 1: the backlog grows, the latencies only depend on duration_s
+} DVPPCapacityResult;
+
+/**
+* @brief least squares fit of the cost model over the successful batches of the traces,
+*        the first batch of every trace is skipped(warm-up), async batches only count for setup and launch
+* @param [in] model: copy_us_per_mb is kept, the rest is fitted
+* @return 1 success, 0 failed(unreadable trace or too few batches)
+*/
+int FitCostModel(const std::vector<std::string>& trace_paths, DVPPCostModel& model);
+
+/**
+* @return 1 success, 0 failed(missing file or bad line)
+*/
+int LoadCostModel(const std::string& path, DVPPCostModel& model);
+
+/**
+* @return 1 success, 0 failed
+*/
+int SaveCostModel(const std::string& path, const DVPPCostModel& model);
+
+/**
+* @brief "key value" lines of DVPPCapacityConfig and one "camera count fps src_width src_height crops_per_frame
+*        crop_width crop_height" line per camera group, '#' starts a comment
+* @return 1 success, 0 failed
+*/
+int LoadCapacityScenario(const std::string& path, std::vector<DVPPCameraGroup>& cameras, DVPPCapacityConfig& config);
+
+/**
+* @brief discrete-event simulation of the cameras feeding one queue: batches are formed like BatchAggregator,
+*        run on the first free channel(setup + launch), wait for a vpc engine(vpc), then copy back
+* @return 1 success, 0 failed(bad config or no images)
+*/
+int RunCapacitySimulation(const DVPPCostModel& model, const std::vector<DVPPCameraGroup>& cameras,
+                          const DVPPCapacityConfig& config, DVPPCapacityResult& result);
+
+/**
+* @brief largest count of cameras[group] that is not overloaded and within latency_cap_us, the other groups fixed
+* @param [out] result: simulation of that count
+* @return the count, 0 if even one camera is too many
+*/
+uint32_t FindMaxCameras(const DVPPCostModel& model, std::vector<DVPPCameraGroup> cameras, size_t group,
+                        const DVPPCapacityConfig& config, DVPPCapacityResult& result);
+
+#endif // _PICTURE_INC_DVPP_CAPACITY_H
@@ -0,0 +1,436 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include "opencv2/opencv.hpp"
+#include "dvpp_decode_resize.h"
+#include "color_convert.h"
+#include "alg_define.h"
+
+static inline bool IsJpeg(const DVPPEncodedImage& image)
+{
+    return image.data && image.size > 3 && 0xFF == image.data[0] && 0xD8 == image.data[1] && 0xFF == image.data[2];
+}
+
+DvppDecodeResize::DvppDecodeResize()
+        : pool_(nullptr), jpegd_channel_desc_(nullptr), decode_stream_(nullptr), nv12_buffer_size_(0),
+          stop_(false), submit_slot_(0), process_slot_(0), last_processed_slot_(-1), has_init_over_(false)
+{
+
+}
+
+DvppDecodeResize::~DvppDecodeResize()
+{
+    DestroyResource();
+}
+
+void DvppDecodeResize::Init(const DVPPDecodeResizeConfig *config, WorkerPool *pool)
+{
+    config_ = *config;
+    config_.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    pool_ = pool;
+    // the slots and Submit check batch_size, a tuned one(tune_profile) is resolved here
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+
+    resize_.Init(&config_.resize_config);
+    if (!resize_.HasInit())
+    {
+        AIALG_ERROR("DvppResize init failed\n");
+        return;
+    }
+
+    aclError ret = aclrtSetCurrentContext(config_.resize_config.context);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", ret);
+        return;
+    }
+    // decode runs on its own stream so it overlaps with the resize stream
+    ret = aclrtCreateStream(&decode_stream_);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("create decode stream failed, aclRet is %d\n", ret);
+        return;
+    }
+    if (config_.use_jpegd)
+    {
+        jpegd_channel_desc_ = acldvppCreateChannelDesc();
+        if (!jpegd_channel_desc_ || ACL_SUCCESS != acldvppCreateChannel(jpegd_channel_desc_))
+        {
+            AIALG_ERROR("create JPEGD channel failed, use host decoder only\n");
+            if (jpegd_channel_desc_)
+            {
+                acldvppDestroyChannelDesc(jpegd_channel_desc_);
+                jpegd_channel_desc_ = nullptr;
+            }
+            config_.use_jpegd = 0;
+        }
+    }
+
+    // JPEGD output on 310P is 64*16 aligned, host decoded images fit into the same buffers
+    nv12_buffer_size_ = YUV420SP_SIZE(ALIGN_UP64(config_.max_width), ALIGN_UP16(config_.max_height));
+    uint32_t batch_size = config_.resize_config.batch_size;
+    for (int s = 0; s < DVPP_DECODE_SLOT_NUM; ++s)
+    {
+        DecodeSlot& slot = slots_[s];
+        slot.nv12_dev.resize(batch_size, nullptr);
+        slot.jpeg_dev.resize(batch_size, nullptr);
+        slot.jpeg_dev_size.resize(batch_size, 0);
+        slot.jpegd_desc.resize(batch_size, nullptr);
+        slot.staging.resize(batch_size);
+        slot.images.resize(batch_size);
+        slot.busy = false;
+        for (uint32_t idx = 0; idx < batch_size; ++idx)
+        {
+            aclError aclRet = acldvppMalloc(&slot.nv12_dev[idx], nv12_buffer_size_);
+            if (aclRet != ACL_SUCCESS)
+            {
+                AIALG_ERROR("acldvppMalloc decode buffer failed, aclRet = %d\n", aclRet);
+                return;
+            }
+            if (config_.use_jpegd)
+            {
+                slot.jpegd_desc[idx] = acldvppCreatePicDesc();
+                if (!slot.jpegd_desc[idx])
+                {
+                    AIALG_ERROR("acldvppCreatePicDesc failed\n");
+                    return;
+                }
+            }
+        }
+    }
+    submit_slot_ = 0;
+    process_slot_ = 0;
+    last_processed_slot_ = -1;
+    stop_ = false;
+    decode_queue_.clear();
+    decode_thread_ = std::thread(&DvppDecodeResize::DecodeLoop, this);
+    has_init_over_ = true;
+}
+
+void DvppDecodeResize::DecodeLoop()
+{
+    DvppTimeline::SetThreadName("dvpp_decode");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        decode_cv_.wait(lock, [this] { return stop_ || !decode_queue_.empty(); });
+        if (decode_queue_.empty())
+        {
+            return;
+        }
+        DecodeSlot& slot = slots_[decode_queue_.front()];
+        decode_queue_.pop_front();
+        lock.unlock();
+        int result = DecodeBatch(slot, static_cast<int>(slot.inputs.size()));
+        lock.lock();
+        slot.result = result;
+        slot.decoded = true;
+        done_cv_.notify_all();
+    }
+}
+
+void DvppDecodeResize::DestroyResource()
+{
+    if (decode_thread_.joinable())
+    {
+        // the submitted batches are decoded before the thread stops
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        decode_cv_.notify_all();
+        decode_thread_.join();
+    }
+    for (int s = 0; s < DVPP_DECODE_SLOT_NUM; ++s)
+    {
+        DecodeSlot& slot = slots_[s];
+        slot.busy = false;
+        for (size_t idx = 0; idx < slot.nv12_dev.size(); ++idx)
+        {
+            if (slot.nv12_dev[idx])
+            {
+                acldvppFree(slot.nv12_dev[idx]);
+                slot.nv12_dev[idx] = nullptr;
+            }
+            if (slot.jpeg_dev[idx])
+            {
+                acldvppFree(slot.jpeg_dev[idx]);
+                slot.jpeg_dev[idx] = nullptr;
+            }
+            if (slot.jpegd_desc[idx])
+            {
+                acldvppDestroyPicDesc(slot.jpegd_desc[idx]);
+                slot.jpegd_desc[idx] = nullptr;
+            }
+        }
+    }
+    if (jpegd_channel_desc_)
+    {
+        aclrtSetCurrentContext(config_.resize_config.context);
+        acldvppDestroyChannel(jpegd_channel_desc_);
+        acldvppDestroyChannelDesc(jpegd_channel_desc_);
+        jpegd_channel_desc_ = nullptr;
+    }
+    if (decode_stream_)
+    {
+        aclrtDestroyStream(decode_stream_);
+        decode_stream_ = nullptr;
+    }
+    if (resize_.HasInit())
+    {
+        resize_.DestroyResource();
+    }
+    has_init_over_ = false;
+}
+
+int DvppDecodeResize::DecodeJpegd(DecodeSlot &slot, int index)
+{
+    const DVPPEncodedImage& input = slot.inputs[index];
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int32_t components = 0;
+    uint32_t decode_size = 0;
+    if (ACL_SUCCESS != acldvppJpegGetImageInfo(input.data, input.size, &width, &height, &components) ||
+        ACL_SUCCESS != acldvppJpegPredictDecSize(input.data, input.size, PIXEL_FORMAT_YUV_SEMIPLANAR_420, &decode_size) ||
+        width > config_.max_width || height > config_.max_height || decode_size > nv12_buffer_size_)
+    {
+        return 0;
+    }
+
+    if (slot.jpeg_dev_size[index] < input.size)
+    {
+        if (slot.jpeg_dev[index])
+        {
+            acldvppFree(slot.jpeg_dev[index]);
+            slot.jpeg_dev[index] = nullptr;
+        }
+        uint32_t capacity = ALIGN_UP128(input.size + input.size / 4);
+        if (ACL_SUCCESS != acldvppMalloc(&slot.jpeg_dev[index], capacity))
+        {
+            slot.jpeg_dev_size[index] = 0;
+            return 0;
+        }
+        slot.jpeg_dev_size[index] = capacity;
+    }
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_decode", "jpeg_upload", input.size);
+        if (ACL_SUCCESS != aclrtMemcpy(slot.jpeg_dev[index], slot.jpeg_dev_size[index], input.data, input.size,
+                                       ACL_MEMCPY_HOST_TO_DEVICE))
+        {
+            return 0;
+        }
+    }
+
+    DVPPImageData& image = slot.images[index];
+    image.width = width;
+    image.height = height;
+    image.alignWidth = ALIGN_UP64(width);
+    image.alignHeight = ALIGN_UP16(height);
+    image.size = decode_size;
+    image.data = static_cast<uint8_t*>(slot.nv12_dev[index]);
+
+    acldvppPicDesc* desc = slot.jpegd_desc[index];
+    acldvppSetPicDescData(desc, image.data);
+    acldvppSetPicDescFormat(desc, PIXEL_FORMAT_YUV_SEMIPLANAR_420);
+    acldvppSetPicDescWidth(desc, width);
+    acldvppSetPicDescHeight(desc, height);
+    acldvppSetPicDescWidthStride(desc, image.alignWidth);
+    acldvppSetPicDescHeightStride(desc, image.alignHeight);
+    acldvppSetPicDescSize(desc, decode_size);
+    DVPP_TIMELINE_SCOPE("dvpp_decode", "jpegd_launch", index);
+    return ACL_SUCCESS == acldvppJpegDecodeAsync(jpegd_channel_desc_, slot.jpeg_dev[index], input.size, desc,
+                                                 decode_stream_) ? 1 : 0;
+}
+
+int DvppDecodeResize::DecodeHost(DecodeSlot &slot, int index)
+{
+    const DVPPEncodedImage& input = slot.inputs[index];
+    if (!input.data || 0 == input.size)
+    {
+        return 0;
+    }
+    DVPP_TIMELINE_SCOPE("dvpp_decode", "host_decode", index);
+    cv::Mat encoded(1, input.size, CV_8UC1, const_cast<uint8_t*>(input.data));
+    cv::Mat bgr = cv::imdecode(encoded, cv::IMREAD_COLOR);
+    if (bgr.empty() || static_cast<uint32_t>(bgr.cols) > config_.max_width ||
+        static_cast<uint32_t>(bgr.rows) > config_.max_height)
+    {
+        return 0;
+    }
+    // yuv420sp needs even width and height, the odd last row/column is dropped
+    DVPPImageData src;
+    src.width = bgr.cols & ~1;
+    src.height = bgr.rows & ~1;
+    src.alignWidth = bgr.step[0];
+    src.alignHeight = bgr.rows;
+    src.size = 0;
+    src.data = bgr.data;
+
+    DVPPImageData& image = slot.images[index];
+    image.alignWidth = ALIGN_UP16(src.width);
+    image.alignHeight = ALIGN_UP2(src.height);
+    image.size = YUV420SP_SIZE(image.alignWidth, image.alignHeight);
+
+    // converted straight into the strided staging buffer, the device layout
+    std::vector<uint8_t>& staging = slot.staging[index];
+    staging.resize(image.size);
+    image.data = staging.data();
+    int ret = ConvertColor(src, CVT_FORMAT_BGR, image, CVT_FORMAT_NV12);
+    image.data = static_cast<uint8_t*>(slot.nv12_dev[index]);
+    return ret;
+}
+
+int DvppDecodeResize::UploadHost(DecodeSlot &slot, int index)
+{
+    const DVPPImageData& image = slot.images[index];
+    DVPP_TIMELINE_SCOPE("dvpp_decode", "upload", image.size);
+    return ACL_SUCCESS == aclrtMemcpy(image.data, nv12_buffer_size_, slot.staging[index].data(), image.size,
+                                      ACL_MEMCPY_HOST_TO_DEVICE) ? 1 : 0;
+}
+
+int DvppDecodeResize::DecodeBatch(DecodeSlot &slot, int img_num)
+{
+    aclError ret = aclrtSetCurrentContext(config_.resize_config.context);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", ret);
+        return 0;
+    }
+
+    DVPP_TIMELINE_SCOPE("dvpp_decode", "decode_batch", img_num);
+    std::vector<int> host_indices;
+    std::vector<int> jpegd_indices;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (config_.use_jpegd && IsJpeg(slot.inputs[idx]) && 1 == DecodeJpegd(slot, idx))
+        {
+            jpegd_indices.push_back(idx);
+        }
+        else
+        {
+            host_indices.push_back(idx);
+        }
+    }
+    uint64_t sync_ns = DvppTimeline::NowNs();
+    aclError sync_ret = jpegd_indices.empty() ? ACL_SUCCESS : aclrtSynchronizeStream(decode_stream_);
+    if (!jpegd_indices.empty())
+    {
+        DvppTimeline::Record("dvpp_decode", "jpegd_sync", sync_ns, DvppTimeline::NowNs(), jpegd_indices.size());
+    }
+    if (ACL_SUCCESS != sync_ret)
+    {
+        // e.g. progressive jpeg, JPEGD does not support it
+        AIALG_ERROR("JPEGD failed, decode the batch on host\n");
+        host_indices.insert(host_indices.end(), jpegd_indices.begin(), jpegd_indices.end());
+    }
+    if (host_indices.empty())
+    {
+        return 1;
+    }
+
+    std::vector<int> status(host_indices.size(), 0);
+    WorkerPool::RangeFunc decode = [&](int begin, int end, int /*worker*/) {
+        for (int job = begin; job < end; ++job)
+        {
+            status[job] = DecodeHost(slot, host_indices[job]);
+        }
+    };
+    if (pool_)
+    {
+        pool_->ParallelFor(0, static_cast<int>(host_indices.size()), decode);
+    }
+    else
+    {
+        decode(0, static_cast<int>(host_indices.size()), 0);
+    }
+
+    int ok = 1;
+    for (size_t job = 0; job < host_indices.size(); ++job)
+    {
+        if (1 != status[job] || 1 != UploadHost(slot, host_indices[job]))
+        {
+            AIALG_ERROR("decode image %d failed\n", host_indices[job]);
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+int DvppDecodeResize::Submit(const DVPPEncodedImage *images, int img_num)
+{
+    if (!has_init_over_ || img_num <= 0 || img_num > static_cast<int>(config_.resize_config.batch_size))
+    {
+        AIALG_ERROR("DvppDecodeResize not init or bad img_num = %d\n", img_num);
+        return 0;
+    }
+    DecodeSlot& slot = slots_[submit_slot_];
+    if (slot.busy)
+    {
+        AIALG_ERROR("no free decode slot, call Process first\n");
+        return 0;
+    }
+    slot.inputs.assign(images, images + img_num);
+    slot.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.decoded = false;
+        decode_queue_.push_back(submit_slot_);
+    }
+    decode_cv_.notify_one();
+    submit_slot_ = (submit_slot_ + 1) % DVPP_DECODE_SLOT_NUM;
+    return 1;
+}
+
+int DvppDecodeResize::Process(const RectInt *rois, int img_num)
+{
+    DecodeSlot& slot = slots_[process_slot_];
+    if (!slot.busy)
+    {
+        AIALG_ERROR("no submitted batch\n");
+        return 0;
+    }
+    int ret = 0;
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_decode", "wait_decode", img_num);
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&slot] { return slot.decoded; });
+        ret = slot.result;
+    }
+    slot.busy = false;
+    last_processed_slot_ = process_slot_;
+    process_slot_ = (process_slot_ + 1) % DVPP_DECODE_SLOT_NUM;
+    if (1 != ret)
+    {
+        return 0;
+    }
+    if (img_num != static_cast<int>(slot.inputs.size()))
+    {
+        AIALG_ERROR("img_num = %d, but %zu images were submitted\n", img_num, slot.inputs.size());
+        return 0;
+    }
+    return resize_.Process(slot.images.data(), rois, img_num);
+}
+
+int DvppDecodeResize::Get(DVPPImageData &resizedImage, int index) const
+{
+    return resize_.Get(resizedImage, index);
+}
+
+int DvppDecodeResize::GetHostData(DVPPImageData &resizedImage, int index)
+{
+    return resize_.GetHostData(resizedImage, index);
+}
+
+int DvppDecodeResize::GetDecoded(DVPPImageData &decodedImage, int index) const
+{
+    if (last_processed_slot_ < 0 || index < 0 || index >= static_cast<int>(slots_[last_processed_slot_].inputs.size()))
+    {
+        return 0;
+    }
+    decodedImage = slots_[last_processed_slot_].images[index];
+    return 1;
+}
@@ -0,0 +1,128 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_DECODE_RESIZE_H
+#define _PICTURE_INC_DVPP_DECODE_RESIZE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "worker_pool.h"
+
+#define DVPP_DECODE_SLOT_NUM 2
+
+typedef struct{
+    const uint8_t* data = nullptr;  // compressed jpeg/png bytes, host memory
+    uint32_t size = 0;
+} DVPPEncodedImage;
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // input_format is always YUV_SEMIPLANAR_420
+    uint32_t use_jpegd = 1;              // decode jpeg by JPEGD, other codecs and JPEGD failures go to host
+    uint32_t max_width = 4096;           // size of the pooled nv12 buffers
+    uint32_t max_height = 4096;
+    char reserve[8];
+} DVPPDecodeResizeConfig;
+
+/**
+* @brief batch decode(JPEGD or host decoder) into pooled nv12 buffers and crop-resize them,
+*        batches are decoded in Submit order on a decode thread owned by the instance, so the decode of the next
+*        batch overlaps with the resize of the current one:
+*        Submit(b0); Submit(b1); Process(rois0); Submit(b2); Process(rois1); ...
+*/
+class DvppDecodeResize {
+public:
+    DvppDecodeResize();
+
+    ~DvppDecodeResize();
+
+    /**
+    * @param [in] pool: host decoder workers, nullptr decodes on the decode thread
+    */
+    void Init(const DVPPDecodeResizeConfig* config, WorkerPool* pool = nullptr);
+
+    /**
+    * @brief start decoding a batch in the background, images must stay valid until its Process returns
+    * @return 1 success, 0 failed(no free slot or bad img_num)
+    */
+    int Submit(const DVPPEncodedImage* images, int img_num);
+
+    /**
+    * @brief wait for the oldest submitted batch and crop-resize it, rois == nullptr means full images
+    * @return 1 success, 0 failed
+    */
+    int Process(const RectInt* rois, int img_num);
+
+    int Get(DVPPImageData& resizedImage, int index) const;
+
+    int GetHostData(DVPPImageData& resizedImage, int index);
+
+    /**
+    * @brief decoded nv12 image of the last processed batch
+    */
+    int GetDecoded(DVPPImageData& decodedImage, int index) const;
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline DvppResize& Resizer()
+    {
+        return resize_;
+    }
+
+    void DestroyResource();
+
+private:
+    struct DecodeSlot {
+        std::vector<void*> nv12_dev;            // batch_size pooled device buffers
+        std::vector<void*> jpeg_dev;            // compressed input of JPEGD
+        std::vector<uint32_t> jpeg_dev_size;
+        std::vector<acldvppPicDesc*> jpegd_desc;
+        std::vector<std::vector<uint8_t>> staging;  // host decoded nv12
+        std::vector<DVPPImageData> images;
+        std::vector<DVPPEncodedImage> inputs;
+        int result = 0;         // of DecodeBatch, with mutex_
+        bool decoded = false;   // with mutex_
+        bool busy = false;      // submitted, not processed yet
+    };
+
+    void DecodeLoop();
+
+    int DecodeBatch(DecodeSlot& slot, int img_num);
+
+    int DecodeJpegd(DecodeSlot& slot, int index);
+
+    int DecodeHost(DecodeSlot& slot, int index);
+
+    int UploadHost(DecodeSlot& slot, int index);
+
+private:
+    DVPPDecodeResizeConfig config_;
+    DvppResize resize_;
+    WorkerPool* pool_;
+
+    acldvppChannelDesc* jpegd_channel_desc_;
+    aclrtStream decode_stream_;
+    uint32_t nv12_buffer_size_;
+
+    DecodeSlot slots_[DVPP_DECODE_SLOT_NUM];
+    std::thread decode_thread_;
+    std::mutex mutex_;
+    std::condition_variable decode_cv_;   // decode thread: a slot was submitted or stop
+    std::condition_variable done_cv_;     // Process: a slot was decoded
+    std::deque<int> decode_queue_;
+    bool stop_;
+    int submit_slot_;
+    int process_slot_;
+    int last_processed_slot_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_DVPP_DECODE_RESIZE_H
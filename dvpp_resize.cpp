@@ -14,22 +14,67 @@
 * limitations under the License.
 */
 
+#include <cmath>
 #include <iostream>
+#include <chrono>
+#include <algorithm>
 #include "acl/acl.h"
 #include "dvpp_resize.h"
+#include "dvpp_trace.h"
+#include "dvpp_autotune.h"
 #include "alg_define.h"
 
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 DvppResize::DvppResize()
         : g_dvppChannelDesc_(nullptr),
           g_resizeConfig_(nullptr), g_vpcBatchInputDesc_(nullptr), g_vpcBatchOutputDesc_(nullptr),
-          g_vpcOutBufferSize_(0), has_init_over_(false)
+          g_vpcBatchOutBufferDev_(nullptr), g_vpcOutBufferSize_(0), has_init_over_(false),
+          cascade_input_desc_(nullptr), cascade_output_desc_(nullptr), status_img_num_(0),
+          output_descs_remapped_(false), stats_img_num_(0), stream_(nullptr), queued_event_(nullptr),
+          queued_stream_(nullptr), batch_queued_(false), trace_start_ns_(0)
 {
 
 }
 
+int ResolveDvppBatchSize(DVPPResizeInitConfig& config)
+{
+    if (0 == config.batch_size && config.tune_profile)
+    {
+        std::vector<DVPPTuneEntry> entries;
+        const DVPPTuneEntry* tuned = nullptr;
+        if (1 == LoadTuneProfile(config.tune_profile, entries))
+        {
+            tuned = FindTuneEntry(entries, config.tune_src_width, config.tune_src_height, config.input_format,
+                                  config.resized_width, config.resized_height);
+        }
+        if (!tuned)
+        {
+            AIALG_ERROR("no tuned batch size for %ux%u in %s, run dvpp_autotune first\n", config.resized_width,
+                        config.resized_height, config.tune_profile);
+            return 0;
+        }
+        config.batch_size = tuned->batch_size;
+    }
+    if (0 == config.batch_size)
+    {
+        AIALG_ERROR("batch_size is 0\n");
+        return 0;
+    }
+    return 1;
+}
+
 void DvppResize::Init(const DVPPResizeInitConfig* dvppResizeInitConfig)
 {
     dvppResizeInitConfig_ = *dvppResizeInitConfig;
+    if (1 != ResolveDvppBatchSize(dvppResizeInitConfig_))
+    {
+        return;
+    }
 
     aclError ret = aclrtSetCurrentContext(dvppResizeInitConfig_.context);
     if (ret != ACL_SUCCESS)
@@ -58,7 +103,7 @@ void DvppResize::Init(const DVPPResizeInitConfig* dvppResizeInitConfig)
         return;
     }
 
-    aclRet = acldvppSetResizeConfigInterpolation(g_resizeConfig_, 2);
+    aclRet = acldvppSetResizeConfigInterpolation(g_resizeConfig_, dvppResizeInitConfig_.interpolation);
     if (aclRet != ACL_SUCCESS)
     {
         AIALG_ERROR("acldvppSetResizeConfigInterpolation failed, aclRet = %d\n", aclRet);
@@ -85,9 +130,33 @@ void DvppResize::Init(const DVPPResizeInitConfig* dvppResizeInitConfig)
 
     src_widths_.resize(dvppResizeInitConfig_.batch_size, 0);
     src_heights_.resize(dvppResizeInitConfig_.batch_size, 0);
+    src_align_widths_.resize(dvppResizeInitConfig_.batch_size, 0);
+    src_align_heights_.resize(dvppResizeInitConfig_.batch_size, 0);
     g_roiNums_.resize(dvppResizeInitConfig_.batch_size, 1);
     g_cropArea_.resize(dvppResizeInitConfig_.batch_size, nullptr);
     g_pasteArea_.resize(dvppResizeInitConfig_.batch_size,nullptr);
+    cascade_crop_area_.resize(dvppResizeInitConfig_.batch_size, nullptr);
+    cascade_paste_area_.resize(dvppResizeInitConfig_.batch_size, nullptr);
+    for (int buffer = 0; buffer < 2; ++buffer)
+    {
+        cascade_buffers_[buffer].resize(dvppResizeInitConfig_.batch_size, nullptr);
+        cascade_buffer_sizes_[buffer].resize(dvppResizeInitConfig_.batch_size, 0);
+    }
+    cascade_passes_.resize(dvppResizeInitConfig_.batch_size, 1);
+    cascade_sizes_.resize(dvppResizeInitConfig_.batch_size);
+    cascade_crops_.resize(dvppResizeInitConfig_.batch_size);
+    cascade_images_.resize(dvppResizeInitConfig_.batch_size);
+    cascade_rois_.resize(dvppResizeInitConfig_.batch_size);
+    fill_borders_.resize(dvppResizeInitConfig_.batch_size, 0);
+    batch_images_.reserve(dvppResizeInitConfig_.batch_size);
+    batch_rois_.reserve(dvppResizeInitConfig_.batch_size);
+    batch_sources_.reserve(dvppResizeInitConfig_.batch_size);
+    batch_positions_.resize(dvppResizeInitConfig_.batch_size, -1);
+    image_status_.resize(dvppResizeInitConfig_.batch_size, DVPP_IMAGE_OK);
+    default_stream_.reset(new AclDvppStream(dvppResizeInitConfig_.stream, dvppResizeInitConfig_.context));
+    paste_rects_.resize(dvppResizeInitConfig_.batch_size);
+    image_stats_.resize(dvppResizeInitConfig_.batch_size);
+    image_stats_valid_.resize(dvppResizeInitConfig_.batch_size, 0);
     has_init_over_ = true;
 
     AIALG_PRINT("Init success\n");
@@ -100,6 +169,9 @@ DvppResize::~DvppResize()
 
 void DvppResize::DestroyResource()
 {
+    DisableTrace();
+    ReleaseQueuedEvent();
+    default_stream_.reset();
     if (g_vpcBatchInputDesc_)
     {
         acldvppDestroyBatchPicDesc(g_vpcBatchInputDesc_);
@@ -115,6 +187,8 @@ void DvppResize::DestroyResource()
         acldvppFree(g_vpcBatchOutBufferDev_);
         g_vpcBatchOutBufferDev_ = nullptr;
     }
+    bound_output_ = DVPPOutputBinding();
+    current_output_ = DVPPOutputBinding();
     for (int idx = 0; idx < dvppResizeInitConfig_.batch_size; ++idx)
     {
         if (!g_cropArea_.empty() && g_cropArea_[idx])
@@ -128,6 +202,7 @@ void DvppResize::DestroyResource()
             g_pasteArea_[idx] = nullptr;
         }
     }
+    DestroyCascade();
 
     if (g_resizeConfig_)
     {
@@ -156,6 +231,41 @@ void DvppResize::DestroyResource()
     }
 }
 
+void GetDvppInputStride(uint32_t input_format, const DVPPImageData& image,
+                        uint32_t& width_stride, uint32_t& height_stride, uint32_t& buffer_size)
+{
+    if(PIXEL_FORMAT_BGR_888 == input_format)
+    {
+        width_stride = ALIGN_UP16(image.width) * 3;
+        height_stride = ALIGN_UP2(image.height);
+        // e.g. frames kept in decoder layout, stride must stay 16 aligned
+        if (image.alignWidth > width_stride && 0 == image.alignWidth % 48)
+        {
+            width_stride = image.alignWidth;
+        }
+        if (image.alignHeight > height_stride && 0 == image.alignHeight % 2)
+        {
+            height_stride = image.alignHeight;
+        }
+        buffer_size = width_stride * height_stride;//YUV420SP_SIZE(alignWidth, alignHeight);
+    }
+    else
+    {
+        width_stride = ALIGN_UP16(image.width);
+        height_stride = ALIGN_UP2(image.height);
+        // if the input yuv is from JPEGD, 128*16 alignment on 310, 64*16 alignment on 310P
+        if (image.alignWidth > width_stride && 0 == image.alignWidth % 16)
+        {
+            width_stride = image.alignWidth;
+        }
+        if (image.alignHeight > height_stride && 0 == image.alignHeight % 2)
+        {
+            height_stride = image.alignHeight;
+        }
+        buffer_size = YUV420SP_SIZE(width_stride, height_stride);
+    }
+}
+
 int DvppResize::InitResizeInputDesc(const DVPPImageData &inputImage, int index)
 {
     // if the input yuv is from JPEGD, 128*16 alignment on 310, 64*16 alignment on 310P
@@ -165,18 +275,7 @@ int DvppResize::InitResizeInputDesc(const DVPPImageData &inputImage, int index)
     uint32_t alignWidthStride;
     uint32_t alignHeightStride;
     uint32_t inputBufferSize;
-    if(PIXEL_FORMAT_BGR_888 == g_format_)
-    {
-        alignWidthStride = ALIGN_UP16(inputImage.width) * 3;
-        alignHeightStride = ALIGN_UP2(inputImage.height);
-        inputBufferSize = alignWidthStride * alignHeightStride;//YUV420SP_SIZE(alignWidth, alignHeight);
-    }
-    else
-    {
-        alignWidthStride = ALIGN_UP16(inputImage.width);
-        alignHeightStride = ALIGN_UP2(inputImage.height);
-        inputBufferSize = YUV420SP_SIZE(alignWidthStride, alignHeightStride);
-    }
+    GetDvppInputStride(g_format_, inputImage, alignWidthStride, alignHeightStride, inputBufferSize);
 
     uint32_t inputWidth = inputImage.width;
     uint32_t inputHeight = inputImage.height;
@@ -218,234 +317,1014 @@ int DvppResize::InitResizeOutputDesc()
     g_vpcOutBufferSize_ = resizeOutWidthStride * resizeOutHeightStride;//YUV420SP_SIZE(resizeOutWidthStride, resizeOutHeightStride);
     out_host_data_.resize(g_vpcOutBufferSize_);
 
-    aclError aclRet = acldvppMalloc(&g_vpcBatchOutBufferDev_, dvppResizeInitConfig_.batch_size * g_vpcOutBufferSize_);
-    if (aclRet != ACL_SUCCESS)
+    if (0 == dvppResizeInitConfig_.use_external_output)
     {
-        AIALG_ERROR("acldvppMalloc g_vpcOutBufferDev_ failed, aclRet = %d\n", aclRet);
-        return 0;
+        aclError aclRet = acldvppMalloc(&g_vpcBatchOutBufferDev_, dvppResizeInitConfig_.batch_size * g_vpcOutBufferSize_);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acldvppMalloc g_vpcOutBufferDev_ failed, aclRet = %d\n", aclRet);
+            return 0;
+        }
     }
     for (int bs = 0; bs < dvppResizeInitConfig_.batch_size; ++bs)
     {
         acldvppPicDesc *vpcOutputDesc = acldvppGetPicDesc(g_vpcBatchOutputDesc_, bs);
-        acldvppSetPicDescData(vpcOutputDesc, reinterpret_cast<uint8_t*>(g_vpcBatchOutBufferDev_) + bs * g_vpcOutBufferSize_);
         acldvppSetPicDescFormat(vpcOutputDesc, PIXEL_FORMAT_BGR_888);
         acldvppSetPicDescWidth(vpcOutputDesc, resizeOutWidth);
         acldvppSetPicDescHeight(vpcOutputDesc, resizeOutHeight);
-        acldvppSetPicDescWidthStride(vpcOutputDesc, resizeOutWidthStride);
-        acldvppSetPicDescHeightStride(vpcOutputDesc, resizeOutHeightStride);
-        acldvppSetPicDescSize(vpcOutputDesc, g_vpcOutBufferSize_);
+    }
+    current_output_ = DVPPOutputBinding();
+    BindOutput(nullptr);
+    if (bound_output_.data)
+    {
+        ApplyOutputBinding(bound_output_, 0);
     }
     return 1;
 }
 
+int DvppResize::CheckOutputBinding(const DVPPOutputBinding& output, int slot_num, DVPPOutputBinding& checked) const
+{
+    checked = output;
+    if (0 == checked.width_stride)
+    {
+        checked.width_stride = ALIGN_UP16(dvppResizeInitConfig_.resized_width) * 3;
+    }
+    if (0 == checked.height_stride)
+    {
+        checked.height_stride = ALIGN_UP2(dvppResizeInitConfig_.resized_height);
+    }
+    uint64_t slot_size = static_cast<uint64_t>(checked.width_stride) * checked.height_stride;
+    if (0 == checked.slot_offset)
+    {
+        checked.slot_offset = slot_size;
+    }
+
+    if (!checked.data && !checked.slot_data)
+    {
+        AIALG_ERROR("output data is nullptr\n");
+        return 0;
+    }
+    // vpc BGR_888 output: width stride is the 16 aligned width * 3, height stride is even
+    if (checked.width_stride < dvppResizeInitConfig_.resized_width * 3 || 0 != checked.width_stride % 48)
+    {
+        AIALG_ERROR("bad output width_stride %d, must be >= %d and a multiple of 48\n", checked.width_stride,
+                    dvppResizeInitConfig_.resized_width * 3);
+        return 0;
+    }
+    if (checked.height_stride < dvppResizeInitConfig_.resized_height || 0 != checked.height_stride % 2)
+    {
+        AIALG_ERROR("bad output height_stride %d, must be >= %d and even\n", checked.height_stride,
+                    dvppResizeInitConfig_.resized_height);
+        return 0;
+    }
+    if (checked.slot_data)
+    {
+        // scattered slots, e.g. result slots of a reorder buffer
+        for (int idx = 0; idx < slot_num; ++idx)
+        {
+            if (!checked.slot_data[idx] || 0 != reinterpret_cast<uintptr_t>(checked.slot_data[idx]) % DVPP_OUTPUT_ADDR_ALIGN)
+            {
+                AIALG_ERROR("output slot %d is nullptr or not aligned to %d\n", idx, DVPP_OUTPUT_ADDR_ALIGN);
+                return 0;
+            }
+        }
+        if (checked.size < slot_size)
+        {
+            AIALG_ERROR("output slot size %ld is less than %ld\n", checked.size, slot_size);
+            return 0;
+        }
+        return 1;
+    }
+    if (0 != reinterpret_cast<uintptr_t>(checked.data) % DVPP_OUTPUT_ADDR_ALIGN ||
+        0 != checked.slot_offset % DVPP_OUTPUT_ADDR_ALIGN)
+    {
+        AIALG_ERROR("output data and slot_offset must be aligned to %d\n", DVPP_OUTPUT_ADDR_ALIGN);
+        return 0;
+    }
+    if (slot_num > 1 && checked.slot_offset < slot_size)
+    {
+        AIALG_ERROR("output slots overlap, slot_offset = %ld, slot size = %ld\n", checked.slot_offset, slot_size);
+        return 0;
+    }
+    uint64_t need_size = checked.slot_offset * (slot_num - 1) + slot_size;
+    if (checked.size < need_size)
+    {
+        AIALG_ERROR("output size %ld is less than %ld required by %d slots\n", checked.size, need_size, slot_num);
+        return 0;
+    }
+    return 1;
+}
 
-void DvppResize::ProcessFullImage(const DVPPImageData* srcImage, int img_num)
+void DvppResize::ApplyOutputBinding(const DVPPOutputBinding& output, int slot_num)
 {
-    if(img_num != dvppResizeInitConfig_.batch_size)
+    uint32_t slot_size = output.width_stride * output.height_stride;
+    if (output.slot_data)
+    {
+        current_slots_.assign(output.slot_data, output.slot_data + slot_num);
+        for (int bs = 0; bs < slot_num; ++bs)
+        {
+            acldvppPicDesc *vpcOutputDesc = acldvppGetPicDesc(g_vpcBatchOutputDesc_, bs);
+            acldvppSetPicDescData(vpcOutputDesc, current_slots_[bs]);
+            acldvppSetPicDescWidthStride(vpcOutputDesc, output.width_stride);
+            acldvppSetPicDescHeightStride(vpcOutputDesc, output.height_stride);
+            acldvppSetPicDescSize(vpcOutputDesc, slot_size);
+        }
+        current_output_ = output;
+        current_output_.data = nullptr;
+        current_output_.slot_data = current_slots_.data();
+        output_descs_remapped_ = false;
+        return;
+    }
+    // descriptors are only touched when the layout really changes, e.g. double buffered model inputs
+    if (!current_output_.slot_data && !output_descs_remapped_ && output.data == current_output_.data &&
+        output.width_stride == current_output_.width_stride && output.height_stride == current_output_.height_stride &&
+        output.slot_offset == current_output_.slot_offset)
     {
-        AIALG_ERROR("img_num must equal batch_size, img_num = %d, batch_size = %d\n", img_num, dvppResizeInitConfig_.batch_size);
+        current_output_.size = output.size;
         return;
     }
+    // all slots are set so that a later larger batch with the same binding is not stale
+    for (int bs = 0; bs < dvppResizeInitConfig_.batch_size; ++bs)
+    {
+        acldvppPicDesc *vpcOutputDesc = acldvppGetPicDesc(g_vpcBatchOutputDesc_, bs);
+        acldvppSetPicDescData(vpcOutputDesc, output.data + bs * output.slot_offset);
+        acldvppSetPicDescWidthStride(vpcOutputDesc, output.width_stride);
+        acldvppSetPicDescHeightStride(vpcOutputDesc, output.height_stride);
+        acldvppSetPicDescSize(vpcOutputDesc, slot_size);
+    }
+    current_output_ = output;
+    output_descs_remapped_ = false;
+}
 
-    for (int idx = 0; idx < dvppResizeInitConfig_.batch_size; ++idx)
+int DvppResize::BindOutput(const DVPPOutputBinding* output)
+{
+    DVPPOutputBinding checked;
+    if (!output)
+    {
+        bound_output_ = DVPPOutputBinding();
+        if (g_vpcBatchOutBufferDev_)
+        {
+            DVPPOutputBinding internal;
+            internal.data = static_cast<uint8_t*>(g_vpcBatchOutBufferDev_);
+            internal.size = static_cast<uint64_t>(dvppResizeInitConfig_.batch_size) * g_vpcOutBufferSize_;
+            CheckOutputBinding(internal, dvppResizeInitConfig_.batch_size, bound_output_);
+        }
+        return 1;
+    }
+    if (output->slot_data)
+    {
+        AIALG_ERROR("slot_data can only be passed to Process\n");
+        return 0;
+    }
+    if (1 != CheckOutputBinding(*output, dvppResizeInitConfig_.batch_size, checked))
+    {
+        return 0;
+    }
+    bound_output_ = checked;
+    return 1;
+}
+
+void GetDvppPasteArea(const DVPPResizeInitConfig& config, int src_width, int src_height,
+                      int& left, int& right, int& top, int& bottom)
+{
+    float r = 1.0f * std::max(config.resized_height, config.resized_width) / std::max(src_height, src_width);
+    r /= config.resize_scale_factor;
+    int net_input_new_width = static_cast<int>(src_width * r);
+    int net_input_new_height = static_cast<int>(src_height * r);
+    int resized_width = static_cast<int>(config.resized_width);
+    int resized_height = static_cast<int>(config.resized_height);
+
+    // left offset must aligned to 16
+    int x = 0;
+    if(0 != config.is_fix_scale_resize && 0 != config.is_symmetry_padding)
+    {
+        x = (resized_width - net_input_new_width) / 2; // 左右对称补0
+    }
+    x = x < 0 ? 0 : x;
+    x = ALIGN_UP16(x);
+    int x_max = resized_width - 1;
+    if(0 != config.is_fix_scale_resize)
+    {
+        x_max = x + net_input_new_width;
+        x_max = x_max >  resized_width ? resized_width - 1 : x_max;
+    }
+    x_max = x_max % 2 ? x_max : x_max - 1;
+
+    int y = 0;
+    if(0 != config.is_fix_scale_resize && 0 != config.is_symmetry_padding)
+    {
+        y = (resized_height - net_input_new_height) / 2; //上下对称补0
+    }
+    y = y % 2 ? y - 1 : y - 2;
+    y = y < 0 ? 0 : y;
+    int y_max = resized_height - 1;
+    if(0 != config.is_fix_scale_resize)
+    {
+        y_max = y + net_input_new_height;
+        y_max = y_max >  resized_height ? resized_height - 1 : y_max;
+    }
+    y_max = y_max % 2 ? y_max : y_max - 1;
+
+    left = x;
+    right = x_max;
+    top = y;
+    bottom = y_max;
+}
+
+// one axis of GetDvppRoiArea, [roi_min, roi_max] of the source is pasted to [paste_min, paste_max]
+static int MapDvppRoiAxis(int roi_min, int roi_max, int size, int paste_min, int paste_max, int align,
+                          int& crop_min, int& crop_max, int& out_min, int& out_max)
+{
+    if (roi_max < 0 || roi_min > size - 1 || roi_max <= roi_min)
+    {
+        return 0;
+    }
+    float scale = 1.0f * (paste_max - paste_min + 1) / (roi_max - roi_min + 1);
+    if (roi_min >= 0)
+    {
+        crop_min = roi_min % 2 ? roi_min - 1 : roi_min;
+        out_min = paste_min;
+    }
+    else
+    {
+        // the aligned paste start at or after where the image edge lands, and the even source column nearest to it
+        out_min = ALIGN_UP(static_cast<int>(std::lround(paste_min - roi_min * scale)), align);
+        float src = roi_min + (out_min - paste_min) / scale;
+        crop_min = std::max(0, 2 * static_cast<int>(std::lround(src / 2)));
+    }
+    if (roi_max <= size - 1)
+    {
+        crop_max = roi_max % 2 ? roi_max : roi_max - 1;
+        out_max = paste_max;
+    }
+    else
+    {
+        crop_max = (size - 1) % 2 ? size - 1 : size - 2;
+        out_max = static_cast<int>(std::lround(paste_min + (crop_max + 1 - roi_min) * scale)) - 1;
+        out_max = std::min(out_max % 2 ? out_max : out_max - 1, paste_max);
+    }
+    return crop_max > crop_min && out_max > out_min ? 1 : 0;
+}
+
+int GetDvppRoiArea(const DVPPResizeInitConfig& config, int image_width, int image_height, const RectInt& roi,
+                   RectInt& crop, RectInt& paste)
+{
+    int left, right, top, bottom;
+    GetDvppPasteArea(config, roi.xmax - roi.xmin + 1, roi.ymax - roi.ymin + 1, left, right, top, bottom);
+    if (1 != MapDvppRoiAxis(roi.xmin, roi.xmax, image_width, left, right, 16, crop.xmin, crop.xmax, paste.xmin, paste.xmax) ||
+        1 != MapDvppRoiAxis(roi.ymin, roi.ymax, image_height, top, bottom, 2, crop.ymin, crop.ymax, paste.ymin, paste.ymax))
+    {
+        return 0;
+    }
+    crop.width = crop.xmax - crop.xmin + 1;
+    crop.height = crop.ymax - crop.ymin + 1;
+    paste.width = paste.xmax - paste.xmin + 1;
+    paste.height = paste.ymax - paste.ymin + 1;
+    return 1;
+}
+
+static bool CascadePassInRange(const DVPPResizeInitConfig& config, int from, int to)
+{
+    int64_t up = config.max_pass_upscale;
+    int64_t down = config.max_pass_downscale;
+    return (0 == up || to <= from * up) && (0 == down || to * down >= from);
+}
+
+static int CascadeSide(float side, int align)
+{
+    int rounded = static_cast<int>(std::lround(side / align)) * align;
+    return rounded > DVPP_CASCADE_MIN_SIDE ? rounded : DVPP_CASCADE_MIN_SIDE;
+}
+
+int PlanDvppCascade(const DVPPResizeInitConfig& config, int crop_width, int crop_height,
+                    int paste_width, int paste_height, std::vector<std::pair<int, int> >& sizes)
+{
+    sizes.clear();
+    if (crop_width <= 0 || crop_height <= 0 || paste_width <= 0 || paste_height <= 0 ||
+        (CascadePassInRange(config, crop_width, paste_width) && CascadePassInRange(config, crop_height, paste_height)))
+    {
+        return 1;
+    }
+    // vpc needs 16 aligned width of BGR_888 input, even width of yuv420sp
+    int align_width = PIXEL_FORMAT_BGR_888 == config.input_format ? 16 : 2;
+    float ratio_x = 1.0f * paste_width / crop_width;
+    float ratio_y = 1.0f * paste_height / crop_height;
+    for (int passes = 2; passes <= DVPP_CASCADE_MAX_PASSES; ++passes)
+    {
+        sizes.clear();
+        int width = crop_width;
+        int height = crop_height;
+        bool in_range = true;
+        for (int pass = 1; pass < passes && in_range; ++pass)
+        {
+            float t = 1.0f * pass / passes;
+            int next_width = CascadeSide(crop_width * std::pow(ratio_x, t), align_width);
+            int next_height = CascadeSide(crop_height * std::pow(ratio_y, t), 2);
+            in_range = CascadePassInRange(config, width, next_width) && CascadePassInRange(config, height, next_height);
+            sizes.push_back(std::make_pair(next_width, next_height));
+            width = next_width;
+            height = next_height;
+        }
+        if (in_range && CascadePassInRange(config, width, paste_width) && CascadePassInRange(config, height, paste_height))
+        {
+            return passes;
+        }
+    }
+    sizes.clear();
+    return 0;
+}
+
+int DvppResize::ProcessFullImage(const DVPPImageData* srcImage, int img_num)
+{
+    for (int idx = 0; idx < img_num; ++idx)
     {
         acldvppPicDesc *vpcInputDesc = acldvppGetPicDesc(g_vpcBatchInputDesc_, idx);
         acldvppSetPicDescData(vpcInputDesc, srcImage[idx].data);
-        if (src_widths_[idx] != srcImage[idx].width || src_heights_[idx] != srcImage[idx].height)
+        if (src_widths_[idx] == srcImage[idx].width && src_heights_[idx] == srcImage[idx].height &&
+            src_align_widths_[idx] == srcImage[idx].alignWidth && src_align_heights_[idx] == srcImage[idx].alignHeight)
         {
-            src_widths_[idx] = srcImage[idx].width;
-            src_heights_[idx] = srcImage[idx].height;
+            continue;
+        }
+        int width = srcImage[idx].width;
+        int height = srcImage[idx].height;
+        int x, x_max, y, y_max;
+        GetDvppPasteArea(dvppResizeInitConfig_, width, height, x, x_max, y, y_max);
+        paste_rects_[idx].xmin = x;
+        paste_rects_[idx].xmax = x_max;
+        paste_rects_[idx].ymin = y;
+        paste_rects_[idx].ymax = y_max;
+        // the roi configs exist(ReserveRoiConfigs) and are updated in place
+        if (ACL_SUCCESS != acldvppSetRoiConfig(g_cropArea_[idx], 0, width % 2 ? width - 2 : width - 1,
+                                               0, height % 2 ? height - 2 : height - 1) ||
+            ACL_SUCCESS != acldvppSetRoiConfig(g_pasteArea_[idx], x, x_max, y, y_max))
+        {
+            AIALG_ERROR("acldvppSetRoiConfig of batch index %d failed\n", idx);
+            src_widths_[idx] = 0;
+            return 0;
+        }
+        InitResizeInputDesc(srcImage[idx], idx);
+        // cached only once everything of the index is set
+        src_widths_[idx] = srcImage[idx].width;
+        src_heights_[idx] = srcImage[idx].height;
+        src_align_widths_[idx] = srcImage[idx].alignWidth;
+        src_align_heights_[idx] = srcImage[idx].alignHeight;
+    }
+    return 1;
+}
 
-            if (!g_cropArea_.empty() && g_cropArea_[idx])
-            {
-                acldvppDestroyRoiConfig(g_cropArea_[idx]);
-                g_cropArea_[idx] = nullptr;
-            }
-            g_cropArea_[idx] = acldvppCreateRoiConfig(0, src_widths_[idx] % 2 ? src_widths_[idx] - 2 : src_widths_[idx] - 1,
-                                                      0, src_heights_[idx] % 2 ? src_heights_[idx] - 2 : src_heights_[idx] - 1);
-            if (!g_cropArea_[idx])
-            {
-                AIALG_ERROR("acldvppCreateRoiConfig cropArea_ failed");
-                return;
-            }
-            InitResizeInputDesc(srcImage[idx], idx);
+int DvppResize::ProcessSubImage(const DVPPImageData *srcImage, const RectInt *crops, int img_num)
+{
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        acldvppPicDesc *vpcInputDesc = acldvppGetPicDesc(g_vpcBatchInputDesc_, idx);
+        acldvppSetPicDescData(vpcInputDesc, srcImage[idx].data);
+        // the crop/paste areas kept by ProcessFullImage are overwritten below
+        src_widths_[idx] = 0;
 
-            float r = 1.0f * std::max(dvppResizeInitConfig_.resized_height, dvppResizeInitConfig_.resized_width) / std::max(src_heights_[idx], src_widths_[idx]);
-            r /= dvppResizeInitConfig_.resize_scale_factor;
-            int net_input_new_width = static_cast<int>(src_widths_[idx] * r);
-            int net_input_new_height = static_cast<int>(src_heights_[idx] * r);
-            if (!g_pasteArea_.empty() && g_pasteArea_[idx])
-            {
-                acldvppDestroyRoiConfig(g_pasteArea_[idx]);
-                g_pasteArea_[idx] = nullptr;
-            }
+        // roi configs of a slot are kept and updated in place, a batch of many rois(e.g. tiles) pays no create/destroy
+        const RectInt& crop = crops[idx];
+        const RectInt& paste = paste_rects_[idx];
+        if (ACL_SUCCESS != acldvppSetRoiConfig(g_cropArea_[idx], crop.xmin, crop.xmax, crop.ymin, crop.ymax) ||
+            ACL_SUCCESS != acldvppSetRoiConfig(g_pasteArea_[idx], paste.xmin, paste.xmax, paste.ymin, paste.ymax))
+        {
+            AIALG_ERROR("acldvppSetRoiConfig of batch index %d failed\n", idx);
+            return 0;
+        }
+        InitResizeInputDesc(srcImage[idx], idx);
+    }
+    return 1;
+}
 
-            // left offset must aligned to 16
-            int x = 0;
-            if(0 != dvppResizeInitConfig_.is_fix_scale_resize && 0 != dvppResizeInitConfig_.is_symmetry_padding)
-            {
-                x = (dvppResizeInitConfig_.resized_width - net_input_new_width) / 2; // 左右对称补0
-            }
-            x = x < 0 ? 0 : x;
-            x = ALIGN_UP16(x);
-            int x_max = dvppResizeInitConfig_.resized_width - 1;
-            if(0 != dvppResizeInitConfig_.is_fix_scale_resize)
-            {
-                x_max = x + net_input_new_width;
-                x_max = x_max >  dvppResizeInitConfig_.resized_width ? dvppResizeInitConfig_.resized_width - 1 : x_max;
-            }
-            x_max = x_max % 2 ? x_max : x_max - 1;
+int DvppResize::ReserveRoiConfigs(int img_num)
+{
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (g_cropArea_[idx] && g_pasteArea_[idx])
+        {
+            continue;
+        }
+        // a new config holds no area yet
+        src_widths_[idx] = 0;
+        if (!g_cropArea_[idx])
+        {
+            g_cropArea_[idx] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        }
+        if (!g_pasteArea_[idx])
+        {
+            g_pasteArea_[idx] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        }
+        if (!g_cropArea_[idx] || !g_pasteArea_[idx])
+        {
+            AIALG_ERROR("acldvppCreateRoiConfig of batch index %d failed\n", idx);
+            return idx;
+        }
+    }
+    return img_num;
+}
 
-            int y = 0;
-            if(0 != dvppResizeInitConfig_.is_fix_scale_resize && 0 != dvppResizeInitConfig_.is_symmetry_padding)
-            {
-                y = (dvppResizeInitConfig_.resized_height - net_input_new_height) / 2; //上下对称补0
-            }
-            y = y % 2 ? y - 1 : y - 2;
-            y = y < 0 ? 0 : y;
-            int y_max = dvppResizeInitConfig_.resized_height - 1;
-            if(0 != dvppResizeInitConfig_.is_fix_scale_resize)
+int DvppResize::CompactBatch(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    batch_images_.clear();
+    batch_rois_.clear();
+    batch_sources_.clear();
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        const DVPPImageData& image = srcImage[idx];
+        image_status_[idx] = CheckDvppImage(dvppResizeInitConfig_, image, rois ? &rois[idx] : nullptr);
+        if (DVPP_IMAGE_OK != image_status_[idx])
+        {
+            if (rois)
             {
-                y_max = y + net_input_new_height;
-                y_max = y_max >  dvppResizeInitConfig_.resized_height ? dvppResizeInitConfig_.resized_height - 1 : y_max;
+                AIALG_ERROR("image %d: roi [%d, %d, %d, %d] of the %dx%d image is left out, status %d\n", idx,
+                            rois[idx].xmin, rois[idx].ymin, rois[idx].xmax, rois[idx].ymax, image.width,
+                            image.height, image_status_[idx]);
             }
-            y_max = y_max % 2 ? y_max : y_max - 1;
-            g_pasteArea_[idx] = acldvppCreateRoiConfig(x, x_max,
-                                                       y, y_max);
-            if (!g_pasteArea_[idx])
+            else
             {
-                AIALG_ERROR("acldvppCreateRoiConfig g_pasteArea_ failed");
-                return;
+                AIALG_ERROR("image %d: %dx%d(stride %dx%d) is left out, status %d\n", idx, image.width,
+                            image.height, image.alignWidth, image.alignHeight, image_status_[idx]);
             }
+            batch_positions_[idx] = -1;
+            continue;
+        }
+        batch_positions_[idx] = static_cast<int>(batch_sources_.size());
+        batch_sources_.push_back(idx);
+        batch_images_.push_back(image);
+        if (rois)
+        {
+            batch_rois_.push_back(rois[idx]);
         }
     }
-    return;
+    return static_cast<int>(batch_sources_.size());
 }
 
+void DvppResize::SetBatchStatus(int status)
+{
+    for (size_t pos = 0; pos < batch_sources_.size(); ++pos)
+    {
+        image_status_[batch_sources_[pos]] = status;
+    }
+}
 
-void DvppResize::ProcessSubImage(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+int DvppResize::GetImageStatus(int index) const
 {
-    if(img_num != dvppResizeInitConfig_.batch_size)
+    if (index < 0 || index >= status_img_num_)
     {
-        AIALG_ERROR("img_num must equal batch_size, img_num = %d, batch_size = %d\n", img_num, dvppResizeInitConfig_.batch_size);
-        return;
+        AIALG_ERROR("image %d is not in the last call\n", index);
+        return -1;
     }
+    return image_status_[index];
+}
 
-    for (int idx = 0; idx < dvppResizeInitConfig_.batch_size; ++idx)
+aclError DvppResize::FillBorders(int img_num, aclrtStream stream)
+{
+    uint64_t slot_size = static_cast<uint64_t>(current_output_.width_stride) * current_output_.height_stride;
+    for (int idx = 0; idx < img_num; ++idx)
     {
-        acldvppPicDesc *vpcInputDesc = acldvppGetPicDesc(g_vpcBatchInputDesc_, idx);
-        acldvppSetPicDescData(vpcInputDesc, srcImage[idx].data);
+        if (!fill_borders_[idx])
+        {
+            continue;
+        }
+        // the whole slot, the vpc then overwrites the paste area of the part inside the image
+        aclError aclRet = aclrtMemsetAsync(OutputSlot(batch_sources_[idx]), slot_size, dvppResizeInitConfig_.border_value & 0xff,
+                                           slot_size, stream);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("aclrtMemsetAsync border of image %d failed, aclRet = %d\n", idx, aclRet);
+            return aclRet;
+        }
+    }
+    return ACL_SUCCESS;
+}
 
-        if (!g_cropArea_.empty() && g_cropArea_[idx])
+int DvppResize::GetRoiArea(int index, RectInt &crop, RectInt &paste) const
+{
+    if (index < 0 || index >= stats_img_num_ || batch_positions_[index] < 0)
+    {
+        AIALG_ERROR("image %d is not in the last batch\n", index);
+        return 0;
+    }
+    crop = cascade_crops_[batch_positions_[index]];
+    paste = paste_rects_[batch_positions_[index]];
+    return 1;
+}
+
+static RectInt FullRect(uint32_t width, uint32_t height)
+{
+    RectInt rect;
+    rect.xmin = 0;
+    rect.ymin = 0;
+    rect.xmax = static_cast<int>(width) - 1;
+    rect.ymax = static_cast<int>(height) - 1;
+    rect.width = width;
+    rect.height = height;
+    return rect;
+}
+
+int CheckDvppImage(const DVPPResizeInitConfig& config, const DVPPImageData& image, const RectInt* roi)
+{
+    if (!image.data)
+    {
+        return DVPP_IMAGE_BAD_DATA;
+    }
+    if (0 != reinterpret_cast<uintptr_t>(image.data) % DVPP_INPUT_ADDR_ALIGN)
+    {
+        return DVPP_IMAGE_BAD_ALIGN;
+    }
+    if (image.width < DVPP_INPUT_MIN_WIDTH || image.height < DVPP_INPUT_MIN_HEIGHT ||
+        image.width > DVPP_INPUT_MAX_SIDE || image.height > DVPP_INPUT_MAX_SIDE)
+    {
+        return DVPP_IMAGE_BAD_SIZE;
+    }
+    // a larger alignWidth/alignHeight that GetDvppInputStride can not take would be read with the wrong stride
+    uint32_t width_stride, height_stride, buffer_size;
+    GetDvppInputStride(config.input_format, image, width_stride, height_stride, buffer_size);
+    if (image.alignWidth > width_stride || image.alignHeight > height_stride ||
+        (0 != image.size && image.size < buffer_size))
+    {
+        return DVPP_IMAGE_BAD_STRIDE;
+    }
+    RectInt crop, paste;
+    if (1 != GetDvppRoiArea(config, image.width, image.height, roi ? *roi : FullRect(image.width, image.height),
+                            crop, paste) ||
+        crop.width < DVPP_INPUT_MIN_WIDTH || crop.height < DVPP_INPUT_MIN_HEIGHT)
+    {
+        return DVPP_IMAGE_BAD_ROI;
+    }
+    std::vector<std::pair<int, int> > sizes;
+    if (0 == PlanDvppCascade(config, crop.width, crop.height, paste.width, paste.height, sizes))
+    {
+        return DVPP_IMAGE_BAD_RATIO;
+    }
+    return DVPP_IMAGE_OK;
+}
+
+static void SetCascadePicDesc(acldvppPicDesc* desc, acldvppPixelFormat format, const DVPPImageData& image)
+{
+    uint32_t width_stride, height_stride, buffer_size;
+    GetDvppInputStride(format, image, width_stride, height_stride, buffer_size);
+    acldvppSetPicDescData(desc, image.data);
+    acldvppSetPicDescFormat(desc, format);
+    acldvppSetPicDescWidth(desc, image.width & ~1u);
+    acldvppSetPicDescHeight(desc, image.height & ~1u);
+    acldvppSetPicDescWidthStride(desc, width_stride);
+    acldvppSetPicDescHeightStride(desc, height_stride);
+    acldvppSetPicDescSize(desc, buffer_size);
+}
+
+int DvppResize::PlanCascades(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    int max_passes = 1;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        int width = static_cast<int>(srcImage[idx].width);
+        int height = static_cast<int>(srcImage[idx].height);
+        RectInt roi = rois ? rois[idx] : FullRect(width, height);
+        RectInt& crop = cascade_crops_[idx];
+        RectInt& paste = paste_rects_[idx];
+        if (1 != GetDvppRoiArea(dvppResizeInitConfig_, width, height, roi, crop, paste))
         {
-            acldvppDestroyRoiConfig(g_cropArea_[idx]);
-            g_cropArea_[idx] = nullptr;
+            AIALG_ERROR("image %d: roi [%d, %d, %d, %d] is outside the %dx%d image or too small\n", idx, roi.xmin,
+                        roi.ymin, roi.xmax, roi.ymax, width, height);
+            return 0;
         }
+        fill_borders_[idx] = roi.xmin < 0 || roi.ymin < 0 || roi.xmax >= width || roi.ymax >= height;
 
-        uint32_t left = rois[idx].xmin % 2 ? rois[idx].xmin - 1 : rois[idx].xmin;
-        left = left > 0 ? left : 0;
-        uint32_t right = rois[idx].xmax % 2 ? rois[idx].xmax : rois[idx].xmax - 1;
-        right = right > 0 ? right : 0;
+        cascade_passes_[idx] = PlanDvppCascade(dvppResizeInitConfig_, crop.width, crop.height, paste.width,
+                                               paste.height, cascade_sizes_[idx]);
+        if (0 == cascade_passes_[idx])
+        {
+            AIALG_ERROR("image %d: %dx%d -> %dx%d needs more than %d passes\n", idx, crop.width, crop.height,
+                        paste.width, paste.height, DVPP_CASCADE_MAX_PASSES);
+            return 0;
+        }
+        max_passes = std::max(max_passes, cascade_passes_[idx]);
+    }
+    return max_passes;
+}
 
-        uint32_t top = rois[idx].ymin % 2 ? rois[idx].ymin - 1 : rois[idx].ymin;
-        top = top > 0 ? top : 0;
-        uint32_t bottom = rois[idx].ymax % 2 ? rois[idx].ymax : rois[idx].ymax - 1;
-        bottom = bottom > 0 ? bottom : 0;
+int DvppResize::ReserveCascadeBuffer(int buffer, int index, uint32_t size)
+{
+    if (cascade_buffer_sizes_[buffer][index] >= size)
+    {
+        return 1;
+    }
+    if (cascade_buffers_[buffer][index])
+    {
+        acldvppFree(cascade_buffers_[buffer][index]);
+        cascade_buffers_[buffer][index] = nullptr;
+        cascade_buffer_sizes_[buffer][index] = 0;
+    }
+    aclError aclRet = acldvppMalloc(&cascade_buffers_[buffer][index], size);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc cascade buffer failed, aclRet = %d\n", aclRet);
+        cascade_buffers_[buffer][index] = nullptr;
+        return 0;
+    }
+    cascade_buffer_sizes_[buffer][index] = size;
+    return 1;
+}
 
-        g_cropArea_[idx] = acldvppCreateRoiConfig(left, right, top, bottom);
-        if (!g_cropArea_[idx])
+int DvppResize::RunCascadePasses(const DVPPImageData *srcImage, int img_num, int max_passes)
+{
+    uint32_t batch_size = dvppResizeInitConfig_.batch_size;
+    if (!cascade_input_desc_)
+    {
+        cascade_input_desc_ = acldvppCreateBatchPicDesc(batch_size);
+        cascade_output_desc_ = acldvppCreateBatchPicDesc(batch_size);
+        if (!cascade_input_desc_ || !cascade_output_desc_)
         {
-            AIALG_ERROR("acldvppCreateRoiConfig cropArea_ failed");
-            return;
+            AIALG_ERROR("acldvppCreateBatchPicDesc of cascade failed\n");
+            DestroyCascade();
+            return 0;
         }
-        InitResizeInputDesc(srcImage[idx], idx);
+    }
+    // created once per batch index before any pass and updated in place, a pass can not fail halfway through setup
+    for (int num = 0; num < img_num; ++num)
+    {
+        if (!cascade_crop_area_[num])
+        {
+            cascade_crop_area_[num] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        }
+        if (!cascade_paste_area_[num])
+        {
+            cascade_paste_area_[num] = acldvppCreateRoiConfig(0, 1, 0, 1);
+        }
+        if (!cascade_crop_area_[num] || !cascade_paste_area_[num])
+        {
+            AIALG_ERROR("acldvppCreateRoiConfig of cascade batch index %d failed\n", num);
+            return 0;
+        }
+    }
+    aclError aclRet = aclrtSetCurrentContext(dvppResizeInitConfig_.context);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", aclRet);
+        return 0;
+    }
 
-        int src_roi_width = rois[idx].xmax - rois[idx].xmin + 1;
-        int src_roi_height = rois[idx].ymax - rois[idx].ymin + 1;
-        float r = 1.0f * std::max(dvppResizeInitConfig_.resized_height, dvppResizeInitConfig_.resized_width) / std::max(src_roi_width, src_roi_height);
-        r /= dvppResizeInitConfig_.resize_scale_factor;
-        int net_input_new_width = static_cast<int>(src_roi_width * r);
-        int net_input_new_height = static_cast<int>(src_roi_height * r);
-        if (!g_pasteArea_.empty() && g_pasteArea_[idx])
+    // passes are aligned at the end, so the last pass of every image is the final batch into the output,
+    // intermediates stay in the input format and ping-pong between two buffers of each batch index
+    for (int round = 0; round < max_passes - 1; ++round)
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_resize", "cascade_pass", round);
+        int num = 0;
+        for (int idx = 0; idx < img_num; ++idx)
         {
-            acldvppDestroyRoiConfig(g_pasteArea_[idx]);
-            g_pasteArea_[idx] = nullptr;
+            int step = round - (max_passes - cascade_passes_[idx]);
+            if (step < 0)
+            {
+                continue;
+            }
+            DVPPImageData input = 0 == step ? srcImage[idx] : cascade_images_[idx];
+            RectInt crop = 0 == step ? cascade_crops_[idx] : FullRect(input.width, input.height);
+
+            DVPPImageData output;
+            output.width = cascade_sizes_[idx][step].first;
+            output.height = cascade_sizes_[idx][step].second;
+            output.alignWidth = 0;
+            output.alignHeight = 0;
+            uint32_t width_stride, height_stride, buffer_size;
+            GetDvppInputStride(g_format_, output, width_stride, height_stride, buffer_size);
+            if (1 != ReserveCascadeBuffer(step % 2, idx, buffer_size))
+            {
+                return 0;
+            }
+            output.alignWidth = width_stride;
+            output.alignHeight = height_stride;
+            output.size = buffer_size;
+            output.data = static_cast<uint8_t*>(cascade_buffers_[step % 2][idx]);
+
+            SetCascadePicDesc(acldvppGetPicDesc(cascade_input_desc_, num), g_format_, input);
+            SetCascadePicDesc(acldvppGetPicDesc(cascade_output_desc_, num), g_format_, output);
+            if (ACL_SUCCESS != acldvppSetRoiConfig(cascade_crop_area_[num], crop.xmin, crop.xmax, crop.ymin, crop.ymax) ||
+                ACL_SUCCESS != acldvppSetRoiConfig(cascade_paste_area_[num], 0, output.width - 1, 0, output.height - 1))
+            {
+                AIALG_ERROR("acldvppSetRoiConfig of cascade batch index %d failed\n", num);
+                return 0;
+            }
+            cascade_images_[idx] = output;
+            num++;
         }
 
-        // left offset must aligned to 16
-        int x = 0;
-        if(0 != dvppResizeInitConfig_.is_fix_scale_resize && 0 != dvppResizeInitConfig_.is_symmetry_padding)
+        aclRet = acldvppVpcBatchCropResizePasteAsync(g_dvppChannelDesc_, cascade_input_desc_, g_roiNums_.data(), num,
+                                                     cascade_output_desc_, cascade_crop_area_.data(),
+                                                     cascade_paste_area_.data(), g_resizeConfig_,
+                                                     dvppResizeInitConfig_.stream);
+        if (aclRet != ACL_SUCCESS)
         {
-            x = (dvppResizeInitConfig_.resized_width - net_input_new_width) / 2; // 左右对称补0
+            AIALG_ERROR("cascade pass %d failed, aclRet = %d\n", round, aclRet);
+            return 0;
         }
-        x = x < 0 ? 0 : x;
-        x = ALIGN_UP16(x);
-        int x_max = dvppResizeInitConfig_.resized_width - 1;
-        if(0 != dvppResizeInitConfig_.is_fix_scale_resize)
+        // the roi configs of this round are rewritten by the next one
+        aclRet = aclrtSynchronizeStream(dvppResizeInitConfig_.stream);
+        if (aclRet != ACL_SUCCESS)
         {
-            x_max = x + net_input_new_width;
-            x_max = x_max >  dvppResizeInitConfig_.resized_width ? dvppResizeInitConfig_.resized_width - 1 : x_max;
+            AIALG_ERROR("cascade pass %d aclrtSynchronizeStream failed, aclRet = %d\n", round, aclRet);
+            return 0;
         }
-        x_max = x_max % 2 ? x_max : x_max - 1;
+        stats_.cascade_pass_count += num;
+    }
 
-        int y = 0;
-        if(0 != dvppResizeInitConfig_.is_fix_scale_resize && 0 != dvppResizeInitConfig_.is_symmetry_padding)
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (cascade_passes_[idx] > 1)
         {
-            y = (dvppResizeInitConfig_.resized_height - net_input_new_height) / 2; //上下对称补0
+            cascade_rois_[idx] = FullRect(cascade_images_[idx].width, cascade_images_[idx].height);
+            stats_.cascade_image_count++;
         }
-        y = y % 2 ? y - 1 : y - 2;
-        y = y < 0 ? 0 : y;
-        int y_max = dvppResizeInitConfig_.resized_height - 1;
-        if(0 != dvppResizeInitConfig_.is_fix_scale_resize)
+        else
         {
-            y_max = y + net_input_new_height;
-            y_max = y_max >  dvppResizeInitConfig_.resized_height ? dvppResizeInitConfig_.resized_height - 1 : y_max;
+            cascade_images_[idx] = srcImage[idx];
+            cascade_rois_[idx] = cascade_crops_[idx];
         }
-        y_max = y_max % 2 ? y_max : y_max - 1;
-        g_pasteArea_[idx] = acldvppCreateRoiConfig(x, x_max,
-                                                   y, y_max);
-        if (!g_pasteArea_[idx])
+    }
+    return 1;
+}
+
+void DvppResize::DestroyCascade()
+{
+    if (cascade_input_desc_)
+    {
+        acldvppDestroyBatchPicDesc(cascade_input_desc_);
+        cascade_input_desc_ = nullptr;
+    }
+    if (cascade_output_desc_)
+    {
+        acldvppDestroyBatchPicDesc(cascade_output_desc_);
+        cascade_output_desc_ = nullptr;
+    }
+    for (size_t idx = 0; idx < cascade_crop_area_.size(); ++idx)
+    {
+        if (cascade_crop_area_[idx])
         {
-            AIALG_ERROR("acldvppCreateRoiConfig g_pasteArea_ failed");
-            return;
+            acldvppDestroyRoiConfig(cascade_crop_area_[idx]);
+            cascade_crop_area_[idx] = nullptr;
+        }
+        if (cascade_paste_area_[idx])
+        {
+            acldvppDestroyRoiConfig(cascade_paste_area_[idx]);
+            cascade_paste_area_[idx] = nullptr;
+        }
+    }
+    for (int buffer = 0; buffer < 2; ++buffer)
+    {
+        for (size_t idx = 0; idx < cascade_buffers_[buffer].size(); ++idx)
+        {
+            if (cascade_buffers_[buffer][idx])
+            {
+                acldvppFree(cascade_buffers_[buffer][idx]);
+                cascade_buffers_[buffer][idx] = nullptr;
+            }
+            cascade_buffer_sizes_[buffer][idx] = 0;
         }
     }
-    return;
 }
 
 int DvppResize::Process(const DVPPImageData* srcImage, const  RectInt* rois, int img_num)
 {
-    if(!rois)
+    return Process(srcImage, rois, img_num, nullptr);
+}
+
+int DvppResize::Process(const DVPPImageData* srcImage, const  RectInt* rois, int img_num, const DVPPOutputBinding* output)
+{
+    return Submit(srcImage, rois, img_num, output, nullptr);
+}
+
+void DvppResize::SetStream(DvppStream *stream)
+{
+    ReleaseQueuedEvent();
+    stream_ = stream;
+}
+
+int DvppResize::WaitQueuedBatch()
+{
+    if (!batch_queued_)
     {
-        ProcessFullImage(srcImage, img_num);
+        return 1;
     }
-    else
+    batch_queued_ = false;
+    if (1 != queued_stream_->SynchronizeEvent(queued_event_))
+    {
+        AIALG_ERROR("wait for the queued batch failed\n");
+        return 0;
+    }
+    return 1;
+}
+
+void DvppResize::ReleaseQueuedEvent()
+{
+    WaitQueuedBatch();
+    if (queued_event_)
     {
-        ProcessSubImage(srcImage, rois, img_num);
+        queued_stream_->DestroyEvent(queued_event_);
+        queued_event_ = nullptr;
+        queued_stream_ = nullptr;
     }
+}
 
+int DvppResize::ProcessAsync(const DVPPImageData *srcImage, const RectInt *rois, int img_num, const DVPPAsyncParam &async,
+                             const DVPPOutputBinding *output)
+{
+    return Submit(srcImage, rois, img_num, output, &async);
+}
+
+int DvppResize::Submit(const DVPPImageData *srcImage, const RectInt *rois, int img_num, const DVPPOutputBinding *output,
+                       const DVPPAsyncParam *async)
+{
+    uint64_t start_ns = SteadyNowNs();
+    stats_img_num_ = 0;
+    status_img_num_ = 0;
+    // the batch queued by the last ProcessAsync still reads the descriptors rewritten below
+    if (1 != WaitQueuedBatch())
+    {
+        stats_.process_count++;
+        stats_.failed_count++;
+        return 0;
+    }
+    if (!srcImage || img_num <= 0 || img_num > static_cast<int>(dvppResizeInitConfig_.batch_size))
+    {
+        // partial batches are fine, the first img_num slots are used
+        AIALG_ERROR("img_num must be in [1, batch_size], img_num = %d, batch_size = %d\n", img_num, dvppResizeInitConfig_.batch_size);
+        stats_.process_count++;
+        stats_.failed_count++;
+        return 0;
+    }
+    status_img_num_ = img_num;
+
+    // every image is checked before any descriptor is touched, the good ones are compacted to the front of the batch
+    int batch_num = CompactBatch(srcImage, rois, img_num);
+    stats_.dropped_count += img_num - batch_num;
+    int reserved = ReserveRoiConfigs(batch_num);
+    if (reserved < batch_num && dvppResizeInitConfig_.drop_bad_images)
+    {
+        for (int pos = reserved; pos < batch_num; ++pos)
+        {
+            image_status_[batch_sources_[pos]] = DVPP_IMAGE_SETUP_FAILED;
+            batch_positions_[batch_sources_[pos]] = -1;
+        }
+        stats_.dropped_count += batch_num - reserved;
+        batch_sources_.resize(reserved);
+        batch_num = reserved;
+    }
+    DVPPOutputBinding checked = bound_output_;
+    if (0 == batch_num || reserved < batch_num || (batch_num < img_num && !dvppResizeInitConfig_.drop_bad_images) ||
+        (output && 1 != CheckOutputBinding(*output, img_num, checked)) || (!checked.data && !checked.slot_data))
+    {
+        AIALG_ERROR("%d of %d images can be resized or no valid output buffer bound\n", batch_num, img_num);
+        SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+        stats_.process_count++;
+        stats_.failed_count++;
+        WriteTrace(srcImage, rois, img_num, 0, start_ns, 0, 0, 0);
+        return 0;
+    }
+    ApplyOutputBinding(checked, img_num);
+    if (batch_num < img_num)
+    {
+        // batch index i writes the slot of the image it came from, the slots of the left out images are not touched
+        for (int pos = 0; pos < batch_num; ++pos)
+        {
+            acldvppSetPicDescData(acldvppGetPicDesc(g_vpcBatchOutputDesc_, pos), OutputSlot(batch_sources_[pos]));
+        }
+        output_descs_remapped_ = true;
+    }
+    const DVPPImageData* images = batch_images_.data();
+    const RectInt* crops = rois ? batch_rois_.data() : nullptr;
+
+    int max_passes = PlanCascades(images, crops, batch_num);
+    if (max_passes > 1 && async)
+    {
+        // the intermediate passes are synchronized one by one
+        AIALG_ERROR("ProcessAsync does not support images that need a cascade, use Process\n");
+        max_passes = 0;
+    }
+    if (max_passes > 1 && 1 != RunCascadePasses(images, batch_num, max_passes))
+    {
+        max_passes = 0;
+    }
+    int setup_ret = 0;
+    if (max_passes > 1)
+    {
+        // final pass from the last intermediates into the paste area of the original crops
+        setup_ret = ProcessSubImage(cascade_images_.data(), cascade_rois_.data(), batch_num);
+    }
+    else if (1 == max_passes && !rois)
+    {
+        setup_ret = ProcessFullImage(images, batch_num);
+    }
+    else if (1 == max_passes)
+    {
+        setup_ret = ProcessSubImage(images, cascade_crops_.data(), batch_num);
+    }
+    if (1 != setup_ret)
+    {
+        SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+        stats_.process_count++;
+        stats_.failed_count++;
+        WriteTrace(srcImage, rois, img_num, 0, start_ns, (SteadyNowNs() - start_ns) / 1000, 0, 0);
+        return 0;
+    }
+    uint64_t setup_ns = SteadyNowNs();
+    DvppTimeline::Record("dvpp_resize", "setup", start_ns, setup_ns, batch_num);
+
+    stats_.process_count++;
     aclError ret = aclrtSetCurrentContext(dvppResizeInitConfig_.context);
     if (ret != ACL_SUCCESS)
     {
         AIALG_ERROR("set current context failed, aclRet is %d\n", ret);
+        SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+        stats_.failed_count++;
+        WriteTrace(srcImage, rois, img_num, 0, start_ns, (setup_ns - start_ns) / 1000, 0, 0);
         return 0;
     }
-    aclError aclRet = acldvppVpcBatchCropResizePasteAsync(g_dvppChannelDesc_, g_vpcBatchInputDesc_,
-                                                          g_roiNums_.data(), dvppResizeInitConfig_.batch_size,
-                                                          g_vpcBatchOutputDesc_, g_cropArea_.data(), g_pasteArea_.data(),
-                                                          g_resizeConfig_, dvppResizeInitConfig_.stream);
+    if (async)
+    {
+        DvppStream* stream = Stream();
+        if (queued_event_ && queued_stream_ != stream)
+        {
+            ReleaseQueuedEvent();
+        }
+        if (!queued_event_)
+        {
+            queued_event_ = stream->CreateEvent();
+            queued_stream_ = queued_event_ ? stream : nullptr;
+        }
+        // the launch may run later(HostEmulatedStream), the descriptors stay untouched until queued_event_
+        bool queued = queued_event_ && (!async->wait_event || 1 == stream->WaitEvent(async->wait_event)) &&
+                      1 == stream->Launch([this, batch_num](aclrtStream vpc_stream) {
+                          aclError fillRet = FillBorders(batch_num, vpc_stream);
+                          if (fillRet != ACL_SUCCESS)
+                          {
+                              return fillRet;
+                          }
+                          return acldvppVpcBatchCropResizePasteAsync(g_dvppChannelDesc_, g_vpcBatchInputDesc_,
+                                                                     g_roiNums_.data(), batch_num, g_vpcBatchOutputDesc_,
+                                                                     g_cropArea_.data(), g_pasteArea_.data(),
+                                                                     g_resizeConfig_, vpc_stream);
+                      }) &&
+                      1 == stream->RecordEvent(queued_event_) &&
+                      (!async->done_event || 1 == stream->RecordEvent(async->done_event)) &&
+                      (!async->callback || 1 == stream->LaunchCallback(async->callback, async->user_data));
+        batch_queued_ = queued;
+        uint64_t launch_ns = SteadyNowNs();
+        DvppTimeline::Record("dvpp_resize", "vpc_launch", setup_ns, launch_ns, batch_num);
+        stats_.setup_us += (setup_ns - start_ns) / 1000;
+        stats_.launch_us += (launch_ns - setup_ns) / 1000;
+        if (!queued)
+        {
+            AIALG_ERROR("queue the batch on the stream failed\n");
+            // whatever part of it was queued must be done before the descriptors change again
+            stream->Synchronize();
+            SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+            stats_.failed_count++;
+            WriteTrace(srcImage, rois, img_num, 0, start_ns, (setup_ns - start_ns) / 1000, (launch_ns - setup_ns) / 1000, 0);
+            return 0;
+        }
+        stats_.async_count++;
+        stats_.image_count += batch_num;
+        stats_img_num_ = img_num;
+        std::fill(image_stats_valid_.begin(), image_stats_valid_.begin() + img_num, 0);
+        WriteTrace(srcImage, rois, img_num, 1, start_ns, (setup_ns - start_ns) / 1000, (launch_ns - setup_ns) / 1000, 0);
+        return 1;
+    }
+    aclError aclRet = FillBorders(batch_num, dvppResizeInitConfig_.stream);
+    if (aclRet == ACL_SUCCESS)
+    {
+        aclRet = acldvppVpcBatchCropResizePasteAsync(g_dvppChannelDesc_, g_vpcBatchInputDesc_,
+                                                     g_roiNums_.data(), batch_num,
+                                                     g_vpcBatchOutputDesc_, g_cropArea_.data(), g_pasteArea_.data(),
+                                                     g_resizeConfig_, dvppResizeInitConfig_.stream);
+    }
+    uint64_t launch_ns = SteadyNowNs();
+    DvppTimeline::Record("dvpp_resize", "vpc_launch", setup_ns, launch_ns, batch_num);
     if (aclRet != ACL_SUCCESS)
     {
         AIALG_ERROR("acldvppVpcResizeAsync failed, aclRet = %d\n", aclRet);
+        SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+        stats_.failed_count++;
+        WriteTrace(srcImage, rois, img_num, 0, start_ns, (setup_ns - start_ns) / 1000, (launch_ns - setup_ns) / 1000, 0);
         return 0;
     }
 
     aclRet = aclrtSynchronizeStream(dvppResizeInitConfig_.stream);
+    uint64_t sync_ns = SteadyNowNs();
+    DvppTimeline::Record("dvpp_resize", "vpc_sync", launch_ns, sync_ns, batch_num);
+    stats_.setup_us += (setup_ns - start_ns) / 1000;
+    stats_.launch_us += (launch_ns - setup_ns) / 1000;
+    stats_.sync_us += (sync_ns - launch_ns) / 1000;
     if (aclRet != ACL_SUCCESS)
     {
         AIALG_ERROR("resize aclrtSynchronizeStream failed, aclRet = %d\n", aclRet);
+        SetBatchStatus(DVPP_IMAGE_BATCH_FAILED);
+        stats_.failed_count++;
+        WriteTrace(srcImage, rois, img_num, 0, start_ns, (setup_ns - start_ns) / 1000, (launch_ns - setup_ns) / 1000, (sync_ns - launch_ns) / 1000);
         return 0;
     }
+    stats_.image_count += batch_num;
+    stats_img_num_ = img_num;
+    std::fill(image_stats_valid_.begin(), image_stats_valid_.begin() + img_num, 0);
+    WriteTrace(srcImage, rois, img_num, 1, start_ns, (setup_ns - start_ns) / 1000, (launch_ns - setup_ns) / 1000, (sync_ns - launch_ns) / 1000);
     return 1;
 }
 
@@ -453,18 +1332,29 @@ int DvppResize::Get(DVPPImageData &resizedImage, int index) const
 {
     resizedImage.width = dvppResizeInitConfig_.resized_width;
     resizedImage.height = dvppResizeInitConfig_.resized_height;
-    resizedImage.alignWidth = ALIGN_UP16(dvppResizeInitConfig_.resized_width) * 3;
-    resizedImage.alignHeight = ALIGN_UP2(dvppResizeInitConfig_.resized_height);
-    resizedImage.size = g_vpcOutBufferSize_;
-    resizedImage.data = reinterpret_cast<uint8_t*>(g_vpcBatchOutBufferDev_) + index * g_vpcOutBufferSize_;
+    resizedImage.alignWidth = current_output_.width_stride;
+    resizedImage.alignHeight = current_output_.height_stride;
+    resizedImage.size = current_output_.width_stride * current_output_.height_stride;
+    resizedImage.data = OutputSlot(index);
     return 1;
 }
 
 int DvppResize::GetHostData(DVPPImageData &resizedImage, int index)
 {
+    uint32_t slot_size = current_output_.width_stride * current_output_.height_stride;
+    if (!current_output_.data && !current_output_.slot_data)
+    {
+        AIALG_ERROR("no output buffer bound\n");
+        return -1;
+    }
+    if (out_host_data_.size() < slot_size)
+    {
+        out_host_data_.resize(slot_size);
+    }
     // copy data from device to host
-    aclError aclRet = aclrtMemcpy(out_host_data_.data(), g_vpcOutBufferSize_,
-                                  reinterpret_cast<uint8_t*>(g_vpcBatchOutBufferDev_) + index * g_vpcOutBufferSize_, g_vpcOutBufferSize_,
+    DVPP_TIMELINE_SCOPE("dvpp_resize", "readback", index);
+    aclError aclRet = aclrtMemcpy(out_host_data_.data(), slot_size,
+                                  OutputSlot(index), slot_size,
                                   ACL_MEMCPY_DEVICE_TO_HOST);
     if (aclRet != ACL_SUCCESS)
     {
@@ -473,14 +1363,108 @@ int DvppResize::GetHostData(DVPPImageData &resizedImage, int index)
     }
     resizedImage.width = dvppResizeInitConfig_.resized_width;
     resizedImage.height = dvppResizeInitConfig_.resized_height;
-    resizedImage.alignWidth = ALIGN_UP16(dvppResizeInitConfig_.resized_width) * 3;
-    resizedImage.alignHeight = ALIGN_UP2(dvppResizeInitConfig_.resized_height);
-    resizedImage.size = g_vpcOutBufferSize_;
+    resizedImage.alignWidth = current_output_.width_stride;
+    resizedImage.alignHeight = current_output_.height_stride;
+    resizedImage.size = slot_size;
     resizedImage.data = out_host_data_.data();
+    if (dvppResizeInitConfig_.compute_stats && index >= 0 && index < stats_img_num_ && batch_positions_[index] >= 0)
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_resize", "image_stats", index);
+        image_stats_valid_[index] = ComputeImageStats(out_host_data_.data(), current_output_.width_stride,
+                                                      paste_rects_[batch_positions_[index]], image_stats_[index]);
+    }
+    return 1;
+}
+
+int DvppResize::GetImageStats(DVPPImageStats &stats, int index)
+{
+    if (!dvppResizeInitConfig_.compute_stats || index < 0 || index >= stats_img_num_ || batch_positions_[index] < 0)
+    {
+        AIALG_ERROR("no statistics of image %d, compute_stats = %d\n", index, dvppResizeInitConfig_.compute_stats);
+        return 0;
+    }
+    DVPPImageData host_image;
+    if (!image_stats_valid_[index] && (1 != GetHostData(host_image, index) || !image_stats_valid_[index]))
+    {
+        return 0;
+    }
+    stats = image_stats_[index];
     return 1;
 }
 
 const uint8_t* DvppResize::GetOutputDevicePtr() const
 {
-    return static_cast<const uint8_t*>(g_vpcBatchOutBufferDev_);
+    return current_output_.data;
+}
+
+int DvppResize::EnableTrace(const std::string &trace_path)
+{
+    DVPPTraceHeader header = {};
+    header.input_format = dvppResizeInitConfig_.input_format;
+    header.batch_size = dvppResizeInitConfig_.batch_size;
+    header.resized_width = dvppResizeInitConfig_.resized_width;
+    header.resized_height = dvppResizeInitConfig_.resized_height;
+    header.is_fix_scale_resize = dvppResizeInitConfig_.is_fix_scale_resize;
+    header.is_symmetry_padding = dvppResizeInitConfig_.is_symmetry_padding;
+    header.resize_scale_factor = dvppResizeInitConfig_.resize_scale_factor;
+    header.interpolation = dvppResizeInitConfig_.interpolation;
+    header.max_pass_upscale = dvppResizeInitConfig_.max_pass_upscale;
+    header.max_pass_downscale = dvppResizeInitConfig_.max_pass_downscale;
+    header.compute_stats = dvppResizeInitConfig_.compute_stats;
+    header.border_value = dvppResizeInitConfig_.border_value;
+    header.drop_bad_images = dvppResizeInitConfig_.drop_bad_images;
+
+    std::unique_ptr<DvppTraceWriter> writer(new DvppTraceWriter());
+    if (1 != writer->Open(trace_path, header))
+    {
+        return 0;
+    }
+    trace_writer_ = std::move(writer);
+    trace_start_ns_ = 0;
+    return 1;
+}
+
+void DvppResize::DisableTrace()
+{
+    trace_writer_.reset();
+}
+
+void DvppResize::WriteTrace(const DVPPImageData *srcImage, const RectInt *rois, int img_num, int status,
+                            uint64_t start_ns, uint32_t setup_us, uint32_t launch_us, uint32_t sync_us)
+{
+    if (!trace_writer_ || img_num <= 0)
+    {
+        return;
+    }
+    if (0 == trace_start_ns_)
+    {
+        trace_start_ns_ = start_ns;
+    }
+    DVPPTraceRecord record;
+    record.timestamp_ns = start_ns - trace_start_ns_;
+    record.img_num = img_num;
+    record.has_rois = rois ? 1 : 0;
+    record.status = status;
+    record.setup_us = setup_us;
+    record.launch_us = launch_us;
+    record.sync_us = sync_us;
+
+    std::vector<DVPPTraceImage>& images = trace_images_;
+    images.resize(img_num);
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        images[idx].width = srcImage[idx].width;
+        images[idx].height = srcImage[idx].height;
+        images[idx].align_width = srcImage[idx].alignWidth;
+        images[idx].align_height = srcImage[idx].alignHeight;
+        images[idx].xmin = rois ? rois[idx].xmin : 0;
+        images[idx].ymin = rois ? rois[idx].ymin : 0;
+        images[idx].xmax = rois ? rois[idx].xmax : static_cast<int32_t>(srcImage[idx].width) - 1;
+        images[idx].ymax = rois ? rois[idx].ymax : static_cast<int32_t>(srcImage[idx].height) - 1;
+    }
+    if (1 != trace_writer_->Write(record, images.data()))
+    {
+        AIALG_ERROR("write trace record failed, trace disabled\n");
+        trace_writer_.reset();
+    }
 }
\ No newline at end of file
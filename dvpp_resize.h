@@ -18,10 +18,16 @@
 #define _PICTURE_INC_DVPP_RESIZE_H
 
 #include <vector>
+#include <string>
+#include <memory>
 #include <cstdint>
 #include "acl/acl.h"
 #include "acl/ops/acl_dvpp.h"
 #include "data_type.h"
+#include "dvpp_trace.h"
+#include "dvpp_timeline.h"
+#include "image_stats.h"
+#include "dvpp_stream.h"
 
 #define RGBU8_IMAGE_SIZE(width, height) ((width) * (height) * 3)
 #define YUV420SP_SIZE(width, height) ((width) * (height) * 3 / 2)
@@ -51,9 +57,135 @@ typedef struct{
     uint32_t is_fix_scale_resize = 1;  //yolov6 && rtmpose: 1
     uint32_t is_symmetry_padding = 1;  //rtmpose: 1
     float resize_scale_factor = 1.0f; //rtmpose: 1.25f
+    uint32_t use_external_output = 0;  // 1: output memory is always bound by caller, never acldvppMalloc
+    uint32_t interpolation = 2;        // acldvppSetResizeConfigInterpolation, 0/1: bilinear, 2: nearest
+    uint32_t max_pass_upscale = 16;    // largest upscale of one vpc pass, larger ratios are cascaded, 0: no limit
+    uint32_t max_pass_downscale = 32;  // largest downscale of one vpc pass, larger ratios are cascaded, 0: no limit
+    uint32_t compute_stats = 0;        // 1: DVPPImageStats of the paste area of every output, see GetImageStats
+    uint32_t border_value = 0;         // byte filling the output slot of a roi that extends past its image
+    const char* tune_profile = nullptr;  // profile of DvppAutotune, batch_size = 0 takes the tuned batch size of this geometry
+    uint32_t tune_src_width = 0;         // source size looked up in tune_profile, 0: any
+    uint32_t tune_src_height = 0;
+    uint32_t drop_bad_images = 0;        // 1: images failing CheckDvppImage are left out and the rest of the batch is
+                                         // resized in the same launch(GetImageStatus), 0: one bad image fails the call
     char reserve[8];
 }DVPPResizeInitConfig;
 
+// start address and slot offset alignment(bytes) of a bound output buffer
+#define DVPP_OUTPUT_ADDR_ALIGN 16
+
+/**
+* @brief caller owned vpc output(BGR_888), slot i starts at data + i * slot_offset,
+*        e.g. contiguous NHWC tensor(w a multiple of 16, h even): width_stride = w * 3, height_stride = h,
+*        slot_offset = w * 3 * h, any other w needs a padded row of width_stride = ALIGN_UP16(w) * 3
+*/
+typedef struct{
+    uint8_t* data = nullptr;     // device memory accessible by dvpp, e.g. acldvppMalloc'ed model input
+    uint64_t size = 0;           // bytes available from data
+    uint32_t width_stride = 0;   // bytes per row, multiple of 48, 0: ALIGN_UP16(resized_width) * 3
+    uint32_t height_stride = 0;  // rows per slot, even, 0: ALIGN_UP2(resized_height)
+    uint64_t slot_offset = 0;    // bytes between two slots, 0: width_stride * height_stride
+    uint8_t* const* slot_data = nullptr;  // Process only: start of every slot, data and slot_offset are
+                                          // ignored and size is the bytes of one slot
+}DVPPOutputBinding;
+
+typedef struct{
+    uint64_t process_count = 0;
+    uint64_t failed_count = 0;
+    uint64_t image_count = 0;
+    uint64_t setup_us = 0;   // roi && pic desc update
+    uint64_t launch_us = 0;  // acldvppVpcBatchCropResizePasteAsync
+    uint64_t sync_us = 0;    // aclrtSynchronizeStream
+    uint64_t cascade_image_count = 0;  // images resized by more than one pass
+    uint64_t cascade_pass_count = 0;   // intermediate passes of those images
+    uint64_t async_count = 0;          // batches queued by ProcessAsync, no host sync
+    uint64_t dropped_count = 0;        // images left out of their batch, see GetImageStatus
+}DVPPResizeStats;
+
+/**
+* @brief stream ordering of one ProcessAsync, the events belong to the DvppStream of the resize
+*/
+typedef struct{
+    void* wait_event = nullptr;             // the vpc starts after it, e.g. recorded once the inputs are decoded/uploaded
+    void* done_event = nullptr;             // recorded after the batch, e.g. waited for by the inference stream
+    DvppStreamCallback callback = nullptr;  // runs on a host thread after the batch
+    void* user_data = nullptr;
+}DVPPAsyncParam;
+
+// sides of cascade intermediates never go below this, multiple of 16
+#define DVPP_CASCADE_MIN_SIDE 16
+#define DVPP_CASCADE_MAX_PASSES 8
+
+// vpc input picture and crop limits, start address alignment(bytes) of an input
+#define DVPP_INPUT_MIN_WIDTH 10
+#define DVPP_INPUT_MIN_HEIGHT 6
+#define DVPP_INPUT_MAX_SIDE 8192
+#define DVPP_INPUT_ADDR_ALIGN 16
+
+/**
+* @brief result of one image of the last Process/ProcessAsync, see CheckDvppImage and GetImageStatus
+*/
+enum DvppImageStatus {
+    DVPP_IMAGE_OK = 0,
+    DVPP_IMAGE_BAD_DATA,        // data is nullptr
+    DVPP_IMAGE_BAD_ALIGN,       // data is not aligned to DVPP_INPUT_ADDR_ALIGN
+    DVPP_IMAGE_BAD_SIZE,        // width/height outside [DVPP_INPUT_MIN_WIDTH/HEIGHT, DVPP_INPUT_MAX_SIDE]
+    DVPP_IMAGE_BAD_STRIDE,      // alignWidth/alignHeight can not be a vpc stride or size is below the strided buffer
+    DVPP_IMAGE_BAD_ROI,         // roi is degenerate, outside the image or its crop is below the vpc minimum
+    DVPP_IMAGE_BAD_RATIO,       // needs more than DVPP_CASCADE_MAX_PASSES passes
+    DVPP_IMAGE_SETUP_FAILED,    // no roi config could be created for its batch index
+    DVPP_IMAGE_BATCH_FAILED,    // valid, but the call or the vpc batch failed
+};
+
+/**
+* @brief vpc input width/height stride(bytes) and buffer size of image, image.alignWidth/alignHeight
+*        are used when they are larger than the minimal alignment, e.g. 64*16 aligned yuv from JPEGD
+*/
+void GetDvppInputStride(uint32_t input_format, const DVPPImageData& image,
+                        uint32_t& width_stride, uint32_t& height_stride, uint32_t& buffer_size);
+
+/**
+* @brief compute the paste area of a src_width x src_height image(or roi) in the resized image,
+*        left is aligned to 16, right and bottom are odd as vpc required
+*/
+void GetDvppPasteArea(const DVPPResizeInitConfig& config, int src_width, int src_height,
+                      int& left, int& right, int& top, int& bottom);
+
+/**
+* @brief crop and paste area of a roi that may extend past its image_width x image_height image: the whole roi is
+*        mapped to the paste area of GetDvppPasteArea, only the part inside the image is cropped and it is pasted at
+*        its own offset in that area, the rest of the output is left to the border fill. On a clipped side the paste
+*        start is aligned to 16(x) / 2(y) and the even crop start is the source pixel nearest to it, so the scale of
+*        the whole roi is kept to within one source pixel, a roi inside the image gets the areas it always had
+* @return 1 success, 0 roi does not overlap the image or its part inside is too small
+*/
+int GetDvppRoiArea(const DVPPResizeInitConfig& config, int image_width, int image_height, const RectInt& roi,
+                   RectInt& crop, RectInt& paste);
+
+/**
+* @brief plan the passes of crop_width x crop_height -> paste_width x paste_height so that no pass exceeds
+*        max_pass_upscale/max_pass_downscale of config, the intermediates follow geometric steps
+* @param [out] sizes: width/height of the passes - 1 intermediates, even(16 aligned width for BGR_888 input)
+* @return passes, 1: one pass is enough, 0: no plan within DVPP_CASCADE_MAX_PASSES
+*/
+int PlanDvppCascade(const DVPPResizeInitConfig& config, int crop_width, int crop_height,
+                    int paste_width, int paste_height, std::vector<std::pair<int, int> >& sizes);
+
+/**
+* @brief the checks Process runs on every image before anything is set up: data and its alignment, size, strides
+*        against size, roi(GetDvppRoiArea) and the cascade plan
+* @param [in] roi: nullptr checks the full image
+* @return DvppImageStatus, DVPP_IMAGE_OK if the vpc can take the image
+*/
+int CheckDvppImage(const DVPPResizeInitConfig& config, const DVPPImageData& image, const RectInt* roi);
+
+/**
+* @brief batch_size = 0 with tune_profile: write the tuned batch size of this geometry into config, every wrapper
+*        taking a DVPPResizeInitConfig resolves its copy with this before it sizes anything by batch_size
+* @return 1 batch_size > 0, 0 batch_size is 0 and tune_profile has no entry for this geometry
+*/
+int ResolveDvppBatchSize(DVPPResizeInitConfig& config);
+
 class DvppResize {
 public:
     /**
@@ -70,38 +202,200 @@ public:
     ~DvppResize();
 
     /**
-    * @brief dvpp process
-    * @return result
+    * @brief dvpp process, img_num <= batch_size, a partial batch uses the first img_num output slots,
+    *        every image is checked(CheckDvppImage) before any descriptor is touched, with drop_bad_images the bad
+    *        ones are left out(their slots are not written) and the others still go through one launch
+    * @return 1 success(drop_bad_images: at least one image resized), 0 failed, see GetImageStatus
     */
     int Process(const DVPPImageData* srcImage, const  RectInt* rois, int img_num);
 
+    /**
+    * @brief dvpp process into output of this call only, output == nullptr uses the BindOutput buffer
+    * @return 1 success, 0 failed
+    */
+    int Process(const DVPPImageData* srcImage, const  RectInt* rois, int img_num, const DVPPOutputBinding* output);
+
+    /**
+    * @brief write all following batches into caller owned memory, nullptr restores the internal buffer
+    * @param [in] output: checked against alignment, stride and batch_size slots
+    * @return 1 success, 0 failed(binding is unchanged)
+    */
+    int BindOutput(const DVPPOutputBinding* output);
+
+    /**
+    * @brief queue the batch on the stream and return without aclrtSynchronizeStream: the vpc waits for
+    *        async.wait_event, then async.done_event is recorded and async.callback is launched, work queued
+    *        on the same stream afterwards(e.g. aclmdlExecuteAsync) runs after the resize, the outputs and
+    *        GetHostData/GetImageStats are valid once the batch completed, images needing a cascade are refused,
+    *        one batch is queued at a time: the descriptors are shared, so the next Process/ProcessAsync first
+    *        waits for the last queued batch(use two instances to keep two batches in flight)
+    * @param [in] output: as Process, nullptr uses the BindOutput buffer
+    * @return 1 queued, 0 failed
+    */
+    int ProcessAsync(const DVPPImageData* srcImage, const RectInt* rois, int img_num, const DVPPAsyncParam& async,
+                     const DVPPOutputBinding* output = nullptr);
+
+    /**
+    * @brief stream of ProcessAsync, nullptr restores the AclDvppStream of the init config stream,
+    *        e.g. a HostEmulatedStream to check event and callback ordering without a device,
+    *        waits for the batch queued on the last stream first
+    */
+    void SetStream(DvppStream* stream);
+
+    /**
+    * @brief stream used by ProcessAsync, create the events of DVPPAsyncParam on it
+    */
+    inline DvppStream* Stream() const
+    {
+        return stream_ ? stream_ : default_stream_.get();
+    }
+
     int Get(DVPPImageData& resizedImage, int index) const;
 
     int GetHostData(DVPPImageData& resizedImage, int index);
 
+    /**
+    * @brief DvppImageStatus of image index of the last Process/ProcessAsync
+    * @return the status, -1 index out of the last call
+    */
+    int GetImageStatus(int index) const;
+
+    /**
+    * @brief statistics of the paste area of output index of the last Process(compute_stats = 1), the vpc
+    *        can not produce them, so they come from the host copy: computed by GetHostData while the copy
+    *        is cache hot, or read back here if GetHostData was not called for index
+    * @return 1 success, 0 compute_stats is off, index out of the last batch or read back failed
+    */
+    int GetImageStats(DVPPImageStats& stats, int index);
+
     inline bool HasInit() const
     {
         return has_init_over_;
     }
 
+    /**
+    * @brief source crop and output paste area of image index of the last Process, detections in the output map back
+    *        by x_src = crop.xmin + (x - paste.xmin) * crop.width / paste.width, exact also for rois past the image edge
+    * @return 1 success, 0 index out of the last batch
+    */
+    int GetRoiArea(int index, RectInt& crop, RectInt& paste) const;
+
+    /**
+    * @brief batch size of Init, the tuned one if it came from tune_profile
+    */
+    inline uint32_t GetBatchSize() const
+    {
+        return dvppResizeInitConfig_.batch_size;
+    }
+
     const uint8_t* GetOutputDevicePtr() const;
 
+    /**
+    * @brief record geometry, rois and stage latencies(no pixel data) of every Process call
+    * @param [in] trace_path: binary trace file, replay it by dvpp_trace_replay
+    * @return 1 success, 0 failed
+    */
+    int EnableTrace(const std::string& trace_path);
+
+    void DisableTrace();
+
+    inline const DVPPResizeStats& GetStats() const
+    {
+        return stats_;
+    }
+
     void DestroyResource();
 
 private:
+    int Submit(const DVPPImageData* srcImage, const RectInt* rois, int img_num, const DVPPOutputBinding* output,
+               const DVPPAsyncParam* async);
+
     int InitResizeInputDesc(const DVPPImageData& inputImage, int index);
 
     int InitResizeOutputDesc();
 
-    void ProcessFullImage(const DVPPImageData* srcImage, int img_num);
+    int CheckOutputBinding(const DVPPOutputBinding& output, int slot_num, DVPPOutputBinding& checked) const;
 
-    void ProcessSubImage(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+    void ApplyOutputBinding(const DVPPOutputBinding& output, int slot_num);
+
+    /**
+    * @brief block until the batch queued by the last ProcessAsync completed
+    * @return 1 success or none queued, 0 waiting failed
+    */
+    int WaitQueuedBatch();
+
+    /**
+    * @brief wait for the queued batch and destroy its event, before the stream that owns it goes away
+    */
+    void ReleaseQueuedEvent();
+
+    inline uint8_t* OutputSlot(int index) const
+    {
+        return current_output_.slot_data ? current_output_.slot_data[index] :
+               current_output_.data + index * current_output_.slot_offset;
+    }
+
+    /**
+    * @brief check every image, and compact the good ones into batch_images_/batch_rois_
+    * @return images left in the batch
+    */
+    int CompactBatch(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief status of every image still in the batch
+    */
+    void SetBatchStatus(int status);
+
+    /**
+    * @brief create the missing roi configs of the first img_num batch indexes, so that the setup below only
+    *        updates them in place and can not fail half way
+    * @return batch indexes that have their roi configs
+    */
+    int ReserveRoiConfigs(int img_num);
+
+    /**
+    * @return 1 success, 0 failed(the cached size of the failed batch index is reset)
+    */
+    int ProcessFullImage(const DVPPImageData* srcImage, int img_num);
+
+    /**
+    * @param [in] crops: even crop of every image, pasted to paste_rects_
+    * @return 1 success, 0 failed
+    */
+    int ProcessSubImage(const DVPPImageData* srcImage, const RectInt* crops, int img_num);
+
+    /**
+    * @brief queue the border fill of the output slots whose roi extends past the image, before the vpc
+    * @return ACL_SUCCESS or the error of aclrtMemsetAsync
+    */
+    aclError FillBorders(int img_num, aclrtStream stream);
+
+    /**
+    * @brief crop and paste area(GetDvppRoiArea) and passes of every image of the call
+    * @return max passes over the images, 0 failed
+    */
+    int PlanCascades(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief run all intermediate passes, the i-th pass of every image goes into one vpc batch, and fill
+    *        cascade_images_/cascade_rois_ as input of the final pass
+    */
+    int RunCascadePasses(const DVPPImageData* srcImage, int img_num, int max_passes);
+
+    int ReserveCascadeBuffer(int buffer, int index, uint32_t size);
+
+    void DestroyCascade();
+
+    void WriteTrace(const DVPPImageData* srcImage, const RectInt* rois, int img_num, int status,
+                    uint64_t start_ns, uint32_t setup_us, uint32_t launch_us, uint32_t sync_us);
 
 private:
     DVPPResizeInitConfig dvppResizeInitConfig_;
 
     std::vector<uint32_t> src_widths_;
     std::vector<uint32_t> src_heights_;
+    std::vector<uint32_t> src_align_widths_;
+    std::vector<uint32_t> src_align_heights_;
 
     acldvppChannelDesc *g_dvppChannelDesc_;
     acldvppResizeConfig *g_resizeConfig_;
@@ -109,8 +403,12 @@ private:
     acldvppBatchPicDesc *g_vpcBatchInputDesc_; // vpc input desc
     acldvppBatchPicDesc *g_vpcBatchOutputDesc_; // vpc output desc
 
-    void* g_vpcBatchOutBufferDev_;  // input pic dev buffer
-    uint32_t g_vpcOutBufferSize_;  // vpc output size
+    void* g_vpcBatchOutBufferDev_;  // self allocated output buffer, nullptr if use_external_output
+    uint32_t g_vpcOutBufferSize_;  // vpc output size of one slot
+
+    DVPPOutputBinding bound_output_;    // used when Process gets no output
+    DVPPOutputBinding current_output_;  // written by the last Process, read by Get/GetHostData
+    std::vector<uint8_t*> current_slots_;  // copy of slot_data of the last Process
 
     acldvppPixelFormat g_format_;
     bool has_init_over_;
@@ -119,8 +417,48 @@ private:
     std::vector<acldvppRoiConfig*> g_cropArea_;
     std::vector<acldvppRoiConfig*> g_pasteArea_;
 
+    // cascade of out of range scale ratios, created on first use
+    acldvppBatchPicDesc* cascade_input_desc_;
+    acldvppBatchPicDesc* cascade_output_desc_;
+    std::vector<acldvppRoiConfig*> cascade_crop_area_;
+    std::vector<acldvppRoiConfig*> cascade_paste_area_;
+    std::vector<void*> cascade_buffers_[2];  // ping-pong intermediates of every batch index, grown on demand
+    std::vector<uint32_t> cascade_buffer_sizes_[2];
+    std::vector<int> cascade_passes_;        // passes of every image of the current call
+    std::vector<std::vector<std::pair<int, int> > > cascade_sizes_;
+    std::vector<RectInt> cascade_crops_;     // even aligned crop of the first pass, inside the image
+    std::vector<DVPPImageData> cascade_images_;
+    std::vector<RectInt> cascade_rois_;
+    std::vector<uint8_t> fill_borders_;      // roi of the image extends past it
+
     // copy data from device to host
     std::vector<uint8_t> out_host_data_;
+
+    // images of the call that passed CheckDvppImage, batch index -> index of the call and back(-1: left out)
+    std::vector<DVPPImageData> batch_images_;
+    std::vector<RectInt> batch_rois_;
+    std::vector<int> batch_sources_;
+    std::vector<int> batch_positions_;
+    std::vector<int> image_status_;
+    int status_img_num_;
+    bool output_descs_remapped_;  // output descs of the last batch point to the slots of its sources
+
+    // paste area of every batch index, kept with g_pasteArea_, and statistics of the last batch
+    std::vector<RectInt> paste_rects_;
+    std::vector<DVPPImageStats> image_stats_;
+    std::vector<uint8_t> image_stats_valid_;
+    int stats_img_num_;
+
+    DvppStream* stream_;
+    std::unique_ptr<AclDvppStream> default_stream_;
+    void* queued_event_;            // recorded after the last ProcessAsync batch, on queued_stream_
+    DvppStream* queued_stream_;
+    bool batch_queued_;             // the descriptors are in use by a batch not waited for yet
+
+    DVPPResizeStats stats_;
+    std::unique_ptr<DvppTraceWriter> trace_writer_;
+    std::vector<DVPPTraceImage> trace_images_;
+    uint64_t trace_start_ns_;
 };
 
 #endif // _PICTURE_INC_DVPP_RESIZE_H
\ No newline at end of file
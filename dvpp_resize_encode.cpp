@@ -0,0 +1,524 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <algorithm>
+#include "opencv2/opencv.hpp"
+#include "dvpp_resize_encode.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// write width x height into the SOF segment of a baseline/progressive jpeg, 1 success, 0 no SOF found
+static int SetJpegSize(std::vector<uint8_t>& jpeg, uint32_t width, uint32_t height)
+{
+    size_t pos = 2;  // after SOI
+    while (pos + 4 <= jpeg.size() && 0xFF == jpeg[pos])
+    {
+        uint8_t marker = jpeg[pos + 1];
+        size_t length = (static_cast<size_t>(jpeg[pos + 2]) << 8) | jpeg[pos + 3];
+        if (marker >= 0xC0 && marker <= 0xC3)
+        {
+            if (pos + 9 > jpeg.size())
+            {
+                return 0;
+            }
+            jpeg[pos + 5] = static_cast<uint8_t>(height >> 8);
+            jpeg[pos + 6] = static_cast<uint8_t>(height & 0xFF);
+            jpeg[pos + 7] = static_cast<uint8_t>(width >> 8);
+            jpeg[pos + 8] = static_cast<uint8_t>(width & 0xFF);
+            return 1;
+        }
+        if (0xDA == marker)
+        {
+            return 0;
+        }
+        pos += 2 + length;
+    }
+    return 0;
+}
+
+DvppResizeEncode::DvppResizeEncode()
+        : pool_(nullptr), channel_desc_(nullptr), convert_config_(nullptr), full_area_(nullptr), jpege_config_(nullptr),
+          encode_stream_(nullptr), out_width_stride_(0), out_slot_size_(0), nv12_size_(0), jpeg_capacity_(0),
+          stop_(false), process_slot_(0), collect_slot_(0), last_collected_slot_(-1), has_init_over_(false)
+{
+
+}
+
+DvppResizeEncode::~DvppResizeEncode()
+{
+    DestroyResource();
+}
+
+void DvppResizeEncode::Init(const DVPPResizeEncodeConfig *config, WorkerPool *pool)
+{
+    config_ = *config;
+    config_.resize_config.use_external_output = 1;
+    config_.quality = std::min(std::max(config_.quality, 1u), 100u);
+    pool_ = pool;
+    // the output and jpeg slots are sized by batch_size, a tuned one(tune_profile) is resolved here
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+
+    resize_.Init(&config_.resize_config);
+    if (!resize_.HasInit())
+    {
+        AIALG_ERROR("DvppResize init failed\n");
+        return;
+    }
+    aclError ret = aclrtSetCurrentContext(config_.resize_config.context);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", ret);
+        return;
+    }
+    // encode runs on its own stream so it overlaps with the resize stream
+    ret = aclrtCreateStream(&encode_stream_);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("create encode stream failed, aclRet is %d\n", ret);
+        return;
+    }
+
+    uint32_t width = config_.resize_config.resized_width;
+    uint32_t height = config_.resize_config.resized_height;
+    uint32_t batch_size = config_.resize_config.batch_size;
+    out_width_stride_ = ALIGN_UP16(width) * 3;
+    out_slot_size_ = out_width_stride_ * ALIGN_UP2(height);
+    // JPEGE input is nv12 of even size, an odd thumbnail is padded into its slot(stride and rows allow it)
+    uint32_t even_width = ALIGN_UP2(width);
+    uint32_t even_height = ALIGN_UP2(height);
+    nv12_size_ = YUV420SP_SIZE(ALIGN_UP16(width), ALIGN_UP2(height));
+    if (config_.use_jpege && (even_width < 2 || even_height < 2))
+    {
+        config_.use_jpege = 0;
+    }
+    if (config_.use_jpege)
+    {
+        channel_desc_ = acldvppCreateChannelDesc();
+        convert_config_ = acldvppCreateResizeConfig();
+        full_area_ = acldvppCreateRoiConfig(0, even_width - 1, 0, even_height - 1);
+        jpege_config_ = acldvppCreateJpegeConfig();
+        if (!channel_desc_ || ACL_SUCCESS != acldvppCreateChannel(channel_desc_) || !convert_config_ || !full_area_ ||
+            !jpege_config_ || ACL_SUCCESS != acldvppSetJpegeConfigLevel(jpege_config_, config_.quality))
+        {
+            AIALG_ERROR("create JPEGE channel failed, use host encoder only\n");
+            config_.use_jpege = 0;
+        }
+    }
+
+    for (int s = 0; s < DVPP_ENCODE_SLOT_NUM; ++s)
+    {
+        EncodeSlot& slot = slots_[s];
+        aclError aclRet = acldvppMalloc(&slot.output_dev, static_cast<size_t>(out_slot_size_) * batch_size);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acldvppMalloc output buffer failed, aclRet = %d\n", aclRet);
+            return;
+        }
+        slot.jpegs.resize(batch_size);
+        slot.jpeg_sizes.resize(batch_size, 0);
+        slot.nv12_dev.resize(batch_size, nullptr);
+        slot.jpeg_dev.resize(batch_size, nullptr);
+        slot.bgr_desc.resize(batch_size, nullptr);
+        slot.nv12_desc.resize(batch_size, nullptr);
+        for (uint32_t idx = 0; idx < batch_size && config_.use_jpege; ++idx)
+        {
+            slot.bgr_desc[idx] = acldvppCreatePicDesc();
+            slot.nv12_desc[idx] = acldvppCreatePicDesc();
+            if (!slot.bgr_desc[idx] || !slot.nv12_desc[idx] ||
+                ACL_SUCCESS != acldvppMalloc(&slot.nv12_dev[idx], nv12_size_))
+            {
+                AIALG_ERROR("create JPEGE buffers failed\n");
+                return;
+            }
+            acldvppPicDesc* bgr = slot.bgr_desc[idx];
+            acldvppSetPicDescData(bgr, OutputSlot(slot, idx));
+            acldvppSetPicDescFormat(bgr, PIXEL_FORMAT_BGR_888);
+            acldvppSetPicDescWidth(bgr, even_width);
+            acldvppSetPicDescHeight(bgr, even_height);
+            acldvppSetPicDescWidthStride(bgr, out_width_stride_);
+            acldvppSetPicDescHeightStride(bgr, ALIGN_UP2(height));
+            acldvppSetPicDescSize(bgr, out_slot_size_);
+            acldvppPicDesc* nv12 = slot.nv12_desc[idx];
+            acldvppSetPicDescData(nv12, slot.nv12_dev[idx]);
+            acldvppSetPicDescFormat(nv12, PIXEL_FORMAT_YUV_SEMIPLANAR_420);
+            acldvppSetPicDescWidth(nv12, even_width);
+            acldvppSetPicDescHeight(nv12, even_height);
+            acldvppSetPicDescWidthStride(nv12, ALIGN_UP16(width));
+            acldvppSetPicDescHeightStride(nv12, ALIGN_UP2(height));
+            acldvppSetPicDescSize(nv12, nv12_size_);
+            if (0 == jpeg_capacity_)
+            {
+                // the worst case of the quality, the raw nv12 size if the prediction is unavailable
+                uint32_t predicted = 0;
+                acldvppJpegPredictEncSize(nv12, jpege_config_, &predicted);
+                jpeg_capacity_ = ALIGN_UP128(std::max(predicted, nv12_size_));
+            }
+            if (ACL_SUCCESS != acldvppMalloc(&slot.jpeg_dev[idx], jpeg_capacity_))
+            {
+                AIALG_ERROR("acldvppMalloc JPEGE output failed\n");
+                return;
+            }
+        }
+        slot.busy = false;
+    }
+    process_slot_ = 0;
+    collect_slot_ = 0;
+    last_collected_slot_ = -1;
+    stop_ = false;
+    encode_queue_.clear();
+    encode_thread_ = std::thread(&DvppResizeEncode::EncodeLoop, this);
+    has_init_over_ = true;
+}
+
+void DvppResizeEncode::EncodeLoop()
+{
+    DvppTimeline::SetThreadName("dvpp_encode");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        encode_cv_.wait(lock, [this] { return stop_ || !encode_queue_.empty(); });
+        if (encode_queue_.empty())
+        {
+            return;
+        }
+        EncodeSlot& slot = slots_[encode_queue_.front()];
+        encode_queue_.pop_front();
+        lock.unlock();
+        int result = EncodeBatch(slot);
+        lock.lock();
+        slot.result = result;
+        slot.encoded = true;
+        done_cv_.notify_all();
+    }
+}
+
+void DvppResizeEncode::DestroyResource()
+{
+    if (encode_thread_.joinable())
+    {
+        // the queued batches are encoded before the thread stops
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        encode_cv_.notify_all();
+        encode_thread_.join();
+    }
+    for (int s = 0; s < DVPP_ENCODE_SLOT_NUM; ++s)
+    {
+        EncodeSlot& slot = slots_[s];
+        slot.busy = false;
+        for (size_t idx = 0; idx < slot.nv12_dev.size(); ++idx)
+        {
+            if (slot.nv12_dev[idx])
+            {
+                acldvppFree(slot.nv12_dev[idx]);
+                slot.nv12_dev[idx] = nullptr;
+            }
+            if (slot.jpeg_dev[idx])
+            {
+                acldvppFree(slot.jpeg_dev[idx]);
+                slot.jpeg_dev[idx] = nullptr;
+            }
+            if (slot.bgr_desc[idx])
+            {
+                acldvppDestroyPicDesc(slot.bgr_desc[idx]);
+                slot.bgr_desc[idx] = nullptr;
+            }
+            if (slot.nv12_desc[idx])
+            {
+                acldvppDestroyPicDesc(slot.nv12_desc[idx]);
+                slot.nv12_desc[idx] = nullptr;
+            }
+        }
+        if (slot.output_dev)
+        {
+            acldvppFree(slot.output_dev);
+            slot.output_dev = nullptr;
+        }
+        std::vector<std::vector<uint8_t> >().swap(slot.jpegs);
+        std::vector<uint8_t>().swap(slot.staging);
+    }
+    if (channel_desc_)
+    {
+        aclrtSetCurrentContext(config_.resize_config.context);
+        acldvppDestroyChannel(channel_desc_);
+        acldvppDestroyChannelDesc(channel_desc_);
+        channel_desc_ = nullptr;
+    }
+    if (convert_config_)
+    {
+        acldvppDestroyResizeConfig(convert_config_);
+        convert_config_ = nullptr;
+    }
+    if (full_area_)
+    {
+        acldvppDestroyRoiConfig(full_area_);
+        full_area_ = nullptr;
+    }
+    if (jpege_config_)
+    {
+        acldvppDestroyJpegeConfig(jpege_config_);
+        jpege_config_ = nullptr;
+    }
+    if (encode_stream_)
+    {
+        aclrtDestroyStream(encode_stream_);
+        encode_stream_ = nullptr;
+    }
+    if (resize_.HasInit())
+    {
+        resize_.DestroyResource();
+    }
+    has_init_over_ = false;
+}
+
+aclError DvppResizeEncode::PadToEven(EncodeSlot &slot)
+{
+    uint32_t width = config_.resize_config.resized_width;
+    uint32_t height = config_.resize_config.resized_height;
+    for (int idx = 0; idx < slot.img_num; ++idx)
+    {
+        uint8_t* bgr = OutputSlot(slot, idx);
+        aclError aclRet = ACL_SUCCESS;
+        if (width % 2)
+        {
+            aclRet = aclrtMemcpy2dAsync(bgr + width * 3, out_width_stride_, bgr + (width - 1) * 3, out_width_stride_,
+                                        3, height, ACL_MEMCPY_DEVICE_TO_DEVICE, encode_stream_);
+        }
+        // the last row already has its padded pixel, the corner is repeated too
+        if (aclRet == ACL_SUCCESS && height % 2)
+        {
+            aclRet = aclrtMemcpyAsync(bgr + height * out_width_stride_, out_width_stride_,
+                                      bgr + (height - 1) * out_width_stride_, ALIGN_UP2(width) * 3,
+                                      ACL_MEMCPY_DEVICE_TO_DEVICE, encode_stream_);
+        }
+        if (aclRet != ACL_SUCCESS)
+        {
+            return aclRet;
+        }
+    }
+    return ACL_SUCCESS;
+}
+
+int DvppResizeEncode::EncodeJpege(EncodeSlot &slot)
+{
+    uint32_t width = config_.resize_config.resized_width;
+    uint32_t height = config_.resize_config.resized_height;
+    bool padded = (width % 2) || (height % 2);
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_encode", "jpege_launch", slot.img_num);
+        if (padded && ACL_SUCCESS != PadToEven(slot))
+        {
+            aclrtSynchronizeStream(encode_stream_);
+            return 0;
+        }
+        for (int idx = 0; idx < slot.img_num; ++idx)
+        {
+            // bgr -> nv12 by the vpc at the same size, JPEGE only takes yuv
+            slot.jpeg_sizes[idx] = jpeg_capacity_;
+            if (ACL_SUCCESS != acldvppVpcCropResizePasteAsync(channel_desc_, slot.bgr_desc[idx], slot.nv12_desc[idx],
+                                                              full_area_, full_area_, convert_config_, encode_stream_) ||
+                ACL_SUCCESS != acldvppJpegEncodeAsync(channel_desc_, slot.nv12_desc[idx], slot.jpeg_dev[idx],
+                                                      &slot.jpeg_sizes[idx], jpege_config_, encode_stream_))
+            {
+                aclrtSynchronizeStream(encode_stream_);
+                return 0;
+            }
+        }
+    }
+    uint64_t sync_ns = DvppTimeline::NowNs();
+    aclError aclRet = aclrtSynchronizeStream(encode_stream_);
+    DvppTimeline::Record("dvpp_encode", "jpege_sync", sync_ns, DvppTimeline::NowNs(), slot.img_num);
+    if (aclRet != ACL_SUCCESS)
+    {
+        return 0;
+    }
+    DVPP_TIMELINE_SCOPE("dvpp_encode", "jpeg_readback", slot.img_num);
+    for (int idx = 0; idx < slot.img_num; ++idx)
+    {
+        uint32_t size = slot.jpeg_sizes[idx];
+        if (0 == size || size > jpeg_capacity_)
+        {
+            return 0;
+        }
+        slot.jpegs[idx].resize(size);
+        if (ACL_SUCCESS != aclrtMemcpy(slot.jpegs[idx].data(), size, slot.jpeg_dev[idx], size, ACL_MEMCPY_DEVICE_TO_HOST))
+        {
+            return 0;
+        }
+        // the padded column/row is inside the last MCU, the header size hides it
+        if (padded && 1 != SetJpegSize(slot.jpegs[idx], width, height))
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int DvppResizeEncode::EncodeHost(EncodeSlot &slot, int index)
+{
+    DVPP_TIMELINE_SCOPE("dvpp_encode", "host_encode", index);
+    cv::Mat bgr(config_.resize_config.resized_height, config_.resize_config.resized_width, CV_8UC3,
+                slot.staging.data() + static_cast<size_t>(index) * out_slot_size_, out_width_stride_);
+    std::vector<int> params;
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(static_cast<int>(config_.quality));
+    return cv::imencode(".jpg", bgr, slot.jpegs[index], params) ? 1 : 0;
+}
+
+int DvppResizeEncode::EncodeBatch(EncodeSlot &slot)
+{
+    uint64_t start_us = SteadyNowUs();
+    slot.jpege_images = 0;
+    slot.host_images = 0;
+    aclError ret = aclrtSetCurrentContext(config_.resize_config.context);
+    if (ret != ACL_SUCCESS)
+    {
+        AIALG_ERROR("set current context failed, aclRet is %d\n", ret);
+        return 0;
+    }
+    DVPP_TIMELINE_SCOPE("dvpp_encode", "encode_batch", slot.img_num);
+    if (config_.use_jpege && 1 == EncodeJpege(slot))
+    {
+        slot.jpege_images = slot.img_num;
+        slot.encode_us = SteadyNowUs() - start_us;
+        return 1;
+    }
+
+    // one readback of the whole batch, the jpegs are encoded in parallel
+    size_t batch_bytes = static_cast<size_t>(out_slot_size_) * slot.img_num;
+    slot.staging.resize(batch_bytes);
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_encode", "readback", slot.img_num);
+        if (ACL_SUCCESS != aclrtMemcpy(slot.staging.data(), batch_bytes, slot.output_dev, batch_bytes,
+                                       ACL_MEMCPY_DEVICE_TO_HOST))
+        {
+            AIALG_ERROR("read back the resized batch failed\n");
+            return 0;
+        }
+    }
+    std::vector<int> status(slot.img_num, 0);
+    WorkerPool::RangeFunc encode = [&](int begin, int end, int) {
+        for (int idx = begin; idx < end; ++idx)
+        {
+            status[idx] = EncodeHost(slot, idx);
+        }
+    };
+    if (pool_)
+    {
+        pool_->ParallelFor(0, slot.img_num, encode);
+    }
+    else
+    {
+        encode(0, slot.img_num, 0);
+    }
+    slot.host_images = slot.img_num;
+    slot.encode_us = SteadyNowUs() - start_us;
+    for (int idx = 0; idx < slot.img_num; ++idx)
+    {
+        if (1 != status[idx])
+        {
+            AIALG_ERROR("encode image %d failed\n", idx);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int DvppResizeEncode::Process(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    if (!has_init_over_ || img_num <= 0 || img_num > static_cast<int>(config_.resize_config.batch_size))
+    {
+        AIALG_ERROR("DvppResizeEncode not init or bad img_num = %d\n", img_num);
+        return 0;
+    }
+    EncodeSlot& slot = slots_[process_slot_];
+    if (slot.busy)
+    {
+        AIALG_ERROR("no free encode slot, call Collect first\n");
+        return 0;
+    }
+    uint64_t start_us = SteadyNowUs();
+    DVPPOutputBinding output;
+    output.data = static_cast<uint8_t*>(slot.output_dev);
+    output.size = static_cast<uint64_t>(out_slot_size_) * config_.resize_config.batch_size;
+    int ret = resize_.Process(srcImage, rois, img_num, &output);
+    stats_.resize_us += SteadyNowUs() - start_us;
+    if (1 != ret)
+    {
+        stats_.batch_count++;
+        stats_.failed_count++;
+        return 0;
+    }
+    slot.img_num = img_num;
+    slot.busy = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot.encoded = false;
+        encode_queue_.push_back(process_slot_);
+    }
+    encode_cv_.notify_one();
+    process_slot_ = (process_slot_ + 1) % DVPP_ENCODE_SLOT_NUM;
+    return 1;
+}
+
+int DvppResizeEncode::Collect()
+{
+    EncodeSlot& slot = slots_[collect_slot_];
+    if (!slot.busy)
+    {
+        AIALG_ERROR("no processed batch\n");
+        return 0;
+    }
+    int ret = 0;
+    {
+        DVPP_TIMELINE_SCOPE("dvpp_encode", "wait_encode", slot.img_num);
+        uint64_t start_us = SteadyNowUs();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [&slot] { return slot.encoded; });
+        ret = slot.result;
+        stats_.wait_us += SteadyNowUs() - start_us;
+    }
+    slot.busy = false;
+    last_collected_slot_ = collect_slot_;
+    collect_slot_ = (collect_slot_ + 1) % DVPP_ENCODE_SLOT_NUM;
+
+    stats_.batch_count++;
+    stats_.encode_us += slot.encode_us;
+    stats_.jpege_image_count += slot.jpege_images;
+    stats_.host_image_count += slot.host_images;
+    if (1 != ret)
+    {
+        stats_.failed_count++;
+        slot.img_num = 0;
+        return 0;
+    }
+    for (int idx = 0; idx < slot.img_num; ++idx)
+    {
+        stats_.encoded_bytes += slot.jpegs[idx].size();
+    }
+    return slot.img_num;
+}
+
+int DvppResizeEncode::GetJpeg(DVPPEncodedImage &jpeg, int index) const
+{
+    if (last_collected_slot_ < 0 || index < 0 || index >= slots_[last_collected_slot_].img_num)
+    {
+        return 0;
+    }
+    const std::vector<uint8_t>& data = slots_[last_collected_slot_].jpegs[index];
+    jpeg.data = data.data();
+    jpeg.size = static_cast<uint32_t>(data.size());
+    return 1;
+}
@@ -0,0 +1,158 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_RESIZE_ENCODE_H
+#define _PICTURE_INC_DVPP_RESIZE_ENCODE_H
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include "dvpp_resize.h"
+#include "dvpp_decode_resize.h"
+#include "worker_pool.h"
+
+#define DVPP_ENCODE_SLOT_NUM 2
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // resized_width x resized_height is the thumbnail size, output is owned here
+    uint32_t quality = 90;               // jpeg quality, [1, 100]
+    uint32_t use_jpege = 1;              // encode by JPEGE(vpc bgr -> nv12 first), failures go to the host encoder
+    char reserve[8];
+} DVPPResizeEncodeConfig;
+
+typedef struct{
+    uint64_t batch_count = 0;
+    uint64_t failed_count = 0;         // batches with an image that could not be resized or encoded
+    uint64_t jpege_image_count = 0;
+    uint64_t host_image_count = 0;
+    uint64_t encoded_bytes = 0;
+    uint64_t resize_us = 0;            // Process, on the calling thread
+    uint64_t encode_us = 0;            // background, overlaps with the next Process
+    uint64_t wait_us = 0;              // Collect waiting for the encode
+} DVPPResizeEncodeStats;
+
+/**
+* @brief resize a batch into thumbnails and encode them to jpeg into pooled host buffers, the encode
+*        of one batch(JPEGE, or readback + cv::imencode over the pool) runs on a persistent encode thread and
+*        overlaps with the resize of the next:
+*        Process(b0); Process(b1); Collect(); GetJpeg(...b0); Process(b2); Collect(); GetJpeg(...b1); ...
+*        every jpeg is resized_width x resized_height on both encoders: JPEGE takes even sizes only, so an odd
+*        thumbnail is padded by repeating its last column/row and the size in the jpeg header is set back to the
+*        odd one, decoders drop the padding(it is inside the last MCU)
+*/
+class DvppResizeEncode {
+public:
+    DvppResizeEncode();
+
+    ~DvppResizeEncode();
+
+    /**
+    * @param [in] pool: host encoder workers, nullptr encodes on the encode thread
+    */
+    void Init(const DVPPResizeEncodeConfig* config, WorkerPool* pool = nullptr);
+
+    /**
+    * @brief resize the batch into a free slot and start encoding it in the background
+    * @return 1 success, 0 failed(no free slot: Collect first, or the resize failed)
+    */
+    int Process(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief wait for the encode of the oldest processed batch, its jpegs stay valid until the next Process
+    * @return number of images, 0 failed or nothing processed
+    */
+    int Collect();
+
+    /**
+    * @brief jpeg of image index of the last collected batch, host memory
+    */
+    int GetJpeg(DVPPEncodedImage& jpeg, int index) const;
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPResizeEncodeStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    inline DvppResize& Resizer()
+    {
+        return resize_;
+    }
+
+    void DestroyResource();
+
+private:
+    struct EncodeSlot {
+        void* output_dev = nullptr;                // resized bgr batch
+        std::vector<void*> nv12_dev;               // JPEGE input
+        std::vector<void*> jpeg_dev;               // JPEGE output
+        std::vector<uint32_t> jpeg_sizes;          // written by JPEGE
+        std::vector<acldvppPicDesc*> bgr_desc;
+        std::vector<acldvppPicDesc*> nv12_desc;
+        std::vector<uint8_t> staging;              // host readback of the resized batch
+        std::vector<std::vector<uint8_t> > jpegs;  // pooled host results
+        int img_num = 0;
+        int jpege_images = 0;
+        int host_images = 0;
+        uint64_t encode_us = 0;
+        int result = 0;         // of EncodeBatch, with mutex_
+        bool encoded = false;   // with mutex_
+        bool busy = false;      // processed, not collected yet
+    };
+
+    void EncodeLoop();
+
+    int EncodeBatch(EncodeSlot& slot);
+
+    /**
+    * @brief repeat the last column/row of the odd sized thumbnails into the padding JPEGE encodes
+    */
+    aclError PadToEven(EncodeSlot& slot);
+
+    int EncodeJpege(EncodeSlot& slot);
+
+    int EncodeHost(EncodeSlot& slot, int index);
+
+    inline uint8_t* OutputSlot(const EncodeSlot& slot, int index) const
+    {
+        return static_cast<uint8_t*>(slot.output_dev) + static_cast<size_t>(index) * out_slot_size_;
+    }
+
+private:
+    DVPPResizeEncodeConfig config_;
+    DvppResize resize_;
+    WorkerPool* pool_;
+
+    acldvppChannelDesc* channel_desc_;
+    acldvppResizeConfig* convert_config_;
+    acldvppRoiConfig* full_area_;
+    acldvppJpegeConfig* jpege_config_;
+    aclrtStream encode_stream_;
+    uint32_t out_width_stride_;
+    uint32_t out_slot_size_;
+    uint32_t nv12_size_;
+    uint32_t jpeg_capacity_;
+
+    EncodeSlot slots_[DVPP_ENCODE_SLOT_NUM];
+    std::thread encode_thread_;
+    std::mutex mutex_;
+    std::condition_variable encode_cv_;   // encode thread: a slot was queued or stop
+    std::condition_variable done_cv_;     // Collect: a slot was encoded
+    std::deque<int> encode_queue_;
+    bool stop_;
+    int process_slot_;
+    int collect_slot_;
+    int last_collected_slot_;
+    DVPPResizeEncodeStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_DVPP_RESIZE_ENCODE_H
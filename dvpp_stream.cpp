@@ -0,0 +1,304 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <algorithm>
+#include "dvpp_stream.h"
+#include "alg_define.h"
+
+// aclrtProcessReport returns after this long without callbacks, so the report thread can see stop_
+#define DVPP_STREAM_REPORT_TIMEOUT_MS 100
+
+AclDvppStream::AclDvppStream(aclrtStream stream, aclrtContext context) : stream_(stream), context_(context),
+                                                                        stop_(false), subscribed_(false)
+{
+
+}
+
+AclDvppStream::~AclDvppStream()
+{
+    if (subscribed_)
+    {
+        // pending callbacks are delivered before the report thread goes away
+        aclrtSynchronizeStream(stream_);
+        aclrtUnSubscribeReport(static_cast<uint64_t>(report_thread_.native_handle()), stream_);
+        stop_ = true;
+        report_thread_.join();
+    }
+}
+
+void* AclDvppStream::CreateEvent()
+{
+    aclrtEvent event = nullptr;
+    aclError aclRet = aclrtCreateEvent(&event);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtCreateEvent failed, aclRet = %d\n", aclRet);
+        return nullptr;
+    }
+    return event;
+}
+
+void AclDvppStream::DestroyEvent(void *event)
+{
+    if (event)
+    {
+        aclrtDestroyEvent(event);
+    }
+}
+
+int AclDvppStream::WaitEvent(void *event)
+{
+    aclError aclRet = aclrtStreamWaitEvent(stream_, event);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtStreamWaitEvent failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+int AclDvppStream::RecordEvent(void *event)
+{
+    aclError aclRet = aclrtRecordEvent(event, stream_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtRecordEvent failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+int AclDvppStream::SynchronizeEvent(void *event)
+{
+    aclError aclRet = aclrtSynchronizeEvent(event);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtSynchronizeEvent failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+int AclDvppStream::StartReportThread()
+{
+    if (subscribed_)
+    {
+        return 1;
+    }
+    stop_ = false;
+    report_thread_ = std::thread([this]() {
+        if (context_)
+        {
+            aclrtSetCurrentContext(context_);
+        }
+        while (!stop_)
+        {
+            aclrtProcessReport(DVPP_STREAM_REPORT_TIMEOUT_MS);
+        }
+    });
+    aclError aclRet = aclrtSubscribeReport(static_cast<uint64_t>(report_thread_.native_handle()), stream_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtSubscribeReport failed, aclRet = %d\n", aclRet);
+        stop_ = true;
+        report_thread_.join();
+        return 0;
+    }
+    subscribed_ = true;
+    return 1;
+}
+
+int AclDvppStream::LaunchCallback(DvppStreamCallback fn, void *user_data)
+{
+    if (1 != StartReportThread())
+    {
+        return 0;
+    }
+    aclError aclRet = aclrtLaunchCallback(fn, user_data, ACL_CALLBACK_BLOCK, stream_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtLaunchCallback failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+int AclDvppStream::Launch(const std::function<aclError(aclrtStream)> &launch)
+{
+    aclError aclRet = launch(stream_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("launch on stream failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+int AclDvppStream::Synchronize()
+{
+    aclError aclRet = aclrtSynchronizeStream(stream_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("aclrtSynchronizeStream failed, aclRet = %d\n", aclRet);
+        return 0;
+    }
+    return 1;
+}
+
+HostEmulatedStream::HostEmulatedStream(aclrtStream stream, aclrtContext context) : stream_(stream), context_(context),
+                                                                                  busy_(false), stop_(false),
+                                                                                  failed_(false)
+{
+    worker_ = std::thread(&HostEmulatedStream::WorkerLoop, this);
+}
+
+HostEmulatedStream::~HostEmulatedStream()
+{
+    Synchronize();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+void HostEmulatedStream::WorkerLoop()
+{
+    if (context_)
+    {
+        aclrtSetCurrentContext(context_);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock, [this]() { return stop_ || !ops_.empty(); });
+        if (ops_.empty())
+        {
+            return;
+        }
+        std::function<void()> op = std::move(ops_.front());
+        ops_.pop_front();
+        busy_ = true;
+        lock.unlock();
+        op();
+        lock.lock();
+        busy_ = false;
+        if (ops_.empty())
+        {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+void HostEmulatedStream::Enqueue(const std::function<void()> &op)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ops_.push_back(op);
+    }
+    cv_.notify_one();
+}
+
+void* HostEmulatedStream::CreateEvent()
+{
+    return new HostEvent();
+}
+
+void HostEmulatedStream::DestroyEvent(void *event)
+{
+    delete static_cast<HostEvent*>(event);
+}
+
+int HostEmulatedStream::WaitEvent(void *event)
+{
+    HostEvent* host_event = static_cast<HostEvent*>(event);
+    if (!host_event)
+    {
+        return 0;
+    }
+    // like aclrtStreamWaitEvent, only the records queued so far are waited for
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(host_event->mutex);
+        target = host_event->recorded;
+    }
+    Enqueue([host_event, target]() {
+        std::unique_lock<std::mutex> lock(host_event->mutex);
+        host_event->cv.wait(lock, [host_event, target]() { return host_event->completed >= target; });
+    });
+    return 1;
+}
+
+int HostEmulatedStream::RecordEvent(void *event)
+{
+    HostEvent* host_event = static_cast<HostEvent*>(event);
+    if (!host_event)
+    {
+        return 0;
+    }
+    uint64_t target;
+    {
+        std::lock_guard<std::mutex> lock(host_event->mutex);
+        target = ++host_event->recorded;
+    }
+    Enqueue([host_event, target]() {
+        // notified under the lock, a waiter may destroy the event as soon as it wakes
+        std::lock_guard<std::mutex> lock(host_event->mutex);
+        host_event->completed = std::max(host_event->completed, target);
+        host_event->cv.notify_all();
+    });
+    return 1;
+}
+
+int HostEmulatedStream::SynchronizeEvent(void *event)
+{
+    HostEvent* host_event = static_cast<HostEvent*>(event);
+    if (!host_event)
+    {
+        return 0;
+    }
+    std::unique_lock<std::mutex> lock(host_event->mutex);
+    uint64_t target = host_event->recorded;
+    host_event->cv.wait(lock, [host_event, target]() { return host_event->completed >= target; });
+    return 1;
+}
+
+int HostEmulatedStream::LaunchCallback(DvppStreamCallback fn, void *user_data)
+{
+    if (!fn)
+    {
+        return 0;
+    }
+    Enqueue([fn, user_data]() { fn(user_data); });
+    return 1;
+}
+
+int HostEmulatedStream::Launch(const std::function<aclError(aclrtStream)> &launch)
+{
+    Enqueue([this, launch]() {
+        // the op ends when the device work ends, like the work of an acl stream
+        aclError aclRet = launch(stream_);
+        if (aclRet == ACL_SUCCESS)
+        {
+            aclRet = aclrtSynchronizeStream(stream_);
+        }
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("launch on host emulated stream failed, aclRet = %d\n", aclRet);
+            std::lock_guard<std::mutex> lock(mutex_);
+            failed_ = true;
+        }
+    });
+    return 1;
+}
+
+int HostEmulatedStream::Synchronize()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return ops_.empty() && !busy_; });
+    int ret = failed_ ? 0 : 1;
+    failed_ = false;
+    return ret;
+}
@@ -0,0 +1,161 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_STREAM_H
+#define _PICTURE_INC_DVPP_STREAM_H
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include "acl/acl.h"
+
+// host function run by the stream once the work queued before it completes, the same as aclrtCallback
+typedef void (*DvppStreamCallback)(void* user_data);
+
+/**
+* @brief the stream operations of an asynchronous resize: everything queued on one stream runs in order,
+*        events are opaque(aclrtEvent for AclDvppStream), created and destroyed by the stream that uses them
+*/
+class DvppStream {
+public:
+    virtual ~DvppStream() {}
+
+    virtual void* CreateEvent() = 0;
+
+    virtual void DestroyEvent(void* event) = 0;
+
+    /**
+    * @brief work queued after this call starts once the last record of event completes
+    */
+    virtual int WaitEvent(void* event) = 0;
+
+    /**
+    * @brief event completes once the work queued before this call completes
+    */
+    virtual int RecordEvent(void* event) = 0;
+
+    /**
+    * @brief block the calling thread until event completes
+    */
+    virtual int SynchronizeEvent(void* event) = 0;
+
+    /**
+    * @brief run fn(user_data) on a host thread of the stream once the work queued before it completes
+    */
+    virtual int LaunchCallback(DvppStreamCallback fn, void* user_data) = 0;
+
+    /**
+    * @brief queue device work, launch gets the acl stream to queue it on and may run later(HostEmulatedStream),
+    *        so it must not read state the caller changes afterwards
+    * @return 1 success, 0 launch failed
+    */
+    virtual int Launch(const std::function<aclError(aclrtStream)>& launch) = 0;
+
+    /**
+    * @brief block until all queued work completes
+    * @return 1 success, 0 some work failed since the last Synchronize
+    */
+    virtual int Synchronize() = 0;
+};
+
+/**
+* @brief DvppStream over an acl stream, callbacks are delivered by a report thread started on first use
+*/
+class AclDvppStream : public DvppStream {
+public:
+    /**
+    * @param [in] context: set on the report thread, nullptr keeps its default
+    */
+    explicit AclDvppStream(aclrtStream stream, aclrtContext context = nullptr);
+
+    ~AclDvppStream();
+
+    void* CreateEvent() override;
+
+    void DestroyEvent(void* event) override;
+
+    int WaitEvent(void* event) override;
+
+    int RecordEvent(void* event) override;
+
+    int SynchronizeEvent(void* event) override;
+
+    int LaunchCallback(DvppStreamCallback fn, void* user_data) override;
+
+    int Launch(const std::function<aclError(aclrtStream)>& launch) override;
+
+    int Synchronize() override;
+
+private:
+    int StartReportThread();
+
+private:
+    aclrtStream stream_;
+    aclrtContext context_;
+    std::thread report_thread_;
+    std::atomic<bool> stop_;
+    bool subscribed_;
+};
+
+/**
+* @brief in-order host queue with the semantics of an acl stream, a worker thread runs launches,
+*        event waits/records and callbacks one after another, to test orderings without a device:
+*        a launch runs launch(stream) on the worker and synchronizes stream there, so the records and callbacks
+*        queued after it wait for the device work too
+*/
+class HostEmulatedStream : public DvppStream {
+public:
+    /**
+    * @param [in] stream: device work of the launches, nullptr the default stream(no device: launch is the work)
+    * @param [in] context: set on the worker thread, nullptr keeps its default
+    */
+    explicit HostEmulatedStream(aclrtStream stream = nullptr, aclrtContext context = nullptr);
+
+    ~HostEmulatedStream();
+
+    void* CreateEvent() override;
+
+    void DestroyEvent(void* event) override;
+
+    int WaitEvent(void* event) override;
+
+    int RecordEvent(void* event) override;
+
+    int SynchronizeEvent(void* event) override;
+
+    int LaunchCallback(DvppStreamCallback fn, void* user_data) override;
+
+    int Launch(const std::function<aclError(aclrtStream)>& launch) override;
+
+    int Synchronize() override;
+
+private:
+    struct HostEvent {
+        std::mutex mutex;
+        std::condition_variable cv;
+        uint64_t recorded = 0;   // records queued
+        uint64_t completed = 0;  // records run by the worker
+    };
+
+    void Enqueue(const std::function<void()>& op);
+
+    void WorkerLoop();
+
+private:
+    aclrtStream stream_;
+    aclrtContext context_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::function<void()> > ops_;
+    bool busy_;
+    bool stop_;
+    bool failed_;
+    std::thread worker_;
+};
+
+#endif // _PICTURE_INC_DVPP_STREAM_H
@@ -0,0 +1,306 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "dvpp_timeline.h"
+#include "alg_define.h"
+
+#define DVPP_TIMELINE_RING_MASK (DVPP_TIMELINE_RING_EVENTS - 1)
+
+namespace {
+
+// one event, seq is pos + 1 of the event in its ring once written and 0 while the owner rewrites it,
+// Dump keeps a copy only if seq is the expected one before and after copying the fields
+struct TimelineSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char*> category{nullptr};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> begin_ns{0};
+    std::atomic<uint64_t> end_ns{0};
+    std::atomic<int64_t> arg{0};
+};
+
+// thread that wrote the ring from pos on
+struct TimelineOwner {
+    uint64_t pos;
+    uint32_t tid;
+    std::string thread_name;
+};
+
+// written by one thread at a time, given back to the free list when that thread exits and reused by the next one,
+// so short-lived threads(e.g. std::async per batch) do not grow the memory
+struct TimelineRing {
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> tail{0};     // events before tail were cleared
+    std::vector<TimelineOwner> owners; // with the registry mutex, the ones whose events were overwritten are pruned
+    TimelineSlot slots[DVPP_TIMELINE_RING_EVENTS];
+};
+
+struct TimelineRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TimelineRing> > rings;  // never freed, exited threads' events stay until reused
+    std::vector<TimelineRing*> free_rings;
+    std::string exit_path;
+};
+
+TimelineRegistry& Registry()
+{
+    // never destroyed, so threads and atexit handlers running late still find it
+    static TimelineRegistry* registry = new TimelineRegistry();
+    return *registry;
+}
+
+// ring of the calling thread, released to the free list at thread exit
+struct ThreadRingHolder {
+    TimelineRing* ring = nullptr;
+
+    ~ThreadRingHolder()
+    {
+        if (ring)
+        {
+            TimelineRegistry& registry = Registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.free_rings.push_back(ring);
+        }
+    }
+};
+
+TimelineRing* ThreadRing()
+{
+    static thread_local ThreadRingHolder holder;
+    if (!holder.ring)
+    {
+        TimelineRegistry& registry = Registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (registry.free_rings.empty())
+        {
+            registry.rings.push_back(std::unique_ptr<TimelineRing>(new TimelineRing()));
+            holder.ring = registry.rings.back().get();
+        }
+        else
+        {
+            holder.ring = registry.free_rings.back();
+            registry.free_rings.pop_back();
+        }
+        TimelineRing* ring = holder.ring;
+        uint64_t head = ring->head.load(std::memory_order_relaxed);
+        // an owner is gone once the next one wrote a whole ring after it
+        while (ring->owners.size() > 1 && ring->owners[1].pos + DVPP_TIMELINE_RING_EVENTS <= head)
+        {
+            ring->owners.erase(ring->owners.begin());
+        }
+        TimelineOwner owner = {head, static_cast<uint32_t>(syscall(SYS_gettid)), std::string()};
+        ring->owners.push_back(owner);
+    }
+    return holder.ring;
+}
+
+void WriteJsonString(FILE* fp, const char* str)
+{
+    std::fputc('"', fp);
+    for (; *str; ++str)
+    {
+        if ('"' == *str || '\\' == *str)
+        {
+            std::fputc('\\', fp);
+        }
+        std::fputc(static_cast<unsigned char>(*str) < 0x20 ? ' ' : *str, fp);
+    }
+    std::fputc('"', fp);
+}
+
+void DumpAtExitHandler()
+{
+    DvppTimeline::Dump(Registry().exit_path);
+}
+
+// DVPP_TIMELINE=path enables the timeline before main
+struct TimelineEnvInit {
+    TimelineEnvInit()
+    {
+        const char* path = std::getenv(DVPP_TIMELINE_ENV);
+        if (path && path[0])
+        {
+            DvppTimeline::Enable(true);
+            DvppTimeline::DumpAtExit(path);
+        }
+    }
+};
+
+TimelineEnvInit g_timeline_env_init;
+
+}
+
+std::atomic<bool> DvppTimeline::enabled_(false);
+
+void DvppTimeline::Enable(bool enable)
+{
+    enabled_.store(enable, std::memory_order_relaxed);
+}
+
+void DvppTimeline::Record(const char *category, const char *name, uint64_t begin_ns, uint64_t end_ns, int64_t arg)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    TimelineRing* ring = ThreadRing();
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    TimelineSlot& slot = ring->slots[head & DVPP_TIMELINE_RING_MASK];
+    // invalidate the slot before its fields change, publish it after
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin_ns.store(begin_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.seq.store(head + 1, std::memory_order_release);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+void DvppTimeline::SetThreadName(const char *name)
+{
+    TimelineRing* ring = ThreadRing();
+    TimelineRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ring->owners.back().thread_name = name;
+}
+
+void DvppTimeline::Clear()
+{
+    TimelineRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t idx = 0; idx < registry.rings.size(); ++idx)
+    {
+        registry.rings[idx]->tail.store(registry.rings[idx]->head.load(std::memory_order_acquire));
+    }
+}
+
+void DvppTimeline::DumpAtExit(const std::string &path)
+{
+    TimelineRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (registry.exit_path.empty())
+    {
+        std::atexit(DumpAtExitHandler);
+    }
+    registry.exit_path = path;
+}
+
+int DvppTimeline::Dump(const std::string &path)
+{
+    TimelineRegistry& registry = Registry();
+    std::vector<DVPPTimelineEvent> events;
+    std::vector<std::pair<uint32_t, size_t> > ends;  // tid, end of its events
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t idx = 0; idx < registry.rings.size(); ++idx)
+        {
+            TimelineRing& ring = *registry.rings[idx];
+            uint64_t head = ring.head.load(std::memory_order_acquire);
+            uint64_t begin = ring.tail.load();
+            begin = head - begin > DVPP_TIMELINE_RING_EVENTS ? head - DVPP_TIMELINE_RING_EVENTS : begin;
+            size_t owner = 0;
+            for (uint64_t pos = begin; pos < head; ++pos)
+            {
+                // the events of one owner are contiguous, start a new group where the next owner begins
+                bool new_group = pos == begin;
+                while (owner + 1 < ring.owners.size() && ring.owners[owner + 1].pos <= pos)
+                {
+                    owner++;
+                    new_group = true;
+                }
+                if (new_group)
+                {
+                    ends.push_back(std::make_pair(ring.owners[owner].tid, events.size()));
+                    names.push_back(ring.owners[owner].thread_name);
+                }
+                // skip an event the owner is rewriting or has overwritten meanwhile
+                const TimelineSlot& slot = ring.slots[pos & DVPP_TIMELINE_RING_MASK];
+                if (pos + 1 != slot.seq.load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+                DVPPTimelineEvent event;
+                event.category = slot.category.load(std::memory_order_relaxed);
+                event.name = slot.name.load(std::memory_order_relaxed);
+                event.begin_ns = slot.begin_ns.load(std::memory_order_relaxed);
+                event.end_ns = slot.end_ns.load(std::memory_order_relaxed);
+                event.arg = slot.arg.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (pos + 1 == slot.seq.load(std::memory_order_relaxed))
+                {
+                    events.push_back(event);
+                    ends.back().second = events.size();
+                }
+            }
+        }
+    }
+
+    FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp)
+    {
+        AIALG_ERROR("open timeline file %s failed\n", path.c_str());
+        return 0;
+    }
+    uint64_t origin_ns = UINT64_MAX;
+    for (size_t idx = 0; idx < events.size(); ++idx)
+    {
+        origin_ns = std::min(origin_ns, events[idx].begin_ns);
+    }
+    int pid = static_cast<int>(getpid());
+    std::fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    size_t begin = 0;
+    for (size_t ring = 0; ring < ends.size(); ++ring)
+    {
+        uint32_t tid = ends[ring].first;
+        if (!names[ring].empty())
+        {
+            std::fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+                         first ? "" : ",\n", pid, tid);
+            WriteJsonString(fp, names[ring].c_str());
+            std::fprintf(fp, "}}");
+            first = false;
+        }
+        for (size_t idx = begin; idx < ends[ring].second; ++idx)
+        {
+            const DVPPTimelineEvent& event = events[idx];
+            std::fprintf(fp, "%s{\"name\":", first ? "" : ",\n");
+            WriteJsonString(fp, event.name);
+            std::fprintf(fp, ",\"cat\":");
+            WriteJsonString(fp, event.category);
+            std::fprintf(fp, ",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", pid, tid,
+                         (event.begin_ns - origin_ns) / 1000.0,
+                         event.end_ns > event.begin_ns ? (event.end_ns - event.begin_ns) / 1000.0 : 0.0);
+            if (event.arg >= 0)
+            {
+                std::fprintf(fp, ",\"args\":{\"n\":%ld}", static_cast<long>(event.arg));
+            }
+            std::fprintf(fp, "}");
+            first = false;
+        }
+        begin = ends[ring].second;
+    }
+    std::fprintf(fp, "\n]}\n");
+    bool ok = 0 == std::ferror(fp);
+    ok = 0 == std::fclose(fp) && ok;
+    if (!ok)
+    {
+        AIALG_ERROR("write timeline file %s failed\n", path.c_str());
+        return 0;
+    }
+    AIALG_PRINT("timeline of %zu events written to %s\n", events.size(), path.c_str());
+    return 1;
+}
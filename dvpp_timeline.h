@@ -0,0 +1,118 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_TIMELINE_H
+#define _PICTURE_INC_DVPP_TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// events kept per thread, the oldest ones are overwritten, power of 2
+#define DVPP_TIMELINE_RING_EVENTS 16384
+// DVPP_TIMELINE=/path/to/trace.json enables the timeline at load and dumps it at exit
+#define DVPP_TIMELINE_ENV "DVPP_TIMELINE"
+
+typedef struct{
+    const char* category;  // string literal, never copied
+    const char* name;      // string literal, never copied
+    uint64_t begin_ns;     // steady clock
+    uint64_t end_ns;
+    int64_t arg;           // e.g. img_num, -1: none
+} DVPPTimelineEvent;
+
+/**
+* @brief opt-in begin/end events of every thread, each live thread writes its own lock-free ring,
+*        Dump writes Chrome trace-event JSON(chrome://tracing, ui.perfetto.dev),
+*        disabled it costs one relaxed atomic load per scope
+*/
+class DvppTimeline {
+public:
+    static inline bool IsEnabled()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    static void Enable(bool enable);
+
+    static inline uint64_t NowNs();
+
+    /**
+    * @brief append one complete event to the ring of the calling thread, dropped if disabled
+    */
+    static void Record(const char* category, const char* name, uint64_t begin_ns, uint64_t end_ns, int64_t arg = -1);
+
+    /**
+    * @brief name of the calling thread in the dump, e.g. "dvpp_aggregator"
+    */
+    static void SetThreadName(const char* name);
+
+    /**
+    * @brief write the events of all threads as Chrome trace-event JSON, the ring of an exited thread is reused by
+    *        the next new thread, so its events are kept until that one overwrote them
+    * @return 1 success, 0 failed
+    */
+    static int Dump(const std::string& path);
+
+    /**
+    * @brief Dump(path) when the process exits
+    */
+    static void DumpAtExit(const std::string& path);
+
+    /**
+    * @brief drop the events recorded so far
+    */
+    static void Clear();
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+class DvppTimelineScope {
+public:
+    inline DvppTimelineScope(const char* category, const char* name, int64_t arg = -1) : name_(nullptr)
+    {
+        if (DvppTimeline::IsEnabled())
+        {
+            category_ = category;
+            name_ = name;
+            arg_ = arg;
+            begin_ns_ = DvppTimeline::NowNs();
+        }
+    }
+
+    inline ~DvppTimelineScope()
+    {
+        if (name_)
+        {
+            DvppTimeline::Record(category_, name_, begin_ns_, DvppTimeline::NowNs(), arg_);
+        }
+    }
+
+private:
+    const char* category_;
+    const char* name_;
+    int64_t arg_;
+    uint64_t begin_ns_;
+};
+
+inline uint64_t DvppTimeline::NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#define DVPP_TIMELINE_CONCAT_(a, b) a##b
+#define DVPP_TIMELINE_CONCAT(a, b) DVPP_TIMELINE_CONCAT_(a, b)
+
+// -DDVPP_DISABLE_TIMELINE compiles every scope away
+#ifdef DVPP_DISABLE_TIMELINE
+#define DVPP_TIMELINE_SCOPE(category, name, arg)
+#else
+#define DVPP_TIMELINE_SCOPE(category, name, arg) \
+    DvppTimelineScope DVPP_TIMELINE_CONCAT(dvpp_timeline_scope_, __LINE__)(category, name, arg)
+#endif
+
+#endif // _PICTURE_INC_DVPP_TIMELINE_H
@@ -0,0 +1,140 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include "dvpp_trace.h"
+#include "alg_define.h"
+
+DvppTraceWriter::DvppTraceWriter() : fp_(nullptr)
+{
+
+}
+
+DvppTraceWriter::~DvppTraceWriter()
+{
+    Close();
+}
+
+int DvppTraceWriter::Open(const std::string &path, const DVPPTraceHeader &header)
+{
+    Close();
+    fp_ = std::fopen(path.c_str(), "wb");
+    if (!fp_)
+    {
+        AIALG_ERROR("open trace file %s failed\n", path.c_str());
+        return 0;
+    }
+    // records are small, let stdio batch them into large writes
+    file_buffer_.resize(1 << 20);
+    std::setvbuf(fp_, file_buffer_.data(), _IOFBF, file_buffer_.size());
+
+    DVPPTraceHeader head = header;
+    head.magic = DVPP_TRACE_MAGIC;
+    head.version = DVPP_TRACE_VERSION;
+    if (1 != std::fwrite(&head, sizeof(head), 1, fp_))
+    {
+        AIALG_ERROR("write trace header failed\n");
+        Close();
+        return 0;
+    }
+    return 1;
+}
+
+int DvppTraceWriter::Write(const DVPPTraceRecord &record, const DVPPTraceImage *images)
+{
+    if (!fp_)
+    {
+        return 0;
+    }
+    if (1 != std::fwrite(&record, sizeof(record), 1, fp_))
+    {
+        return 0;
+    }
+    if (record.img_num > 0 && record.img_num != std::fwrite(images, sizeof(DVPPTraceImage), record.img_num, fp_))
+    {
+        return 0;
+    }
+    return 1;
+}
+
+void DvppTraceWriter::Close()
+{
+    if (fp_)
+    {
+        std::fclose(fp_);
+        fp_ = nullptr;
+    }
+}
+
+DvppTraceReader::DvppTraceReader() : fp_(nullptr), header_()
+{
+
+}
+
+DvppTraceReader::~DvppTraceReader()
+{
+    Close();
+}
+
+int DvppTraceReader::Open(const std::string &path)
+{
+    Close();
+    fp_ = std::fopen(path.c_str(), "rb");
+    if (!fp_)
+    {
+        AIALG_ERROR("open trace file %s failed\n", path.c_str());
+        return 0;
+    }
+    if (1 != std::fread(&header_, sizeof(header_.magic) + sizeof(header_.version), 1, fp_) ||
+        DVPP_TRACE_MAGIC != header_.magic)
+    {
+        AIALG_ERROR("%s is not a dvpp trace file\n", path.c_str());
+        Close();
+        return 0;
+    }
+    if (DVPP_TRACE_VERSION != header_.version)
+    {
+        AIALG_ERROR("%s is trace version %d, expected %d, record it again\n", path.c_str(), header_.version,
+                    DVPP_TRACE_VERSION);
+        Close();
+        return 0;
+    }
+    size_t offset = sizeof(header_.magic) + sizeof(header_.version);
+    if (1 != std::fread(reinterpret_cast<char*>(&header_) + offset, sizeof(header_) - offset, 1, fp_))
+    {
+        AIALG_ERROR("%s has a broken header\n", path.c_str());
+        Close();
+        return 0;
+    }
+    return 1;
+}
+
+int DvppTraceReader::Next(DVPPTraceRecord &record, std::vector<DVPPTraceImage> &images)
+{
+    if (!fp_ || 1 != std::fread(&record, sizeof(record), 1, fp_))
+    {
+        return 0;
+    }
+    // a batch never holds more than batch_size images, a larger count is a corrupt record
+    if (record.img_num > header_.batch_size)
+    {
+        AIALG_ERROR("bad trace record of %u images, batch_size is %u\n", record.img_num, header_.batch_size);
+        return 0;
+    }
+    images.resize(record.img_num);
+    if (record.img_num > 0 && record.img_num != std::fread(images.data(), sizeof(DVPPTraceImage), record.img_num, fp_))
+    {
+        AIALG_ERROR("truncated trace record\n");
+        return 0;
+    }
+    return 1;
+}
+
+void DvppTraceReader::Close()
+{
+    if (fp_)
+    {
+        std::fclose(fp_);
+        fp_ = nullptr;
+    }
+}
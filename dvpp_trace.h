@@ -0,0 +1,111 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_DVPP_TRACE_H
+#define _PICTURE_INC_DVPP_TRACE_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "data_type.h"
+
+#define DVPP_TRACE_MAGIC 0x52545644  // "DVTR"
+#define DVPP_TRACE_VERSION 2
+
+// file layout: DVPPTraceHeader, then for every Process call one DVPPTraceRecord
+// followed by record.img_num DVPPTraceImage, all little endian, no pixel data
+typedef struct{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t input_format;
+    uint32_t batch_size;
+    uint32_t resized_width;
+    uint32_t resized_height;
+    uint32_t is_fix_scale_resize;
+    uint32_t is_symmetry_padding;
+    float resize_scale_factor;
+    uint32_t interpolation;
+    uint32_t max_pass_upscale;
+    uint32_t max_pass_downscale;
+    uint32_t compute_stats;
+    uint32_t border_value;
+    uint32_t drop_bad_images;
+    uint32_t reserve;
+} DVPPTraceHeader;
+
+typedef struct{
+    uint64_t timestamp_ns;  // steady clock, relative to the first record
+    uint32_t img_num;
+    uint32_t has_rois;
+    uint32_t status;        // return value of Process
+    uint32_t setup_us;      // roi && pic desc update
+    uint32_t launch_us;     // acldvppVpcBatchCropResizePasteAsync
+    uint32_t sync_us;       // aclrtSynchronizeStream
+} DVPPTraceRecord;
+
+typedef struct{
+    uint32_t width;
+    uint32_t height;
+    uint32_t align_width;
+    uint32_t align_height;
+    int32_t xmin;
+    int32_t ymin;
+    int32_t xmax;
+    int32_t ymax;
+} DVPPTraceImage;
+
+class DvppTraceWriter {
+public:
+    DvppTraceWriter();
+
+    ~DvppTraceWriter();
+
+    /**
+    * @brief open trace file and write header
+    * @return 1 success, 0 failed
+    */
+    int Open(const std::string& path, const DVPPTraceHeader& header);
+
+    int Write(const DVPPTraceRecord& record, const DVPPTraceImage* images);
+
+    void Close();
+
+    inline bool IsOpen() const
+    {
+        return nullptr != fp_;
+    }
+
+private:
+    FILE* fp_;
+    std::vector<char> file_buffer_;
+};
+
+class DvppTraceReader {
+public:
+    DvppTraceReader();
+
+    ~DvppTraceReader();
+
+    int Open(const std::string& path);
+
+    /**
+    * @brief read next record
+    * @return 1 success, 0 end of file or broken record
+    */
+    int Next(DVPPTraceRecord& record, std::vector<DVPPTraceImage>& images);
+
+    void Close();
+
+    inline const DVPPTraceHeader& Header() const
+    {
+        return header_;
+    }
+
+private:
+    FILE* fp_;
+    DVPPTraceHeader header_;
+};
+
+#endif // _PICTURE_INC_DVPP_TRACE_H
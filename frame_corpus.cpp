@@ -0,0 +1,197 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "frame_corpus.h"
+#include "alg_define.h"
+
+FrameCorpusWriter::FrameCorpusWriter() : fp_(nullptr), header_()
+{
+
+}
+
+FrameCorpusWriter::~FrameCorpusWriter()
+{
+    Close();
+}
+
+int FrameCorpusWriter::Open(const std::string &path, uint32_t input_format)
+{
+    Close();
+    fp_ = std::fopen(path.c_str(), "wb");
+    if (!fp_)
+    {
+        AIALG_ERROR("open corpus file %s failed\n", path.c_str());
+        return 0;
+    }
+    std::memset(&header_, 0, sizeof(header_));
+    header_.magic = FRAME_CORPUS_MAGIC;
+    header_.version = FRAME_CORPUS_VERSION;
+    header_.input_format = input_format;
+    entries_.clear();
+    // the real header is written by Close
+    if (1 != std::fwrite(&header_, sizeof(header_), 1, fp_))
+    {
+        AIALG_ERROR("write corpus header failed\n");
+        std::fclose(fp_);
+        fp_ = nullptr;
+        return 0;
+    }
+    return 1;
+}
+
+int FrameCorpusWriter::Append(const DVPPImageData &image)
+{
+    if (!fp_ || !image.data || 0 == image.size)
+    {
+        return 0;
+    }
+    long pos = std::ftell(fp_);
+    long aligned = static_cast<long>(alignSize(pos, FRAME_CORPUS_ALIGN));
+    static const char zeros[FRAME_CORPUS_ALIGN] = {0};
+    if (aligned > pos && 1 != std::fwrite(zeros, aligned - pos, 1, fp_))
+    {
+        return 0;
+    }
+    if (1 != std::fwrite(image.data, image.size, 1, fp_))
+    {
+        AIALG_ERROR("write corpus frame %zu failed\n", entries_.size());
+        return 0;
+    }
+    FrameCorpusEntry entry = {};
+    entry.offset = aligned;
+    entry.size = image.size;
+    entry.width = image.width;
+    entry.height = image.height;
+    entry.align_width = image.alignWidth;
+    entry.align_height = image.alignHeight;
+    entries_.push_back(entry);
+    return 1;
+}
+
+int FrameCorpusWriter::Close()
+{
+    if (!fp_)
+    {
+        return 0;
+    }
+    int ret = 1;
+    // keep the index 8 bytes aligned, the reader uses it in place
+    long pos = std::ftell(fp_);
+    long aligned = static_cast<long>(alignSize(pos, 8));
+    static const char zeros[8] = {0};
+    header_.frame_count = entries_.size();
+    header_.index_offset = aligned;
+    if ((aligned > pos && 1 != std::fwrite(zeros, aligned - pos, 1, fp_)) ||
+        (!entries_.empty() && entries_.size() != std::fwrite(entries_.data(), sizeof(FrameCorpusEntry), entries_.size(), fp_)) ||
+        0 != std::fseek(fp_, 0, SEEK_SET) || 1 != std::fwrite(&header_, sizeof(header_), 1, fp_))
+    {
+        AIALG_ERROR("write corpus index failed\n");
+        ret = 0;
+    }
+    std::fclose(fp_);
+    fp_ = nullptr;
+    return ret;
+}
+
+FrameCorpusReader::FrameCorpusReader() : mapped_(nullptr), mapped_size_(0), header_(), entries_(nullptr)
+{
+
+}
+
+FrameCorpusReader::~FrameCorpusReader()
+{
+    Close();
+}
+
+int FrameCorpusReader::Open(const std::string &path, bool populate)
+{
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        AIALG_ERROR("open corpus file %s failed\n", path.c_str());
+        return 0;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(FrameCorpusHeader)))
+    {
+        AIALG_ERROR("%s is not a frame corpus\n", path.c_str());
+        close(fd);
+        return 0;
+    }
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    if (populate)
+    {
+        flags |= MAP_POPULATE;
+    }
+#endif
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        AIALG_ERROR("mmap %s failed\n", path.c_str());
+        return 0;
+    }
+    mapped_ = static_cast<uint8_t*>(addr);
+    mapped_size_ = st.st_size;
+
+    std::memcpy(&header_, mapped_, sizeof(header_));
+    if (FRAME_CORPUS_MAGIC != header_.magic || FRAME_CORPUS_VERSION != header_.version ||
+        header_.index_offset + static_cast<uint64_t>(header_.frame_count) * sizeof(FrameCorpusEntry) > mapped_size_)
+    {
+        AIALG_ERROR("%s is not a frame corpus or is truncated\n", path.c_str());
+        Close();
+        return 0;
+    }
+    entries_ = reinterpret_cast<const FrameCorpusEntry*>(mapped_ + header_.index_offset);
+    for (uint32_t idx = 0; idx < header_.frame_count; ++idx)
+    {
+        if (entries_[idx].offset + entries_[idx].size > header_.index_offset)
+        {
+            AIALG_ERROR("corpus frame %d is out of range\n", idx);
+            Close();
+            return 0;
+        }
+    }
+    if (!populate)
+    {
+        madvise(mapped_, mapped_size_, MADV_SEQUENTIAL);
+    }
+    return 1;
+}
+
+void FrameCorpusReader::Close()
+{
+    if (mapped_)
+    {
+        munmap(mapped_, mapped_size_);
+        mapped_ = nullptr;
+        mapped_size_ = 0;
+    }
+    entries_ = nullptr;
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+int FrameCorpusReader::Get(DVPPImageData &image, uint32_t index) const
+{
+    if (!entries_ || index >= header_.frame_count)
+    {
+        return 0;
+    }
+    const FrameCorpusEntry& entry = entries_[index];
+    image.width = entry.width;
+    image.height = entry.height;
+    image.alignWidth = entry.align_width;
+    image.alignHeight = entry.align_height;
+    image.size = entry.size;
+    // the mapping is read only, the resize path never writes its input
+    image.data = mapped_ + entry.offset;
+    return 1;
+}
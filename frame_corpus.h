@@ -0,0 +1,100 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_FRAME_CORPUS_H
+#define _PICTURE_INC_FRAME_CORPUS_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dvpp_resize.h"
+
+#define FRAME_CORPUS_MAGIC 0x43465644  // "DVFC"
+#define FRAME_CORPUS_VERSION 1
+// every frame starts at a page boundary of the file, so the mmap pointer of it is page aligned too
+#define FRAME_CORPUS_ALIGN 4096
+
+// file layout: FrameCorpusHeader | frame 0 | frame 1 | ... | FrameCorpusEntry[frame_count]
+typedef struct{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frame_count;
+    uint32_t input_format;  // PIXEL_FORMAT_BGR_888 : 13, PIXEL_FORMAT_YUV_SEMIPLANAR_420 : 1
+    uint64_t index_offset;
+    uint64_t reserve[5];
+} FrameCorpusHeader;
+
+typedef struct{
+    uint64_t offset;
+    uint32_t size;
+    uint32_t width;
+    uint32_t height;
+    uint32_t align_width;  // bytes per row, the same as DVPPImageData::alignWidth
+    uint32_t align_height;
+    uint32_t reserve;
+} FrameCorpusEntry;
+
+class FrameCorpusWriter {
+public:
+    FrameCorpusWriter();
+
+    ~FrameCorpusWriter();
+
+    int Open(const std::string& path, uint32_t input_format);
+
+    /**
+    * @brief append one pre-aligned frame, image.size bytes of image.data are written
+    * @return 1 success, 0 failed
+    */
+    int Append(const DVPPImageData& image);
+
+    /**
+    * @brief write the index and finish the file
+    */
+    int Close();
+
+private:
+    FILE* fp_;
+    FrameCorpusHeader header_;
+    std::vector<FrameCorpusEntry> entries_;
+};
+
+class FrameCorpusReader {
+public:
+    FrameCorpusReader();
+
+    ~FrameCorpusReader();
+
+    /**
+    * @brief mmap a corpus file
+    * @param [in] populate: fault all pages in now, keeps page faults out of later measurements
+    */
+    int Open(const std::string& path, bool populate = true);
+
+    void Close();
+
+    inline uint32_t FrameCount() const
+    {
+        return header_.frame_count;
+    }
+
+    inline uint32_t InputFormat() const
+    {
+        return header_.input_format;
+    }
+
+    /**
+    * @brief zero-copy view of frame index, data points into the mapping and is valid until Close
+    */
+    int Get(DVPPImageData& image, uint32_t index) const;
+
+private:
+    uint8_t* mapped_;
+    size_t mapped_size_;
+    FrameCorpusHeader header_;
+    const FrameCorpusEntry* entries_;
+};
+
+#endif // _PICTURE_INC_FRAME_CORPUS_H
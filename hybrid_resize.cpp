@@ -0,0 +1,424 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "hybrid_resize.h"
+#include "cpu_resize.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+namespace {
+
+// CpuResize, optionally paced to a fixed per-image cost to stand in for a path of another speed
+class HostResizeWorker : public HybridResizeWorker {
+public:
+    int Init(const DVPPResizeInitConfig& config, WorkerPool* pool, float sim_us_per_image)
+    {
+        sim_us_per_image_ = sim_us_per_image;
+        resize_.Init(&config);
+        resize_.SetWorkerPool(pool);
+        return resize_.HasInit() ? 1 : 0;
+    }
+
+    int Process(const DVPPImageData* images, const RectInt* rois, int img_num, uint8_t* output) override
+    {
+        std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+        if (1 != resize_.Process(images, rois, img_num))
+        {
+            return 0;
+        }
+        DVPPImageData resized;
+        for (int idx = 0; idx < img_num; ++idx)
+        {
+            resize_.Get(resized, idx);
+            std::memcpy(output + static_cast<size_t>(idx) * resized.size, resized.data, resized.size);
+        }
+        if (sim_us_per_image_ > 0.0f)
+        {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(
+                    static_cast<int64_t>(sim_us_per_image_ * img_num)));
+        }
+        return 1;
+    }
+
+    void DestroyResource() override
+    {
+        resize_.DestroyResource();
+    }
+
+private:
+    CpuResize resize_;
+    float sim_us_per_image_ = 0.0f;
+};
+
+// uploads the host images, resizes them by DvppResize into a device batch and reads it back in one copy
+class DeviceResizeWorker : public HybridResizeWorker {
+public:
+    int Init(const DVPPResizeInitConfig& config)
+    {
+        config_ = config;
+        config_.use_external_output = 1;
+        resize_.Init(&config_);
+        if (!resize_.HasInit())
+        {
+            return 0;
+        }
+        output_size_ = static_cast<uint64_t>(ALIGN_UP16(config_.resized_width) * 3) *
+                       ALIGN_UP2(config_.resized_height) * config_.batch_size;
+        aclError aclRet = acldvppMalloc(&output_dev_, output_size_);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acldvppMalloc hybrid device output failed, aclRet = %d\n", aclRet);
+            output_dev_ = nullptr;
+            return 0;
+        }
+        inputs_dev_.assign(config_.batch_size, nullptr);
+        input_sizes_.assign(config_.batch_size, 0);
+        images_dev_.resize(config_.batch_size);
+        return 1;
+    }
+
+    int Process(const DVPPImageData* images, const RectInt* rois, int img_num, uint8_t* output) override
+    {
+        aclError aclRet = aclrtSetCurrentContext(config_.context);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("set current context failed, aclRet is %d\n", aclRet);
+            return 0;
+        }
+        {
+            DVPP_TIMELINE_SCOPE("hybrid_resize", "upload", img_num);
+            for (int idx = 0; idx < img_num; ++idx)
+            {
+                uint32_t width_stride, height_stride, buffer_size;
+                GetDvppInputStride(config_.input_format, images[idx], width_stride, height_stride, buffer_size);
+                // the strides say how much vpc reads, the host image must hold all of it
+                if (images[idx].size < buffer_size)
+                {
+                    AIALG_ERROR("image %d has %u bytes, its strides need %u\n", idx, images[idx].size, buffer_size);
+                    return 0;
+                }
+                if (input_sizes_[idx] < buffer_size)
+                {
+                    if (inputs_dev_[idx])
+                    {
+                        acldvppFree(inputs_dev_[idx]);
+                        inputs_dev_[idx] = nullptr;
+                    }
+                    input_sizes_[idx] = 0;
+                    if (ACL_SUCCESS != acldvppMalloc(&inputs_dev_[idx], buffer_size))
+                    {
+                        AIALG_ERROR("acldvppMalloc hybrid input of %d bytes failed\n", buffer_size);
+                        inputs_dev_[idx] = nullptr;
+                        return 0;
+                    }
+                    input_sizes_[idx] = buffer_size;
+                }
+                aclRet = aclrtMemcpy(inputs_dev_[idx], buffer_size, images[idx].data,
+                                     std::min(images[idx].size, buffer_size), ACL_MEMCPY_HOST_TO_DEVICE);
+                if (aclRet != ACL_SUCCESS)
+                {
+                    AIALG_ERROR("upload image %d failed, aclRet is %d\n", idx, aclRet);
+                    return 0;
+                }
+                images_dev_[idx] = images[idx];
+                images_dev_[idx].data = static_cast<uint8_t*>(inputs_dev_[idx]);
+            }
+        }
+
+        DVPPOutputBinding binding;
+        binding.data = static_cast<uint8_t*>(output_dev_);
+        binding.size = output_size_;
+        if (1 != resize_.Process(images_dev_.data(), rois, img_num, &binding))
+        {
+            return 0;
+        }
+        size_t size = output_size_ / config_.batch_size * img_num;
+        DVPP_TIMELINE_SCOPE("hybrid_resize", "readback", img_num);
+        aclRet = aclrtMemcpy(output, size, output_dev_, size, ACL_MEMCPY_DEVICE_TO_HOST);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("read back %d images failed, aclRet is %d\n", img_num, aclRet);
+            return 0;
+        }
+        return 1;
+    }
+
+    void DestroyResource() override
+    {
+        resize_.DestroyResource();
+        for (size_t idx = 0; idx < inputs_dev_.size(); ++idx)
+        {
+            if (inputs_dev_[idx])
+            {
+                acldvppFree(inputs_dev_[idx]);
+            }
+        }
+        inputs_dev_.clear();
+        input_sizes_.clear();
+        if (output_dev_)
+        {
+            acldvppFree(output_dev_);
+            output_dev_ = nullptr;
+        }
+    }
+
+private:
+    DVPPResizeInitConfig config_;
+    DvppResize resize_;
+    std::vector<void*> inputs_dev_;  // per batch index, grown on demand
+    std::vector<uint32_t> input_sizes_;
+    std::vector<DVPPImageData> images_dev_;
+    void* output_dev_ = nullptr;
+    uint64_t output_size_ = 0;
+};
+
+}
+
+HybridResizeWorker* CreateHostResizeWorker(const DVPPResizeInitConfig &config, WorkerPool *pool, float sim_us_per_image)
+{
+    std::unique_ptr<HostResizeWorker> worker(new HostResizeWorker());
+    if (1 != worker->Init(config, pool, sim_us_per_image))
+    {
+        worker->DestroyResource();
+        return nullptr;
+    }
+    return worker.release();
+}
+
+HybridResizeWorker* CreateDeviceResizeWorker(const DVPPResizeInitConfig &config)
+{
+    std::unique_ptr<DeviceResizeWorker> worker(new DeviceResizeWorker());
+    if (1 != worker->Init(config))
+    {
+        worker->DestroyResource();
+        return nullptr;
+    }
+    return worker.release();
+}
+
+HybridResize::HybridResize() : out_width_stride_(0), out_buffer_size_(0), stop_(false), device_pending_(false),
+                               device_images_(nullptr), device_rois_(nullptr), device_num_(0), device_ret_(0),
+                               device_us_(0), device_us_per_image_(0.0f), host_us_per_image_(0.0f),
+                               device_idle_batches_(0), host_idle_batches_(0), has_init_over_(false)
+{
+
+}
+
+HybridResize::~HybridResize()
+{
+    DestroyResource();
+}
+
+void HybridResize::Init(const DVPPHybridResizeConfig *config, WorkerPool *pool)
+{
+    config_ = *config;
+    if (config_.ema_alpha <= 0.0f || config_.ema_alpha > 1.0f || config_.device_us_per_image <= 0.0f ||
+        config_.host_us_per_image <= 0.0f)
+    {
+        AIALG_ERROR("ema_alpha must be in (0, 1] and the initial costs > 0\n");
+        return;
+    }
+    // both workers and the host output batch are sized by the resolved(tuned) batch_size
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    device_worker_.reset(config_.simulate ?
+                         CreateHostResizeWorker(config_.resize_config, nullptr, config_.sim_device_us_per_image) :
+                         CreateDeviceResizeWorker(config_.resize_config));
+    host_worker_.reset(CreateHostResizeWorker(config_.resize_config, pool,
+                                              config_.simulate ? config_.sim_host_us_per_image : 0.0f));
+    if (!device_worker_ || !host_worker_)
+    {
+        if (device_worker_)
+        {
+            device_worker_->DestroyResource();
+            device_worker_.reset();
+        }
+        if (host_worker_)
+        {
+            host_worker_->DestroyResource();
+            host_worker_.reset();
+        }
+        return;
+    }
+
+    out_width_stride_ = ALIGN_UP16(config_.resize_config.resized_width) * 3;
+    out_buffer_size_ = out_width_stride_ * ALIGN_UP2(config_.resize_config.resized_height);
+    out_data_.assign(static_cast<size_t>(out_buffer_size_) * config_.resize_config.batch_size, 0);
+    device_us_per_image_ = config_.device_us_per_image;
+    host_us_per_image_ = config_.host_us_per_image;
+    device_idle_batches_ = 0;
+    host_idle_batches_ = 0;
+    stop_ = false;
+    device_pending_ = false;
+    device_thread_ = std::thread(&HybridResize::DeviceLoop, this);
+    has_init_over_ = true;
+}
+
+void HybridResize::DestroyResource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (device_thread_.joinable())
+    {
+        device_thread_.join();
+    }
+    if (device_worker_)
+    {
+        device_worker_->DestroyResource();
+        device_worker_.reset();
+    }
+    if (host_worker_)
+    {
+        host_worker_->DestroyResource();
+        host_worker_.reset();
+    }
+    has_init_over_ = false;
+}
+
+void HybridResize::DeviceLoop()
+{
+    DvppTimeline::SetThreadName("hybrid_device");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock, [this] { return stop_ || device_pending_; });
+        if (!device_pending_)
+        {
+            break;
+        }
+        lock.unlock();
+        uint64_t start_ns = SteadyNowNs();
+        int ret;
+        {
+            DVPP_TIMELINE_SCOPE("hybrid_resize", "device", device_num_);
+            ret = device_worker_->Process(device_images_, device_rois_, device_num_, out_data_.data());
+        }
+        uint64_t elapsed_us = (SteadyNowNs() - start_ns) / 1000;
+        lock.lock();
+        device_ret_ = ret;
+        device_us_ = elapsed_us;
+        device_pending_ = false;
+        cv_.notify_all();
+    }
+}
+
+int HybridResize::DeviceShare(int img_num)
+{
+    // n_device * device_cost == n_host * host_cost
+    float share = host_us_per_image_ / (device_us_per_image_ + host_us_per_image_);
+    int device_num = static_cast<int>(std::lround(img_num * share));
+    device_num = std::max(0, std::min(device_num, img_num));
+    if (img_num > 1 && device_num == img_num && host_idle_batches_ >= config_.probe_interval)
+    {
+        device_num--;
+    }
+    if (img_num > 1 && 0 == device_num && device_idle_batches_ >= config_.probe_interval)
+    {
+        device_num = 1;
+    }
+    return device_num;
+}
+
+int HybridResize::Process(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("HybridResize has not init\n");
+        return 0;
+    }
+    if (img_num <= 0 || img_num > static_cast<int>(config_.resize_config.batch_size))
+    {
+        AIALG_ERROR("img_num must be in [1, batch_size], img_num = %d, batch_size = %d\n", img_num,
+                    config_.resize_config.batch_size);
+        stats_.failed_count++;
+        return 0;
+    }
+    uint64_t start_ns = SteadyNowNs();
+    int device_num = DeviceShare(img_num);
+    int host_num = img_num - device_num;
+    if (device_num > 0)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        device_images_ = srcImage;
+        device_rois_ = rois;
+        device_num_ = device_num;
+        device_pending_ = true;
+        cv_.notify_all();
+    }
+
+    int host_ret = 1;
+    uint64_t host_us = 0;
+    if (host_num > 0)
+    {
+        DVPP_TIMELINE_SCOPE("hybrid_resize", "host", host_num);
+        host_ret = host_worker_->Process(srcImage + device_num, rois ? rois + device_num : nullptr, host_num,
+                                         out_data_.data() + static_cast<size_t>(device_num) * out_buffer_size_);
+        host_us = (SteadyNowNs() - start_ns) / 1000;
+    }
+
+    int device_ret = 1;
+    uint64_t device_us = 0;
+    if (device_num > 0)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !device_pending_; });
+        device_ret = device_ret_;
+        device_us = device_us_;
+    }
+
+    float alpha = config_.ema_alpha;
+    if (device_num > 0 && 1 == device_ret)
+    {
+        device_us_per_image_ = (1.0f - alpha) * device_us_per_image_ + alpha * device_us / device_num;
+    }
+    if (host_num > 0 && 1 == host_ret)
+    {
+        host_us_per_image_ = (1.0f - alpha) * host_us_per_image_ + alpha * host_us / host_num;
+    }
+    device_idle_batches_ = device_num > 0 ? 0 : device_idle_batches_ + 1;
+    host_idle_batches_ = host_num > 0 ? 0 : host_idle_batches_ + 1;
+
+    stats_.batch_count++;
+    stats_.device_us_per_image = device_us_per_image_;
+    stats_.host_us_per_image = host_us_per_image_;
+    stats_.total_us += (SteadyNowNs() - start_ns) / 1000;
+    if (1 != device_ret || 1 != host_ret)
+    {
+        AIALG_ERROR("hybrid batch failed, device path %d, host path %d\n", device_ret, host_ret);
+        stats_.failed_count++;
+        return 0;
+    }
+    stats_.device_image_count += device_num;
+    stats_.host_image_count += host_num;
+    if (device_num > 0 && host_num > 0)
+    {
+        stats_.idle_us += device_us > host_us ? device_us - host_us : host_us - device_us;
+    }
+    return 1;
+}
+
+int HybridResize::Get(DVPPImageData &resizedImage, int index) const
+{
+    resizedImage.width = config_.resize_config.resized_width;
+    resizedImage.height = config_.resize_config.resized_height;
+    resizedImage.alignWidth = out_width_stride_;
+    resizedImage.alignHeight = ALIGN_UP2(config_.resize_config.resized_height);
+    resizedImage.size = out_buffer_size_;
+    resizedImage.data = const_cast<uint8_t*>(out_data_.data()) + static_cast<size_t>(index) * out_buffer_size_;
+    return 1;
+}
@@ -0,0 +1,148 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_HYBRID_RESIZE_H
+#define _PICTURE_INC_HYBRID_RESIZE_H
+
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include "dvpp_resize.h"
+#include "worker_pool.h"
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;     // inputs and the output batch are host memory
+    float ema_alpha = 0.2f;                 // weight of the newest per-image cost
+    float device_us_per_image = 1000.0f;    // initial estimates, refined from every batch
+    float host_us_per_image = 4000.0f;
+    uint32_t probe_interval = 16;           // a path idle for this many batches gets one image to refresh its estimate
+    uint32_t simulate = 0;                  // 1: no acl calls, both paths are CpuResize paced to the sim_* costs
+    float sim_device_us_per_image = 500.0f;
+    float sim_host_us_per_image = 2000.0f;
+    char reserve[8];
+} DVPPHybridResizeConfig;
+
+typedef struct{
+    uint64_t batch_count = 0;
+    uint64_t failed_count = 0;
+    uint64_t device_image_count = 0;
+    uint64_t host_image_count = 0;
+    float device_us_per_image = 0.0f;  // current estimates
+    float host_us_per_image = 0.0f;
+    uint64_t idle_us = 0;              // sum over batches of how long the faster path waited for the slower one
+    uint64_t total_us = 0;
+} DVPPHybridResizeStats;
+
+/**
+* @brief one path of HybridResize, resizes host images into host slots of the DVPPResizeInitConfig layout
+*/
+class HybridResizeWorker {
+public:
+    virtual ~HybridResizeWorker() {}
+
+    /**
+    * @param [out] output: slot i starts at output + i * ALIGN_UP16(resized_width) * 3 * ALIGN_UP2(resized_height)
+    * @return 1 success, 0 failed
+    */
+    virtual int Process(const DVPPImageData* images, const RectInt* rois, int img_num, uint8_t* output) = 0;
+
+    virtual void DestroyResource() = 0;
+};
+
+/**
+* @brief host path: CpuResize over pool, paced to sim_us_per_image per image when > 0 to stand in for another speed
+* @return nullptr if Init failed
+*/
+HybridResizeWorker* CreateHostResizeWorker(const DVPPResizeInitConfig& config, WorkerPool* pool,
+                                           float sim_us_per_image = 0.0f);
+
+/**
+* @brief vpc path: uploads the host images, resizes them by DvppResize into a device batch and reads it back in one copy
+* @return nullptr if Init failed
+*/
+HybridResizeWorker* CreateDeviceResizeWorker(const DVPPResizeInitConfig& config);
+
+/**
+* @brief splits every batch between the vpc and the host SIMD resize so that both finish together:
+*        the first n_device images go to the vpc(uploaded, resized, read back) on a dedicated thread,
+*        the rest to CpuResize on the calling thread and the pool, n_device follows the moving average
+*        of the per-image cost of both paths, all results land in one host batch with the same layout
+*/
+class HybridResize {
+public:
+    HybridResize();
+
+    ~HybridResize();
+
+    /**
+    * @param [in] pool: workers of the host path, nullptr runs it on the calling thread
+    */
+    void Init(const DVPPHybridResizeConfig* config, WorkerPool* pool = nullptr);
+
+    /**
+    * @param [in] srcImage: host images, img_num <= batch_size
+    * @param [in] rois: nullptr resizes the full images
+    * @return 1 success, 0 failed
+    */
+    int Process(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief host result of the last Process
+    */
+    int Get(DVPPImageData& resizedImage, int index) const;
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPHybridResizeStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    /**
+    * @brief images of a batch of img_num that go to the vpc with the current estimates
+    */
+    int DeviceShare(int img_num);
+
+    void DestroyResource();
+
+private:
+    void DeviceLoop();
+
+private:
+    DVPPHybridResizeConfig config_;
+    std::unique_ptr<HybridResizeWorker> device_worker_;
+    std::unique_ptr<HybridResizeWorker> host_worker_;
+
+    std::vector<uint8_t> out_data_;
+    uint32_t out_width_stride_;
+    uint32_t out_buffer_size_;
+
+    // hand-off to the device thread
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread device_thread_;
+    bool stop_;
+    bool device_pending_;
+    const DVPPImageData* device_images_;
+    const RectInt* device_rois_;
+    int device_num_;
+    int device_ret_;
+    uint64_t device_us_;
+
+    float device_us_per_image_;
+    float host_us_per_image_;
+    uint32_t device_idle_batches_;
+    uint32_t host_idle_batches_;
+
+    DVPPHybridResizeStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_HYBRID_RESIZE_H
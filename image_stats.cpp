@@ -0,0 +1,303 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <vector>
+#include <cstring>
+#include "image_stats.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define STATS_HAS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include "common/utils/simd_shuffle.hpp"
+#define STATS_HAS_AVX2 1
+#endif
+
+// 32 bit lanes of the Laplacian sums are flushed to 64 bit every this many vectors: a lane takes two squares of
+// |lap| <= 1020 per vector, 2 * 256 * 1020^2 < 2^31, the lanes are widened to 64 bit before they are added up
+#define STATS_FLUSH_VECTORS 256
+
+// kernels start at pixel 0 and return the pixels they handled, the scalar ones finish the row
+typedef int (*LumaRowFunc)(const uint8_t* bgr, uint8_t* luma, int width, uint64_t sums[3]);
+typedef int (*LaplacianRowFunc)(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width,
+                                int64_t& sum, int64_t& sum_sq);
+
+static inline int LumaOf(int b, int g, int r)
+{
+    return (29 * b + 150 * g + 77 * r + 128) >> 8;
+}
+
+static void LumaRowScalar(const uint8_t* bgr, uint8_t* luma, int x_begin, int width, uint64_t sums[3])
+{
+    for (int x = x_begin; x < width; ++x)
+    {
+        int b = bgr[3 * x];
+        int g = bgr[3 * x + 1];
+        int r = bgr[3 * x + 2];
+        luma[x] = static_cast<uint8_t>(LumaOf(b, g, r));
+        sums[0] += b;
+        sums[1] += g;
+        sums[2] += r;
+    }
+}
+
+// interior pixels [x_begin, width - 1)
+static void LaplacianRowScalar(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int x_begin, int width,
+                               int64_t& sum, int64_t& sum_sq)
+{
+    for (int x = x_begin; x < width - 1; ++x)
+    {
+        int lap = up[x] + down[x] + mid[x - 1] + mid[x + 1] - 4 * mid[x];
+        sum += lap;
+        sum_sq += lap * lap;
+    }
+}
+
+#if defined(STATS_HAS_NEON)
+static int LumaRowNeon(const uint8_t* bgr, uint8_t* luma, int width, uint64_t sums[3])
+{
+    uint8x8_t cb = vdup_n_u8(29);
+    uint8x8_t cg = vdup_n_u8(150);
+    uint8x8_t cr = vdup_n_u8(77);
+    uint16x8_t round = vdupq_n_u16(128);
+    uint32x4_t acc[3] = {vdupq_n_u32(0), vdupq_n_u32(0), vdupq_n_u32(0)};
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t px = vld3q_u8(bgr + 3 * x);
+        uint16x8_t lo = vmlal_u8(vmlal_u8(vmlal_u8(round, vget_low_u8(px.val[0]), cb), vget_low_u8(px.val[1]), cg),
+                                 vget_low_u8(px.val[2]), cr);
+        uint16x8_t hi = vmlal_u8(vmlal_u8(vmlal_u8(round, vget_high_u8(px.val[0]), cb), vget_high_u8(px.val[1]), cg),
+                                 vget_high_u8(px.val[2]), cr);
+        vst1q_u8(luma + x, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+        for (int k = 0; k < 3; ++k)
+        {
+            acc[k] = vpadalq_u16(acc[k], vpaddlq_u8(px.val[k]));
+        }
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        sums[k] += vaddvq_u32(acc[k]);
+    }
+    return x;
+}
+
+static int LaplacianRowNeon(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width,
+                            int64_t& sum, int64_t& sum_sq)
+{
+    int32x4_t acc = vdupq_n_s32(0);
+    int32x4_t acc_sq = vdupq_n_s32(0);
+    int vectors = 0;
+    int x = 1;
+    for (; x + 8 <= width - 1; x += 8)
+    {
+        int16x8_t around = vreinterpretq_s16_u16(vaddq_u16(vaddl_u8(vld1_u8(up + x), vld1_u8(down + x)),
+                                                           vaddl_u8(vld1_u8(mid + x - 1), vld1_u8(mid + x + 1))));
+        int16x8_t center = vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(mid + x), 2));
+        int16x8_t lap = vsubq_s16(around, center);
+        acc = vpadalq_s16(acc, lap);
+        acc_sq = vmlal_s16(acc_sq, vget_low_s16(lap), vget_low_s16(lap));
+        acc_sq = vmlal_s16(acc_sq, vget_high_s16(lap), vget_high_s16(lap));
+        if (++vectors == STATS_FLUSH_VECTORS)
+        {
+            sum += vaddvq_s64(vpaddlq_s32(acc));
+            sum_sq += vaddvq_s64(vpaddlq_s32(acc_sq));
+            acc = vdupq_n_s32(0);
+            acc_sq = vdupq_n_s32(0);
+            vectors = 0;
+        }
+    }
+    sum += vaddvq_s64(vpaddlq_s32(acc));
+    sum_sq += vaddvq_s64(vpaddlq_s32(acc_sq));
+    return x;
+}
+#endif
+
+#if defined(STATS_HAS_AVX2)
+// every lane is widened to 64 bit first, the sum of eight lanes does not fit 32 bit
+__attribute__((target("avx2")))
+static inline int64_t SumEpi32Avx2(__m256i val)
+{
+    __m256i wide = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(val)),
+                                    _mm256_cvtepi32_epi64(_mm256_extracti128_si256(val, 1)));
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+    return _mm_cvtsi128_si64(sum);
+}
+
+__attribute__((target("avx2")))
+static int LumaRowAvx2(const uint8_t* bgr, uint8_t* luma, int width, uint64_t sums[3])
+{
+    const alg_utils::ShuffleTables& tables = alg_utils::GetShuffleTables();
+    __m128i split[3][3];
+    for (int k = 0; k < 3; ++k)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            split[k][m] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.split[k][m]));
+        }
+    }
+    // 16 bit products wrap as unsigned, 29 * 255 + 150 * 255 + 77 * 255 + 128 < 65536
+    const __m256i coef[3] = {_mm256_set1_epi16(29), _mm256_set1_epi16(150), _mm256_set1_epi16(77)};
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[3] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8_t* src = bgr + 3 * x;
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+        __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+        __m256i y = round;
+        for (int k = 0; k < 3; ++k)
+        {
+            __m128i bytes = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, split[k][0]), _mm_shuffle_epi8(a1, split[k][1])),
+                                         _mm_shuffle_epi8(a2, split[k][2]));
+            __m256i ch = _mm256_cvtepu8_epi16(bytes);
+            y = _mm256_add_epi16(y, _mm256_mullo_epi16(ch, coef[k]));
+            acc[k] = _mm256_add_epi32(acc[k], _mm256_madd_epi16(ch, ones));
+        }
+        y = _mm256_srli_epi16(y, 8);
+        __m256i packed = _mm256_packus_epi16(y, y);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + x), _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, 0x08)));
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+        sums[k] += SumEpi32Avx2(acc[k]);
+    }
+    return x;
+}
+
+__attribute__((target("avx2")))
+static int LaplacianRowAvx2(const uint8_t* up, const uint8_t* mid, const uint8_t* down, int width,
+                            int64_t& sum, int64_t& sum_sq)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    __m256i acc_sq = _mm256_setzero_si256();
+    int vectors = 0;
+    int x = 1;
+    for (; x + 16 <= width - 1; x += 16)
+    {
+        __m256i u = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x)));
+        __m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down + x)));
+        __m256i l = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + x - 1)));
+        __m256i r = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + x + 1)));
+        __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + x)));
+        __m256i lap = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(u, d), _mm256_add_epi16(l, r)),
+                                       _mm256_slli_epi16(c, 2));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(lap, ones));
+        acc_sq = _mm256_add_epi32(acc_sq, _mm256_madd_epi16(lap, lap));
+        if (++vectors == STATS_FLUSH_VECTORS)
+        {
+            sum += SumEpi32Avx2(acc);
+            sum_sq += SumEpi32Avx2(acc_sq);
+            acc = _mm256_setzero_si256();
+            acc_sq = _mm256_setzero_si256();
+            vectors = 0;
+        }
+    }
+    sum += SumEpi32Avx2(acc);
+    sum_sq += SumEpi32Avx2(acc_sq);
+    return x;
+}
+#endif
+
+typedef struct{
+    LumaRowFunc luma_row;
+    LaplacianRowFunc laplacian_row;
+    const char* isa;
+} StatsKernels;
+
+static StatsKernels PickKernels()
+{
+    StatsKernels kernels = {nullptr, nullptr, "scalar"};
+#if defined(STATS_HAS_NEON)
+    kernels.luma_row = LumaRowNeon;
+    kernels.laplacian_row = LaplacianRowNeon;
+    kernels.isa = "neon";
+#elif defined(STATS_HAS_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.luma_row = LumaRowAvx2;
+        kernels.laplacian_row = LaplacianRowAvx2;
+        kernels.isa = "avx2";
+    }
+#endif
+    return kernels;
+}
+
+static const StatsKernels& SimdKernels()
+{
+    static const StatsKernels kernels = PickKernels();
+    return kernels;
+}
+
+const char* ImageStatsIsa()
+{
+    return SimdKernels().isa;
+}
+
+int ComputeImageStats(const uint8_t* bgr, uint32_t stride, const RectInt& area, DVPPImageStats& stats, bool use_simd)
+{
+    stats = DVPPImageStats();
+    int width = area.xmax - area.xmin + 1;
+    int height = area.ymax - area.ymin + 1;
+    if (!bgr || width <= 0 || height <= 0)
+    {
+        return 0;
+    }
+    static const StatsKernels scalar = {nullptr, nullptr, "scalar"};
+    const StatsKernels& kernels = use_simd ? SimdKernels() : scalar;
+
+    // ring of three luma rows, the Laplacian of row y is taken once row y + 1 is converted
+    static thread_local std::vector<uint8_t> luma_rows;
+    if (luma_rows.size() < 3 * static_cast<size_t>(width))
+    {
+        luma_rows.resize(3 * static_cast<size_t>(width));
+    }
+    uint64_t sums[3] = {0, 0, 0};
+    int64_t lap_sum = 0;
+    int64_t lap_sum_sq = 0;
+    for (int row = 0; row < height; ++row)
+    {
+        const uint8_t* src = bgr + static_cast<size_t>(area.ymin + row) * stride + area.xmin * 3;
+        uint8_t* luma = luma_rows.data() + static_cast<size_t>(row % 3) * width;
+        int x = kernels.luma_row ? kernels.luma_row(src, luma, width, sums) : 0;
+        LumaRowScalar(src, luma, x, width, sums);
+        for (int col = 0; col < width; ++col)
+        {
+            stats.histogram[luma[col]]++;
+        }
+        if (row >= 2 && width >= 3)
+        {
+            const uint8_t* up = luma_rows.data() + static_cast<size_t>((row - 2) % 3) * width;
+            const uint8_t* mid = luma_rows.data() + static_cast<size_t>((row - 1) % 3) * width;
+            x = kernels.laplacian_row ? kernels.laplacian_row(up, mid, luma, width, lap_sum, lap_sum_sq) : 1;
+            LaplacianRowScalar(up, mid, luma, x, width, lap_sum, lap_sum_sq);
+        }
+    }
+
+    uint64_t luma_sum = 0;
+    for (int bin = 0; bin < DVPP_STATS_HIST_BINS; ++bin)
+    {
+        luma_sum += static_cast<uint64_t>(bin) * stats.histogram[bin];
+    }
+    double count = static_cast<double>(width) * height;
+    stats.pixel_count = static_cast<uint32_t>(width) * height;
+    stats.mean_luma = static_cast<float>(luma_sum / count);
+    for (int k = 0; k < 3; ++k)
+    {
+        stats.mean_bgr[k] = static_cast<float>(sums[k] / count);
+    }
+    if (width >= 3 && height >= 3)
+    {
+        double interior = static_cast<double>(width - 2) * (height - 2);
+        double mean = lap_sum / interior;
+        stats.laplacian_var = static_cast<float>(lap_sum_sq / interior - mean * mean);
+    }
+    return 1;
+}
@@ -0,0 +1,36 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_IMAGE_STATS_H
+#define _PICTURE_INC_IMAGE_STATS_H
+
+#include <cstdint>
+#include "data_type.h"
+
+#define DVPP_STATS_HIST_BINS 256
+
+typedef struct{
+    uint32_t pixel_count = 0;
+    float mean_luma = 0.0f;                      // Y = (29B + 150G + 77R + 128) >> 8, full range
+    float mean_bgr[3] = {0.0f, 0.0f, 0.0f};
+    float laplacian_var = 0.0f;                  // variance of the 4-neighbour Laplacian of Y over interior pixels, low: blurred
+    uint32_t histogram[DVPP_STATS_HIST_BINS] = {0};  // of Y
+} DVPPImageStats;
+
+/**
+* @brief mean, luma histogram and Laplacian variance of a BGR_888 area in one pass over its rows,
+*        every row is turned into luma once(NEON/AVX2) and kept for the Laplacian of the row above,
+*        the SIMD kernels give the same results as the scalar ones
+* @param [in] area: inclusive rectangle inside the image, e.g. the paste area of a resized image
+* @return 1 success, 0 empty area
+*/
+int ComputeImageStats(const uint8_t* bgr, uint32_t stride, const RectInt& area, DVPPImageStats& stats,
+                      bool use_simd = true);
+
+/**
+* @brief "neon", "avx2" or "scalar", the kernels ComputeImageStats uses with use_simd
+*/
+const char* ImageStatsIsa();
+
+#endif // _PICTURE_INC_IMAGE_STATS_H
@@ -0,0 +1,550 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include "incremental_resize.h"
+#include "dvpp_timeline.h"
+#include "alg_define.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TILE_HASH_HAS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TILE_HASH_HAS_AVX2 1
+#endif
+
+// four sets of 8 lanes, row r of a tile goes to set r % 4, so that four multiply chains are in flight
+#define TILE_HASH_SETS 4
+#define TILE_HASH_LANES (8 * TILE_HASH_SETS)
+#define TILE_HASH_BLOCK 32
+#define TILE_HASH_PRIME 0x9E3779B1u
+
+// hash the TILE_HASH_BLOCK byte blocks [0, blocks) of rows rows, lane i of a set takes bytes [4 * i, 4 * i + 4)
+typedef void (*HashBlocksFunc)(const uint8_t* data, uint32_t stride, int rows, int blocks, uint32_t mask,
+                               uint32_t* lanes);
+
+static void HashBlocksScalar(const uint8_t* data, uint32_t stride, int rows, int blocks, uint32_t mask,
+                             uint32_t* lanes)
+{
+    for (int row = 0; row < rows; ++row)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        uint32_t* set = lanes + 8 * (row % TILE_HASH_SETS);
+        for (int blk = 0; blk < blocks; ++blk, ptr += TILE_HASH_BLOCK)
+        {
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                uint32_t word;
+                std::memcpy(&word, ptr + 4 * lane, 4);
+                set[lane] = (set[lane] ^ (word & mask)) * TILE_HASH_PRIME;
+            }
+        }
+    }
+}
+
+#if defined(TILE_HASH_HAS_NEON)
+static inline uint32x4_t HashHalfBlockNeon(uint32x4_t acc, const uint8_t* ptr, uint32x4_t vmask, uint32x4_t prime)
+{
+    return vmulq_u32(veorq_u32(acc, vandq_u32(vreinterpretq_u32_u8(vld1q_u8(ptr)), vmask)), prime);
+}
+
+static void HashBlocksNeon(const uint8_t* data, uint32_t stride, int rows, int blocks, uint32_t mask,
+                           uint32_t* lanes)
+{
+    uint32x4_t vmask = vdupq_n_u32(mask);
+    uint32x4_t prime = vdupq_n_u32(TILE_HASH_PRIME);
+    uint32x4_t acc[2 * TILE_HASH_SETS];
+    for (int half = 0; half < 2 * TILE_HASH_SETS; ++half)
+    {
+        acc[half] = vld1q_u32(lanes + 4 * half);
+    }
+    int row = 0;
+    for (; row + TILE_HASH_SETS <= rows; row += TILE_HASH_SETS)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        for (int blk = 0; blk < blocks; ++blk, ptr += TILE_HASH_BLOCK)
+        {
+            for (int set = 0; set < TILE_HASH_SETS; ++set)
+            {
+                acc[2 * set] = HashHalfBlockNeon(acc[2 * set], ptr + set * stride, vmask, prime);
+                acc[2 * set + 1] = HashHalfBlockNeon(acc[2 * set + 1], ptr + set * stride + 16, vmask, prime);
+            }
+        }
+    }
+    for (int set = 0; row < rows; ++row, ++set)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        for (int blk = 0; blk < blocks; ++blk, ptr += TILE_HASH_BLOCK)
+        {
+            acc[2 * set] = HashHalfBlockNeon(acc[2 * set], ptr, vmask, prime);
+            acc[2 * set + 1] = HashHalfBlockNeon(acc[2 * set + 1], ptr + 16, vmask, prime);
+        }
+    }
+    for (int half = 0; half < 2 * TILE_HASH_SETS; ++half)
+    {
+        vst1q_u32(lanes + 4 * half, acc[half]);
+    }
+}
+#endif
+
+#if defined(TILE_HASH_HAS_AVX2)
+__attribute__((target("avx2")))
+static inline __m256i HashBlockAvx2(__m256i acc, const uint8_t* ptr, __m256i vmask, __m256i prime)
+{
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    return _mm256_mullo_epi32(_mm256_xor_si256(acc, _mm256_and_si256(block, vmask)), prime);
+}
+
+__attribute__((target("avx2")))
+static void HashBlocksAvx2(const uint8_t* data, uint32_t stride, int rows, int blocks, uint32_t mask,
+                           uint32_t* lanes)
+{
+    __m256i vmask = _mm256_set1_epi32(static_cast<int>(mask));
+    __m256i prime = _mm256_set1_epi32(static_cast<int>(TILE_HASH_PRIME));
+    __m256i acc[TILE_HASH_SETS];
+    for (int set = 0; set < TILE_HASH_SETS; ++set)
+    {
+        acc[set] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes + 8 * set));
+    }
+    int row = 0;
+    for (; row + TILE_HASH_SETS <= rows; row += TILE_HASH_SETS)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        for (int blk = 0; blk < blocks; ++blk, ptr += TILE_HASH_BLOCK)
+        {
+            for (int set = 0; set < TILE_HASH_SETS; ++set)
+            {
+                acc[set] = HashBlockAvx2(acc[set], ptr + set * stride, vmask, prime);
+            }
+        }
+    }
+    for (int set = 0; row < rows; ++row, ++set)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        for (int blk = 0; blk < blocks; ++blk, ptr += TILE_HASH_BLOCK)
+        {
+            acc[set] = HashBlockAvx2(acc[set], ptr, vmask, prime);
+        }
+    }
+    for (int set = 0; set < TILE_HASH_SETS; ++set)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes + 8 * set), acc[set]);
+    }
+}
+#endif
+
+typedef struct{
+    HashBlocksFunc hash_blocks;
+    const char* isa;
+} TileHashKernels;
+
+static TileHashKernels PickKernels()
+{
+    TileHashKernels kernels = {nullptr, "scalar"};
+#if defined(TILE_HASH_HAS_NEON)
+    kernels.hash_blocks = HashBlocksNeon;
+    kernels.isa = "neon";
+#elif defined(TILE_HASH_HAS_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.hash_blocks = HashBlocksAvx2;
+        kernels.isa = "avx2";
+    }
+#endif
+    return kernels;
+}
+
+static const TileHashKernels& SimdKernels()
+{
+    static const TileHashKernels kernels = PickKernels();
+    return kernels;
+}
+
+const char* TileHashIsa()
+{
+    return SimdKernels().isa;
+}
+
+// the blocks of all rows first, then the bytes after the last block of every row one by one into lane 0 of its set
+static void HashArea(HashBlocksFunc hash_blocks, const uint8_t* data, uint32_t stride, int rows, int bytes,
+                     uint32_t mask, uint32_t* lanes)
+{
+    int blocks = bytes / TILE_HASH_BLOCK;
+    if (blocks > 0)
+    {
+        hash_blocks(data, stride, rows, blocks, mask, lanes);
+    }
+    for (int row = 0; row < rows; ++row)
+    {
+        const uint8_t* ptr = data + static_cast<size_t>(row) * stride;
+        uint32_t* set = lanes + 8 * (row % TILE_HASH_SETS);
+        for (int idx = blocks * TILE_HASH_BLOCK; idx < bytes; ++idx)
+        {
+            set[0] = (set[0] ^ (ptr[idx] & mask & 0xffu)) * TILE_HASH_PRIME;
+        }
+    }
+}
+
+static inline uint64_t FinishTileHash(const uint32_t* lanes)
+{
+    // every step is invertible, a difference in one lane is never lost
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (int lane = 0; lane < TILE_HASH_LANES; ++lane)
+    {
+        hash = (hash ^ lanes[lane]) * 0x100000001b3ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void ComputeTileHashes(const DVPPImageData &image, uint32_t format, uint32_t tile_width, uint32_t tile_height,
+                       uint32_t ignore_low_bits, int tile_row_begin, int tile_row_end, uint64_t *hashes,
+                       bool use_simd)
+{
+    HashBlocksFunc hash_blocks = use_simd && SimdKernels().hash_blocks ? SimdKernels().hash_blocks : HashBlocksScalar;
+    uint32_t width_stride, height_stride, buffer_size;
+    GetDvppInputStride(format, image, width_stride, height_stride, buffer_size);
+    bool is_bgr = PIXEL_FORMAT_BGR_888 == format;
+    int pixel_step = is_bgr ? 3 : 1;
+    const uint8_t* uv = image.data + static_cast<size_t>(width_stride) * height_stride;
+    uint32_t byte_mask = (0xffu << std::min<uint32_t>(ignore_low_bits, 8)) & 0xffu;
+    uint32_t mask = byte_mask * 0x01010101u;
+    int width = image.width;
+    int height = image.height;
+    int tiles_x = (width + tile_width - 1) / tile_width;
+    for (int ty = tile_row_begin; ty < tile_row_end; ++ty)
+    {
+        int y0 = ty * tile_height;
+        int y1 = std::min<int>(y0 + tile_height, height);
+        for (int tx = 0; tx < tiles_x; ++tx)
+        {
+            int x0 = tx * tile_width;
+            int x1 = std::min<int>(x0 + tile_width, width);
+            uint32_t lanes[TILE_HASH_LANES];
+            for (int lane = 0; lane < TILE_HASH_LANES; ++lane)
+            {
+                lanes[lane] = 0x811C9DC5u + lane;
+            }
+            HashArea(hash_blocks, image.data + static_cast<size_t>(y0) * width_stride + x0 * pixel_step,
+                     width_stride, y1 - y0, (x1 - x0) * pixel_step, mask, lanes);
+            if (!is_bgr)
+            {
+                // interleaved uv of the tile, tiles are even so every uv pair belongs to one tile
+                HashArea(hash_blocks, uv + static_cast<size_t>(y0 / 2) * width_stride + x0, width_stride,
+                         (y1 + 1) / 2 - y0 / 2, ALIGN_UP2(x1) - x0, mask, lanes);
+            }
+            *hashes++ = FinishTileHash(lanes);
+        }
+    }
+}
+
+IncrementalResize::IncrementalResize() : pool_(nullptr), out_width_stride_(0), out_buffer_size_(0),
+                                         has_init_over_(false)
+{
+
+}
+
+IncrementalResize::~IncrementalResize()
+{
+    DestroyResource();
+}
+
+void IncrementalResize::Init(const DVPPIncrementalConfig *config, WorkerPool *pool)
+{
+    config_ = *config;
+    pool_ = pool;
+    const DVPPResizeInitConfig& resize_config = config_.resize_config;
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    if (0 == config_.max_streams)
+    {
+        AIALG_ERROR("max_streams must be > 0\n");
+        return;
+    }
+    if (0 == config_.tile_width || 0 == config_.tile_height || config_.tile_width % 2 || config_.tile_height % 2)
+    {
+        AIALG_ERROR("tile_width and tile_height must be even and > 0, tile = %dx%d\n", config_.tile_width,
+                    config_.tile_height);
+        return;
+    }
+    config_.ignore_low_bits = std::min<uint32_t>(config_.ignore_low_bits, 7);
+    full_worker_.reset(config_.use_cpu ? CreateHostResizeWorker(resize_config, pool) :
+                       CreateDeviceResizeWorker(resize_config));
+    if (!full_worker_)
+    {
+        return;
+    }
+    // ProcessDirty writes into the stream slots, no batch of its own
+    DVPPResizeInitConfig dirty_config = resize_config;
+    dirty_config.batch_size = 1;
+    dirty_resize_.Init(&dirty_config);
+    if (!dirty_resize_.HasInit())
+    {
+        return;
+    }
+    dirty_resize_.SetWorkerPool(pool);
+
+    out_width_stride_ = ALIGN_UP16(resize_config.resized_width) * 3;
+    out_buffer_size_ = out_width_stride_ * ALIGN_UP2(resize_config.resized_height);
+    full_output_.resize(static_cast<size_t>(out_buffer_size_) * resize_config.batch_size);
+    streams_.assign(config_.max_streams, StreamState());
+    hashes_.resize(resize_config.batch_size);
+    tiles_x_.resize(resize_config.batch_size);
+    tile_rows_.resize(resize_config.batch_size);
+    job_offsets_.resize(resize_config.batch_size + 1);
+    stats_ = DVPPIncrementalStats();
+    has_init_over_ = true;
+}
+
+void IncrementalResize::DestroyResource()
+{
+    if (full_worker_)
+    {
+        full_worker_->DestroyResource();
+        full_worker_.reset();
+    }
+    dirty_resize_.DestroyResource();
+    std::vector<uint8_t>().swap(full_output_);
+    std::vector<StreamState>().swap(streams_);
+    std::vector<std::vector<uint64_t> >().swap(hashes_);
+    std::vector<RectInt>().swap(dirty_);
+    last_streams_.clear();
+    has_init_over_ = false;
+}
+
+void IncrementalResize::HashFrames(const DVPPImageData *srcImage, int img_num)
+{
+    DVPP_TIMELINE_SCOPE("incremental_resize", "hash", img_num);
+    // one job per tile row, spread over the pool together with the tile rows of the other frames
+    job_offsets_[0] = 0;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        tiles_x_[idx] = (srcImage[idx].width + config_.tile_width - 1) / config_.tile_width;
+        tile_rows_[idx] = (srcImage[idx].height + config_.tile_height - 1) / config_.tile_height;
+        hashes_[idx].resize(static_cast<size_t>(tiles_x_[idx]) * tile_rows_[idx]);
+        job_offsets_[idx + 1] = job_offsets_[idx] + tile_rows_[idx];
+    }
+    WorkerPool::RangeFunc run = [&](int begin, int end, int) {
+        for (int job = begin; job < end; ++job)
+        {
+            int idx = static_cast<int>(std::upper_bound(job_offsets_.begin(), job_offsets_.begin() + img_num + 1, job) -
+                                       job_offsets_.begin()) - 1;
+            int tile_row = job - job_offsets_[idx];
+            ComputeTileHashes(srcImage[idx], config_.resize_config.input_format, config_.tile_width,
+                              config_.tile_height, config_.ignore_low_bits, tile_row, tile_row + 1,
+                              hashes_[idx].data() + static_cast<size_t>(tile_row) * tiles_x_[idx]);
+        }
+    };
+    if (pool_)
+    {
+        pool_->ParallelFor(0, job_offsets_[img_num], run);
+    }
+    else
+    {
+        run(0, job_offsets_[img_num], 0);
+    }
+}
+
+int IncrementalResize::CollectDirty(const DVPPImageData &image, int idx, std::vector<RectInt> &dirty)
+{
+    const std::vector<uint64_t>& hashes = hashes_[idx];
+    const std::vector<uint64_t>& last = streams_[last_streams_[idx]].hashes;
+    int tiles_x = tiles_x_[idx];
+    int dirty_tiles = 0;
+    dirty.clear();
+    for (int ty = 0; ty < tile_rows_[idx]; ++ty)
+    {
+        const uint64_t* row = hashes.data() + static_cast<size_t>(ty) * tiles_x;
+        const uint64_t* last_row = last.data() + static_cast<size_t>(ty) * tiles_x;
+        for (int tx = 0; tx < tiles_x; ++tx)
+        {
+            if (row[tx] == last_row[tx])
+            {
+                continue;
+            }
+            int run_end = tx + 1;
+            while (run_end < tiles_x && row[run_end] != last_row[run_end])
+            {
+                run_end++;
+            }
+            RectInt rect;
+            rect.xmin = tx * config_.tile_width;
+            rect.xmax = std::min<int>(run_end * config_.tile_width, image.width) - 1;
+            rect.ymin = ty * config_.tile_height;
+            rect.ymax = std::min<int>((ty + 1) * config_.tile_height, image.height) - 1;
+            rect.width = rect.xmax - rect.xmin + 1;
+            rect.height = rect.ymax - rect.ymin + 1;
+            dirty.push_back(rect);
+            dirty_tiles += run_end - tx;
+            tx = run_end;
+        }
+    }
+    return dirty_tiles;
+}
+
+int IncrementalResize::Process(const DVPPImageData *srcImage, const uint32_t *stream_ids, int img_num)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("IncrementalResize has not init\n");
+        return 0;
+    }
+    if (!srcImage || !stream_ids || img_num <= 0 || img_num > static_cast<int>(config_.resize_config.batch_size))
+    {
+        AIALG_ERROR("img_num must be in [1, batch_size], img_num = %d, batch_size = %d\n", img_num,
+                    config_.resize_config.batch_size);
+        return 0;
+    }
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (stream_ids[idx] >= config_.max_streams || !srcImage[idx].data || 0 == srcImage[idx].width ||
+            0 == srcImage[idx].height || std::find(stream_ids, stream_ids + idx, stream_ids[idx]) != stream_ids + idx)
+        {
+            AIALG_ERROR("invalid frame %d of stream %u(max_streams = %u, a stream once per batch)\n", idx,
+                        stream_ids[idx], config_.max_streams);
+            return 0;
+        }
+    }
+
+    DVPP_TIMELINE_SCOPE("incremental_resize", "process", img_num);
+    last_streams_.assign(stream_ids, stream_ids + img_num);
+    std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
+    HashFrames(srcImage, img_num);
+    std::chrono::time_point<std::chrono::steady_clock> hashed = std::chrono::steady_clock::now();
+    stats_.detect_us += std::chrono::duration_cast<std::chrono::microseconds>(hashed - start).count();
+
+    full_frames_.clear();
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        StreamState& stream = streams_[stream_ids[idx]];
+        stream.stats.frame_count++;
+        stats_.frame_count++;
+        if (stream.width != srcImage[idx].width || stream.height != srcImage[idx].height ||
+            (config_.refresh_interval > 0 && stream.frames_since_full + 1 >= config_.refresh_interval))
+        {
+            full_frames_.push_back(idx);
+            continue;
+        }
+        int dirty_tiles = CollectDirty(srcImage[idx], idx, dirty_);
+        stream.stats.tile_count += hashes_[idx].size();
+        stream.stats.dirty_tile_count += dirty_tiles;
+        stats_.tile_count += hashes_[idx].size();
+        stats_.dirty_tile_count += dirty_tiles;
+        if (0 == dirty_tiles)
+        {
+            stream.frames_since_full++;
+            stream.stats.skipped_count++;
+            stats_.skipped_count++;
+            continue;
+        }
+        if (dirty_tiles > config_.max_dirty_fraction * hashes_[idx].size() ||
+            !(config_.use_cpu || config_.partial_on_host))
+        {
+            full_frames_.push_back(idx);
+            continue;
+        }
+        int pixels = dirty_resize_.ProcessDirty(srcImage[idx], dirty_.data(), static_cast<int>(dirty_.size()),
+                                                stream.output.data());
+        if (pixels < 0)
+        {
+            // e.g. a scale ratio that needs a cascade
+            full_frames_.push_back(idx);
+            continue;
+        }
+        stream.hashes.swap(hashes_[idx]);
+        stream.frames_since_full++;
+        stream.stats.partial_count++;
+        stream.stats.redone_pixels += pixels;
+        stats_.partial_count++;
+        stats_.redone_pixels += pixels;
+    }
+
+    int ret = 1;
+    if (!full_frames_.empty())
+    {
+        int full_num = static_cast<int>(full_frames_.size());
+        full_images_.resize(full_num);
+        for (int num = 0; num < full_num; ++num)
+        {
+            full_images_[num] = srcImage[full_frames_[num]];
+        }
+        if (1 != full_worker_->Process(full_images_.data(), nullptr, full_num, full_output_.data()))
+        {
+            AIALG_ERROR("resize of %d whole frames failed\n", full_num);
+            for (int num = 0; num < full_num; ++num)
+            {
+                ResetStream(stream_ids[full_frames_[num]]);
+            }
+            ret = 0;
+        }
+        else
+        {
+            for (int num = 0; num < full_num; ++num)
+            {
+                int idx = full_frames_[num];
+                StreamState& stream = streams_[stream_ids[idx]];
+                stream.output.resize(out_buffer_size_);
+                std::memcpy(stream.output.data(), full_output_.data() + static_cast<size_t>(num) * out_buffer_size_,
+                            out_buffer_size_);
+                stream.width = srcImage[idx].width;
+                stream.height = srcImage[idx].height;
+                stream.hashes.swap(hashes_[idx]);
+                stream.frames_since_full = 0;
+                stream.stats.full_count++;
+                stats_.full_count++;
+            }
+        }
+    }
+    stats_.resize_us += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - hashed).count();
+    return ret;
+}
+
+int IncrementalResize::Get(DVPPImageData &resizedImage, int index) const
+{
+    if (index < 0 || index >= static_cast<int>(last_streams_.size()) ||
+        streams_[last_streams_[index]].output.empty())
+    {
+        AIALG_ERROR("no output of frame %d\n", index);
+        return 0;
+    }
+    resizedImage.width = config_.resize_config.resized_width;
+    resizedImage.height = config_.resize_config.resized_height;
+    resizedImage.alignWidth = out_width_stride_;
+    resizedImage.alignHeight = ALIGN_UP2(config_.resize_config.resized_height);
+    resizedImage.size = out_buffer_size_;
+    resizedImage.data = const_cast<uint8_t*>(streams_[last_streams_[index]].output.data());
+    return 1;
+}
+
+int IncrementalResize::GetStreamStats(uint32_t stream_id, DVPPIncrementalStats &stats) const
+{
+    if (stream_id >= streams_.size())
+    {
+        AIALG_ERROR("stream %u out of max_streams %zu\n", stream_id, streams_.size());
+        return 0;
+    }
+    stats = streams_[stream_id].stats;
+    return 1;
+}
+
+void IncrementalResize::ResetStream(uint32_t stream_id)
+{
+    if (stream_id >= streams_.size())
+    {
+        return;
+    }
+    StreamState& stream = streams_[stream_id];
+    stream.width = 0;
+    stream.height = 0;
+    stream.frames_since_full = 0;
+    stream.hashes.clear();
+}
@@ -0,0 +1,154 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_INCREMENTAL_RESIZE_H
+#define _PICTURE_INC_INCREMENTAL_RESIZE_H
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "cpu_resize.h"
+#include "hybrid_resize.h"
+#include "worker_pool.h"
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // full host frames in, host outputs, batch_size frames per Process
+    uint32_t max_streams = 64;           // stream ids are 0 .. max_streams - 1
+    uint32_t tile_width = 64;            // change detection grid of the source, even
+    uint32_t tile_height = 32;
+    uint32_t ignore_low_bits = 0;        // low bits of every byte left out of the hashes, e.g. 2 against sensor noise
+    float max_dirty_fraction = 0.5f;     // a frame with more changed tiles is resized whole
+    uint32_t refresh_interval = 250;     // a stream is resized whole at least every this many frames, 0: only if needed
+    uint32_t use_cpu = 0;                // 1: CpuResize for whole frames too, no acl calls
+    uint32_t partial_on_host = 0;        // vpc: 1 redoes the changed tiles with the host kernels, whose pixels differ
+                                         // slightly from the vpc ones, 0: a changed frame is resized whole on the vpc
+    char reserve[8];
+} DVPPIncrementalConfig;
+
+typedef struct{
+    uint64_t frame_count = 0;
+    uint64_t skipped_count = 0;     // nothing changed, the previous output was reused
+    uint64_t partial_count = 0;     // only the outputs of the changed tiles were redone
+    uint64_t full_count = 0;        // first frame, new size, too many changed tiles or refresh
+    uint64_t tile_count = 0;        // tiles compared
+    uint64_t dirty_tile_count = 0;
+    uint64_t redone_pixels = 0;     // output pixels of the partial updates
+    uint64_t detect_us = 0;         // GetStats only: hashing
+    uint64_t resize_us = 0;         // GetStats only: partial and whole resizes
+} DVPPIncrementalStats;
+
+/**
+* @brief 64 bit hash of every tile_width x tile_height tile(row major) of tile rows [tile_row_begin, tile_row_end) of a
+*        host BGR_888 or YUV_SEMIPLANAR_420 image(the uv rows of a tile are part of it), the low ignore_low_bits bits of
+*        every byte are left out; 32 bit multiply-xor lanes over 32 byte blocks(NEON/AVX2, the same hashes as the
+*        scalar kernel), a change inside one block of a tile row always changes the hash of the tile
+* @param [out] hashes: (tile_row_end - tile_row_begin) * tiles per row
+*/
+void ComputeTileHashes(const DVPPImageData& image, uint32_t format, uint32_t tile_width, uint32_t tile_height,
+                       uint32_t ignore_low_bits, int tile_row_begin, int tile_row_end, uint64_t* hashes,
+                       bool use_simd = true);
+
+/**
+* @brief "neon", "avx2" or "scalar", the kernel ComputeTileHashes uses with use_simd
+*/
+const char* TileHashIsa();
+
+/**
+* @brief incremental resize of the frames of fixed cameras: every stream keeps the tile hashes of its last frame and
+*        its own output slot, a frame without changed tiles is not resized at all(its output is the previous one),
+*        a frame with a few changed tiles only gets the outputs that read them recomputed by CpuResize::ProcessDirty,
+*        the other frames of a batch go through one whole frame resize(vpc or CpuResize)
+*/
+class IncrementalResize {
+public:
+    IncrementalResize();
+
+    ~IncrementalResize();
+
+    /**
+    * @param [in] pool: hashing and the host kernels, nullptr runs them on the calling thread
+    */
+    void Init(const DVPPIncrementalConfig* config, WorkerPool* pool = nullptr);
+
+    /**
+    * @brief the next frame of every stream, a stream appears at most once per call
+    * @param [in] srcImage: host frames, img_num <= batch_size
+    * @param [in] stream_ids: stream of every frame
+    * @return 1 success, 0 failed(the streams of the failed frames start over with a whole frame)
+    */
+    int Process(const DVPPImageData* srcImage, const uint32_t* stream_ids, int img_num);
+
+    /**
+    * @brief output of frame index of the last Process: the host slot of its stream, valid until the next frame of
+    *        that stream
+    */
+    int Get(DVPPImageData& resizedImage, int index) const;
+
+    /**
+    * @return 1 success, 0 stream id out of range
+    */
+    int GetStreamStats(uint32_t stream_id, DVPPIncrementalStats& stats) const;
+
+    /**
+    * @brief all streams together
+    */
+    inline const DVPPIncrementalStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    /**
+    * @brief forget the last frame of a stream, e.g. after the camera was switched, its next frame is resized whole
+    */
+    void ResetStream(uint32_t stream_id);
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    void DestroyResource();
+
+private:
+    struct StreamState {
+        uint32_t width = 0;             // of the frame behind hashes, 0: no frame yet
+        uint32_t height = 0;
+        uint32_t frames_since_full = 0;
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> output;
+        DVPPIncrementalStats stats;
+    };
+
+    void HashFrames(const DVPPImageData* srcImage, int img_num);
+
+    /**
+    * @brief changed tiles of frame idx merged into runs along the tile rows
+    */
+    int CollectDirty(const DVPPImageData& image, int idx, std::vector<RectInt>& dirty);
+
+private:
+    DVPPIncrementalConfig config_;
+    WorkerPool* pool_;
+    std::unique_ptr<HybridResizeWorker> full_worker_;
+    CpuResize dirty_resize_;
+    uint32_t out_width_stride_;
+    uint32_t out_buffer_size_;
+    std::vector<uint8_t> full_output_;  // batch of the whole frame resizes, copied into the stream slots
+    std::vector<StreamState> streams_;
+    std::vector<uint32_t> last_streams_;
+    // per frame of the current batch
+    std::vector<std::vector<uint64_t> > hashes_;
+    std::vector<int> tiles_x_;
+    std::vector<int> tile_rows_;
+    std::vector<int> job_offsets_;
+    std::vector<int> dirty_counts_;
+    std::vector<RectInt> dirty_;
+    std::vector<int> full_frames_;
+    std::vector<DVPPImageData> full_images_;
+    DVPPIncrementalStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_INCREMENTAL_RESIZE_H
@@ -5,25 +5,8 @@
 
 #include "common/utils/file_process.hpp"
 #include "dvpp_resize.h"
-
-cv::Mat BGR2YUV_NV12(const cv::Mat &src)
-{
-    auto src_h = src.rows;
-    auto src_w = src.cols;
-    cv::Mat dst(src_h * 1.5, src_w, CV_8UC1);
-    cv::cvtColor(src, dst, cv::COLOR_BGR2YUV_I420);  // I420: YYYY...UU...VV...
-
-    auto n_y = src_h * src_w;
-    auto n_uv = n_y / 2;
-    auto n_u = n_y / 4;
-    std::vector<uint8_t> uv(n_uv);
-    std::copy(dst.data+n_y, dst.data+n_y+n_uv, uv.data());
-    for (auto i = 0; i < n_u; i++) {
-        dst.data[n_y + 2*i] = uv[i];            // U
-        dst.data[n_y + 2*i + 1] = uv[n_u + i];  // V
-    }
-    return dst;
-}
+#include "frame_corpus.h"
+#include "color_convert.h"
 
 int get_random(int min, int max)
 {
@@ -40,7 +23,7 @@ int main(int argc, const char *argv[])
         std::cout << "Usage: ./main img_list_file batch_size des_width des_height num_loop yuv420sp_nv12_resize fix_scale crop_size" << std::endl;
         return -1;
     }
-    int32_t deviceId;
+    int32_t deviceId = 0;
     aclrtContext context;
     aclrtStream stream;
     aclrtRunMode run_mode;
@@ -86,8 +69,23 @@ int main(int argc, const char *argv[])
         return -1;
     }
 
+    // img_list_file can also be a frame corpus written by make_frame_corpus, the frames are mmap-ed
+    // and uploaded as they are, no decode or color conversion before timing
     std::vector<std::string> img_list;
-    alg_utils::get_all_line_from_txt(argv[1], img_list);
+    FrameCorpusReader corpus;
+    bool use_corpus = alg_utils::EndsWith(argv[1], ".corpus");
+    if (use_corpus)
+    {
+        if (1 != corpus.Open(argv[1]) || 0 == corpus.FrameCount())
+        {
+            std::printf("open frame corpus %s failed\n", argv[1]);
+            return -1;
+        }
+    }
+    else
+    {
+        alg_utils::get_all_line_from_txt(argv[1], img_list);
+    }
     int batch_size = std::atoi(argv[2]);
     int des_width = std::atoi(argv[3]);
     int des_height = std::atoi(argv[4]);
@@ -95,6 +93,11 @@ int main(int argc, const char *argv[])
     int yuv420sp_nv12_resize = std::atoi(argv[6]);
     int fix_scale = std::atoi(argv[7]);
     int crop_size = std::atoi(argv[8]);
+    if (use_corpus && corpus.InputFormat() != (1 == yuv420sp_nv12_resize ? 1 : 13))
+    {
+        std::printf("frame corpus format %d does not match yuv420sp_nv12_resize = %d\n", corpus.InputFormat(), yuv420sp_nv12_resize);
+        return -1;
+    }
 
     DvppResize dvppResize;
     if(!dvppResize.HasInit())
@@ -123,14 +126,24 @@ int main(int argc, const char *argv[])
         // if the input yuv is from JPEGD, 128*16 alignment on 310, 64*16 alignment on 310P
         // if the input yuv is from VDEC, it shoud be aligned to 16*2
         // alloc device memory && copy data from host to device
-        cv::Mat tmp = cv::imread(img_list[idx], cv::IMREAD_COLOR);
+        const uint8_t* host_data = nullptr;
+        if (use_corpus)
+        {
+            corpus.Get(src_imgs[idx], idx % corpus.FrameCount());
+            host_data = src_imgs[idx].data;
+        }
+        cv::Mat tmp = use_corpus ? cv::Mat() : cv::imread(img_list[idx], cv::IMREAD_COLOR);
         int img_height = tmp.rows;
         int img_width = tmp.cols;
         cv::Mat img;
-        cv::resize(tmp, img, {ALIGN_UP16(img_width),ALIGN_UP2(img_height)});
         cv::Mat img_new;
-        if(0 == yuv420sp_nv12_resize)
+        if (use_corpus)
         {
+            std::cout << src_imgs[idx].width << " " << src_imgs[idx].height << " " << src_imgs[idx].alignWidth << " " << src_imgs[idx].alignHeight << std::endl;
+        }
+        else if(0 == yuv420sp_nv12_resize)
+        {
+            cv::resize(tmp, img, {ALIGN_UP16(img_width),ALIGN_UP2(img_height)});
             std::cout << img.cols << " " << img.rows << std::endl;
             img_new = img.clone();
             src_imgs[idx].width = img_new.cols; // 1920
@@ -143,8 +156,21 @@ int main(int argc, const char *argv[])
         }
         else
         {
+            cv::resize(tmp, img, {ALIGN_UP16(img_width),ALIGN_UP2(img_height)});
             std::cout << img.cols << " " << img.rows << std::endl;
-            img_new = BGR2YUV_NV12(img);
+            img_new = cv::Mat(img.rows * 3 / 2, img.cols, CV_8UC1);
+            DVPPImageData bgr, nv12;
+            bgr.width = img.cols;
+            bgr.height = img.rows;
+            bgr.alignWidth = img.step[0];
+            bgr.alignHeight = img.rows;
+            bgr.size = 0;
+            bgr.data = img.data;
+            nv12.alignWidth = img.cols;
+            nv12.alignHeight = img.rows;
+            nv12.size = img_new.total();
+            nv12.data = img_new.data;
+            ConvertColor(bgr, CVT_FORMAT_BGR, nv12, CVT_FORMAT_NV12);
             src_imgs[idx].width = img_new.cols; // 1920
             src_imgs[idx].height = img_new.rows / 1.5; // 1080
 //            src_img.alignWidth = ALIGN_UP128(img.cols); // 1920
@@ -154,6 +180,10 @@ int main(int argc, const char *argv[])
             std::cout << src_imgs[idx].width << " " << src_imgs[idx].height << " " << src_imgs[idx].alignWidth << " " << src_imgs[idx].alignHeight << std::endl;
             src_imgs[idx].size = YUV420SP_SIZE(src_imgs[idx].alignWidth, src_imgs[idx].alignHeight);
         }
+        if (!use_corpus)
+        {
+            host_data = img_new.data;
+        }
         if(crop_size <= 0)
         {
             rects[idx].xmin = 0;
@@ -176,7 +206,9 @@ int main(int argc, const char *argv[])
             return -1;
         }
 
-        aclRet = aclrtMemcpy(src_buffers[idx], src_imgs[idx].size, img_new.data, src_imgs[idx].size, ACL_MEMCPY_HOST_TO_DEVICE);
+        uint64_t upload_ns = DvppTimeline::NowNs();
+        aclRet = aclrtMemcpy(src_buffers[idx], src_imgs[idx].size, host_data, src_imgs[idx].size, ACL_MEMCPY_HOST_TO_DEVICE);
+        DvppTimeline::Record("demo", "upload", upload_ns, DvppTimeline::NowNs(), idx);
         if (aclRet != ACL_SUCCESS)
         {
             std::printf("Copy data to device failed, aclRet is %d\n", aclRet);
@@ -202,7 +234,9 @@ int main(int argc, const char *argv[])
 
         // alloc device memory && copy data from device to host
         std::vector<uint8_t> out_data(des_img.size);
+        uint64_t readback_ns = DvppTimeline::NowNs();
         aclError aclRet = aclrtMemcpy(out_data.data(), des_img.size, des_img.data, des_img.size, ACL_MEMCPY_DEVICE_TO_HOST);
+        DvppTimeline::Record("demo", "readback", readback_ns, DvppTimeline::NowNs(), idx);
         if (aclRet != ACL_SUCCESS)
         {
             std::printf("Copy data to host failed, aclRet is %d\n", aclRet);
@@ -0,0 +1,617 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include "multi_device_resize.h"
+#include "hybrid_resize.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::future<DVPPMultiDeviceResult> FailedFuture()
+{
+    std::promise<DVPPMultiDeviceResult> promise;
+    promise.set_value(DVPPMultiDeviceResult());
+    return promise.get_future();
+}
+
+class MultiDeviceChannel {
+public:
+    virtual ~MultiDeviceChannel() {}
+
+    /**
+    * @param [in] on_device: the images are in the memory of the device of the channel
+    * @param [out] output: slot i starts at output + i * ALIGN_UP16(resized_width) * 3 * ALIGN_UP2(resized_height)
+    * @return 1 success, 0 failed
+    */
+    virtual int Process(const DVPPImageData* images, const RectInt* rois, int img_num, bool on_device,
+                        uint8_t* output) = 0;
+
+    virtual void DestroyResource() = 0;
+};
+
+namespace {
+
+// simulated device: CpuResize(paced when sim_us_per_image > 0) from and into host memory
+class SimChannel : public MultiDeviceChannel {
+public:
+    explicit SimChannel(HybridResizeWorker* worker) : worker_(worker)
+    {
+
+    }
+
+    int Process(const DVPPImageData* images, const RectInt* rois, int img_num, bool on_device,
+                uint8_t* output) override
+    {
+        (void)on_device;
+        return worker_->Process(images, rois, img_num, output);
+    }
+
+    void DestroyResource() override
+    {
+        worker_->DestroyResource();
+    }
+
+private:
+    std::unique_ptr<HybridResizeWorker> worker_;
+};
+
+// DvppResize on its own stream of the device context, host images are uploaded into per channel buffers first
+class AclChannel : public MultiDeviceChannel {
+public:
+    int Init(const DVPPResizeInitConfig& config)
+    {
+        config_ = config;
+        config_.use_external_output = 1;
+        resize_.Init(&config_);
+        if (!resize_.HasInit())
+        {
+            return 0;
+        }
+        output_size_ = static_cast<uint64_t>(ALIGN_UP16(config_.resized_width) * 3) *
+                       ALIGN_UP2(config_.resized_height) * config_.batch_size;
+        inputs_dev_.assign(config_.batch_size, nullptr);
+        input_sizes_.assign(config_.batch_size, 0);
+        images_dev_.resize(config_.batch_size);
+        return 1;
+    }
+
+    int Process(const DVPPImageData* images, const RectInt* rois, int img_num, bool on_device,
+                uint8_t* output) override
+    {
+        aclError aclRet = aclrtSetCurrentContext(config_.context);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("set current context failed, aclRet is %d\n", aclRet);
+            return 0;
+        }
+        if (!on_device)
+        {
+            DVPP_TIMELINE_SCOPE("multi_device", "upload", img_num);
+            for (int idx = 0; idx < img_num; ++idx)
+            {
+                uint32_t width_stride, height_stride, buffer_size;
+                GetDvppInputStride(config_.input_format, images[idx], width_stride, height_stride, buffer_size);
+                if (input_sizes_[idx] < buffer_size)
+                {
+                    if (inputs_dev_[idx])
+                    {
+                        acldvppFree(inputs_dev_[idx]);
+                        inputs_dev_[idx] = nullptr;
+                    }
+                    input_sizes_[idx] = 0;
+                    if (ACL_SUCCESS != acldvppMalloc(&inputs_dev_[idx], buffer_size))
+                    {
+                        AIALG_ERROR("acldvppMalloc channel input of %d bytes failed\n", buffer_size);
+                        inputs_dev_[idx] = nullptr;
+                        return 0;
+                    }
+                    input_sizes_[idx] = buffer_size;
+                }
+                aclRet = aclrtMemcpy(inputs_dev_[idx], buffer_size, images[idx].data, buffer_size,
+                                     ACL_MEMCPY_HOST_TO_DEVICE);
+                if (aclRet != ACL_SUCCESS)
+                {
+                    AIALG_ERROR("upload image %d failed, aclRet is %d\n", idx, aclRet);
+                    return 0;
+                }
+                images_dev_[idx] = images[idx];
+                images_dev_[idx].data = static_cast<uint8_t*>(inputs_dev_[idx]);
+            }
+        }
+
+        DVPPOutputBinding binding;
+        binding.data = output;
+        binding.size = output_size_;
+        return resize_.Process(on_device ? images : images_dev_.data(), rois, img_num, &binding);
+    }
+
+    void DestroyResource() override
+    {
+        resize_.DestroyResource();
+        for (size_t idx = 0; idx < inputs_dev_.size(); ++idx)
+        {
+            if (inputs_dev_[idx])
+            {
+                acldvppFree(inputs_dev_[idx]);
+            }
+        }
+        inputs_dev_.clear();
+        input_sizes_.clear();
+    }
+
+private:
+    DVPPResizeInitConfig config_;
+    DvppResize resize_;
+    std::vector<void*> inputs_dev_;  // per batch index, grown on demand
+    std::vector<uint32_t> input_sizes_;
+    std::vector<DVPPImageData> images_dev_;
+    uint64_t output_size_ = 0;
+};
+
+}
+
+MultiDeviceResize::MultiDeviceResize() : slot_size_(0), batch_bytes_(0), stop_(false), has_init_over_(false)
+{
+
+}
+
+MultiDeviceResize::~MultiDeviceResize()
+{
+    DestroyResource();
+}
+
+void MultiDeviceResize::Init(const DVPPMultiDeviceConfig *config)
+{
+    config_ = *config;
+    // the arena is sized by the resolved(tuned) batch_size, every channel then gets it as is
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    if (0 == config_.device_num || 0 == config_.channels_per_device)
+    {
+        AIALG_ERROR("device_num and channels_per_device must be > 0\n");
+        return;
+    }
+    if (config_.ema_alpha <= 0.0f || config_.ema_alpha > 1.0f || config_.us_per_image <= 0.0f)
+    {
+        AIALG_ERROR("ema_alpha must be in (0, 1] and us_per_image > 0\n");
+        return;
+    }
+    config_.arena_slots = config_.arena_slots ? config_.arena_slots : 2 * config_.channels_per_device;
+    slot_size_ = ALIGN_UP16(config_.resize_config.resized_width) * 3 * ALIGN_UP2(config_.resize_config.resized_height);
+    batch_bytes_ = static_cast<uint64_t>(slot_size_) * config_.resize_config.batch_size;
+
+    stop_ = false;
+    // the channels of the first devices already run while the later ones are added
+    devices_.reserve(config_.device_num);
+    for (uint32_t idx = 0; idx < config_.device_num; ++idx)
+    {
+        devices_.emplace_back(new Device());
+        if (1 != InitDevice(static_cast<int>(idx)))
+        {
+            DestroyResource();
+            return;
+        }
+    }
+    has_init_over_ = true;
+}
+
+int MultiDeviceResize::InitDevice(int index)
+{
+    Device& device = *devices_[index];
+    device.device_id = config_.device_ids ? config_.device_ids[index] : index;
+    device.stats.us_per_image = config_.us_per_image;
+    for (int slot = static_cast<int>(config_.arena_slots) - 1; slot >= 0; --slot)
+    {
+        device.free_slots.push_back(slot);
+    }
+
+    DVPPResizeInitConfig resize_config = config_.resize_config;
+    if (config_.simulate)
+    {
+        device.host_arena.assign(batch_bytes_ * config_.arena_slots, 0);
+        device.arena = device.host_arena.data();
+        float sim_us_per_image = config_.sim_us_per_image ? config_.sim_us_per_image[index] : 0.0f;
+        for (uint32_t channel = 0; channel < config_.channels_per_device; ++channel)
+        {
+            HybridResizeWorker* worker = CreateHostResizeWorker(resize_config, nullptr, sim_us_per_image);
+            if (!worker)
+            {
+                return 0;
+            }
+            device.channels.emplace_back(new SimChannel(worker));
+        }
+    }
+    else
+    {
+        aclError aclRet = aclrtSetDevice(device.device_id);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acl open device %d failed, aclRet is %d\n", device.device_id, aclRet);
+            return 0;
+        }
+        device.device_set = true;
+        aclRet = aclrtCreateContext(&device.context, device.device_id);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acl create context on device %d failed, aclRet is %d\n", device.device_id, aclRet);
+            device.context = nullptr;
+            return 0;
+        }
+        void* arena = nullptr;
+        aclRet = acldvppMalloc(&arena, batch_bytes_ * config_.arena_slots);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("acldvppMalloc arena of device %d failed, aclRet = %d\n", device.device_id, aclRet);
+            return 0;
+        }
+        device.arena = static_cast<uint8_t*>(arena);
+        for (uint32_t channel = 0; channel < config_.channels_per_device; ++channel)
+        {
+            aclrtStream stream = nullptr;
+            aclRet = aclrtCreateStream(&stream);
+            if (aclRet != ACL_SUCCESS)
+            {
+                AIALG_ERROR("acl create stream on device %d failed, aclRet is %d\n", device.device_id, aclRet);
+                return 0;
+            }
+            device.streams.push_back(stream);
+            resize_config.context = device.context;
+            resize_config.stream = stream;
+            std::unique_ptr<AclChannel> acl_channel(new AclChannel());
+            if (1 != acl_channel->Init(resize_config))
+            {
+                acl_channel->DestroyResource();
+                return 0;
+            }
+            device.channels.emplace_back(acl_channel.release());
+        }
+    }
+
+    for (uint32_t channel = 0; channel < config_.channels_per_device; ++channel)
+    {
+        device.threads.emplace_back(&MultiDeviceResize::ChannelLoop, this, index, static_cast<int>(channel));
+    }
+    return 1;
+}
+
+void MultiDeviceResize::DestroyDevice(Device &device)
+{
+    for (size_t idx = 0; idx < device.threads.size(); ++idx)
+    {
+        if (device.threads[idx].joinable())
+        {
+            device.threads[idx].join();
+        }
+    }
+    device.threads.clear();
+    if (device.context)
+    {
+        aclrtSetCurrentContext(device.context);
+    }
+    for (size_t idx = 0; idx < device.channels.size(); ++idx)
+    {
+        device.channels[idx]->DestroyResource();
+    }
+    device.channels.clear();
+    for (size_t idx = 0; idx < device.streams.size(); ++idx)
+    {
+        aclrtDestroyStream(device.streams[idx]);
+    }
+    device.streams.clear();
+    if (device.arena && device.host_arena.empty())
+    {
+        acldvppFree(device.arena);
+    }
+    device.arena = nullptr;
+    std::vector<uint8_t>().swap(device.host_arena);
+    if (device.context)
+    {
+        aclrtDestroyContext(device.context);
+        device.context = nullptr;
+    }
+    if (device.device_set)
+    {
+        aclrtResetDevice(device.device_id);
+        device.device_set = false;
+    }
+}
+
+void MultiDeviceResize::DestroyResource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    slot_cv_.notify_all();
+    for (size_t idx = 0; idx < devices_.size(); ++idx)
+    {
+        devices_[idx]->job_cv.notify_all();
+    }
+    // the channels run the queued batches before they exit
+    for (size_t idx = 0; idx < devices_.size(); ++idx)
+    {
+        DestroyDevice(*devices_[idx]);
+    }
+    devices_.clear();
+    stream_devices_.clear();
+    has_init_over_ = false;
+}
+
+int MultiDeviceResize::PickDevice(int img_num) const
+{
+    int best = -1;
+    for (size_t idx = 0; idx < devices_.size(); ++idx)
+    {
+        const Device& device = *devices_[idx];
+        if (device.free_slots.empty())
+        {
+            continue;
+        }
+        if (best < 0 || Backlog(device, img_num) < Backlog(*devices_[best], img_num))
+        {
+            best = static_cast<int>(idx);
+        }
+    }
+    return best;
+}
+
+std::future<DVPPMultiDeviceResult> MultiDeviceResize::Submit(const DVPPImageData *srcImage, const RectInt *rois,
+                                                             int img_num, int resident_device)
+{
+    if (!has_init_over_ || !srcImage || img_num <= 0 ||
+        img_num > static_cast<int>(config_.resize_config.batch_size))
+    {
+        AIALG_ERROR("MultiDeviceResize has not init or bad img_num = %d\n", img_num);
+        return FailedFuture();
+    }
+    if (resident_device < -1 || resident_device >= DeviceNum())
+    {
+        AIALG_ERROR("resident_device = %d out of range, device_num = %d\n", resident_device, DeviceNum());
+        return FailedFuture();
+    }
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (!srcImage[idx].data)
+        {
+            AIALG_ERROR("srcImage[%d].data is nullptr\n", idx);
+            return FailedFuture();
+        }
+    }
+    Job job;
+    job.images.assign(srcImage, srcImage + img_num);
+    if (rois)
+    {
+        job.rois.assign(rois, rois + img_num);
+    }
+    job.on_device = resident_device >= 0;
+    std::future<DVPPMultiDeviceResult> future = job.promise.get_future();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    int device_index = -1;
+    slot_cv_.wait(lock, [&] {
+        if (stop_)
+        {
+            return true;
+        }
+        if (resident_device >= 0)
+        {
+            device_index = devices_[resident_device]->free_slots.empty() ? -1 : resident_device;
+        }
+        else
+        {
+            device_index = PickDevice(img_num);
+        }
+        return device_index >= 0;
+    });
+    if (stop_)
+    {
+        return FailedFuture();
+    }
+    Device& device = *devices_[device_index];
+    job.arena_slot = device.free_slots.back();
+    device.free_slots.pop_back();
+    job.submit_ns = SteadyNowNs();
+    device.stats.pending_images += img_num;
+    if (job.on_device)
+    {
+        device.stats.resident_count++;
+    }
+    else
+    {
+        device.stats.balanced_count++;
+    }
+    device.jobs.push_back(std::move(job));
+    lock.unlock();
+    device.job_cv.notify_one();
+    return future;
+}
+
+int MultiDeviceResize::Get(const DVPPMultiDeviceResult &result, int index, DVPPImageData &resizedImage) const
+{
+    if (1 != result.status || !result.data || index < 0 || index >= static_cast<int>(result.img_num))
+    {
+        AIALG_ERROR("failed result or index = %d out of range\n", index);
+        return 0;
+    }
+    resizedImage.width = config_.resize_config.resized_width;
+    resizedImage.height = config_.resize_config.resized_height;
+    resizedImage.alignWidth = ALIGN_UP16(config_.resize_config.resized_width) * 3;
+    resizedImage.alignHeight = ALIGN_UP2(config_.resize_config.resized_height);
+    resizedImage.size = result.slot_size;
+    resizedImage.data = result.data + static_cast<size_t>(index) * result.slot_size;
+    return 1;
+}
+
+void MultiDeviceResize::Release(const DVPPMultiDeviceResult &result)
+{
+    if (1 != result.status || result.device < 0 || result.device >= DeviceNum() || result.arena_slot < 0 ||
+        result.arena_slot >= static_cast<int>(config_.arena_slots))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        devices_[result.device]->free_slots.push_back(result.arena_slot);
+    }
+    // submitters may wait for different devices
+    slot_cv_.notify_all();
+}
+
+int MultiDeviceResize::PlaceStream(uint32_t stream_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!has_init_over_)
+    {
+        return -1;
+    }
+    std::unordered_map<uint32_t, int>::const_iterator iter = stream_devices_.find(stream_id);
+    if (iter != stream_devices_.end())
+    {
+        return iter->second;
+    }
+    // streams per unit of speed, ties go to the smaller backlog
+    int best = 0;
+    for (int idx = 1; idx < DeviceNum(); ++idx)
+    {
+        const Device& device = *devices_[idx];
+        const Device& best_device = *devices_[best];
+        float cost = (device.stats.stream_count + 1) * device.stats.us_per_image;
+        float best_cost = (best_device.stats.stream_count + 1) * best_device.stats.us_per_image;
+        if (cost < best_cost || (cost == best_cost && Backlog(device, 0) < Backlog(best_device, 0)))
+        {
+            best = idx;
+        }
+    }
+    devices_[best]->stats.stream_count++;
+    stream_devices_[stream_id] = best;
+    return best;
+}
+
+void MultiDeviceResize::ReleaseStream(uint32_t stream_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_map<uint32_t, int>::iterator iter = stream_devices_.find(stream_id);
+    if (iter == stream_devices_.end())
+    {
+        return;
+    }
+    devices_[iter->second]->stats.stream_count--;
+    stream_devices_.erase(iter);
+}
+
+DVPPMultiDeviceStats MultiDeviceResize::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    DVPPMultiDeviceStats stats;
+    for (size_t idx = 0; idx < devices_.size(); ++idx)
+    {
+        const DVPPMultiDeviceStats& device = devices_[idx]->stats;
+        stats.batch_count += device.batch_count;
+        stats.image_count += device.image_count;
+        stats.failed_count += device.failed_count;
+        stats.resident_count += device.resident_count;
+        stats.balanced_count += device.balanced_count;
+        stats.busy_us += device.busy_us;
+        stats.queue_us += device.queue_us;
+        stats.pending_images += device.pending_images;
+        stats.stream_count += device.stream_count;
+        stats.us_per_image += device.us_per_image / devices_.size();
+    }
+    return stats;
+}
+
+int MultiDeviceResize::GetDeviceStats(int device, DVPPMultiDeviceStats &stats) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (device < 0 || device >= DeviceNum())
+    {
+        return 0;
+    }
+    stats = devices_[device]->stats;
+    return 1;
+}
+
+void MultiDeviceResize::ChannelLoop(int device_index, int channel_index)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "device%d_channel%d", device_index, channel_index);
+    DvppTimeline::SetThreadName(name);
+    Device& device = *devices_[device_index];
+    MultiDeviceChannel* channel = device.channels[channel_index].get();
+    if (device.context)
+    {
+        aclrtSetCurrentContext(device.context);
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        if (device.jobs.empty())
+        {
+            if (stop_)
+            {
+                break;
+            }
+            device.job_cv.wait(lock);
+            continue;
+        }
+        Job job = std::move(device.jobs.front());
+        device.jobs.pop_front();
+        lock.unlock();
+
+        int img_num = static_cast<int>(job.images.size());
+        uint8_t* output = device.arena + job.arena_slot * batch_bytes_;
+        uint64_t start_ns = SteadyNowNs();
+        int ret;
+        {
+            DVPP_TIMELINE_SCOPE("multi_device", "batch", img_num);
+            ret = channel->Process(job.images.data(), job.rois.empty() ? nullptr : job.rois.data(), img_num,
+                                   job.on_device, output);
+        }
+        uint64_t end_ns = SteadyNowNs();
+
+        DVPPMultiDeviceResult result;
+        result.status = 1 == ret ? 1 : 0;
+        result.device = device_index;
+        result.arena_slot = 1 == ret ? job.arena_slot : -1;
+        result.img_num = img_num;
+        result.data = 1 == ret ? output : nullptr;
+        result.slot_size = slot_size_;
+        result.queue_us = (start_ns - job.submit_ns) / 1000;
+        result.run_us = (end_ns - start_ns) / 1000;
+
+        lock.lock();
+        DVPPMultiDeviceStats& stats = device.stats;
+        stats.pending_images -= img_num;
+        stats.batch_count++;
+        stats.image_count += img_num;
+        stats.busy_us += result.run_us;
+        stats.queue_us += result.queue_us;
+        if (1 == ret)
+        {
+            stats.us_per_image += config_.ema_alpha * (static_cast<float>(result.run_us) / img_num - stats.us_per_image);
+        }
+        else
+        {
+            // nothing to consume, the slot goes back at once
+            stats.failed_count += img_num;
+            device.free_slots.push_back(job.arena_slot);
+        }
+        lock.unlock();
+        if (1 != ret)
+        {
+            slot_cv_.notify_all();
+        }
+        job.promise.set_value(result);
+        lock.lock();
+    }
+}
@@ -0,0 +1,190 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_MULTI_DEVICE_RESIZE_H
+#define _PICTURE_INC_MULTI_DEVICE_RESIZE_H
+
+#include <deque>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <condition_variable>
+#include "dvpp_resize.h"
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;       // context/stream are ignored, every channel gets its own on its device
+    uint32_t device_num = 1;
+    const int32_t* device_ids = nullptr;      // device_num acl device ids, nullptr: 0 .. device_num - 1
+    uint32_t channels_per_device = 1;         // DvppResize instances per device, each on its own stream and thread
+    uint32_t arena_slots = 0;                 // output batches per device, 0: 2 * channels_per_device
+    float ema_alpha = 0.2f;                   // weight of the newest per-image cost of a device
+    float us_per_image = 1000.0f;             // initial estimate of every device
+    uint32_t simulate = 0;                    // 1: no acl calls, every device is CpuResize over host memory
+    const float* sim_us_per_image = nullptr;  // device_num per-image costs the simulated devices are paced to,
+                                              // nullptr: not paced
+    char reserve[8];
+} DVPPMultiDeviceConfig;
+
+typedef struct{
+    int status = 0;             // 1 success, 0 failed
+    int device = -1;            // index of the device(0 .. device_num - 1) the batch ran on
+    int arena_slot = -1;        // give it back by Release once the outputs are consumed
+    uint32_t img_num = 0;
+    uint8_t* data = nullptr;    // output i at data + i * slot_size in the memory of device(host memory if simulated)
+    uint32_t slot_size = 0;     // ALIGN_UP16(resized_width) * 3 * ALIGN_UP2(resized_height)
+    uint64_t queue_us = 0;      // Submit -> channel start
+    uint64_t run_us = 0;        // upload + resize
+} DVPPMultiDeviceResult;
+
+typedef struct{
+    uint64_t batch_count = 0;
+    uint64_t image_count = 0;
+    uint64_t failed_count = 0;       // images of failed batches
+    uint64_t resident_count = 0;     // batches run on the device holding their inputs
+    uint64_t balanced_count = 0;     // batches of host inputs run on the least loaded device
+    uint64_t busy_us = 0;            // channel time spent in batches
+    uint64_t queue_us = 0;           // sum over batches of Submit -> channel start
+    uint32_t pending_images = 0;     // queued or running now
+    uint32_t stream_count = 0;       // streams placed by PlaceStream
+    float us_per_image = 0.0f;       // current estimate, all devices: mean over the devices
+} DVPPMultiDeviceStats;
+
+// one resize channel of a device, see multi_device_resize.cpp
+class MultiDeviceChannel;
+
+/**
+* @brief resize front end over several devices: every device has its own context, channels(DvppResize + stream +
+*        thread) and arena of output batches, a batch of host images goes to the device with the smallest estimated
+*        backlog(pending images * its moving per-image cost / its channels), a batch already in the memory of a
+*        device(decoded there) runs on that device, PlaceStream keeps all frames of a stream on one device:
+*        int dev = resize.PlaceStream(camera); decode into dev; f = resize.Submit(frames, nullptr, n, dev); ...
+*        resize.Release(f.get());
+*/
+class MultiDeviceResize {
+public:
+    MultiDeviceResize();
+
+    ~MultiDeviceResize();
+
+    /**
+    * @brief set the devices(aclInit is the caller's) and create the contexts, streams, channels and arenas
+    */
+    void Init(const DVPPMultiDeviceConfig* config);
+
+    /**
+    * @brief queue one batch, thread safe, blocks while every arena slot of the candidate devices is in use
+    * @param [in] srcImage: img_num <= batch_size, the images and rois are copied, image.data must stay valid until
+    *                       the future is ready
+    * @param [in] rois: nullptr resizes the full images
+    * @param [in] resident_device: -1 host images, else index of the device whose memory holds them
+    * @return future of the result, a failed result(status 0) at once if not init, bad arguments or shutting down
+    */
+    std::future<DVPPMultiDeviceResult> Submit(const DVPPImageData* srcImage, const RectInt* rois, int img_num,
+                                              int resident_device = -1);
+
+    /**
+    * @brief output index of a successful result
+    */
+    int Get(const DVPPMultiDeviceResult& result, int index, DVPPImageData& resizedImage) const;
+
+    /**
+    * @brief give the arena slot of a result back, failed results are ignored
+    */
+    void Release(const DVPPMultiDeviceResult& result);
+
+    /**
+    * @brief device index of stream_id: the device with the fewest streams per unit of speed on first use,
+    *        the same device afterwards until ReleaseStream, so its frames can be decoded there
+    * @return device index, -1 if not init
+    */
+    int PlaceStream(uint32_t stream_id);
+
+    void ReleaseStream(uint32_t stream_id);
+
+    /**
+    * @brief all devices together
+    */
+    DVPPMultiDeviceStats GetStats() const;
+
+    /**
+    * @return 1 success, 0 device out of range
+    */
+    int GetDeviceStats(int device, DVPPMultiDeviceStats& stats) const;
+
+    inline int DeviceNum() const
+    {
+        return static_cast<int>(devices_.size());
+    }
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    /**
+    * @brief run the queued batches, stop the channels and free the devices,
+    *        outputs of results not released yet become invalid
+    */
+    void DestroyResource();
+
+private:
+    struct Job {
+        std::vector<DVPPImageData> images;
+        std::vector<RectInt> rois;  // empty: full images
+        bool on_device = false;
+        int arena_slot = -1;
+        uint64_t submit_ns = 0;
+        std::promise<DVPPMultiDeviceResult> promise;
+    };
+
+    struct Device {
+        int32_t device_id = 0;
+        bool device_set = false;           // aclrtSetDevice succeeded
+        aclrtContext context = nullptr;
+        std::vector<aclrtStream> streams;
+        std::vector<std::unique_ptr<MultiDeviceChannel> > channels;
+        std::vector<std::thread> threads;
+        uint8_t* arena = nullptr;          // arena_slots output batches
+        std::vector<uint8_t> host_arena;   // arena of a simulated device
+        std::vector<int> free_slots;
+        std::deque<Job> jobs;
+        std::condition_variable job_cv;
+        DVPPMultiDeviceStats stats;        // us_per_image is the live estimate of the device
+    };
+
+    int InitDevice(int index);
+
+    void DestroyDevice(Device& device);
+
+    /**
+    * @brief device of a host batch of img_num images with a free arena slot and the smallest estimated backlog,
+    *        -1 if every arena is full, with mutex_ held
+    */
+    int PickDevice(int img_num) const;
+
+    void ChannelLoop(int device_index, int channel_index);
+
+    inline float Backlog(const Device& device, int img_num) const
+    {
+        return (device.stats.pending_images + img_num) * device.stats.us_per_image / config_.channels_per_device;
+    }
+
+private:
+    DVPPMultiDeviceConfig config_;
+    std::vector<std::unique_ptr<Device> > devices_;
+    uint32_t slot_size_;
+    uint64_t batch_bytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable slot_cv_;  // submitters: a slot was released
+    std::unordered_map<uint32_t, int> stream_devices_;
+    bool stop_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_MULTI_DEVICE_RESIZE_H
@@ -0,0 +1,368 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "output_quantizer.h"
+#include "alg_define.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define QUANT_HAS_NEON 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#include "common/utils/simd_shuffle.hpp"
+#define QUANT_HAS_AVX2 1
+#endif
+
+// rows of one band when the batch is spread over the pool
+#define QUANT_BAND_ROWS 32
+
+typedef struct{
+    const int32_t* mult;
+    const int32_t* offset;
+    const uint32_t* order;
+    int is_signed;
+    uint8_t* dst[3];   // output channel c of pixel x is dst[c][x * dst_step]
+    int dst_step;      // 1: NCHW plane rows, 3: NHWC row
+} QuantizeRowArgs;
+
+static void QuantizeRowScalar(const uint8_t* src, int x_begin, int width, const QuantizeRowArgs& args)
+{
+    int lo = args.is_signed ? -128 : 0;
+    int hi = args.is_signed ? 127 : 255;
+    for (int x = x_begin; x < width; ++x)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            int q = (src[x * 3 + args.order[c]] * args.mult[c] + args.offset[c]) >> QUANT_FRAC_BITS;
+            q = q < lo ? lo : (q > hi ? hi : q);
+            args.dst[c][x * args.dst_step] = static_cast<uint8_t>(q);
+        }
+    }
+}
+
+#if defined(QUANT_HAS_NEON)
+static int QuantizeRowNeon(const uint8_t* src, int width, const QuantizeRowArgs& args)
+{
+    int32x4_t mult[3], offset[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        mult[c] = vdupq_n_s32(args.mult[c]);
+        offset[c] = vdupq_n_s32(args.offset[c]);
+    }
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t px = vld3q_u8(src + x * 3);
+        uint8x16x3_t out;
+        for (int c = 0; c < 3; ++c)
+        {
+            uint8x16_t val = px.val[args.order[c]];
+            uint16x8_t half[2] = {vmovl_u8(vget_low_u8(val)), vmovl_u8(vget_high_u8(val))};
+            int16x8_t q16[2];
+            for (int h = 0; h < 2; ++h)
+            {
+                int32x4_t q0 = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(half[h])));
+                int32x4_t q1 = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(half[h])));
+                q0 = vshrq_n_s32(vmlaq_s32(offset[c], q0, mult[c]), QUANT_FRAC_BITS);
+                q1 = vshrq_n_s32(vmlaq_s32(offset[c], q1, mult[c]), QUANT_FRAC_BITS);
+                q16[h] = vcombine_s16(vqmovn_s32(q0), vqmovn_s32(q1));
+            }
+            out.val[c] = args.is_signed ?
+                         vreinterpretq_u8_s8(vcombine_s8(vqmovn_s16(q16[0]), vqmovn_s16(q16[1]))) :
+                         vcombine_u8(vqmovun_s16(q16[0]), vqmovun_s16(q16[1]));
+        }
+        if (3 == args.dst_step)
+        {
+            vst3q_u8(args.dst[0] + x * 3, out);
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                vst1q_u8(args.dst[c] + x, out.val[c]);
+            }
+        }
+    }
+    return x;
+}
+#endif
+
+#if defined(QUANT_HAS_AVX2)
+__attribute__((target("avx2")))
+static int QuantizeRowAvx2(const uint8_t* src, int width, const QuantizeRowArgs& args)
+{
+    const alg_utils::ShuffleTables& tables = alg_utils::GetShuffleTables();
+    __m128i split[3][3], merge[3][3];
+    for (int k = 0; k < 3; ++k)
+    {
+        for (int m = 0; m < 3; ++m)
+        {
+            split[k][m] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.split[k][m]));
+            merge[k][m] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.merge[k][m]));
+        }
+    }
+    __m256i mult[3], offset[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        mult[c] = _mm256_set1_epi32(args.mult[c]);
+        offset[c] = _mm256_set1_epi32(args.offset[c]);
+    }
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8_t* p = src + x * 3;
+        __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32));
+        __m128i ch[3], out[3];
+        for (int k = 0; k < 3; ++k)
+        {
+            ch[k] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a0, split[k][0]), _mm_shuffle_epi8(a1, split[k][1])),
+                                 _mm_shuffle_epi8(a2, split[k][2]));
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            __m128i val = ch[args.order[c]];
+            __m256i q0 = _mm256_cvtepu8_epi32(val);
+            __m256i q1 = _mm256_cvtepu8_epi32(_mm_srli_si128(val, 8));
+            q0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(q0, mult[c]), offset[c]), QUANT_FRAC_BITS);
+            q1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(q1, mult[c]), offset[c]), QUANT_FRAC_BITS);
+            // [q0 0-3, q1 0-3 | q0 4-7, q1 4-7] -> 16 int16 in pixel order
+            __m256i q16 = _mm256_permute4x64_epi64(_mm256_packs_epi32(q0, q1), 0xD8);
+            __m128i lo = _mm256_castsi256_si128(q16);
+            __m128i hi = _mm256_extracti128_si256(q16, 1);
+            out[c] = args.is_signed ? _mm_packs_epi16(lo, hi) : _mm_packus_epi16(lo, hi);
+        }
+        if (3 == args.dst_step)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                __m128i bytes = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(out[0], merge[k][0]),
+                                                          _mm_shuffle_epi8(out[1], merge[k][1])),
+                                             _mm_shuffle_epi8(out[2], merge[k][2]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(args.dst[0] + x * 3 + 16 * k), bytes);
+            }
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(args.dst[c] + x), out[c]);
+            }
+        }
+    }
+    return x;
+}
+
+static bool HasAvx2()
+{
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+OutputQuantizer::OutputQuantizer() : has_init_over_(false)
+{
+
+}
+
+OutputQuantizer::~OutputQuantizer()
+{
+
+}
+
+int OutputQuantizer::Init(const DVPPQuantizeConfig *config)
+{
+    config_ = *config;
+    has_init_over_ = false;
+    for (int c = 0; c < 3; ++c)
+    {
+        double denom = static_cast<double>(config_.std[c]) * config_.scale[c];
+        if (0.0 == denom || config_.channel_order[c] > 2)
+        {
+            AIALG_ERROR("bad quantize config of channel %d, std * scale = %f, channel_order = %d\n", c, denom,
+                        config_.channel_order[c]);
+            return 0;
+        }
+        double mult = std::round((1 << QUANT_FRAC_BITS) / denom);
+        double offset = std::round((1 << QUANT_FRAC_BITS) * (config_.zero_point[c] - config_.mean[c] / denom)) +
+                        (1 << (QUANT_FRAC_BITS - 1));
+        // x * mult + offset is evaluated in int32 for x in [0, 255]
+        if (std::fabs(mult) * 255 + std::fabs(offset) >= 2147483647.0)
+        {
+            AIALG_ERROR("quantize multiplier of channel %d overflows int32, 1 / (std * scale) = %f\n", c, 1.0 / denom);
+            return 0;
+        }
+        mult_[c] = static_cast<int32_t>(mult);
+        offset_[c] = static_cast<int32_t>(offset);
+    }
+    has_init_over_ = true;
+    return 1;
+}
+
+void OutputQuantizer::QuantizeRows(const DVPPImageData &src, uint8_t *dst, int row_begin, int row_end,
+                                   bool use_simd) const
+{
+    int width = src.width;
+    int height = src.height;
+    uint32_t stride = src.alignWidth ? src.alignWidth : src.width * 3;
+    size_t plane = static_cast<size_t>(width) * height;
+    QuantizeRowArgs args;
+    args.mult = mult_;
+    args.offset = offset_;
+    args.order = config_.channel_order;
+    args.is_signed = config_.is_signed;
+    args.dst_step = QUANT_LAYOUT_NHWC == config_.layout ? 3 : 1;
+    for (int row = row_begin; row < row_end; ++row)
+    {
+        const uint8_t* src_row = src.data + static_cast<size_t>(row) * stride;
+        for (int c = 0; c < 3; ++c)
+        {
+            args.dst[c] = QUANT_LAYOUT_NHWC == config_.layout ? dst + static_cast<size_t>(row) * width * 3 + c :
+                          dst + c * plane + static_cast<size_t>(row) * width;
+        }
+        int x = 0;
+        if (use_simd)
+        {
+#if defined(QUANT_HAS_NEON)
+            x = QuantizeRowNeon(src_row, width, args);
+#elif defined(QUANT_HAS_AVX2)
+            x = HasAvx2() ? QuantizeRowAvx2(src_row, width, args) : 0;
+#endif
+        }
+        QuantizeRowScalar(src_row, x, width, args);
+    }
+}
+
+int OutputQuantizer::Quantize(const DVPPImageData &src, void *dst, WorkerPool *pool, bool use_simd) const
+{
+    if (!has_init_over_ || !src.data || !dst || (src.alignWidth && src.alignWidth < src.width * 3))
+    {
+        AIALG_ERROR("OutputQuantizer not init or bad image\n");
+        return 0;
+    }
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    if (pool && pool->NumWorkers() > 1)
+    {
+        pool->ParallelForRows(src.height, QUANT_BAND_ROWS, [&](int begin, int end, int)
+        {
+            QuantizeRows(src, out, begin, end, use_simd);
+        });
+    }
+    else
+    {
+        QuantizeRows(src, out, 0, src.height, use_simd);
+    }
+    return 1;
+}
+
+int OutputQuantizer::QuantizeBatch(const DVPPImageData *srcImages, int img_num, void *dst, WorkerPool *pool) const
+{
+    if (!has_init_over_ || img_num <= 0 || !dst)
+    {
+        AIALG_ERROR("OutputQuantizer not init or bad img_num = %d\n", img_num);
+        return 0;
+    }
+    std::vector<size_t> offsets(img_num + 1, 0);
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        if (!srcImages[idx].data || (srcImages[idx].alignWidth && srcImages[idx].alignWidth < srcImages[idx].width * 3))
+        {
+            AIALG_ERROR("bad image %d\n", idx);
+            return 0;
+        }
+        offsets[idx + 1] = offsets[idx] + ImageBytes(srcImages[idx].width, srcImages[idx].height);
+    }
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    if (!pool || pool->NumWorkers() <= 1)
+    {
+        for (int idx = 0; idx < img_num; ++idx)
+        {
+            QuantizeRows(srcImages[idx], out + offsets[idx], 0, srcImages[idx].height, true);
+        }
+        return 1;
+    }
+
+    // images x row bands, so both a large batch and a single large image keep all workers busy
+    int bands = (srcImages[0].height + QUANT_BAND_ROWS - 1) / QUANT_BAND_ROWS;
+    for (int idx = 1; idx < img_num; ++idx)
+    {
+        bands = std::max<int>(bands, (srcImages[idx].height + QUANT_BAND_ROWS - 1) / QUANT_BAND_ROWS);
+    }
+    pool->ParallelFor(0, img_num * bands, [&](int begin, int end, int)
+    {
+        for (int task = begin; task < end; ++task)
+        {
+            const DVPPImageData& src = srcImages[task / bands];
+            int row_begin = (task % bands) * QUANT_BAND_ROWS;
+            int row_end = std::min<int>(row_begin + QUANT_BAND_ROWS, src.height);
+            if (row_begin < row_end)
+            {
+                QuantizeRows(src, out + offsets[task / bands], row_begin, row_end, true);
+            }
+        }
+    });
+    return 1;
+}
+
+int OutputQuantizer::ReadbackQuantizeBatch(const DvppResize &resize, int img_num, void *dst, WorkerPool *pool)
+{
+    if (!has_init_over_ || img_num <= 0)
+    {
+        AIALG_ERROR("OutputQuantizer not init or bad img_num = %d\n", img_num);
+        return 0;
+    }
+    std::vector<DVPPImageData> images(img_num);
+    bool contiguous = true;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        resize.Get(images[idx], idx);
+        contiguous = contiguous && images[idx].data == images[0].data + static_cast<size_t>(idx) * images[0].size;
+    }
+    size_t slot_size = images[0].size;
+    staging_.resize(slot_size * img_num);
+    DVPP_TIMELINE_SCOPE("quantizer", "readback_quantize", img_num);
+    if (contiguous)
+    {
+        // one device -> host copy for the whole batch
+        aclError aclRet = aclrtMemcpy(staging_.data(), staging_.size(), images[0].data, staging_.size(),
+                                      ACL_MEMCPY_DEVICE_TO_HOST);
+        if (aclRet != ACL_SUCCESS)
+        {
+            AIALG_ERROR("copy batch to host failed, aclRet = %d\n", aclRet);
+            return 0;
+        }
+    }
+    else
+    {
+        for (int idx = 0; idx < img_num; ++idx)
+        {
+            aclError aclRet = aclrtMemcpy(staging_.data() + idx * slot_size, slot_size, images[idx].data, slot_size,
+                                          ACL_MEMCPY_DEVICE_TO_HOST);
+            if (aclRet != ACL_SUCCESS)
+            {
+                AIALG_ERROR("copy image %d to host failed, aclRet = %d\n", idx, aclRet);
+                return 0;
+            }
+        }
+    }
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        images[idx].data = staging_.data() + idx * slot_size;
+    }
+    return QuantizeBatch(images.data(), img_num, dst, pool);
+}
+
+int OutputQuantizer::Verify(const DVPPImageData &src, const void *dst) const
+{
+    std::vector<uint8_t> reference(ImageBytes(src.width, src.height));
+    if (1 != Quantize(src, reference.data(), nullptr, false))
+    {
+        return 0;
+    }
+    return 0 == std::memcmp(reference.data(), dst, reference.size()) ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_OUTPUT_QUANTIZER_H
+#define _PICTURE_INC_OUTPUT_QUANTIZER_H
+
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "worker_pool.h"
+
+enum QuantizeLayout {
+    QUANT_LAYOUT_NCHW = 0,
+    QUANT_LAYOUT_NHWC,
+};
+
+// fixed point bits of the per-channel multiplier and offset
+#define QUANT_FRAC_BITS 12
+
+typedef struct{
+    // q = saturate(round(((x - mean[c]) / std[c]) / scale[c]) + zero_point[c]), x is the pixel of channel_order[c]
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    float std[3] = {1.0f, 1.0f, 1.0f};
+    float scale[3] = {1.0f, 1.0f, 1.0f};
+    int32_t zero_point[3] = {0, 0, 0};
+    uint32_t channel_order[3] = {0, 1, 2};  // source channel of output channel c, {2, 1, 0}: BGR -> RGB
+    uint32_t layout = QUANT_LAYOUT_NCHW;
+    uint32_t is_signed = 1;                 // 1: int8 [-128, 127], 0: uint8 [0, 255]
+    char reserve[8];
+} DVPPQuantizeConfig;
+
+/**
+* @brief per-channel affine quantization of BGR_888 resize output into a dense int8/uint8 NCHW or NHWC
+*        batch tensor, fused with channel reorder and the device -> host copy of the batch,
+*        q = (x * M[c] + B[c] + 2^11) >> 12 saturated, NEON/AVX2 and the scalar reference are bit-exact
+*/
+class OutputQuantizer {
+public:
+    OutputQuantizer();
+
+    ~OutputQuantizer();
+
+    /**
+    * @return 1 success, 0 failed(std/scale is 0 or the fixed point multiplier overflows)
+    */
+    int Init(const DVPPQuantizeConfig* config);
+
+    /**
+    * @brief bytes of one quantized image, width * height * 3
+    */
+    static inline size_t ImageBytes(uint32_t width, uint32_t height)
+    {
+        return static_cast<size_t>(width) * height * 3;
+    }
+
+    /**
+    * @brief quantize one host BGR_888 image(alignWidth is the row stride in bytes) into dst
+    * @param [in] use_simd: false runs the scalar reference
+    */
+    int Quantize(const DVPPImageData& src, void* dst, WorkerPool* pool = nullptr, bool use_simd = true) const;
+
+    /**
+    * @brief quantize img_num host images into dst, image i starts at i * ImageBytes
+    */
+    int QuantizeBatch(const DVPPImageData* srcImages, int img_num, void* dst, WorkerPool* pool = nullptr) const;
+
+    /**
+    * @brief read back the first img_num outputs of the last resize.Process with one copy when
+    *        the slots are contiguous, then quantize them into dst(host)
+    */
+    int ReadbackQuantizeBatch(const DvppResize& resize, int img_num, void* dst, WorkerPool* pool = nullptr);
+
+    /**
+    * @brief compare dst with the scalar reference of src
+    * @return 1 bit-exact, 0 mismatch
+    */
+    int Verify(const DVPPImageData& src, const void* dst) const;
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+private:
+    void QuantizeRows(const DVPPImageData& src, uint8_t* dst, int row_begin, int row_end, bool use_simd) const;
+
+private:
+    DVPPQuantizeConfig config_;
+    int32_t mult_[3];    // Q12 multiplier of output channel c
+    int32_t offset_[3];  // Q12 offset plus rounding of output channel c
+    std::vector<uint8_t> staging_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_OUTPUT_QUANTIZER_H
@@ -0,0 +1,695 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <new>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "resize_service.h"
+#include "alg_define.h"
+
+// the futex words live in memory shared by processes
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32 bit integer");
+
+#define DVPP_SERVICE_ALIGN 64
+
+namespace {
+
+enum {
+    REQUEST_FREE = 0,
+    REQUEST_SUBMITTED = 1,   // written by the client, waiting for a channel
+    REQUEST_RUNNING = 2,     // claimed by a channel
+    REQUEST_DONE = 3,
+    REQUEST_FAILED = 4,
+};
+
+struct ServiceLane {
+    std::atomic<int32_t> owner_pid;  // 0: free
+};
+
+struct ServiceRequest {
+    std::atomic<uint32_t> state;     // futex word the client waits on
+    int32_t img_num;
+    int32_t has_rois;
+};
+
+}
+
+static inline uint64_t HeadSize()
+{
+    return ALIGN_UP(static_cast<uint64_t>(sizeof(DVPPServiceHeader)), DVPP_SERVICE_ALIGN);
+}
+
+// layout is the header in the shared memory for a client, the daemon's own copy for the daemon
+static inline uint8_t* LanePtr(uint8_t* shm, const DVPPServiceHeader* layout, int lane)
+{
+    return shm + HeadSize() + lane * layout->lane_size;
+}
+
+static inline uint8_t* RequestPtr(uint8_t* shm, const DVPPServiceHeader* layout, int lane, int entry)
+{
+    return LanePtr(shm, layout, lane) + DVPP_SERVICE_ALIGN + entry * layout->request_size;
+}
+
+static inline DVPPServiceImage* RequestImages(uint8_t* request)
+{
+    return reinterpret_cast<DVPPServiceImage*>(request + DVPP_SERVICE_ALIGN);
+}
+
+static inline uint8_t* RequestFrame(const DVPPServiceHeader* header, uint8_t* request, int index)
+{
+    uint64_t images_size = ALIGN_UP(static_cast<uint64_t>(header->batch_size) * sizeof(DVPPServiceImage), DVPP_SERVICE_ALIGN);
+    return request + DVPP_SERVICE_ALIGN + images_size + static_cast<uint64_t>(index) * header->frame_slot_size;
+}
+
+// the output slots of a request are contiguous, the batch layout of HybridResizeWorker
+static inline uint8_t* RequestOutput(const DVPPServiceHeader* header, uint8_t* request, int index)
+{
+    return RequestFrame(header, request, header->batch_size) + static_cast<uint64_t>(index) * header->out_slot_size;
+}
+
+static void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms)
+{
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+    // returns at once if *word != expected, a wake is never lost
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<uint32_t>* word, int count)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+}
+
+static bool ProcessAlive(int32_t pid)
+{
+    return pid > 0 && (0 == kill(pid, 0) || EPERM == errno);
+}
+
+static inline uint64_t SteadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DvppResizeService::DvppResizeService() : pool_(nullptr), shm_(nullptr), header_(nullptr), request_count_(0),
+                                         failed_count_(0), image_count_(0), busy_us_(0), has_init_over_(false)
+{
+
+}
+
+DvppResizeService::~DvppResizeService()
+{
+    DestroyResource();
+}
+
+void DvppResizeService::Init(const DVPPResizeServiceConfig *config, WorkerPool *pool)
+{
+    config_ = *config;
+    name_ = config_.name ? config_.name : "";
+    pool_ = pool;
+    const DVPPResizeInitConfig& resize_config = config_.resize_config;
+    // the requests in the shared memory are sized by the resolved(tuned) batch_size
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    if (name_.empty() || '/' != name_[0] || 0 == config_.lane_num || 0 == config_.channel_num ||
+        0 == config_.max_src_width || 0 == config_.max_src_height)
+    {
+        AIALG_ERROR("bad resize service config\n");
+        return;
+    }
+
+    DVPPImageData max_frame;
+    max_frame.width = config_.max_src_width;
+    max_frame.height = config_.max_src_height;
+    max_frame.alignWidth = 0;
+    max_frame.alignHeight = 0;
+    uint32_t width_stride, height_stride, frame_size;
+    GetDvppInputStride(resize_config.input_format, max_frame, width_stride, height_stride, frame_size);
+    uint32_t batch_size = resize_config.batch_size;
+    uint32_t frame_slot_size = ALIGN_UP(frame_size, DVPP_SERVICE_ALIGN);
+    uint32_t out_width_stride = ALIGN_UP16(resize_config.resized_width) * 3;
+    uint32_t out_slot_size = out_width_stride * ALIGN_UP2(resize_config.resized_height);
+    uint64_t request_size = DVPP_SERVICE_ALIGN +
+                            ALIGN_UP(static_cast<uint64_t>(batch_size) * sizeof(DVPPServiceImage), DVPP_SERVICE_ALIGN) +
+                            static_cast<uint64_t>(batch_size) * frame_slot_size +
+                            ALIGN_UP(static_cast<uint64_t>(batch_size) * out_slot_size, DVPP_SERVICE_ALIGN);
+    uint64_t lane_size = DVPP_SERVICE_ALIGN + DVPP_SERVICE_RING_DEPTH * request_size;
+    uint64_t total_size = HeadSize() + config_.lane_num * lane_size;
+
+    // a segment left by a daemon that crashed is replaced, its clients keep their mapping of the old one
+    shm_unlink(name_.c_str());
+    mode_t mode = static_cast<mode_t>(config_.shm_mode & 0777);
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, mode);
+    if (fd < 0)
+    {
+        AIALG_ERROR("shm_open %s failed, errno = %d\n", name_.c_str(), errno);
+        return;
+    }
+    // the umask is not applied, every client that may connect is given by shm_mode
+    fchmod(fd, mode);
+    if (0 != ftruncate(fd, static_cast<off_t>(total_size)))
+    {
+        AIALG_ERROR("ftruncate %s to %lu bytes failed, errno = %d\n", name_.c_str(), total_size, errno);
+        close(fd);
+        shm_unlink(name_.c_str());
+        return;
+    }
+    void* addr = mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        AIALG_ERROR("mmap %s failed, errno = %d\n", name_.c_str(), errno);
+        shm_unlink(name_.c_str());
+        return;
+    }
+    shm_ = static_cast<uint8_t*>(addr);
+    layout_.version = DVPP_SERVICE_VERSION;
+    layout_.server_pid = getpid();
+    layout_.lane_num = config_.lane_num;
+    layout_.batch_size = batch_size;
+    layout_.input_format = resize_config.input_format;
+    layout_.resized_width = resize_config.resized_width;
+    layout_.resized_height = resize_config.resized_height;
+    layout_.frame_slot_size = frame_slot_size;
+    layout_.out_width_stride = out_width_stride;
+    layout_.out_slot_size = out_slot_size;
+    layout_.lane_size = lane_size;
+    layout_.request_size = request_size;
+    layout_.total_size = total_size;
+    header_ = new (shm_) DVPPServiceHeader();
+    header_->magic = 0;
+    header_->version = layout_.version;
+    header_->server_pid = layout_.server_pid;
+    header_->lane_num = layout_.lane_num;
+    header_->batch_size = layout_.batch_size;
+    header_->input_format = layout_.input_format;
+    header_->resized_width = layout_.resized_width;
+    header_->resized_height = layout_.resized_height;
+    header_->frame_slot_size = layout_.frame_slot_size;
+    header_->out_width_stride = layout_.out_width_stride;
+    header_->out_slot_size = layout_.out_slot_size;
+    header_->lane_size = layout_.lane_size;
+    header_->request_size = layout_.request_size;
+    header_->total_size = layout_.total_size;
+    header_->doorbell.store(0);
+    header_->stopping.store(0);
+    for (uint32_t lane = 0; lane < config_.lane_num; ++lane)
+    {
+        ServiceLane* owner = new (LanePtr(shm_, &layout_, lane)) ServiceLane();
+        owner->owner_pid.store(0);
+        for (int entry = 0; entry < DVPP_SERVICE_RING_DEPTH; ++entry)
+        {
+            ServiceRequest* request = new (RequestPtr(shm_, &layout_, lane, entry)) ServiceRequest();
+            request->state.store(REQUEST_FREE);
+        }
+    }
+
+    for (uint32_t channel = 0; channel < config_.channel_num; ++channel)
+    {
+        DVPPResizeInitConfig channel_config = resize_config;
+        HybridResizeWorker* worker = nullptr;
+        if (config_.use_cpu)
+        {
+            worker = CreateHostResizeWorker(channel_config, pool_);
+        }
+        else
+        {
+            aclrtStream stream = nullptr;
+            if (ACL_SUCCESS != aclrtSetCurrentContext(resize_config.context) || ACL_SUCCESS != aclrtCreateStream(&stream))
+            {
+                AIALG_ERROR("create the stream of channel %d failed\n", channel);
+                DestroyResource();
+                return;
+            }
+            streams_.push_back(stream);
+            channel_config.stream = stream;
+            worker = CreateDeviceResizeWorker(channel_config);
+        }
+        if (!worker)
+        {
+            AIALG_ERROR("init resize channel %d failed\n", channel);
+            DestroyResource();
+            return;
+        }
+        workers_.emplace_back(worker);
+    }
+    images_.assign(config_.channel_num, std::vector<DVPPImageData>(batch_size));
+    rois_.assign(config_.channel_num, std::vector<RectInt>(batch_size));
+
+    // clients check magic before anything else
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = DVPP_SERVICE_MAGIC;
+    has_init_over_ = true;
+}
+
+void DvppResizeService::Run()
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("DvppResizeService has not init\n");
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (uint32_t channel = 0; channel < config_.channel_num; ++channel)
+    {
+        threads.emplace_back(&DvppResizeService::ChannelLoop, this, static_cast<int>(channel));
+    }
+    for (size_t idx = 0; idx < threads.size(); ++idx)
+    {
+        threads[idx].join();
+    }
+}
+
+void DvppResizeService::Stop()
+{
+    if (header_)
+    {
+        header_->stopping.store(1);
+        header_->doorbell.fetch_add(1);
+        FutexWake(&header_->doorbell, INT_MAX);
+    }
+}
+
+void DvppResizeService::ChannelLoop(int channel)
+{
+    DvppTimeline::SetThreadName("dvpp_service_channel");
+    if (!config_.use_cpu)
+    {
+        aclrtSetCurrentContext(config_.resize_config.context);
+    }
+    // channels start their scan at different lanes so that no lane is always served last
+    uint32_t start_lane = channel % config_.lane_num;
+    while (0 == header_->stopping.load())
+    {
+        uint32_t doorbell = header_->doorbell.load(std::memory_order_acquire);
+        bool served = false;
+        for (uint32_t step = 0; step < config_.lane_num; ++step)
+        {
+            int lane = static_cast<int>((start_lane + step) % config_.lane_num);
+            for (int entry = 0; entry < DVPP_SERVICE_RING_DEPTH; ++entry)
+            {
+                uint8_t* request = RequestPtr(shm_, &layout_, lane, entry);
+                ServiceRequest* head = reinterpret_cast<ServiceRequest*>(request);
+                uint32_t expected = REQUEST_SUBMITTED;
+                if (!head->state.compare_exchange_strong(expected, REQUEST_RUNNING, std::memory_order_acquire))
+                {
+                    continue;
+                }
+                int ret = ServeRequest(channel, request);
+                head->state.store(1 == ret ? REQUEST_DONE : REQUEST_FAILED, std::memory_order_release);
+                FutexWake(&head->state, INT_MAX);
+                served = true;
+            }
+        }
+        start_lane = (start_lane + 1) % config_.lane_num;
+        if (!served)
+        {
+            // any Submit after the load above changed the doorbell, so this returns at once
+            FutexWait(&header_->doorbell, doorbell, DVPP_SERVICE_POLL_MS);
+        }
+    }
+}
+
+int DvppResizeService::ServeRequest(int channel, uint8_t *request)
+{
+    DVPP_TIMELINE_SCOPE("dvpp_service", "request", channel);
+    uint64_t start_us = SteadyNowUs();
+    request_count_++;
+    const ServiceRequest* head = reinterpret_cast<const ServiceRequest*>(request);
+    // the request is read once, a client writing it meanwhile can not get past the checks
+    int img_num = head->img_num;
+    bool has_rois = 0 != head->has_rois;
+    if (img_num <= 0 || img_num > static_cast<int>(layout_.batch_size))
+    {
+        AIALG_ERROR("bad img_num %d of a request\n", img_num);
+        failed_count_++;
+        return 0;
+    }
+    const DVPPServiceImage* images = RequestImages(request);
+    std::vector<DVPPImageData>& inputs = images_[channel];
+    std::vector<RectInt>& rois = rois_[channel];
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        // the client is not trusted, the whole frame its strides describe must be in its slot
+        DVPPServiceImage image = images[idx];
+        if (image.width < DVPP_INPUT_MIN_WIDTH || image.height < DVPP_INPUT_MIN_HEIGHT ||
+            image.width > DVPP_INPUT_MAX_SIDE || image.height > DVPP_INPUT_MAX_SIDE)
+        {
+            AIALG_ERROR("bad size %ux%u of image %d of a request\n", image.width, image.height, idx);
+            failed_count_++;
+            return 0;
+        }
+        inputs[idx].width = image.width;
+        inputs[idx].height = image.height;
+        inputs[idx].alignWidth = image.alignWidth;
+        inputs[idx].alignHeight = image.alignHeight;
+        inputs[idx].size = image.size;
+        inputs[idx].data = RequestFrame(&layout_, request, idx);
+        uint32_t width_stride, height_stride, buffer_size;
+        GetDvppInputStride(layout_.input_format, inputs[idx], width_stride, height_stride, buffer_size);
+        if (buffer_size > layout_.frame_slot_size || image.size > layout_.frame_slot_size || image.size < buffer_size)
+        {
+            AIALG_ERROR("image %d of a request needs %u bytes, size is %u, frame slot is %u bytes\n", idx, buffer_size,
+                        image.size, layout_.frame_slot_size);
+            failed_count_++;
+            return 0;
+        }
+        // a roi may extend past the image, within a range its width/height can not overflow
+        const int32_t* roi = image.roi;
+        if (has_rois &&
+            (roi[0] > roi[2] || roi[1] > roi[3] || roi[0] < -DVPP_INPUT_MAX_SIDE || roi[1] < -DVPP_INPUT_MAX_SIDE ||
+             roi[2] >= 2 * DVPP_INPUT_MAX_SIDE || roi[3] >= 2 * DVPP_INPUT_MAX_SIDE))
+        {
+            AIALG_ERROR("bad roi of image %d of a request\n", idx);
+            failed_count_++;
+            return 0;
+        }
+        rois[idx].xmin = roi[0];
+        rois[idx].ymin = roi[1];
+        rois[idx].xmax = roi[2];
+        rois[idx].ymax = roi[3];
+        rois[idx].width = rois[idx].xmax - rois[idx].xmin + 1;
+        rois[idx].height = rois[idx].ymax - rois[idx].ymin + 1;
+        int status = CheckDvppImage(config_.resize_config, inputs[idx], has_rois ? &rois[idx] : nullptr);
+        if (DVPP_IMAGE_OK != status)
+        {
+            AIALG_ERROR("image %d of a request failed the checks, status = %d\n", idx, status);
+            failed_count_++;
+            return 0;
+        }
+    }
+    int ret = workers_[channel]->Process(inputs.data(), has_rois ? rois.data() : nullptr, img_num,
+                                         RequestOutput(&layout_, request, 0));
+    if (1 == ret)
+    {
+        image_count_ += img_num;
+    }
+    else
+    {
+        failed_count_++;
+    }
+    busy_us_ += SteadyNowUs() - start_us;
+    return ret;
+}
+
+DVPPResizeServiceStats DvppResizeService::GetStats() const
+{
+    DVPPResizeServiceStats stats;
+    stats.request_count = request_count_.load();
+    stats.failed_count = failed_count_.load();
+    stats.image_count = image_count_.load();
+    stats.busy_us = busy_us_.load();
+    return stats;
+}
+
+void DvppResizeService::DestroyResource()
+{
+    Stop();
+    for (size_t idx = 0; idx < workers_.size(); ++idx)
+    {
+        workers_[idx]->DestroyResource();
+    }
+    workers_.clear();
+    for (size_t idx = 0; idx < streams_.size(); ++idx)
+    {
+        aclrtDestroyStream(streams_[idx]);
+    }
+    streams_.clear();
+    if (shm_)
+    {
+        munmap(shm_, layout_.total_size);
+        shm_unlink(name_.c_str());
+        shm_ = nullptr;
+        header_ = nullptr;
+    }
+    has_init_over_ = false;
+}
+
+DvppResizeClient::DvppResizeClient() : shm_(nullptr), header_(nullptr), lane_(-1), submit_entry_(0), wait_entry_(0),
+                                       pending_(0), done_entry_(-1), done_img_num_(0)
+{
+
+}
+
+DvppResizeClient::~DvppResizeClient()
+{
+    Disconnect();
+}
+
+uint8_t* DvppResizeClient::Request(int entry) const
+{
+    return RequestPtr(shm_, header_, lane_, entry);
+}
+
+// wait until a request of the lane is not queued or running any more, 0 if the daemon went away
+static int WaitRequestSettled(const DVPPServiceHeader* header, ServiceRequest* head)
+{
+    while (true)
+    {
+        uint32_t state = head->state.load(std::memory_order_acquire);
+        if (REQUEST_SUBMITTED != state && REQUEST_RUNNING != state)
+        {
+            return 1;
+        }
+        // a request still queued when the daemon stops is never served
+        if (!ProcessAlive(header->server_pid) || (REQUEST_SUBMITTED == state && header->stopping.load()))
+        {
+            return 0;
+        }
+        FutexWait(&head->state, state, DVPP_SERVICE_POLL_MS);
+    }
+}
+
+int DvppResizeClient::Connect(const std::string &name)
+{
+    Disconnect();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        AIALG_ERROR("no resize service at %s, errno = %d\n", name.c_str(), errno);
+        return 0;
+    }
+    struct stat st;
+    if (0 != fstat(fd, &st) || st.st_size < static_cast<off_t>(sizeof(DVPPServiceHeader)))
+    {
+        AIALG_ERROR("%s is not a resize service\n", name.c_str());
+        close(fd);
+        return 0;
+    }
+    void* addr = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (MAP_FAILED == addr)
+    {
+        AIALG_ERROR("mmap %s failed, errno = %d\n", name.c_str(), errno);
+        return 0;
+    }
+    shm_ = static_cast<uint8_t*>(addr);
+    header_ = reinterpret_cast<DVPPServiceHeader*>(shm_);
+    uint32_t magic = header_->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (DVPP_SERVICE_MAGIC != magic || DVPP_SERVICE_VERSION != header_->version ||
+        header_->total_size != static_cast<uint64_t>(st.st_size) || !ProcessAlive(header_->server_pid))
+    {
+        AIALG_ERROR("%s is not a running resize service of version %d\n", name.c_str(), DVPP_SERVICE_VERSION);
+        munmap(shm_, st.st_size);
+        shm_ = nullptr;
+        header_ = nullptr;
+        return 0;
+    }
+
+    int32_t pid = getpid();
+    for (uint32_t lane = 0; lane < header_->lane_num && lane_ < 0; ++lane)
+    {
+        ServiceLane* owner = reinterpret_cast<ServiceLane*>(LanePtr(shm_, header_, lane));
+        int32_t expected = owner->owner_pid.load();
+        // a lane of a dead client is taken over once its last requests are settled
+        if ((0 == expected || !ProcessAlive(expected)) && owner->owner_pid.compare_exchange_strong(expected, pid))
+        {
+            lane_ = static_cast<int>(lane);
+        }
+    }
+    if (lane_ < 0)
+    {
+        AIALG_ERROR("all %d lanes of %s are in use\n", header_->lane_num, name.c_str());
+        munmap(shm_, header_->total_size);
+        shm_ = nullptr;
+        header_ = nullptr;
+        return 0;
+    }
+    for (int entry = 0; entry < DVPP_SERVICE_RING_DEPTH; ++entry)
+    {
+        ServiceRequest* head = reinterpret_cast<ServiceRequest*>(Request(entry));
+        if (1 != WaitRequestSettled(header_, head))
+        {
+            Disconnect();
+            return 0;
+        }
+        head->state.store(REQUEST_FREE);
+    }
+    submit_entry_ = 0;
+    wait_entry_ = 0;
+    pending_ = 0;
+    done_entry_ = -1;
+    done_img_num_ = 0;
+    return 1;
+}
+
+int DvppResizeClient::GetInputSlot(DVPPImageData &image, int index, uint32_t width, uint32_t height)
+{
+    if (!header_ || index < 0 || index >= static_cast<int>(header_->batch_size) || DVPP_SERVICE_RING_DEPTH == pending_)
+    {
+        AIALG_ERROR("no frame slot %d, connected = %d, pending = %d\n", index, header_ ? 1 : 0, pending_);
+        return 0;
+    }
+    image.width = width;
+    image.height = height;
+    image.alignWidth = 0;
+    image.alignHeight = 0;
+    uint32_t width_stride, height_stride, buffer_size;
+    GetDvppInputStride(header_->input_format, image, width_stride, height_stride, buffer_size);
+    if (buffer_size > header_->frame_slot_size)
+    {
+        AIALG_ERROR("a %ux%u frame does not fit a frame slot of %u bytes\n", width, height, header_->frame_slot_size);
+        return 0;
+    }
+    image.alignWidth = width_stride;
+    image.alignHeight = height_stride;
+    image.size = buffer_size;
+    image.data = RequestFrame(header_, Request(submit_entry_), index);
+    return 1;
+}
+
+int DvppResizeClient::Process(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    if (1 != Submit(srcImage, rois, img_num))
+    {
+        return 0;
+    }
+    return Wait();
+}
+
+int DvppResizeClient::Submit(const DVPPImageData *srcImage, const RectInt *rois, int img_num)
+{
+    if (!header_ || DVPP_SERVICE_RING_DEPTH == pending_)
+    {
+        AIALG_ERROR("can not submit, connected = %d, pending = %d\n", header_ ? 1 : 0, pending_);
+        return 0;
+    }
+    if (img_num <= 0 || img_num > static_cast<int>(header_->batch_size))
+    {
+        AIALG_ERROR("img_num must be in [1, batch_size], img_num = %d, batch_size = %d\n", img_num, header_->batch_size);
+        return 0;
+    }
+    uint8_t* request = Request(submit_entry_);
+    DVPPServiceImage* images = RequestImages(request);
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        uint32_t width_stride, height_stride, buffer_size;
+        GetDvppInputStride(header_->input_format, srcImage[idx], width_stride, height_stride, buffer_size);
+        if (!srcImage[idx].data || buffer_size > header_->frame_slot_size)
+        {
+            AIALG_ERROR("image %d does not fit a frame slot of %u bytes\n", idx, header_->frame_slot_size);
+            return 0;
+        }
+        uint8_t* frame = RequestFrame(header_, request, idx);
+        // frames written into their slot by GetInputSlot are not copied
+        if (srcImage[idx].data != frame)
+        {
+            std::memcpy(frame, srcImage[idx].data, buffer_size);
+        }
+        images[idx].width = srcImage[idx].width;
+        images[idx].height = srcImage[idx].height;
+        images[idx].alignWidth = width_stride;
+        images[idx].alignHeight = height_stride;
+        images[idx].size = buffer_size;
+        if (rois)
+        {
+            images[idx].roi[0] = rois[idx].xmin;
+            images[idx].roi[1] = rois[idx].ymin;
+            images[idx].roi[2] = rois[idx].xmax;
+            images[idx].roi[3] = rois[idx].ymax;
+        }
+    }
+    ServiceRequest* head = reinterpret_cast<ServiceRequest*>(request);
+    head->img_num = img_num;
+    head->has_rois = rois ? 1 : 0;
+    head->state.store(REQUEST_SUBMITTED, std::memory_order_release);
+    header_->doorbell.fetch_add(1, std::memory_order_release);
+    FutexWake(&header_->doorbell, 1);
+    submit_entry_ = (submit_entry_ + 1) % DVPP_SERVICE_RING_DEPTH;
+    pending_++;
+    return 1;
+}
+
+int DvppResizeClient::Wait()
+{
+    if (!header_ || 0 == pending_)
+    {
+        AIALG_ERROR("nothing submitted\n");
+        return 0;
+    }
+    ServiceRequest* head = reinterpret_cast<ServiceRequest*>(Request(wait_entry_));
+    int settled = WaitRequestSettled(header_, head);
+    int ret = settled && REQUEST_DONE == head->state.load(std::memory_order_acquire) ? 1 : 0;
+    if (!settled)
+    {
+        AIALG_ERROR("the resize service is gone\n");
+    }
+    done_entry_ = 1 == ret ? wait_entry_ : -1;
+    done_img_num_ = 1 == ret ? head->img_num : 0;
+    wait_entry_ = (wait_entry_ + 1) % DVPP_SERVICE_RING_DEPTH;
+    pending_--;
+    return ret;
+}
+
+int DvppResizeClient::Get(DVPPImageData &resizedImage, int index) const
+{
+    if (done_entry_ < 0 || index < 0 || index >= done_img_num_)
+    {
+        AIALG_ERROR("no result %d\n", index);
+        return 0;
+    }
+    resizedImage.width = header_->resized_width;
+    resizedImage.height = header_->resized_height;
+    resizedImage.alignWidth = header_->out_width_stride;
+    resizedImage.alignHeight = ALIGN_UP2(header_->resized_height);
+    resizedImage.size = header_->out_slot_size;
+    resizedImage.data = RequestOutput(header_, Request(done_entry_), index);
+    return 1;
+}
+
+void DvppResizeClient::Disconnect()
+{
+    if (!shm_)
+    {
+        return;
+    }
+    if (lane_ >= 0)
+    {
+        for (int entry = 0; entry < DVPP_SERVICE_RING_DEPTH; ++entry)
+        {
+            WaitRequestSettled(header_, reinterpret_cast<ServiceRequest*>(Request(entry)));
+        }
+        reinterpret_cast<ServiceLane*>(LanePtr(shm_, header_, lane_))->owner_pid.store(0);
+        lane_ = -1;
+    }
+    munmap(shm_, header_->total_size);
+    shm_ = nullptr;
+    header_ = nullptr;
+    pending_ = 0;
+    done_entry_ = -1;
+    done_img_num_ = 0;
+}
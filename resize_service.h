@@ -0,0 +1,204 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_RESIZE_SERVICE_H
+#define _PICTURE_INC_RESIZE_SERVICE_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+#include "hybrid_resize.h"
+#include "worker_pool.h"
+
+#define DVPP_SERVICE_MAGIC 0x53525644u  // "DVRS"
+#define DVPP_SERVICE_VERSION 1
+// requests in flight per client, Submit(b1) may be called before Wait for b0
+#define DVPP_SERVICE_RING_DEPTH 2
+// a waiting client checks that the daemon is still alive this often
+#define DVPP_SERVICE_POLL_MS 100
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // batch_size, input_format, resized size and options of every request,
+                                         // context of the vpc channels, stream is created per channel
+    const char* name = "/dvpp_resize";   // shm_open name the clients connect to
+    uint32_t lane_num = 8;               // clients connected at once
+    uint32_t channel_num = 1;            // resize threads, each with its own DvppResize/CpuResize
+    uint32_t max_src_width = 1920;       // frame slots hold an input of up to this size
+    uint32_t max_src_height = 1080;
+    uint32_t use_cpu = 0;                // 1: CpuResize stands in for the vpc, no acl calls
+    uint32_t shm_mode = 0600;            // permissions of the shared memory, 0660 lets clients of the same group in
+    char reserve[8];
+} DVPPResizeServiceConfig;
+
+typedef struct{
+    uint64_t request_count = 0;
+    uint64_t failed_count = 0;
+    uint64_t image_count = 0;
+    uint64_t busy_us = 0;      // summed over channels
+} DVPPResizeServiceStats;
+
+/**
+* @brief the frame, roi and result of one image of a request, in shared memory
+*/
+typedef struct{
+    uint32_t width;
+    uint32_t height;
+    uint32_t alignWidth;
+    uint32_t alignHeight;
+    uint32_t size;
+    int32_t roi[4];            // xmin, ymin, xmax, ymax, used if has_rois of the request
+} DVPPServiceImage;
+
+/**
+* @brief head of the shared memory, followed by lane_num lanes of DVPP_SERVICE_RING_DEPTH requests,
+*        every request holds batch_size DVPPServiceImage, frame slots and output slots
+*/
+typedef struct{
+    uint32_t magic;            // written last by the daemon
+    uint32_t version;
+    int32_t server_pid;
+    uint32_t lane_num;
+    uint32_t batch_size;
+    uint32_t input_format;
+    uint32_t resized_width;
+    uint32_t resized_height;
+    uint32_t frame_slot_size;  // bytes of one frame slot
+    uint32_t out_width_stride;
+    uint32_t out_slot_size;
+    uint32_t reserve;
+    uint64_t lane_size;
+    uint64_t request_size;
+    uint64_t total_size;
+    std::atomic<uint32_t> doorbell;  // futex word, bumped by every Submit, the channels sleep on it
+    std::atomic<uint32_t> stopping;
+} DVPPServiceHeader;
+
+/**
+* @brief local resize daemon: owns the vpc channels(or the CpuResize stand-in) for every inference process of the
+*        host, clients write frames straight into frame slots of a shared memory ring and sleep on a futex
+*        until their request is done, results are written straight into the output slots of the request
+*/
+class DvppResizeService {
+public:
+    DvppResizeService();
+
+    ~DvppResizeService();
+
+    /**
+    * @param [in] pool: workers of the CpuResize stand-in, nullptr runs it on the channel threads
+    */
+    void Init(const DVPPResizeServiceConfig* config, WorkerPool* pool = nullptr);
+
+    /**
+    * @brief serve requests on channel_num threads until Stop, a lane of a client that died is reclaimed
+    *        by the next client that connects
+    */
+    void Run();
+
+    /**
+    * @brief make Run return, may be called from a signal handler thread
+    */
+    void Stop();
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    DVPPResizeServiceStats GetStats() const;
+
+    void DestroyResource();
+
+private:
+    void ChannelLoop(int channel);
+
+    int ServeRequest(int channel, uint8_t* request);
+
+private:
+    DVPPResizeServiceConfig config_;
+    std::string name_;
+    WorkerPool* pool_;
+    uint8_t* shm_;
+    DVPPServiceHeader* header_;
+    DVPPServiceHeader layout_;  // the daemon's copy of the layout, the shared header may be written by any client
+    std::vector<std::unique_ptr<HybridResizeWorker> > workers_;
+    std::vector<aclrtStream> streams_;
+    std::vector<std::vector<DVPPImageData> > images_;  // per channel
+    std::vector<std::vector<RectInt> > rois_;
+    std::atomic<uint64_t> request_count_;
+    std::atomic<uint64_t> failed_count_;
+    std::atomic<uint64_t> image_count_;
+    std::atomic<uint64_t> busy_us_;
+    bool has_init_over_;
+};
+
+/**
+* @brief client of DvppResizeService, mirrors Process/Get of DvppResize, everything is host memory:
+*        GetInputSlot(...) and write the frame there(no copy), or pass any host images to Process(copied once)
+*/
+class DvppResizeClient {
+public:
+    DvppResizeClient();
+
+    ~DvppResizeClient();
+
+    /**
+    * @return 1 success, 0 no daemon at name or no free lane
+    */
+    int Connect(const std::string& name = "/dvpp_resize");
+
+    /**
+    * @brief frame slot index of the next Submit, sized for a width x height input of the service format
+    * @return 1 success, 0 not connected, index out of batch_size or the frame is larger than a slot
+    */
+    int GetInputSlot(DVPPImageData& image, int index, uint32_t width, uint32_t height);
+
+    /**
+    * @brief Submit + Wait
+    */
+    int Process(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief queue a request, images that are not already in their frame slot are copied into it
+    * @return 1 success, 0 failed(DVPP_SERVICE_RING_DEPTH requests in flight: Wait first)
+    */
+    int Submit(const DVPPImageData* srcImage, const RectInt* rois, int img_num);
+
+    /**
+    * @brief wait for the oldest submitted request, Get then reads its results
+    * @return 1 success, 0 the request failed, nothing submitted or the daemon is gone
+    */
+    int Wait();
+
+    /**
+    * @brief result index of the last waited request, valid until the request after the next one is submitted
+    */
+    int Get(DVPPImageData& resizedImage, int index) const;
+
+    inline uint32_t GetBatchSize() const
+    {
+        return header_ ? header_->batch_size : 0;
+    }
+
+    void Disconnect();
+
+private:
+    uint8_t* Request(int entry) const;
+
+private:
+    uint8_t* shm_;
+    DVPPServiceHeader* header_;
+    int lane_;
+    int submit_entry_;
+    int wait_entry_;
+    int pending_;
+    int done_entry_;
+    int done_img_num_;
+};
+
+#endif // _PICTURE_INC_RESIZE_SERVICE_H
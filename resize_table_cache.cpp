@@ -0,0 +1,214 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include "resize_table_cache.h"
+#include "alg_define.h"
+
+// map dst coordinate d of [dst_lo, ...] to [lo, hi] of the source the same way as vpc(pixel center aligned)
+static void MapCoord(int d, int dst_lo, float scale, int lo, int hi, int interpolation,
+                     int& s0, int& s1, int16_t& w0, int16_t& w1)
+{
+    const int one = 1 << RESIZE_COEF_BITS;
+    if (RESIZE_INTER_NEAREST == interpolation)
+    {
+        s0 = static_cast<int>((d - dst_lo + 0.5f) * scale) + lo;
+        s0 = s0 > hi ? hi : s0;
+        s1 = s0;
+        w0 = one;
+        w1 = 0;
+        return;
+    }
+    float fs = (d - dst_lo + 0.5f) * scale - 0.5f + lo;
+    fs = fs < lo ? lo : fs;
+    s0 = static_cast<int>(fs);
+    s0 = s0 > hi ? hi : s0;
+    s1 = s0 + 1 > hi ? hi : s0 + 1;
+    int alpha = static_cast<int>(std::lround((fs - s0) * one));
+    alpha = alpha > one ? one : alpha;
+    w0 = static_cast<int16_t>(one - alpha);
+    w1 = static_cast<int16_t>(alpha);
+}
+
+ResizeTables::ResizeTables() : xofs(nullptr), xw(nullptr), yofs(nullptr), yw(nullptr), uv_xofs(nullptr),
+                               uv_yofs(nullptr), bytes(0), block(nullptr)
+{
+
+}
+
+ResizeTables::~ResizeTables()
+{
+    fastFree(block);
+}
+
+static std::shared_ptr<const ResizeTables> BuildTables(const ResizeTableKey& key)
+{
+    int nx = key.out_right - key.out_left + 1;
+    int ny = key.out_bottom - key.out_top + 1;
+    bool has_uv = 1 == key.pixel_step;
+    size_t xofs_bytes = alignSize(sizeof(int32_t) * 2 * nx, AI_MALLOC_ALIGN);
+    size_t xw_bytes = alignSize(sizeof(int16_t) * 2 * nx, AI_MALLOC_ALIGN);
+    size_t yofs_bytes = alignSize(sizeof(int32_t) * 2 * ny, AI_MALLOC_ALIGN);
+    size_t yw_bytes = alignSize(sizeof(int16_t) * 2 * ny, AI_MALLOC_ALIGN);
+    size_t uv_xofs_bytes = has_uv ? alignSize(sizeof(int32_t) * nx, AI_MALLOC_ALIGN) : 0;
+    size_t uv_yofs_bytes = has_uv ? alignSize(sizeof(int32_t) * ny, AI_MALLOC_ALIGN) : 0;
+
+    std::shared_ptr<ResizeTables> tables = std::make_shared<ResizeTables>();
+    tables->key = key;
+    tables->bytes = xofs_bytes + xw_bytes + yofs_bytes + yw_bytes + uv_xofs_bytes + uv_yofs_bytes;
+    tables->block = fastMalloc(tables->bytes);
+    if (!tables->block)
+    {
+        AIALG_ERROR("fastMalloc %zu bytes of resize tables failed\n", tables->bytes);
+        return nullptr;
+    }
+    uint8_t* ptr = static_cast<uint8_t*>(tables->block);
+    tables->xofs = reinterpret_cast<int32_t*>(ptr);
+    ptr += xofs_bytes;
+    tables->xw = reinterpret_cast<int16_t*>(ptr);
+    ptr += xw_bytes;
+    tables->yofs = reinterpret_cast<int32_t*>(ptr);
+    ptr += yofs_bytes;
+    tables->yw = reinterpret_cast<int16_t*>(ptr);
+    ptr += yw_bytes;
+    if (has_uv)
+    {
+        tables->uv_xofs = reinterpret_cast<int32_t*>(ptr);
+        tables->uv_yofs = reinterpret_cast<int32_t*>(ptr + uv_xofs_bytes);
+    }
+
+    float scale_x = 1.0f * (key.right - key.left + 1) / nx;
+    float scale_y = 1.0f * (key.bottom - key.top + 1) / ny;
+    for (int d = 0; d < nx; ++d)
+    {
+        int x0, x1;
+        MapCoord(d + key.out_left, key.out_left, scale_x, key.left, key.right, key.interpolation, x0, x1,
+                 tables->xw[2 * d], tables->xw[2 * d + 1]);
+        tables->xofs[2 * d] = (x0 - key.left) * key.pixel_step;
+        tables->xofs[2 * d + 1] = (x1 - key.left) * key.pixel_step;
+        if (has_uv)
+        {
+            tables->uv_xofs[d] = x0 / 2 * 2;
+        }
+    }
+    for (int d = 0; d < ny; ++d)
+    {
+        int y0, y1;
+        MapCoord(d + key.out_top, key.out_top, scale_y, key.top, key.bottom, key.interpolation, y0, y1,
+                 tables->yw[2 * d], tables->yw[2 * d + 1]);
+        tables->yofs[2 * d] = y0;
+        tables->yofs[2 * d + 1] = y1;
+        if (has_uv)
+        {
+            tables->uv_yofs[d] = y0 / 2;
+        }
+    }
+    return tables;
+}
+
+size_t ResizeTableCache::KeyHash::operator()(const ResizeTableKey &key) const
+{
+    // all fields are int32, fnv-1a over them
+    const int32_t* fields = reinterpret_cast<const int32_t*>(&key);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t idx = 0; idx < sizeof(ResizeTableKey) / sizeof(int32_t); ++idx)
+    {
+        hash = (hash ^ static_cast<uint32_t>(fields[idx])) * 1099511628211ULL;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool ResizeTableCache::KeyEqual::operator()(const ResizeTableKey &a, const ResizeTableKey &b) const
+{
+    return 0 == std::memcmp(&a, &b, sizeof(ResizeTableKey));
+}
+
+ResizeTableCache::ResizeTableCache() : capacity_(RESIZE_TABLE_CACHE_ENTRIES)
+{
+
+}
+
+ResizeTableCache& ResizeTableCache::Instance()
+{
+    static ResizeTableCache cache;
+    return cache;
+}
+
+std::shared_ptr<const ResizeTables> ResizeTableCache::Acquire(const ResizeTableKey &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = index_.find(key);
+        if (iter != index_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, iter->second);
+            stats_.hit_count++;
+            return lru_.front();
+        }
+        stats_.miss_count++;
+    }
+
+    // build outside of the lock, a concurrent miss of the same key builds twice and keeps the first
+    std::shared_ptr<const ResizeTables> tables = BuildTables(key);
+    if (!tables)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = index_.find(key);
+    if (iter != index_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, iter->second);
+        return lru_.front();
+    }
+    lru_.push_front(tables);
+    index_[key] = lru_.begin();
+    stats_.bytes += tables->bytes;
+    EvictLocked();
+    return tables;
+}
+
+void ResizeTableCache::EvictLocked()
+{
+    while (lru_.size() > capacity_)
+    {
+        stats_.bytes -= lru_.back()->bytes;
+        stats_.evict_count++;
+        index_.erase(lru_.back()->key);
+        lru_.pop_back();
+    }
+    stats_.entry_count = lru_.size();
+}
+
+void ResizeTableCache::SetCapacity(size_t max_entries)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = max_entries;
+    EvictLocked();
+}
+
+ResizeTableCacheStats ResizeTableCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ResizeTableCache::ResetStats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.hit_count = 0;
+    stats_.miss_count = 0;
+    stats_.evict_count = 0;
+}
+
+void ResizeTableCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+    stats_.bytes = 0;
+    stats_.entry_count = 0;
+}
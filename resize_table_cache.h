@@ -0,0 +1,119 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_RESIZE_TABLE_CACHE_H
+#define _PICTURE_INC_RESIZE_TABLE_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+
+// fixed point bits of the interpolation weights, w0 + w1 == 1 << RESIZE_COEF_BITS
+#define RESIZE_COEF_BITS 11
+// default number of geometries kept by ResizeTableCache
+#define RESIZE_TABLE_CACHE_ENTRIES 64
+
+enum ResizeInterpolation {
+    RESIZE_INTER_DEFAULT = 0,  // the same as acldvppSetResizeConfigInterpolation
+    RESIZE_INTER_BILINEAR = 1,
+    RESIZE_INTER_NEAREST = 2,
+};
+
+/**
+* @brief everything the per-column and per-row coordinates depend on
+*/
+typedef struct{
+    int32_t src_width = 0;
+    int32_t src_height = 0;
+    int32_t left = 0;         // crop, inclusive
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+    int32_t out_left = 0;     // paste area, inclusive
+    int32_t out_top = 0;
+    int32_t out_right = 0;
+    int32_t out_bottom = 0;
+    int32_t pixel_step = 3;   // bytes per pixel of the interpolated plane, 3: BGR_888, 1: luma of yuv420sp
+    int32_t interpolation = RESIZE_INTER_BILINEAR;
+} ResizeTableKey;
+
+/**
+* @brief coordinate/weight tables of one geometry, one 64 bytes aligned fastMalloc block,
+*        column d of the paste area reads src bytes xofs[2d], xofs[2d + 1] with weights xw[2d], xw[2d + 1],
+*        row d reads src rows yofs[2d], yofs[2d + 1] with weights yw[2d], yw[2d + 1]
+*/
+struct ResizeTables {
+    ResizeTableKey key;
+    int32_t* xofs;     // byte offset from the crop left of the src row
+    int16_t* xw;
+    int32_t* yofs;     // absolute src row
+    int16_t* yw;
+    int32_t* uv_xofs;  // byte offset of the uv pair from the row start, yuv420sp only
+    int32_t* uv_yofs;  // uv row
+    size_t bytes;
+    void* block;
+
+    ResizeTables();
+
+    ~ResizeTables();
+};
+
+typedef struct{
+    uint64_t hit_count = 0;
+    uint64_t miss_count = 0;
+    uint64_t evict_count = 0;
+    uint64_t entry_count = 0;
+    uint64_t bytes = 0;
+} ResizeTableCacheStats;
+
+/**
+* @brief process wide bounded LRU of ResizeTables shared by all resize instances, thread safe,
+*        a table stays valid while any caller holds its shared_ptr even after it is evicted
+*/
+class ResizeTableCache {
+public:
+    static ResizeTableCache& Instance();
+
+    /**
+    * @brief the tables of key, built on a miss
+    */
+    std::shared_ptr<const ResizeTables> Acquire(const ResizeTableKey& key);
+
+    /**
+    * @brief max number of geometries kept, least recently used ones are evicted
+    */
+    void SetCapacity(size_t max_entries);
+
+    ResizeTableCacheStats GetStats() const;
+
+    void ResetStats();
+
+    void Clear();
+
+private:
+    ResizeTableCache();
+
+    struct KeyHash {
+        size_t operator()(const ResizeTableKey& key) const;
+    };
+
+    struct KeyEqual {
+        bool operator()(const ResizeTableKey& a, const ResizeTableKey& b) const;
+    };
+
+    typedef std::list<std::shared_ptr<const ResizeTables> > LruList;
+
+    void EvictLocked();
+
+private:
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    LruList lru_;  // most recently used first
+    std::unordered_map<ResizeTableKey, LruList::iterator, KeyHash, KeyEqual> index_;
+    ResizeTableCacheStats stats_;
+};
+
+#endif // _PICTURE_INC_RESIZE_TABLE_CACHE_H
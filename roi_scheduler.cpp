@@ -0,0 +1,223 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <chrono>
+#include <algorithm>
+#include "roi_scheduler.h"
+#include "alg_define.h"
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static inline int FloorLog2(uint64_t val)
+{
+    int bits = -1;
+    while (val)
+    {
+        val >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+RoiScheduler::RoiScheduler() : base_ticket_(0), next_ticket_(0), arena_dev_(nullptr), slot_size_(0), arena_slots_(0),
+                               has_init_over_(false)
+{
+
+}
+
+RoiScheduler::~RoiScheduler()
+{
+
+}
+
+void RoiScheduler::Init(const DVPPRoiSchedulerConfig *config)
+{
+    config_ = *config;
+    if (config_.arena_batches < 1)
+    {
+        AIALG_ERROR("arena_batches must be >= 1\n");
+        return;
+    }
+    config_.resize_config.use_external_output = 1;
+    // the arena is sized by the resolved(tuned) batch_size, not only the inner DvppResize
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    resize_.Init(&config_.resize_config);
+    if (!resize_.HasInit())
+    {
+        return;
+    }
+
+    uint32_t batch_size = config_.resize_config.batch_size;
+    slot_size_ = ALIGN_UP16(config_.resize_config.resized_width) * 3 * ALIGN_UP2(config_.resize_config.resized_height);
+    // one more slot keeps the last popped result readable while the next batch runs
+    arena_slots_ = static_cast<int64_t>(batch_size) * config_.arena_batches + 1;
+    aclError aclRet = acldvppMalloc(&arena_dev_, static_cast<size_t>(slot_size_) * arena_slots_);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc arena failed, aclRet = %d\n", aclRet);
+        return;
+    }
+    buckets_.resize(config_.use_buckets ? DVPP_SCHED_AREA_CLASSES * DVPP_SCHED_SCALE_CLASSES : 1);
+    batch_frames_.reserve(batch_size);
+    batch_rois_.reserve(batch_size);
+    batch_slots_.reserve(batch_size);
+    has_init_over_ = true;
+}
+
+void RoiScheduler::DestroyResource()
+{
+    resize_.DestroyResource();
+    if (arena_dev_)
+    {
+        acldvppFree(arena_dev_);
+        arena_dev_ = nullptr;
+    }
+    buckets_.clear();
+    results_.clear();
+    has_init_over_ = false;
+}
+
+int RoiScheduler::BucketIndex(const RectInt &roi) const
+{
+    if (1 == buckets_.size())
+    {
+        return 0;
+    }
+    uint64_t width = std::max(roi.xmax - roi.xmin + 1, 1);
+    uint64_t height = std::max(roi.ymax - roi.ymin + 1, 1);
+    int area_class = std::min(FloorLog2(width * height) / 2, DVPP_SCHED_AREA_CLASSES - 1);
+
+    // resize ratio of the longer side, the same r as GetDvppPasteArea
+    uint64_t out_side = std::max(config_.resize_config.resized_width, config_.resize_config.resized_height);
+    uint64_t src_side = std::max(width, height);
+    int scale_class = src_side > 2 * out_side ? 0 : (out_side > 2 * src_side ? 2 : 1);
+    return area_class * DVPP_SCHED_SCALE_CLASSES + scale_class;
+}
+
+int64_t RoiScheduler::Submit(const DVPPImageData &frame, const RectInt &roi)
+{
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("RoiScheduler has not init\n");
+        return -1;
+    }
+    PendingRoi pending;
+    pending.ticket = next_ticket_++;
+    pending.frame = frame;
+    pending.roi = roi;
+    pending.submit_ns = SteadyNowNs();
+    std::deque<PendingRoi>& bucket = buckets_[BucketIndex(roi)];
+    bucket.push_back(pending);
+
+    RoiResult result;
+    result.done = false;
+    result.ok = false;
+    result.image_status = DVPP_IMAGE_OK;
+    results_.push_back(result);
+    stats_.submit_count++;
+
+    if (bucket.size() >= config_.resize_config.batch_size)
+    {
+        RunBucket(bucket);
+    }
+    return pending.ticket;
+}
+
+int RoiScheduler::RunBucket(std::deque<PendingRoi> &bucket)
+{
+    // the bucket is in ticket order, rois whose slot is still held by an unpopped result wait
+    uint32_t batch_size = config_.resize_config.batch_size;
+    int64_t ticket_end = base_ticket_ + arena_slots_ - 1;
+    batch_frames_.clear();
+    batch_rois_.clear();
+    batch_slots_.clear();
+    for (size_t idx = 0; idx < bucket.size() && idx < batch_size && bucket[idx].ticket < ticket_end; ++idx)
+    {
+        batch_frames_.push_back(bucket[idx].frame);
+        batch_rois_.push_back(bucket[idx].roi);
+        batch_slots_.push_back(ResultSlot(bucket[idx].ticket));
+    }
+    int img_num = static_cast<int>(batch_frames_.size());
+    if (0 == img_num)
+    {
+        return 0;
+    }
+    DVPP_TIMELINE_SCOPE("roi_scheduler", "run_bucket", img_num);
+
+    DVPPOutputBinding output;
+    output.size = slot_size_;
+    output.slot_data = batch_slots_.data();
+    int ret = resize_.Process(batch_frames_.data(), batch_rois_.data(), img_num, &output);
+
+    // with drop_bad_images the call succeeds if any roi was resized, the slots of the left out ones are stale
+    uint64_t failed_num = 0;
+    for (int idx = 0; idx < img_num; ++idx)
+    {
+        RoiResult& result = results_[bucket[idx].ticket - base_ticket_];
+        result.done = true;
+        result.image_status = resize_.GetImageStatus(idx);
+        result.ok = 1 == ret && DVPP_IMAGE_OK == result.image_status;
+        failed_num += result.ok ? 0 : 1;
+    }
+    bucket.erase(bucket.begin(), bucket.begin() + img_num);
+
+    stats_.batch_count++;
+    stats_.full_batch_count += img_num == static_cast<int>(batch_size) ? 1 : 0;
+    stats_.failed_count += failed_num;
+    return 1;
+}
+
+int RoiScheduler::Flush(bool force)
+{
+    if (!has_init_over_)
+    {
+        return 0;
+    }
+    uint64_t now_ns = SteadyNowNs();
+    uint64_t max_delay_ns = static_cast<uint64_t>(config_.max_delay_us) * 1000;
+    int batches = 0;
+    for (size_t idx = 0; idx < buckets_.size(); ++idx)
+    {
+        std::deque<PendingRoi>& bucket = buckets_[idx];
+        while (!bucket.empty() && (force || bucket.size() >= config_.resize_config.batch_size ||
+                                   now_ns - bucket.front().submit_ns >= max_delay_ns))
+        {
+            if (1 != RunBucket(bucket))
+            {
+                break;
+            }
+            batches++;
+        }
+    }
+    return batches;
+}
+
+int RoiScheduler::Pop(int64_t &ticket, DVPPImageData &resized, int *image_status)
+{
+    if (results_.empty() || !results_.front().done)
+    {
+        return 0;
+    }
+    ticket = base_ticket_;
+    resized.width = config_.resize_config.resized_width;
+    resized.height = config_.resize_config.resized_height;
+    resized.alignWidth = ALIGN_UP16(config_.resize_config.resized_width) * 3;
+    resized.alignHeight = ALIGN_UP2(config_.resize_config.resized_height);
+    resized.size = results_.front().ok ? slot_size_ : 0;
+    resized.data = results_.front().ok ? ResultSlot(ticket) : nullptr;
+    if (image_status)
+    {
+        *image_status = results_.front().image_status;
+    }
+    results_.pop_front();
+    base_ticket_++;
+    return 1;
+}
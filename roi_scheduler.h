@@ -0,0 +1,126 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_ROI_SCHEDULER_H
+#define _PICTURE_INC_ROI_SCHEDULER_H
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+
+// area classes(one class per 4x of roi area) and scale classes(down > 2x, [1/2, 2], up > 2x)
+#define DVPP_SCHED_AREA_CLASSES 12
+#define DVPP_SCHED_SCALE_CLASSES 3
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // batch_size is the max rois of one vpc call, output is owned by the scheduler
+    uint32_t max_delay_us = 2000;        // a bucket is flushed when its oldest roi waited this long
+    uint32_t arena_batches = 16;         // result slots = arena_batches * batch_size, how far results may run ahead of Pop
+    uint32_t use_buckets = 1;            // 0: one fifo bucket, the baseline of roi_scheduler_bench
+    char reserve[8];
+} DVPPRoiSchedulerConfig;
+
+typedef struct{
+    uint64_t submit_count = 0;
+    uint64_t batch_count = 0;
+    uint64_t full_batch_count = 0;   // flushed because batch_size rois were pending
+    uint64_t failed_count = 0;       // rois whose batch failed or that were left out of it(drop_bad_images)
+} DVPPRoiSchedulerStats;
+
+/**
+* @brief collect rois of many frames, group them by source area and resize ratio so that one vpc
+*        batch never mixes 32x32 crops with 1000x1000 ones, results are popped in submit order:
+*        ticket = Submit(frame, roi); ... Flush(false); while (Pop(ticket, resized)) {...}
+*/
+class RoiScheduler {
+public:
+    RoiScheduler();
+
+    ~RoiScheduler();
+
+    void Init(const DVPPRoiSchedulerConfig* config);
+
+    /**
+    * @brief queue one roi, frame.data must stay valid until the roi is popped, full buckets are run at once
+    * @return ticket(submit order, starts from 0), -1 failed
+    */
+    int64_t Submit(const DVPPImageData& frame, const RectInt& roi);
+
+    /**
+    * @brief run full buckets and the buckets older than max_delay_us, force runs every pending roi
+    * @return number of batches run
+    */
+    int Flush(bool force);
+
+    /**
+    * @brief next result in submit order, resized.data(device) stays valid until the next Pop,
+    *        resized.data is nullptr if its batch failed or drop_bad_images left it out
+    * @param [out] image_status: DvppImageStatus of the roi in its batch, nullptr: not needed
+    * @return 1 a result is returned, 0 the oldest roi is not resized yet
+    */
+    int Pop(int64_t& ticket, DVPPImageData& resized, int* image_status = nullptr);
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPRoiSchedulerStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    inline DvppResize& Resizer()
+    {
+        return resize_;
+    }
+
+    void DestroyResource();
+
+private:
+    struct PendingRoi {
+        int64_t ticket;
+        DVPPImageData frame;
+        RectInt roi;
+        uint64_t submit_ns;
+    };
+
+    struct RoiResult {
+        bool done;
+        bool ok;
+        int image_status;  // DvppImageStatus
+    };
+
+    int BucketIndex(const RectInt& roi) const;
+
+    int RunBucket(std::deque<PendingRoi>& bucket);
+
+    inline uint8_t* ResultSlot(int64_t ticket) const
+    {
+        return static_cast<uint8_t*>(arena_dev_) + static_cast<size_t>(ticket % arena_slots_) * slot_size_;
+    }
+
+private:
+    DVPPRoiSchedulerConfig config_;
+    DvppResize resize_;
+
+    std::vector<std::deque<PendingRoi>> buckets_;
+    std::deque<RoiResult> results_;  // results_[0] is ticket base_ticket_
+    int64_t base_ticket_;
+    int64_t next_ticket_;
+
+    // ring of result slots indexed by ticket, so any roi within the window can go into any batch
+    void* arena_dev_;
+    uint32_t slot_size_;
+    int64_t arena_slots_;
+    std::vector<DVPPImageData> batch_frames_;
+    std::vector<RectInt> batch_rois_;
+    std::vector<uint8_t*> batch_slots_;
+
+    DVPPRoiSchedulerStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_ROI_SCHEDULER_H
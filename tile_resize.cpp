@@ -0,0 +1,268 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <cmath>
+#include <algorithm>
+#include "tile_resize.h"
+#include "alg_define.h"
+
+static void TileStarts(int size, int tile, float overlap, std::vector<int>& starts)
+{
+    starts.clear();
+    if (tile >= size)
+    {
+        starts.push_back(0);
+        return;
+    }
+    int step = std::max(2, static_cast<int>(tile * (1.0f - overlap)) & ~1);
+    for (int pos = 0; ; pos += step)
+    {
+        if (pos + tile >= size)
+        {
+            // the last tile ends at the border, it overlaps its neighbour more than the others
+            int last = (size - tile) & ~1;
+            if (starts.empty() || last > starts.back())
+            {
+                starts.push_back(last);
+            }
+            break;
+        }
+        starts.push_back(pos);
+    }
+}
+
+int GenerateTileGrid(uint32_t frame_width, uint32_t frame_height, uint32_t tile_width, uint32_t tile_height,
+                     float overlap, std::vector<RectInt>& tiles)
+{
+    tiles.clear();
+    if (frame_width < 2 || frame_height < 2 || tile_width < 2 || tile_height < 2)
+    {
+        return 0;
+    }
+    overlap = std::min(std::max(overlap, 0.0f), 0.9f);
+    int width = static_cast<int>(frame_width);
+    int height = static_cast<int>(frame_height);
+    int tile_w = static_cast<int>(tile_width) & ~1;
+    int tile_h = static_cast<int>(tile_height) & ~1;
+    std::vector<int> xs, ys;
+    TileStarts(width, tile_w, overlap, xs);
+    TileStarts(height, tile_h, overlap, ys);
+    for (size_t row = 0; row < ys.size(); ++row)
+    {
+        for (size_t col = 0; col < xs.size(); ++col)
+        {
+            RectInt tile;
+            tile.xmin = xs[col];
+            tile.ymin = ys[row];
+            tile.xmax = std::min(xs[col] + tile_w, width) - 1;
+            tile.ymax = std::min(ys[row] + tile_h, height) - 1;
+            tile.width = tile.xmax - tile.xmin + 1;
+            tile.height = tile.ymax - tile.ymin + 1;
+            tiles.push_back(tile);
+        }
+    }
+    return static_cast<int>(tiles.size());
+}
+
+TileResize::TileResize() : arena_dev_(nullptr), slot_size_(0), arena_slots_(0), grid_width_(0), grid_height_(0),
+                           has_init_over_(false)
+{
+
+}
+
+TileResize::~TileResize()
+{
+
+}
+
+void TileResize::Init(const DVPPTileConfig *config)
+{
+    config_ = *config;
+    if (0 == config_.tile_width)
+    {
+        config_.tile_width = config_.resize_config.resized_width;
+    }
+    if (0 == config_.tile_height)
+    {
+        config_.tile_height = config_.resize_config.resized_height;
+    }
+    if (config_.tile_width < 2 || config_.tile_height < 2 || config_.overlap < 0.0f || config_.overlap > 0.9f)
+    {
+        AIALG_ERROR("tile must be at least 2x2 and overlap in [0, 0.9], tile = %dx%d, overlap = %f\n",
+                    config_.tile_width, config_.tile_height, config_.overlap);
+        return;
+    }
+    config_.resize_config.use_external_output = 1;
+    // tiles are split into launches of the resolved(tuned) batch_size, not only inside DvppResize
+    if (1 != ResolveDvppBatchSize(config_.resize_config))
+    {
+        return;
+    }
+    resize_.Init(&config_.resize_config);
+    if (!resize_.HasInit())
+    {
+        return;
+    }
+    slot_size_ = ALIGN_UP16(config_.resize_config.resized_width) * 3 * ALIGN_UP2(config_.resize_config.resized_height);
+    batch_frames_.reserve(config_.resize_config.batch_size);
+    batch_rois_.reserve(config_.resize_config.batch_size);
+    batch_slots_.reserve(config_.resize_config.batch_size);
+    has_init_over_ = true;
+}
+
+void TileResize::DestroyResource()
+{
+    resize_.DestroyResource();
+    if (arena_dev_)
+    {
+        acldvppFree(arena_dev_);
+        arena_dev_ = nullptr;
+    }
+    arena_slots_ = 0;
+    grid_.clear();
+    grid_width_ = 0;
+    grid_height_ = 0;
+    has_init_over_ = false;
+}
+
+int TileResize::ReserveArena(int slots)
+{
+    if (slots <= arena_slots_)
+    {
+        return 1;
+    }
+    if (arena_dev_)
+    {
+        acldvppFree(arena_dev_);
+        arena_dev_ = nullptr;
+        arena_slots_ = 0;
+    }
+    aclError aclRet = acldvppMalloc(&arena_dev_, static_cast<size_t>(slot_size_) * slots);
+    if (aclRet != ACL_SUCCESS)
+    {
+        AIALG_ERROR("acldvppMalloc arena of %d slots failed, aclRet = %d\n", slots, aclRet);
+        arena_dev_ = nullptr;
+        return 0;
+    }
+    arena_slots_ = slots;
+    return 1;
+}
+
+int TileResize::Process(const DVPPImageData *frames, int frame_num, std::vector<DVPPTileView> &views)
+{
+    views.clear();
+    if (!has_init_over_)
+    {
+        AIALG_ERROR("TileResize has not init\n");
+        return -1;
+    }
+    if (!frames || frame_num <= 0)
+    {
+        AIALG_ERROR("no frames, frame_num = %d\n", frame_num);
+        return -1;
+    }
+    DVPP_TIMELINE_SCOPE("tile_resize", "process", frame_num);
+    stats_.process_count++;
+
+    const DVPPResizeInitConfig& resize_config = config_.resize_config;
+    view_rois_.clear();
+    for (int frame = 0; frame < frame_num; ++frame)
+    {
+        if (!frames[frame].data || frames[frame].width < 2 || frames[frame].height < 2)
+        {
+            AIALG_ERROR("invalid frame %d\n", frame);
+            stats_.failed_count++;
+            views.clear();
+            return -1;
+        }
+        if (frames[frame].width != grid_width_ || frames[frame].height != grid_height_)
+        {
+            grid_width_ = frames[frame].width;
+            grid_height_ = frames[frame].height;
+            GenerateTileGrid(grid_width_, grid_height_, config_.tile_width, config_.tile_height, config_.overlap, grid_);
+        }
+        size_t num_tiles = grid_.size();
+        for (size_t tile = 0; tile <= num_tiles; ++tile)
+        {
+            if (tile == num_tiles && !config_.full_view)
+            {
+                break;
+            }
+            RectInt roi = tile < num_tiles ? grid_[tile] : RectInt();
+            if (tile == num_tiles)
+            {
+                roi.xmin = 0;
+                roi.ymin = 0;
+                roi.xmax = static_cast<int>(grid_width_) - 1;
+                roi.ymax = static_cast<int>(grid_height_) - 1;
+                roi.width = grid_width_;
+                roi.height = grid_height_;
+            }
+            DVPPTileView view;
+            view.frame = frame;
+            view.is_full_view = tile == num_tiles ? 1 : 0;
+            // the crop and paste area DvppResize uses for the roi
+            if (1 != GetDvppRoiArea(resize_config, grid_width_, grid_height_, roi, view.crop, view.paste))
+            {
+                AIALG_ERROR("tile %zu of frame %d is too small\n", tile, frame);
+                stats_.failed_count++;
+                views.clear();
+                return -1;
+            }
+            view.scale_x = static_cast<float>(view.paste.width) / view.crop.width;
+            view.scale_y = static_cast<float>(view.paste.height) / view.crop.height;
+            views.push_back(view);
+            view_rois_.push_back(roi);
+        }
+    }
+
+    int num_views = static_cast<int>(views.size());
+    if (1 != ReserveArena(num_views))
+    {
+        stats_.failed_count++;
+        views.clear();
+        return -1;
+    }
+    for (int idx = 0; idx < num_views; ++idx)
+    {
+        DVPPImageData& image = views[idx].image;
+        image.width = resize_config.resized_width;
+        image.height = resize_config.resized_height;
+        image.alignWidth = ALIGN_UP16(resize_config.resized_width) * 3;
+        image.alignHeight = ALIGN_UP2(resize_config.resized_height);
+        image.size = slot_size_;
+        image.data = static_cast<uint8_t*>(arena_dev_) + static_cast<size_t>(idx) * slot_size_;
+    }
+
+    // all views of the call in as few vpc calls as batch_size allows
+    int batch_size = static_cast<int>(resize_config.batch_size);
+    for (int start = 0; start < num_views; start += batch_size)
+    {
+        int img_num = std::min(batch_size, num_views - start);
+        batch_frames_.clear();
+        batch_rois_.clear();
+        batch_slots_.clear();
+        for (int idx = start; idx < start + img_num; ++idx)
+        {
+            batch_frames_.push_back(frames[views[idx].frame]);
+            batch_rois_.push_back(view_rois_[idx]);
+            batch_slots_.push_back(views[idx].image.data);
+        }
+        DVPPOutputBinding output;
+        output.size = slot_size_;
+        output.slot_data = batch_slots_.data();
+        int ret = resize_.Process(batch_frames_.data(), batch_rois_.data(), img_num, &output);
+        stats_.submit_count++;
+        if (1 != ret)
+        {
+            AIALG_ERROR("resize of views [%d, %d) failed\n", start, start + img_num);
+            stats_.failed_count++;
+            views.clear();
+            return -1;
+        }
+    }
+    stats_.frame_count += frame_num;
+    stats_.view_count += num_views;
+    return num_views;
+}
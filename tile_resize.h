@@ -0,0 +1,123 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_TILE_RESIZE_H
+#define _PICTURE_INC_TILE_RESIZE_H
+
+#include <vector>
+#include <cstdint>
+#include "dvpp_resize.h"
+
+typedef struct{
+    DVPPResizeInitConfig resize_config;  // resized_width x resized_height is the model input, batch_size the
+                                         // views of one vpc call, output is owned by TileResize
+    uint32_t tile_width = 0;             // source pixels of one tile, 0: resized_width
+    uint32_t tile_height = 0;            // 0: resized_height
+    float overlap = 0.2f;                // part of a tile shared with its neighbour, [0, 0.9]
+    uint32_t full_view = 1;              // 1: one more view of every frame, the whole frame downscaled
+    char reserve[8];
+} DVPPTileConfig;
+
+typedef struct{
+    int frame = 0;             // index into frames of Process
+    int is_full_view = 0;
+    RectInt crop;              // source pixels resized into paste, even aligned as the vpc crops them
+    RectInt paste;             // output pixels
+    float scale_x = 1.0f;      // output pixels per source pixel
+    float scale_y = 1.0f;
+    DVPPImageData image;       // output slot(device), valid until the next Process
+} DVPPTileView;
+
+typedef struct{
+    uint64_t process_count = 0;
+    uint64_t failed_count = 0;
+    uint64_t frame_count = 0;
+    uint64_t view_count = 0;
+    uint64_t submit_count = 0;  // vpc calls, ceil(views / batch_size) per Process
+} DVPPTileStats;
+
+/**
+* @brief top-left corners of the tiles covering frame_width x frame_height, neighbours share about
+*        overlap of a tile, the last tile of a row/column is moved back to end at the frame border,
+*        tiles are even aligned, a frame smaller than a tile gets one tile clipped to the frame
+* @return number of tiles
+*/
+int GenerateTileGrid(uint32_t frame_width, uint32_t frame_height, uint32_t tile_width, uint32_t tile_height,
+                     float overlap, std::vector<RectInt>& tiles);
+
+/**
+* @brief frame coordinates of point(x, y) of the output of view, e.g. a detection box corner
+*/
+inline void TileToFrame(const DVPPTileView& view, float x, float y, float& frame_x, float& frame_y)
+{
+    frame_x = view.crop.xmin + (x - view.paste.xmin) / view.scale_x;
+    frame_y = view.crop.ymin + (y - view.paste.ymin) / view.scale_y;
+}
+
+/**
+* @brief SAHI style slicing for small objects: every frame is cut into overlapping tiles at model
+*        resolution plus an optional downscaled full view, the views of all frames of one call are
+*        resized in ceil(views / batch_size) vpc calls into one device arena
+*/
+class TileResize {
+public:
+    TileResize();
+
+    ~TileResize();
+
+    void Init(const DVPPTileConfig* config);
+
+    /**
+    * @param [in] frames: device images(input_format), the tile grid follows the size of every frame
+    * @param [out] views: tiles of frame 0(row major), its full view, tiles of frame 1, ...
+    * @return number of views, -1 failed
+    */
+    int Process(const DVPPImageData* frames, int frame_num, std::vector<DVPPTileView>& views);
+
+    inline bool HasInit() const
+    {
+        return has_init_over_;
+    }
+
+    inline const DVPPTileStats& GetStats() const
+    {
+        return stats_;
+    }
+
+    inline DvppResize& Resizer()
+    {
+        return resize_;
+    }
+
+    void DestroyResource();
+
+private:
+    /**
+    * @brief grow the arena to slots output slots
+    */
+    int ReserveArena(int slots);
+
+private:
+    DVPPTileConfig config_;
+    DvppResize resize_;
+
+    void* arena_dev_;
+    uint32_t slot_size_;
+    int arena_slots_;
+
+    // grid of the last frame size
+    uint32_t grid_width_;
+    uint32_t grid_height_;
+    std::vector<RectInt> grid_;
+    std::vector<RectInt> view_rois_;  // roi of every view, crops and paste areas follow from it
+
+    std::vector<DVPPImageData> batch_frames_;
+    std::vector<RectInt> batch_rois_;
+    std::vector<uint8_t*> batch_slots_;
+
+    DVPPTileStats stats_;
+    bool has_init_over_;
+};
+
+#endif // _PICTURE_INC_TILE_RESIZE_H
@@ -0,0 +1,210 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "atlas_resize.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+#define BENCH_FRAME_NUM 8
+
+// face sized crops: 24 ~ 160 pixels, spread over the frames
+static void GenerateCrops(int num_crops, std::vector<DVPPAtlasCrop>& crops)
+{
+    std::mt19937 rng(20261019);
+    std::uniform_int_distribution<int> side_dist(24, 160);
+    std::uniform_real_distribution<float> pos_dist(0.0f, 1.0f);
+    std::uniform_int_distribution<int> frame_dist(0, BENCH_FRAME_NUM - 1);
+    crops.resize(num_crops);
+    for (int idx = 0; idx < num_crops; ++idx)
+    {
+        int side = side_dist(rng);
+        DVPPAtlasCrop& crop = crops[idx];
+        crop.frame = frame_dist(rng);
+        crop.roi.xmin = static_cast<int>(pos_dist(rng) * (BENCH_FRAME_WIDTH - side - 2));
+        crop.roi.ymin = static_cast<int>(pos_dist(rng) * (BENCH_FRAME_HEIGHT - side - 2));
+        crop.roi.xmax = crop.roi.xmin + side - 1;
+        crop.roi.ymax = crop.roi.ymin + side - 1;
+        crop.roi.width = side;
+        crop.roi.height = side;
+    }
+}
+
+// baseline: batch_size crops per vpc call, one output slot and descriptor pair per crop
+static long RunDvppResize(const DVPPResizeInitConfig& config, const std::vector<DVPPImageData>& frames,
+                          const std::vector<DVPPAtlasCrop>& crops)
+{
+    DvppResize resize;
+    resize.Init(&config);
+    if (!resize.HasInit())
+    {
+        return -1;
+    }
+    int batch_size = static_cast<int>(config.batch_size);
+    std::vector<DVPPImageData> batch_frames(batch_size);
+    std::vector<RectInt> batch_rois(batch_size);
+    int calls = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (size_t begin = 0; begin < crops.size(); begin += batch_size)
+    {
+        int img_num = static_cast<int>(std::min(crops.size() - begin, static_cast<size_t>(batch_size)));
+        for (int idx = 0; idx < img_num; ++idx)
+        {
+            batch_frames[idx] = frames[crops[begin + idx].frame];
+            batch_rois[idx] = crops[begin + idx].roi;
+        }
+        resize.Process(batch_frames.data(), batch_rois.data(), img_num);
+        calls++;
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPResizeStats& stats = resize.GetStats();
+    std::printf("dvpp_resize: %zu crops in %ld us, %.1f crops/s, %d vpc calls, %ld failed, setup %ld us, sync %ld us\n",
+                crops.size(), total_us, total_us > 0 ? 1e6 * crops.size() / total_us : 0.0, calls, stats.failed_count,
+                stats.setup_us, stats.sync_us);
+    resize.DestroyResource();
+    return total_us;
+}
+
+static long RunAtlas(const DVPPAtlasConfig& config, const std::vector<DVPPImageData>& frames,
+                     std::vector<DVPPAtlasCrop> crops)
+{
+    AtlasResize atlas;
+    atlas.Init(&config);
+    if (!atlas.HasInit())
+    {
+        return -1;
+    }
+    std::vector<DVPPAtlasView> views(crops.size());
+    std::vector<DVPPAtlasCrop> deferred;
+    int calls = 0;
+    int failed = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    while (!crops.empty())
+    {
+        int num = atlas.Process(frames.data(), static_cast<int>(frames.size()), crops.data(),
+                                static_cast<int>(crops.size()), views.data());
+        calls++;
+        if (num <= 0)
+        {
+            failed += static_cast<int>(crops.size());
+            break;
+        }
+        deferred.clear();
+        for (size_t idx = 0; idx < crops.size(); ++idx)
+        {
+            if (0 == views[idx].status)
+            {
+                deferred.push_back(crops[idx]);
+            }
+            failed += views[idx].status < 0 ? 1 : 0;
+        }
+        crops.swap(deferred);
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPAtlasStats& stats = atlas.GetStats();
+    uint64_t canvas_area = static_cast<uint64_t>(config.canvas_width) * config.canvas_height * stats.canvas_count;
+    std::printf("atlas      : %ld crops in %ld us, %.1f crops/s, %d vpc calls, %ld canvases(%.1f%% filled), %d failed, "
+                "setup %ld us, sync %ld us\n", stats.crop_count, total_us,
+                total_us > 0 ? 1e6 * stats.crop_count / total_us : 0.0, calls, stats.canvas_count,
+                canvas_area ? 100.0 * stats.packed_area / canvas_area : 0.0, failed, stats.setup_us, stats.sync_us);
+    atlas.DestroyResource();
+    return total_us;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./atlas_resize_bench num_crops crop_width crop_height [batch_size(32)] [canvas_side(1024)] [max_canvases(4)] [device_id]" << std::endl;
+        return -1;
+    }
+    int num_crops = std::atoi(argv[1]);
+    int crop_width = std::atoi(argv[2]);
+    int crop_height = std::atoi(argv[3]);
+    int batch_size = argc > 4 ? std::atoi(argv[4]) : 32;
+    int canvas_side = argc > 5 ? std::atoi(argv[5]) : 1024;
+    int max_canvases = argc > 6 ? std::atoi(argv[6]) : 4;
+    int32_t deviceId = argc > 7 ? std::atoi(argv[7]) : 0;
+    if (num_crops <= 0 || crop_width <= 0 || crop_height <= 0 || batch_size <= 0)
+    {
+        std::printf("bad num_crops, crop size or batch_size\n");
+        return -1;
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // synthetic nv12 frames, the vpc cost does not depend on pixel values
+    std::vector<DVPPImageData> frames(BENCH_FRAME_NUM);
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    for (int idx = 0; idx < BENCH_FRAME_NUM; ++idx)
+    {
+        void* dev_frame = nullptr;
+        if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+            ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+        {
+            std::printf("upload frame failed\n");
+            return -1;
+        }
+        frames[idx].width = BENCH_FRAME_WIDTH;
+        frames[idx].height = BENCH_FRAME_HEIGHT;
+        frames[idx].alignWidth = BENCH_FRAME_WIDTH;
+        frames[idx].alignHeight = BENCH_FRAME_HEIGHT;
+        frames[idx].size = frame_size;
+        frames[idx].data = static_cast<uint8_t*>(dev_frame);
+    }
+
+    std::vector<DVPPAtlasCrop> crops;
+    GenerateCrops(num_crops, crops);
+
+    DVPPResizeInitConfig resize_config;
+    resize_config.context = context;
+    resize_config.stream = stream;
+    resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    resize_config.batch_size = batch_size;
+    resize_config.resized_width = crop_width;
+    resize_config.resized_height = crop_height;
+    resize_config.is_fix_scale_resize = 0;
+    resize_config.is_symmetry_padding = 0;
+    resize_config.resize_scale_factor = 1.0f;
+    long resize_us = RunDvppResize(resize_config, frames, crops);
+
+    DVPPAtlasConfig atlas_config;
+    atlas_config.context = context;
+    atlas_config.stream = stream;
+    atlas_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    atlas_config.canvas_width = ALIGN_UP16(canvas_side);
+    atlas_config.canvas_height = ALIGN_UP2(canvas_side);
+    atlas_config.max_canvases = max_canvases;
+    atlas_config.max_frames = BENCH_FRAME_NUM;
+    atlas_config.crop_width = crop_width;
+    atlas_config.crop_height = crop_height;
+    long atlas_us = RunAtlas(atlas_config, frames, crops);
+    if (resize_us > 0 && atlas_us > 0)
+    {
+        std::printf("speedup of atlas packing: %.2fx\n", 1.0f * resize_us / atlas_us);
+    }
+
+    for (int idx = 0; idx < BENCH_FRAME_NUM; ++idx)
+    {
+        acldvppFree(frames[idx].data);
+    }
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "batch_aggregator.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+
+static uint64_t Percentile(std::vector<uint64_t> values, float p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(p * (values.size() - 1));
+    return values[idx];
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 6)
+    {
+        std::cout << "Usage: ./batch_aggregator_bench batch_size des_width des_height num_threads requests_per_thread [max_delay_us(2000)] [interval_us(1000)] [device_id]" << std::endl;
+        return -1;
+    }
+    int batch_size = std::atoi(argv[1]);
+    int des_width = std::atoi(argv[2]);
+    int des_height = std::atoi(argv[3]);
+    int num_threads = std::atoi(argv[4]);
+    int num_requests = std::atoi(argv[5]);
+    int max_delay_us = argc > 6 ? std::atoi(argv[6]) : 2000;
+    int interval_us = argc > 7 ? std::atoi(argv[7]) : 1000;
+    int32_t deviceId = argc > 8 ? std::atoi(argv[8]) : 0;
+    if (batch_size <= 0 || num_threads <= 0 || num_requests <= 0)
+    {
+        std::printf("bad batch_size, num_threads or requests_per_thread\n");
+        return -1;
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // one synthetic nv12 frame shared by all handlers, the vpc cost does not depend on pixel values
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    void* dev_frame = nullptr;
+    if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+        ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+    {
+        std::printf("upload frame failed\n");
+        return -1;
+    }
+    DVPPImageData frame;
+    frame.width = BENCH_FRAME_WIDTH;
+    frame.height = BENCH_FRAME_HEIGHT;
+    frame.alignWidth = BENCH_FRAME_WIDTH;
+    frame.alignHeight = BENCH_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = static_cast<uint8_t*>(dev_frame);
+
+    DVPPBatchAggregatorConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.max_delay_us = max_delay_us;
+    BatchAggregator aggregator;
+    aggregator.Init(&config);
+    if (!aggregator.HasInit())
+    {
+        return -1;
+    }
+
+    // every handler produces one frame per interval_us and waits for its own result
+    std::vector<std::vector<uint64_t> > latencies(num_threads);
+    std::vector<int> failed(num_threads, 0);
+    std::vector<std::thread> handlers;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int thread_id = 0; thread_id < num_threads; ++thread_id)
+    {
+        handlers.emplace_back([&, thread_id] {
+            std::chrono::time_point<std::chrono::steady_clock> next = std::chrono::steady_clock::now();
+            for (int idx = 0; idx < num_requests; ++idx)
+            {
+                std::this_thread::sleep_until(next);
+                next += std::chrono::microseconds(interval_us);
+                std::chrono::time_point<std::chrono::steady_clock> submitTP = std::chrono::steady_clock::now();
+                DVPPBatchResult result = aggregator.Submit(frame).get();
+                latencies[thread_id].push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - submitTP).count());
+                failed[thread_id] += result.status ? 0 : 1;
+                aggregator.Release(result.slot);
+            }
+        });
+    }
+    for (size_t idx = 0; idx < handlers.size(); ++idx)
+    {
+        handlers[idx].join();
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    std::vector<uint64_t> all;
+    int num_failed = 0;
+    for (int thread_id = 0; thread_id < num_threads; ++thread_id)
+    {
+        all.insert(all.end(), latencies[thread_id].begin(), latencies[thread_id].end());
+        num_failed += failed[thread_id];
+    }
+    DVPPBatchAggregatorStats stats = aggregator.GetStats();
+    std::printf("%zu requests in %ld us, %.1f images/s, %d failed\n", all.size(), total_us,
+                total_us > 0 ? 1e6 * all.size() / total_us : 0.0, num_failed);
+    std::printf("%ld batches(%ld full, %ld by deadline), %.2f images/batch, max queue wait %ld us\n",
+                stats.batch_count, stats.full_batch_count, stats.deadline_batch_count,
+                stats.batch_count ? 1.0 * stats.submit_count / stats.batch_count : 0.0, stats.max_wait_us);
+    std::printf("latency p50 = %ld us, p99 = %ld us, max = %ld us\n", Percentile(all, 0.5f), Percentile(all, 0.99f),
+                Percentile(all, 1.0f));
+
+    aggregator.DestroyResource();
+    acldvppFree(dev_frame);
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cstring>
+#include "opencv2/opencv.hpp"
+
+#include "color_convert.h"
+
+static const char* FormatName(uint32_t format)
+{
+    static const char* names[] = {"BGR", "RGB", "NV12", "NV21", "I420"};
+    return format <= CVT_FORMAT_I420 ? names[format] : "?";
+}
+
+// the former host path of the nv12 input: cvtColor to I420, copy uv to a temporary, interleave
+static void LegacyBGR2NV12(const cv::Mat& src, cv::Mat& dst)
+{
+    cv::cvtColor(src, dst, cv::COLOR_BGR2YUV_I420);
+    int n_y = src.rows * src.cols;
+    int n_u = n_y / 4;
+    std::vector<uint8_t> uv(dst.data + n_y, dst.data + n_y + 2 * n_u);
+    for (int i = 0; i < n_u; i++)
+    {
+        dst.data[n_y + 2 * i] = uv[i];
+        dst.data[n_y + 2 * i + 1] = uv[n_u + i];
+    }
+}
+
+static long TimeConvert(const DVPPImageData& src, uint32_t src_format, DVPPImageData& dst, uint32_t dst_format,
+                        WorkerPool* pool, bool use_simd, int num_loop)
+{
+    ConvertColor(src, src_format, dst, dst_format, pool, use_simd);
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < num_loop; ++loop)
+    {
+        ConvertColor(src, src_format, dst, dst_format, pool, use_simd);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count() / num_loop;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./color_convert_bench width height num_loop [cpu_threads]" << std::endl;
+        return -1;
+    }
+    int width = std::atoi(argv[1]) & ~1;
+    int height = std::atoi(argv[2]) & ~1;
+    int num_loop = std::atoi(argv[3]);
+    int cpu_threads = argc > 4 ? std::atoi(argv[4]) : 0;
+    if (width <= 0 || height <= 0 || num_loop <= 0)
+    {
+        std::printf("bad width/height/num_loop\n");
+        return -1;
+    }
+
+    WorkerPool pool;
+    WorkerPoolConfig poolConfig;
+    poolConfig.num_threads = cpu_threads;
+    if (1 != pool.Init(&poolConfig))
+    {
+        return -1;
+    }
+
+    // packed buffers use the 16 aligned stride of the vpc input
+    DVPPImageData packed;
+    packed.width = width;
+    packed.height = height;
+    packed.alignWidth = ALIGN_UP16(width) * 3;
+    packed.alignHeight = height;
+    std::vector<uint8_t> packed_data(packed.alignWidth * height);
+    for (size_t idx = 0; idx < packed_data.size(); ++idx)
+    {
+        packed_data[idx] = static_cast<uint8_t>((idx * 7) ^ (idx >> 9));
+    }
+    packed.size = packed_data.size();
+    packed.data = packed_data.data();
+
+    DVPPImageData yuv;
+    yuv.width = width;
+    yuv.height = height;
+    yuv.alignWidth = ALIGN_UP16(width);
+    yuv.alignHeight = height;
+    yuv.size = YUV420SP_SIZE(yuv.alignWidth, yuv.alignHeight);
+    std::vector<uint8_t> yuv_data(yuv.size), yuv_ref(yuv.size);
+    std::vector<uint8_t> packed_out(packed.size), packed_ref(packed.size);
+
+    std::printf("%dx%d, isa = %s, %d workers\n", width, height, ConvertColorIsa(), pool.NumWorkers());
+    const uint32_t packed_formats[] = {CVT_FORMAT_BGR, CVT_FORMAT_RGB};
+    const uint32_t yuv_formats[] = {CVT_FORMAT_NV12, CVT_FORMAT_NV21, CVT_FORMAT_I420};
+    int mismatch = 0;
+    for (uint32_t packed_format : packed_formats)
+    {
+        for (uint32_t yuv_format : yuv_formats)
+        {
+            // packed -> yuv
+            yuv.data = yuv_ref.data();
+            long scalar_us = TimeConvert(packed, packed_format, yuv, yuv_format, nullptr, false, num_loop);
+            yuv.data = yuv_data.data();
+            long simd_us = TimeConvert(packed, packed_format, yuv, yuv_format, nullptr, true, num_loop);
+            long pool_us = TimeConvert(packed, packed_format, yuv, yuv_format, &pool, true, num_loop);
+            bool exact = yuv_data == yuv_ref;
+            mismatch += exact ? 0 : 1;
+            std::printf("%4s -> %-4s scalar %6ld us, simd %6ld us, simd + pool %6ld us, %s\n", FormatName(packed_format),
+                        FormatName(yuv_format), scalar_us, simd_us, pool_us, exact ? "bit-exact" : "MISMATCH");
+
+            // yuv -> packed, the yuv written above is the input
+            DVPPImageData out = packed;
+            out.data = packed_ref.data();
+            scalar_us = TimeConvert(yuv, yuv_format, out, packed_format, nullptr, false, num_loop);
+            out.data = packed_out.data();
+            simd_us = TimeConvert(yuv, yuv_format, out, packed_format, nullptr, true, num_loop);
+            pool_us = TimeConvert(yuv, yuv_format, out, packed_format, &pool, true, num_loop);
+            exact = packed_out == packed_ref;
+            mismatch += exact ? 0 : 1;
+            std::printf("%4s -> %-4s scalar %6ld us, simd %6ld us, simd + pool %6ld us, %s\n", FormatName(yuv_format),
+                        FormatName(packed_format), scalar_us, simd_us, pool_us, exact ? "bit-exact" : "MISMATCH");
+        }
+    }
+
+    // against the former cv::cvtColor + interleave path of BGR -> NV12
+    cv::Mat bgr(height, width, CV_8UC3);
+    for (int row = 0; row < height; ++row)
+    {
+        std::memcpy(bgr.ptr(row), packed.data + row * packed.alignWidth, width * 3);
+    }
+    cv::Mat legacy;
+    LegacyBGR2NV12(bgr, legacy);
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < num_loop; ++loop)
+    {
+        LegacyBGR2NV12(bgr, legacy);
+    }
+    long legacy_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count() / num_loop;
+    yuv.data = yuv_data.data();
+    ConvertColor(packed, CVT_FORMAT_BGR, yuv, CVT_FORMAT_NV12, &pool);
+    int max_diff = 0;
+    for (int row = 0; row < height * 3 / 2; ++row)
+    {
+        for (int col = 0; col < width; ++col)
+        {
+            int diff = std::abs(legacy.ptr(row)[col] - yuv_data[row * yuv.alignWidth + col]);
+            max_diff = diff > max_diff ? diff : max_diff;
+        }
+    }
+    std::printf("legacy cvtColor + interleave BGR -> NV12 %ld us, max diff to ConvertColor %d\n", legacy_us, max_diff);
+    pool.Destroy();
+    return mismatch ? -1 : 0;
+}
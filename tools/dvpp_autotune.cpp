@@ -0,0 +1,66 @@
+#include <iostream>
+#include <vector>
+
+#include "dvpp_autotune.h"
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 7)
+    {
+        std::cout << "Usage: ./dvpp_autotune profile src_width src_height des_width des_height yuv420sp_nv12_resize [fix_scale(1)] [latency_cap_us(0: none)] [max_batch_size(32)] [max_channels(4)] [batches_per_trial(50)] [device_id]" << std::endl;
+        return -1;
+    }
+    std::string profile = argv[1];
+    DVPPAutotuneConfig config;
+    config.src_width = std::atoi(argv[2]);
+    config.src_height = std::atoi(argv[3]);
+    config.resize_config.resized_width = std::atoi(argv[4]);
+    config.resize_config.resized_height = std::atoi(argv[5]);
+    config.resize_config.input_format = 1 == std::atoi(argv[6]) ? 1 : 13;
+    config.resize_config.is_fix_scale_resize = argc > 7 ? std::atoi(argv[7]) : 1;
+    config.resize_config.is_symmetry_padding = 0;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.latency_cap_us = argc > 8 ? std::atof(argv[8]) : 0.0f;
+    config.max_batch_size = argc > 9 ? std::atoi(argv[9]) : 32;
+    config.max_channels = argc > 10 ? std::atoi(argv[10]) : 4;
+    config.batches_per_trial = argc > 11 ? std::atoi(argv[11]) : 50;
+    int32_t deviceId = argc > 12 ? std::atoi(argv[12]) : 0;
+
+    aclrtContext context;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+    config.resize_config.context = context;
+
+    // always sweeps, the entry of this geometry in the profile is replaced
+    DVPPTuneEntry best;
+    std::vector<DVPPTuneEntry> trials;
+    int ret = RunDvppAutotune(config, best, &trials);
+    std::printf("%10s %8s %14s %14s\n", "batch_size", "channels", "images/s", "p99 us");
+    for (size_t idx = 0; idx < trials.size(); ++idx)
+    {
+        std::printf("%10u %8u %14.1f %14.1f\n", trials[idx].batch_size, trials[idx].channels,
+                    trials[idx].images_per_second, trials[idx].p99_latency_us);
+    }
+    if (1 == ret)
+    {
+        std::printf("best: batch_size = %u, channels = %u, %.1f images/s, p99 %.1f us\n", best.batch_size,
+                    best.channels, best.images_per_second, best.p99_latency_us);
+        if (1 != UpdateTuneProfile(profile, best))
+        {
+            ret = 0;
+        }
+        else
+        {
+            std::printf("saved to %s\n", profile.c_str());
+        }
+    }
+
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 1 == ret ? 0 : -1;
+}
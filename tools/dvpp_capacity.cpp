@@ -0,0 +1,70 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dvpp_capacity.h"
+
+static void PrintResult(const DVPPCapacityResult& result)
+{
+    std::printf("%lu images in %lu batches(mean %.2f), offered %.1f images/s, done %.1f images/s%s\n", result.images,
+                result.batches, result.mean_batch_size, result.offered_images_per_second, result.images_per_second,
+                result.overloaded ? ", OVERLOADED" : "");
+    std::printf("utilization: channels %.1f%%, vpc %.1f%%\n", 100.0f * result.channel_utilization,
+                100.0f * result.vpc_utilization);
+    std::printf("latency: p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n", result.p50_latency_us,
+                result.p99_latency_us, result.p999_latency_us, result.max_latency_us);
+}
+
+int main(int argc, const char *argv[])
+{
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (!(("fit" == mode && argc > 4) || ("sim" == mode && argc > 3)))
+    {
+        std::cout << "Usage: ./dvpp_capacity fit model_file copy_us_per_mb(0: results stay on the device) trace_file [trace_file ...]" << std::endl;
+        std::cout << "       ./dvpp_capacity sim model_file scenario_file" << std::endl;
+        std::cout << "       trace_file: DvppResize::EnableTrace, scenario_file: see README" << std::endl;
+        return -1;
+    }
+    std::string model_path = argv[2];
+    DVPPCostModel model;
+    if ("fit" == mode)
+    {
+        model.copy_us_per_mb = std::atof(argv[3]);
+        std::vector<std::string> traces(argv + 4, argv + argc);
+        if (1 != FitCostModel(traces, model) || 1 != SaveCostModel(model_path, model))
+        {
+            return -1;
+        }
+        std::printf("setup  = %.2f + %.2f * img_num us, launch = %.2f us\n", model.setup_fixed_us,
+                    model.setup_per_image_us, model.launch_us);
+        std::printf("vpc    = %.2f + %.2f * img_num + %.2f * in_mpixels + %.2f * out_mpixels us, rmse %.2f us over %u batches\n",
+                    model.vpc_fixed_us, model.vpc_per_image_us, model.vpc_per_mpixel_in_us, model.vpc_per_mpixel_out_us,
+                    model.vpc_rmse_us, model.fitted_batches);
+        std::printf("saved to %s\n", model_path.c_str());
+        return 0;
+    }
+
+    std::vector<DVPPCameraGroup> cameras;
+    DVPPCapacityConfig config;
+    if (1 != LoadCostModel(model_path, model) || 1 != LoadCapacityScenario(argv[3], cameras, config))
+    {
+        return -1;
+    }
+    DVPPCapacityResult result;
+    if (1 != RunCapacitySimulation(model, cameras, config, result))
+    {
+        return -1;
+    }
+    std::printf("batch_size = %u, max_delay_us = %.0f, channels = %u, vpc_engines = %u, %.0f s simulated\n",
+                config.batch_size, config.max_delay_us, config.channels, config.vpc_engines, config.duration_s);
+    PrintResult(result);
+
+    // how far the first camera group could grow
+    uint32_t max_count = FindMaxCameras(model, cameras, 0, config, result);
+    std::printf("\nmax cameras of the first group(p99 cap %.0f us): %u\n", config.latency_cap_us, max_count);
+    if (max_count > 0)
+    {
+        PrintResult(result);
+    }
+    return 0;
+}
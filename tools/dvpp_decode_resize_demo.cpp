@@ -0,0 +1,108 @@
+#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+
+#include "common/utils/file_process.hpp"
+#include "dvpp_decode_resize.h"
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 7)
+    {
+        std::cout << "Usage: ./dvpp_decode_resize_demo img_list_file(jpg、png...) batch_size des_width des_height num_loop use_jpegd(0/1) [device_id] [cpu_threads]" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> img_list;
+    alg_utils::get_all_line_from_txt(argv[1], img_list);
+    int batch_size = std::atoi(argv[2]);
+    int des_width = std::atoi(argv[3]);
+    int des_height = std::atoi(argv[4]);
+    int num_loop = std::atoi(argv[5]);
+    int use_jpegd = std::atoi(argv[6]);
+    int32_t deviceId = argc > 7 ? std::atoi(argv[7]) : 0;
+    int cpu_threads = argc > 8 ? std::atoi(argv[8]) : 0;
+    if (img_list.empty() || batch_size <= 0 || num_loop <= 0)
+    {
+        std::printf("empty img_list or bad batch_size/num_loop\n");
+        return -1;
+    }
+
+    // compressed bytes stay on host, only they are uploaded
+    std::vector<std::vector<uint8_t>> files(img_list.size());
+    for (size_t idx = 0; idx < img_list.size(); ++idx)
+    {
+        std::ifstream infile(img_list[idx], std::ios::binary);
+        files[idx].assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    WorkerPool pool;
+    WorkerPoolConfig poolConfig;
+    poolConfig.num_threads = cpu_threads;
+    pool.Init(&poolConfig);
+
+    DVPPDecodeResizeConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 0;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.use_jpegd = use_jpegd;
+    DvppDecodeResize decodeResize;
+    decodeResize.Init(&config, &pool);
+    if (!decodeResize.HasInit())
+    {
+        return -1;
+    }
+
+    std::vector<std::vector<DVPPEncodedImage>> batches(num_loop, std::vector<DVPPEncodedImage>(batch_size));
+    for (int loop = 0; loop < num_loop; ++loop)
+    {
+        for (int idx = 0; idx < batch_size; ++idx)
+        {
+            const std::vector<uint8_t>& file = files[(loop * batch_size + idx) % files.size()];
+            batches[loop][idx].data = file.data();
+            batches[loop][idx].size = file.size();
+        }
+    }
+
+    int failed = 0;
+    std::chrono::time_point<std::chrono::system_clock> startTP = std::chrono::system_clock::now();
+    decodeResize.Submit(batches[0].data(), batch_size);
+    for (int loop = 0; loop < num_loop; ++loop)
+    {
+        // decode of the next batch runs while this one is resized
+        if (loop + 1 < num_loop)
+        {
+            decodeResize.Submit(batches[loop + 1].data(), batch_size);
+        }
+        if (1 != decodeResize.Process(nullptr, batch_size))
+        {
+            failed++;
+        }
+    }
+    std::chrono::time_point<std::chrono::system_clock> finishTP = std::chrono::system_clock::now();
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(finishTP - startTP).count();
+    std::printf("decode + resize %d batches(%d failed) time = %ld us, average = %ld us\n", num_loop, failed,
+                total_us, total_us / num_loop);
+
+    decodeResize.DestroyResource();
+    pool.Destroy();
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
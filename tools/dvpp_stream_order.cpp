@@ -0,0 +1,211 @@
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "dvpp_resize.h"
+
+#define ORDER_FRAME_WIDTH 1920
+#define ORDER_FRAME_HEIGHT 1080
+
+// steps in the order the streams ran them
+static std::mutex g_log_mutex;
+static std::vector<std::string> g_log;
+
+static void Log(const std::string& step)
+{
+    std::lock_guard<std::mutex> lock(g_log_mutex);
+    g_log.push_back(step);
+}
+
+static void LogCallback(void* user_data)
+{
+    Log(static_cast<const char*>(user_data));
+}
+
+static int Position(const std::string& step)
+{
+    std::lock_guard<std::mutex> lock(g_log_mutex);
+    std::vector<std::string>::const_iterator iter = std::find(g_log.begin(), g_log.end(), step);
+    return g_log.end() == iter ? -1 : static_cast<int>(iter - g_log.begin());
+}
+
+static int Expect(bool ok, const char* what)
+{
+    std::printf("%s: %s\n", ok ? "ok  " : "FAIL", what);
+    return ok ? 0 : 1;
+}
+
+// decode -> resize -> inference on three host emulated streams, chained by events only
+static int CheckHostOrdering()
+{
+    g_log.clear();
+    HostEmulatedStream decode_stream;
+    HostEmulatedStream resize_stream;
+    HostEmulatedStream infer_stream;
+    void* decoded = resize_stream.CreateEvent();
+    void* resized = resize_stream.CreateEvent();
+
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    decode_stream.Launch([](aclrtStream) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Log("decode");
+        return ACL_SUCCESS;
+    });
+    decode_stream.RecordEvent(decoded);
+    resize_stream.WaitEvent(decoded);
+    resize_stream.Launch([](aclrtStream) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        Log("resize");
+        return ACL_SUCCESS;
+    });
+    resize_stream.RecordEvent(resized);
+    resize_stream.LaunchCallback(LogCallback, const_cast<char*>("callback"));
+    infer_stream.WaitEvent(resized);
+    infer_stream.Launch([](aclrtStream) {
+        Log("infer");
+        return ACL_SUCCESS;
+    });
+    long queue_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    resize_stream.SynchronizeEvent(resized);
+    bool resized_done = Position("resize") >= 0;
+    int failed = 0;
+    failed += Expect(1 == infer_stream.Synchronize() && 1 == resize_stream.Synchronize() &&
+                     1 == decode_stream.Synchronize(), "every stream completes");
+    failed += Expect(queue_ms < 20, "queuing does not block the host");
+    failed += Expect(resized_done, "SynchronizeEvent returns after the work recorded before the event");
+    failed += Expect(Position("decode") < Position("resize"), "resize waits for the decoded event");
+    failed += Expect(Position("resize") < Position("callback"), "callback runs after the resize");
+    failed += Expect(Position("resize") < Position("infer"), "inference waits for the resized event");
+
+    // a wait queued before the record only waits for the records queued so far, as aclrtStreamWaitEvent
+    g_log.clear();
+    void* late = resize_stream.CreateEvent();
+    resize_stream.WaitEvent(late);
+    resize_stream.Launch([](aclrtStream) {
+        Log("unblocked");
+        return ACL_SUCCESS;
+    });
+    failed += Expect(1 == resize_stream.Synchronize() && Position("unblocked") >= 0,
+                     "a wait for an event never recorded does not block");
+
+    resize_stream.DestroyEvent(decoded);
+    resize_stream.DestroyEvent(resized);
+    resize_stream.DestroyEvent(late);
+    return failed;
+}
+
+// ProcessAsync on a host emulated stream over the device stream and on the acl stream
+static int CheckResizeOrdering(int32_t deviceId, int num_batches)
+{
+    aclrtContext context = nullptr;
+    aclrtStream stream = nullptr;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return 1;
+    }
+    uint32_t frame_size = YUV420SP_SIZE(ORDER_FRAME_WIDTH, ORDER_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    void* dev_frame = nullptr;
+    if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+        ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+    {
+        std::printf("upload synthetic frame failed\n");
+        return 1;
+    }
+    DVPPImageData frame;
+    frame.width = ORDER_FRAME_WIDTH;
+    frame.height = ORDER_FRAME_HEIGHT;
+    frame.alignWidth = ORDER_FRAME_WIDTH;
+    frame.alignHeight = ORDER_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = static_cast<uint8_t*>(dev_frame);
+    std::vector<DVPPImageData> frames(4, frame);
+
+    DVPPResizeInitConfig config;
+    config.context = context;
+    config.stream = stream;
+    config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.batch_size = static_cast<uint32_t>(frames.size());
+    config.resized_width = 640;
+    config.resized_height = 640;
+    DvppResize resize;
+    resize.Init(&config);
+    if (!resize.HasInit())
+    {
+        return 1;
+    }
+
+    int failed = 0;
+    HostEmulatedStream host_stream(stream, context);
+    DvppStream* streams[2] = {&host_stream, nullptr};
+    const char* stream_names[2] = {"host emulated", "acl"};
+    std::vector<std::string> names(num_batches);
+    for (int which = 0; which < 2; ++which)
+    {
+        resize.SetStream(streams[which]);
+        g_log.clear();
+        void* done = resize.Stream()->CreateEvent();
+        for (int batch = 0; batch < num_batches; ++batch)
+        {
+            names[batch] = "batch_" + std::to_string(batch);
+            DVPPAsyncParam async;
+            async.done_event = done;
+            async.callback = LogCallback;
+            async.user_data = const_cast<char*>(names[batch].c_str());
+            if (1 != resize.ProcessAsync(frames.data(), nullptr, static_cast<int>(frames.size()), async))
+            {
+                failed++;
+            }
+        }
+        bool synced = 1 == resize.Stream()->SynchronizeEvent(done) && 1 == resize.Stream()->Synchronize();
+        bool in_order = static_cast<int>(g_log.size()) == num_batches;
+        for (int batch = 0; in_order && batch < num_batches; ++batch)
+        {
+            in_order = names[batch] == g_log[batch];
+        }
+        std::printf("%s stream: %d batches queued, %zu callbacks\n", stream_names[which], num_batches, g_log.size());
+        failed += Expect(synced, "the done event completes");
+        failed += Expect(in_order, "one callback per batch, in submit order");
+        // a blocking Process right after the queued batches rewrites the descriptors only once they are done
+        failed += Expect(1 == resize.Process(frames.data(), nullptr, static_cast<int>(frames.size())),
+                         "Process after ProcessAsync");
+        resize.Stream()->DestroyEvent(done);
+    }
+    resize.SetStream(nullptr);
+    resize.DestroyResource();
+
+    acldvppFree(dev_frame);
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return failed;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc > 1 && std::string("-h") == argv[1])
+    {
+        std::cout << "Usage: ./dvpp_stream_order [device_id] [num_batches]" << std::endl;
+        std::cout << "       without device_id only the host emulated streams are checked" << std::endl;
+        return -1;
+    }
+    int failed = CheckHostOrdering();
+    if (argc > 1)
+    {
+        failed += CheckResizeOrdering(std::atoi(argv[1]), argc > 2 ? std::max(1, std::atoi(argv[2])) : 8);
+    }
+    std::printf("%s, %d checks failed\n", failed ? "FAILED" : "PASSED", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "dvpp_resize.h"
+#include "cpu_resize.h"
+#include "dvpp_trace.h"
+#include "worker_pool.h"
+
+static uint32_t MaxImageSize(const DVPPTraceImage& image)
+{
+    // large enough for both BGR_888 and YUV_SEMIPLANAR_420
+    uint32_t width = std::max(image.width, image.align_width);
+    uint32_t height = std::max(image.height, image.align_height);
+    return ALIGN_UP16(width) * 3 * ALIGN_UP2(height);
+}
+
+static void FillSyntheticPixels(std::vector<uint8_t>& pixels)
+{
+    uint32_t seed = 0x9e3779b9u;
+    for (size_t idx = 0; idx < pixels.size(); ++idx)
+    {
+        // gradient with a bit of noise, close enough to camera content for the vpc
+        seed = seed * 1664525u + 1013904223u;
+        pixels[idx] = static_cast<uint8_t>((idx >> 4) + (seed >> 28));
+    }
+}
+
+static uint64_t Percentile(std::vector<uint64_t> values, float p)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t pos = static_cast<size_t>(p * (values.size() - 1));
+    return values[pos];
+}
+
+template<typename Engine>
+static int Replay(Engine& engine, const std::vector<DVPPTraceRecord>& records,
+                  const std::vector<std::vector<DVPPTraceImage>>& images,
+                  const std::vector<uint8_t*>& slot_buffers, int pace, std::vector<uint64_t>& latencies)
+{
+    std::vector<DVPPImageData> src_imgs;
+    std::vector<RectInt> rects;
+    int failed = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (size_t rec = 0; rec < records.size(); ++rec)
+    {
+        const DVPPTraceRecord& record = records[rec];
+        if (pace)
+        {
+            std::this_thread::sleep_until(startTP + std::chrono::nanoseconds(record.timestamp_ns));
+        }
+        src_imgs.resize(record.img_num);
+        rects.resize(record.img_num);
+        for (uint32_t idx = 0; idx < record.img_num; ++idx)
+        {
+            const DVPPTraceImage& image = images[rec][idx];
+            src_imgs[idx].width = image.width;
+            src_imgs[idx].height = image.height;
+            src_imgs[idx].alignWidth = image.align_width;
+            src_imgs[idx].alignHeight = image.align_height;
+            src_imgs[idx].size = MaxImageSize(image);
+            src_imgs[idx].data = slot_buffers[idx];
+            rects[idx].xmin = image.xmin;
+            rects[idx].ymin = image.ymin;
+            rects[idx].xmax = image.xmax;
+            rects[idx].ymax = image.ymax;
+            rects[idx].width = image.xmax - image.xmin + 1;
+            rects[idx].height = image.ymax - image.ymin + 1;
+        }
+        std::chrono::time_point<std::chrono::steady_clock> callTP = std::chrono::steady_clock::now();
+        if (1 != engine.Process(src_imgs.data(), record.has_rois ? rects.data() : nullptr, record.img_num))
+        {
+            failed++;
+        }
+        latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - callTP).count());
+    }
+    return failed;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./dvpp_trace_replay trace_file engine(dvpp/cpu) pace(0: max speed, 1: recorded speed) [device_id] [cpu_threads]" << std::endl;
+        return -1;
+    }
+    std::string engine_name = argv[2];
+    int pace = std::atoi(argv[3]);
+    int32_t deviceId = argc > 4 ? std::atoi(argv[4]) : 0;
+    int cpu_threads = argc > 5 ? std::atoi(argv[5]) : 0;
+    bool use_dvpp = "dvpp" == engine_name;
+
+    DvppTraceReader reader;
+    if (1 != reader.Open(argv[1]))
+    {
+        return -1;
+    }
+    const DVPPTraceHeader& header = reader.Header();
+    std::vector<DVPPTraceRecord> records;
+    std::vector<std::vector<DVPPTraceImage>> images;
+    DVPPTraceRecord record;
+    std::vector<DVPPTraceImage> record_images;
+    std::vector<uint32_t> slot_sizes(header.batch_size, 0);
+    while (reader.Next(record, record_images))
+    {
+        if (record.img_num > header.batch_size)
+        {
+            std::printf("skip record with img_num %d > batch_size %d\n", record.img_num, header.batch_size);
+            continue;
+        }
+        for (uint32_t idx = 0; idx < record.img_num; ++idx)
+        {
+            slot_sizes[idx] = std::max(slot_sizes[idx], MaxImageSize(record_images[idx]));
+        }
+        records.push_back(record);
+        images.push_back(record_images);
+    }
+    std::printf("trace: %zu records, batch_size = %d, resized %dx%d, input_format = %d\n", records.size(),
+                header.batch_size, header.resized_width, header.resized_height, header.input_format);
+    if (records.empty())
+    {
+        return 0;
+    }
+
+    DVPPResizeInitConfig dvppResizeInitConfig;
+    dvppResizeInitConfig.context = nullptr;
+    dvppResizeInitConfig.stream = nullptr;
+    dvppResizeInitConfig.input_format = header.input_format;
+    dvppResizeInitConfig.batch_size = header.batch_size;
+    dvppResizeInitConfig.resized_width = header.resized_width;
+    dvppResizeInitConfig.resized_height = header.resized_height;
+    dvppResizeInitConfig.is_fix_scale_resize = header.is_fix_scale_resize;
+    dvppResizeInitConfig.is_symmetry_padding = header.is_symmetry_padding;
+    dvppResizeInitConfig.resize_scale_factor = header.resize_scale_factor;
+    dvppResizeInitConfig.interpolation = header.interpolation;
+    dvppResizeInitConfig.max_pass_upscale = header.max_pass_upscale;
+    dvppResizeInitConfig.max_pass_downscale = header.max_pass_downscale;
+    dvppResizeInitConfig.compute_stats = header.compute_stats;
+    dvppResizeInitConfig.border_value = header.border_value;
+    dvppResizeInitConfig.drop_bad_images = header.drop_bad_images;
+
+    std::vector<uint64_t> latencies;
+    std::vector<uint8_t*> slot_buffers(header.batch_size, nullptr);
+    std::vector<std::vector<uint8_t>> host_buffers(header.batch_size);
+    for (uint32_t idx = 0; idx < header.batch_size; ++idx)
+    {
+        host_buffers[idx].resize(std::max<uint32_t>(slot_sizes[idx], 1));
+        FillSyntheticPixels(host_buffers[idx]);
+        slot_buffers[idx] = host_buffers[idx].data();
+    }
+
+    int failed = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    if (use_dvpp)
+    {
+        aclrtContext context = nullptr;
+        aclrtStream stream = nullptr;
+        if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+            ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+        {
+            std::printf("acl init on device %d failed\n", deviceId);
+            return -1;
+        }
+        for (uint32_t idx = 0; idx < header.batch_size; ++idx)
+        {
+            void* dev_buffer = nullptr;
+            if (ACL_SUCCESS != acldvppMalloc(&dev_buffer, host_buffers[idx].size()) ||
+                ACL_SUCCESS != aclrtMemcpy(dev_buffer, host_buffers[idx].size(), host_buffers[idx].data(),
+                                           host_buffers[idx].size(), ACL_MEMCPY_HOST_TO_DEVICE))
+            {
+                std::printf("upload synthetic pixels failed\n");
+                return -1;
+            }
+            slot_buffers[idx] = static_cast<uint8_t*>(dev_buffer);
+        }
+
+        dvppResizeInitConfig.context = context;
+        dvppResizeInitConfig.stream = stream;
+        DvppResize dvppResize;
+        dvppResize.Init(&dvppResizeInitConfig);
+        if (!dvppResize.HasInit())
+        {
+            return -1;
+        }
+        startTP = std::chrono::steady_clock::now();
+        failed = Replay(dvppResize, records, images, slot_buffers, pace, latencies);
+        dvppResize.DestroyResource();
+
+        for (uint32_t idx = 0; idx < header.batch_size; ++idx)
+        {
+            acldvppFree(slot_buffers[idx]);
+        }
+        aclrtDestroyStream(stream);
+        aclrtDestroyContext(context);
+        aclrtResetDevice(deviceId);
+        aclFinalize();
+    }
+    else
+    {
+        WorkerPool pool;
+        WorkerPoolConfig poolConfig;
+        poolConfig.num_threads = cpu_threads;
+        CpuResize cpuResize;
+        cpuResize.Init(&dvppResizeInitConfig);
+        if (!cpuResize.HasInit() || 1 != pool.Init(&poolConfig))
+        {
+            return -1;
+        }
+        cpuResize.SetWorkerPool(&pool);
+        startTP = std::chrono::steady_clock::now();
+        pool.ResetStats();
+        failed = Replay(cpuResize, records, images, slot_buffers, pace, latencies);
+        cpuResize.DestroyResource();
+
+        std::vector<WorkerStats> worker_stats;
+        pool.GetStats(worker_stats);
+        for (size_t idx = 0; idx < worker_stats.size(); ++idx)
+        {
+            std::printf("worker %zu: cpu %d, numa node %d, %ld tasks, busy %ld us, utilization %.1f%%\n", idx,
+                        worker_stats[idx].cpu, worker_stats[idx].numa_node, worker_stats[idx].tasks,
+                        worker_stats[idx].busy_us, 100.0f * worker_stats[idx].utilization);
+        }
+        ResizeTableCacheStats tableStats = CpuResize::GetTableCacheStats();
+        std::printf("resize tables: %ld hits, %ld misses, %ld evictions, %ld entries, %ld bytes\n",
+                    tableStats.hit_count, tableStats.miss_count, tableStats.evict_count, tableStats.entry_count,
+                    tableStats.bytes);
+    }
+    uint64_t total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    std::vector<uint64_t> recorded;
+    uint64_t num_images = 0;
+    for (size_t rec = 0; rec < records.size(); ++rec)
+    {
+        recorded.push_back(records[rec].setup_us + records[rec].launch_us + records[rec].sync_us);
+        num_images += records[rec].img_num;
+    }
+    std::printf("replay %s: %zu calls, %d failed, %ld us, %.1f images/s\n", engine_name.c_str(), records.size(), failed,
+                total_us, total_us > 0 ? 1e6 * num_images / total_us : 0.0);
+    std::printf("recorded latency p50 = %ld us, p99 = %ld us, max = %ld us\n", Percentile(recorded, 0.5f),
+                Percentile(recorded, 0.99f), Percentile(recorded, 1.0f));
+    std::printf("replayed latency p50 = %ld us, p99 = %ld us, max = %ld us\n", Percentile(latencies, 0.5f),
+                Percentile(latencies, 0.99f), Percentile(latencies, 1.0f));
+    return 0;
+}
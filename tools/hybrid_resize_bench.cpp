@@ -0,0 +1,121 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "hybrid_resize.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 5)
+    {
+        std::cout << "Usage: ./hybrid_resize_bench batch_size des_width des_height num_batches [num_threads(0: all cpus)] [sim_device_us sim_host_us] [device_id]" << std::endl;
+        std::cout << "       sim_device_us/sim_host_us > 0: no device, both paths are CpuResize paced to these per-image costs" << std::endl;
+        return -1;
+    }
+    int batch_size = std::atoi(argv[1]);
+    int des_width = std::atoi(argv[2]);
+    int des_height = std::atoi(argv[3]);
+    int num_batches = std::atoi(argv[4]);
+    int num_threads = argc > 5 ? std::atoi(argv[5]) : 0;
+    float sim_device_us = argc > 7 ? std::atof(argv[6]) : 0.0f;
+    float sim_host_us = argc > 7 ? std::atof(argv[7]) : 0.0f;
+    int32_t deviceId = argc > 8 ? std::atoi(argv[8]) : 0;
+    bool simulate = sim_device_us > 0.0f && sim_host_us > 0.0f;
+    if (batch_size <= 0 || num_batches <= 0)
+    {
+        std::printf("bad batch_size or num_batches\n");
+        return -1;
+    }
+
+    aclrtContext context = nullptr;
+    aclrtStream stream = nullptr;
+    if (!simulate && (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+                      ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream)))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // one synthetic nv12 host frame for every image of the batch
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    DVPPImageData frame;
+    frame.width = BENCH_FRAME_WIDTH;
+    frame.height = BENCH_FRAME_HEIGHT;
+    frame.alignWidth = BENCH_FRAME_WIDTH;
+    frame.alignHeight = BENCH_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = host_frame.data();
+    std::vector<DVPPImageData> frames(batch_size, frame);
+
+    WorkerPool pool;
+    WorkerPoolConfig pool_config;
+    pool_config.num_threads = num_threads;
+    if (1 != pool.Init(&pool_config))
+    {
+        return -1;
+    }
+
+    DVPPHybridResizeConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.simulate = simulate ? 1 : 0;
+    config.sim_device_us_per_image = sim_device_us;
+    config.sim_host_us_per_image = sim_host_us;
+    HybridResize hybrid;
+    hybrid.Init(&config, &pool);
+    if (!hybrid.HasInit())
+    {
+        return -1;
+    }
+
+    int report = std::max(1, num_batches / 10);
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int batch = 0; batch < num_batches; ++batch)
+    {
+        if (1 != hybrid.Process(frames.data(), nullptr, batch_size))
+        {
+            std::printf("batch %d failed\n", batch);
+            break;
+        }
+        if (0 == (batch + 1) % report)
+        {
+            const DVPPHybridResizeStats& stats = hybrid.GetStats();
+            std::printf("batch %d: device %.1f us/image, host %.1f us/image, next split %d device + %d host\n", batch + 1,
+                        stats.device_us_per_image, stats.host_us_per_image, hybrid.DeviceShare(batch_size),
+                        batch_size - hybrid.DeviceShare(batch_size));
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPHybridResizeStats& stats = hybrid.GetStats();
+    uint64_t images = stats.device_image_count + stats.host_image_count;
+    std::printf("%ld images in %ld us, %.1f images/s, %ld on device, %ld on host, %ld failed batches, idle %.1f%%\n",
+                images, total_us, total_us > 0 ? 1e6 * images / total_us : 0.0, stats.device_image_count,
+                stats.host_image_count, stats.failed_count, stats.total_us ? 100.0 * stats.idle_us / stats.total_us : 0.0);
+
+    hybrid.DestroyResource();
+    pool.Destroy();
+    if (!simulate)
+    {
+        aclrtDestroyStream(stream);
+        aclrtDestroyContext(context);
+        aclrtResetDevice(deviceId);
+        aclFinalize();
+    }
+    return 0;
+}
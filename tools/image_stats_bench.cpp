@@ -0,0 +1,84 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cstring>
+
+#include "image_stats.h"
+
+// the Laplacian sums of a wide checkerboard overflow any 32 bit accumulation across a row
+#define STATS_WIDE_WIDTH 4000
+#define STATS_WIDE_HEIGHT 16
+
+static bool SameStats(const DVPPImageStats& a, const DVPPImageStats& b)
+{
+    return a.pixel_count == b.pixel_count && a.mean_luma == b.mean_luma && a.mean_bgr[0] == b.mean_bgr[0] &&
+           a.mean_bgr[1] == b.mean_bgr[1] && a.mean_bgr[2] == b.mean_bgr[2] && a.laplacian_var == b.laplacian_var &&
+           0 == std::memcmp(a.histogram, b.histogram, sizeof(a.histogram));
+}
+
+static long TimeStats(const std::vector<uint8_t>& bgr, uint32_t stride, const RectInt& area, DVPPImageStats& stats,
+                      bool use_simd, int num_loop)
+{
+    ComputeImageStats(bgr.data(), stride, area, stats, use_simd);
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int loop = 0; loop < num_loop; ++loop)
+    {
+        ComputeImageStats(bgr.data(), stride, area, stats, use_simd);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count() / num_loop;
+}
+
+// 0: noise, 1: black/white checkerboard of single pixels(largest Laplacian everywhere)
+static int CompareStats(int width, int height, int pattern, int num_loop)
+{
+    uint32_t stride = static_cast<uint32_t>(width) * 3;
+    std::vector<uint8_t> bgr(static_cast<size_t>(stride) * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < stride; ++x)
+        {
+            size_t idx = static_cast<size_t>(y) * stride + x;
+            bgr[idx] = 0 == pattern ? static_cast<uint8_t>((idx * 7) ^ (idx >> 9)) : ((x / 3 + y) % 2 ? 255 : 0);
+        }
+    }
+    RectInt area;
+    area.xmin = 0;
+    area.ymin = 0;
+    area.xmax = width - 1;
+    area.ymax = height - 1;
+    area.width = width;
+    area.height = height;
+    DVPPImageStats scalar, simd;
+    long scalar_us = TimeStats(bgr, stride, area, scalar, false, num_loop);
+    long simd_us = TimeStats(bgr, stride, area, simd, true, num_loop);
+    bool exact = SameStats(scalar, simd);
+    std::printf("%5dx%-5d %-12s scalar %6ld us, %s %6ld us, laplacian_var %.2f / %.2f, %s\n", width, height,
+                pattern ? "checkerboard" : "noise", scalar_us, ImageStatsIsa(), simd_us, scalar.laplacian_var,
+                simd.laplacian_var, exact ? "exact" : "MISMATCH");
+    return exact ? 0 : 1;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./image_stats_bench width height num_loop" << std::endl;
+        std::cout << "       a " << STATS_WIDE_WIDTH << "x" << STATS_WIDE_HEIGHT
+                  << " checkerboard is always compared too" << std::endl;
+        return -1;
+    }
+    int width = std::atoi(argv[1]);
+    int height = std::atoi(argv[2]);
+    int num_loop = std::atoi(argv[3]);
+    if (width <= 0 || height <= 0 || num_loop <= 0)
+    {
+        std::printf("bad width/height/num_loop\n");
+        return -1;
+    }
+    int failed = 0;
+    failed += CompareStats(width, height, 0, num_loop);
+    failed += CompareStats(width, height, 1, num_loop);
+    failed += CompareStats(STATS_WIDE_WIDTH, STATS_WIDE_HEIGHT, 1, num_loop);
+    std::printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cstring>
+
+#include "incremental_resize.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+#define BENCH_BOX_SIZE 96
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 5)
+    {
+        std::cout << "Usage: ./incremental_resize_bench num_streams des_width des_height num_frames [moving_streams] [use_cpu(0/1)] [partial_on_host(0/1)] [device_id]" << std::endl;
+        std::cout << "       every stream is a static BGR 1920x1080 scene, a box moves across the first moving_streams ones" << std::endl;
+        return -1;
+    }
+    int num_streams = std::atoi(argv[1]);
+    int des_width = std::atoi(argv[2]);
+    int des_height = std::atoi(argv[3]);
+    int num_frames = std::atoi(argv[4]);
+    int moving_streams = argc > 5 ? std::atoi(argv[5]) : 1;
+    int use_cpu = argc > 6 ? std::atoi(argv[6]) : 1;
+    int partial_on_host = argc > 7 ? std::atoi(argv[7]) : 0;
+    int32_t deviceId = argc > 8 ? std::atoi(argv[8]) : 0;
+    if (num_streams <= 0 || num_frames <= 0)
+    {
+        std::printf("bad num_streams or num_frames\n");
+        return -1;
+    }
+
+    aclrtContext context = nullptr;
+    aclrtStream stream = nullptr;
+    if (!use_cpu && (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+                     ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream)))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // one noise background per stream, the moving box is drawn into a copy of it
+    uint32_t frame_size = RGBU8_IMAGE_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<std::vector<uint8_t> > backgrounds(num_streams, std::vector<uint8_t>(frame_size));
+    std::vector<std::vector<uint8_t> > host_frames(backgrounds);
+    for (int idx = 0; idx < num_streams; ++idx)
+    {
+        for (uint32_t pos = 0; pos < frame_size; ++pos)
+        {
+            backgrounds[idx][pos] = static_cast<uint8_t>((pos + idx * 7919u) * 2654435761u >> 24);
+        }
+        host_frames[idx] = backgrounds[idx];
+    }
+    std::vector<DVPPImageData> frames(num_streams);
+    std::vector<uint32_t> stream_ids(num_streams);
+    for (int idx = 0; idx < num_streams; ++idx)
+    {
+        frames[idx].width = BENCH_FRAME_WIDTH;
+        frames[idx].height = BENCH_FRAME_HEIGHT;
+        frames[idx].alignWidth = BENCH_FRAME_WIDTH;
+        frames[idx].alignHeight = BENCH_FRAME_HEIGHT;
+        frames[idx].size = frame_size;
+        frames[idx].data = host_frames[idx].data();
+        stream_ids[idx] = idx;
+    }
+
+    WorkerPool pool;
+    WorkerPoolConfig pool_config;
+    if (1 != pool.Init(&pool_config))
+    {
+        return -1;
+    }
+
+    DVPPIncrementalConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_BGR_888;
+    config.resize_config.batch_size = num_streams;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.max_streams = num_streams;
+    config.use_cpu = use_cpu;
+    config.partial_on_host = partial_on_host;
+    IncrementalResize incremental;
+    incremental.Init(&config, &pool);
+    if (!incremental.HasInit())
+    {
+        return -1;
+    }
+
+    uint32_t row_bytes = BENCH_FRAME_WIDTH * 3;
+    int box_x = 0;
+    int box_y = BENCH_FRAME_HEIGHT / 2;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < num_frames; ++frame)
+    {
+        // erase the box of the last frame and draw it 8 pixels further
+        for (int idx = 0; idx < moving_streams && idx < num_streams; ++idx)
+        {
+            for (int row = box_y; row < box_y + BENCH_BOX_SIZE; ++row)
+            {
+                uint32_t offset = row * row_bytes + box_x * 3;
+                std::memcpy(host_frames[idx].data() + offset, backgrounds[idx].data() + offset, BENCH_BOX_SIZE * 3);
+            }
+        }
+        box_x = (box_x + 8) % (BENCH_FRAME_WIDTH - BENCH_BOX_SIZE);
+        for (int idx = 0; idx < moving_streams && idx < num_streams; ++idx)
+        {
+            for (int row = box_y; row < box_y + BENCH_BOX_SIZE; ++row)
+            {
+                std::memset(host_frames[idx].data() + row * row_bytes + box_x * 3, 255, BENCH_BOX_SIZE * 3);
+            }
+        }
+        if (1 != incremental.Process(frames.data(), stream_ids.data(), num_streams))
+        {
+            std::printf("frame %d failed\n", frame);
+            break;
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    const DVPPIncrementalStats& stats = incremental.GetStats();
+    std::printf("%lu frames in %ld us, %.1f frames/s, hash kernel %s\n", stats.frame_count, total_us,
+                total_us > 0 ? 1e6 * stats.frame_count / total_us : 0.0, TileHashIsa());
+    std::printf("skipped %lu, partial %lu, full %lu, dirty tiles %.2f%%, %lu output pixels redone\n",
+                stats.skipped_count, stats.partial_count, stats.full_count,
+                stats.tile_count ? 100.0 * stats.dirty_tile_count / stats.tile_count : 0.0, stats.redone_pixels);
+    std::printf("hashing %.1f us/frame, resizing %.1f us/frame\n",
+                stats.frame_count ? 1.0 * stats.detect_us / stats.frame_count : 0.0,
+                stats.frame_count ? 1.0 * stats.resize_us / stats.frame_count : 0.0);
+    for (int idx = 0; idx < num_streams && idx < 4; ++idx)
+    {
+        DVPPIncrementalStats stream_stats;
+        incremental.GetStreamStats(idx, stream_stats);
+        std::printf("stream %d: skipped %lu, partial %lu, full %lu\n", idx, stream_stats.skipped_count,
+                    stream_stats.partial_count, stream_stats.full_count);
+    }
+
+    incremental.DestroyResource();
+    pool.Destroy();
+    if (!use_cpu)
+    {
+        aclrtDestroyStream(stream);
+        aclrtDestroyContext(context);
+        aclrtResetDevice(deviceId);
+        aclFinalize();
+    }
+    return 0;
+}
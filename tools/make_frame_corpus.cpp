@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cstring>
+#include "opencv2/opencv.hpp"
+
+#include "common/utils/file_process.hpp"
+#include "frame_corpus.h"
+#include "color_convert.h"
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./make_frame_corpus img_list_file out_file(.corpus) yuv420sp_nv12(0/1) [width_align(16)] [height_align(2)]" << std::endl;
+        std::cout << "       width_align/height_align: 16/2 for VDEC layout, 64/16 for JPEGD layout on 310P" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> img_list;
+    alg_utils::get_all_line_from_txt(argv[1], img_list);
+    int yuv420sp_nv12 = std::atoi(argv[3]);
+    int width_align = argc > 4 ? std::atoi(argv[4]) : 16;
+    int height_align = argc > 5 ? std::atoi(argv[5]) : 2;
+    if (width_align <= 0 || 0 != width_align % 16 || height_align <= 0 || 0 != height_align % 2)
+    {
+        std::printf("width_align must be a multiple of 16 and height_align must be even\n");
+        return -1;
+    }
+
+    FrameCorpusWriter writer;
+    if (1 != writer.Open(argv[2], 1 == yuv420sp_nv12 ? PIXEL_FORMAT_YUV_SEMIPLANAR_420 : PIXEL_FORMAT_BGR_888))
+    {
+        return -1;
+    }
+
+    int num_frames = 0;
+    std::vector<uint8_t> frame;
+    for (size_t idx = 0; idx < img_list.size(); ++idx)
+    {
+        cv::Mat tmp = cv::imread(img_list[idx], cv::IMREAD_COLOR);
+        if (tmp.empty())
+        {
+            std::printf("read %s failed, skip it\n", img_list[idx].c_str());
+            continue;
+        }
+        // keep the decoded pixels, only drop the odd last row/column, padding goes into the stride
+        cv::Mat img = tmp(cv::Rect(0, 0, tmp.cols & ~1, tmp.rows & ~1));
+        uint32_t width = img.cols;
+        uint32_t height = img.rows;
+        uint32_t align_height = ALIGN_UP(height, height_align);
+
+        DVPPImageData image;
+        image.width = width;
+        image.height = height;
+        image.alignHeight = align_height;
+        if (1 == yuv420sp_nv12)
+        {
+            image.alignWidth = ALIGN_UP(width, width_align);
+            image.size = YUV420SP_SIZE(image.alignWidth, align_height);
+            frame.assign(image.size, 0);
+            // converted straight into the strided frame
+            DVPPImageData bgr;
+            bgr.width = width;
+            bgr.height = height;
+            bgr.alignWidth = img.step[0];
+            bgr.alignHeight = height;
+            bgr.size = 0;
+            bgr.data = img.data;
+            image.data = frame.data();
+            if (1 != ConvertColor(bgr, CVT_FORMAT_BGR, image, CVT_FORMAT_NV12))
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            image.alignWidth = ALIGN_UP(width, width_align) * 3;
+            image.size = image.alignWidth * align_height;
+            frame.assign(image.size, 0);
+            for (uint32_t row = 0; row < height; ++row)
+            {
+                std::memcpy(frame.data() + row * image.alignWidth, img.ptr(row), width * 3);
+            }
+        }
+        image.data = frame.data();
+        if (1 != writer.Append(image))
+        {
+            return -1;
+        }
+        num_frames++;
+    }
+    if (1 != writer.Close())
+    {
+        return -1;
+    }
+    std::printf("write %d frames to %s\n", num_frames, argv[2]);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "multi_device_resize.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 7)
+    {
+        std::cout << "Usage: ./multi_device_bench device_num channels_per_device batch_size des_width des_height batches_per_submitter [num_submitters] [sim_us_per_image ...]" << std::endl;
+        std::cout << "       sim_us_per_image given: no device, device i is CpuResize paced to the i-th cost(the last one for the rest)" << std::endl;
+        return -1;
+    }
+    int device_num = std::atoi(argv[1]);
+    int channels = std::atoi(argv[2]);
+    int batch_size = std::atoi(argv[3]);
+    int des_width = std::atoi(argv[4]);
+    int des_height = std::atoi(argv[5]);
+    int num_batches = std::atoi(argv[6]);
+    int num_submitters = argc > 7 ? std::atoi(argv[7]) : 2 * device_num;
+    std::vector<float> sim_us_per_image;
+    for (int idx = 8; idx < argc; ++idx)
+    {
+        sim_us_per_image.push_back(std::atof(argv[idx]));
+    }
+    bool simulate = !sim_us_per_image.empty();
+    if (device_num <= 0 || batch_size <= 0 || num_batches <= 0 || num_submitters <= 0)
+    {
+        std::printf("bad device_num, batch_size, batches_per_submitter or num_submitters\n");
+        return -1;
+    }
+    sim_us_per_image.resize(device_num, simulate ? sim_us_per_image.back() : 0.0f);
+    if (!simulate && ACL_SUCCESS != aclInit(nullptr))
+    {
+        std::printf("acl init failed\n");
+        return -1;
+    }
+
+    // one synthetic nv12 host frame for every image of the batch
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    DVPPImageData frame;
+    frame.width = BENCH_FRAME_WIDTH;
+    frame.height = BENCH_FRAME_HEIGHT;
+    frame.alignWidth = BENCH_FRAME_WIDTH;
+    frame.alignHeight = BENCH_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = host_frame.data();
+    std::vector<DVPPImageData> frames(batch_size, frame);
+
+    DVPPMultiDeviceConfig config;
+    config.resize_config.context = nullptr;
+    config.resize_config.stream = nullptr;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.device_num = device_num;
+    config.channels_per_device = channels;
+    config.simulate = simulate ? 1 : 0;
+    config.sim_us_per_image = sim_us_per_image.data();
+    MultiDeviceResize resize;
+    resize.Init(&config);
+    if (!resize.HasInit())
+    {
+        return -1;
+    }
+
+    // every submitter keeps one batch of host frames in flight
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    std::vector<std::thread> submitters;
+    for (int submitter = 0; submitter < num_submitters; ++submitter)
+    {
+        submitters.emplace_back([&resize, &frames, batch_size, num_batches] {
+            for (int batch = 0; batch < num_batches; ++batch)
+            {
+                DVPPMultiDeviceResult result = resize.Submit(frames.data(), nullptr, batch_size).get();
+                resize.Release(result);
+            }
+        });
+    }
+    for (size_t idx = 0; idx < submitters.size(); ++idx)
+    {
+        submitters[idx].join();
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    DVPPMultiDeviceStats stats = resize.GetStats();
+    std::printf("%lu images in %ld us, %.1f images/s, %lu failed, mean queue %.1f us/batch\n", stats.image_count,
+                total_us, total_us > 0 ? 1e6 * stats.image_count / total_us : 0.0, stats.failed_count,
+                stats.batch_count ? 1.0 * stats.queue_us / stats.batch_count : 0.0);
+    for (int device = 0; device < resize.DeviceNum(); ++device)
+    {
+        resize.GetDeviceStats(device, stats);
+        std::printf("device %d: %lu batches, %lu images, %.1f us/image, busy %.1f%%\n", device, stats.batch_count,
+                    stats.image_count, stats.us_per_image,
+                    total_us > 0 ? 100.0 * stats.busy_us / (static_cast<double>(total_us) * channels) : 0.0);
+    }
+
+    resize.DestroyResource();
+    if (!simulate)
+    {
+        aclFinalize();
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "resize_service.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+
+// one client process: frames are written straight into the frame slots, two requests in flight
+static int RunClient(const char* name, int client, int num_batches)
+{
+    DvppResizeClient resize;
+    if (1 != resize.Connect(name))
+    {
+        return -1;
+    }
+    int batch_size = static_cast<int>(resize.GetBatchSize());
+    std::vector<DVPPImageData> frames(batch_size);
+    std::vector<uint64_t> latencies;
+    std::vector<std::chrono::time_point<std::chrono::steady_clock> > submit_tps;
+    int failed = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int batch = 0; batch < num_batches + 1; ++batch)
+    {
+        if (batch < num_batches)
+        {
+            for (int idx = 0; idx < batch_size; ++idx)
+            {
+                if (1 != resize.GetInputSlot(frames[idx], idx, BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT))
+                {
+                    return -1;
+                }
+                // stands in for the decoder writing the frame
+                std::fill(frames[idx].data, frames[idx].data + frames[idx].size, static_cast<uint8_t>(batch + idx));
+            }
+            submit_tps.push_back(std::chrono::steady_clock::now());
+            if (1 != resize.Submit(frames.data(), nullptr, batch_size))
+            {
+                return -1;
+            }
+        }
+        if (batch > 0)
+        {
+            failed += 1 == resize.Wait() ? 0 : 1;
+            latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - submit_tps[batch - 1]).count());
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("client %d: %d batches in %ld us, %.1f images/s, latency p50 %lu us p99 %lu us, %d failed\n", client,
+                num_batches, total_us, total_us > 0 ? 1e6 * num_batches * batch_size / total_us : 0.0,
+                latencies[latencies.size() / 2], latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)],
+                failed);
+    resize.Disconnect();
+    return 0 == failed ? 0 : -1;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 3)
+    {
+        std::cout << "Usage: ./resize_client_bench num_clients num_batches [name(/dvpp_resize)]" << std::endl;
+        std::cout << "       start ./resize_daemon first, every client is a process of its own" << std::endl;
+        return -1;
+    }
+    int num_clients = std::atoi(argv[1]);
+    int num_batches = std::atoi(argv[2]);
+    const char* name = argc > 3 ? argv[3] : "/dvpp_resize";
+    if (num_clients <= 0 || num_batches <= 0)
+    {
+        std::printf("bad num_clients or num_batches\n");
+        return -1;
+    }
+    std::vector<pid_t> pids;
+    for (int client = 0; client < num_clients; ++client)
+    {
+        pid_t pid = fork();
+        if (0 == pid)
+        {
+            int ret = RunClient(name, client, num_batches);
+            std::fflush(stdout);
+            _exit(0 == ret ? 0 : 1);
+        }
+        pids.push_back(pid);
+    }
+    int failed = 0;
+    for (size_t idx = 0; idx < pids.size(); ++idx)
+    {
+        int status = 0;
+        waitpid(pids[idx], &status, 0);
+        failed += WIFEXITED(status) && 0 == WEXITSTATUS(status) ? 0 : 1;
+    }
+    std::printf("%d of %d clients failed\n", failed, num_clients);
+    return 0 == failed ? 0 : -1;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "resize_service.h"
+
+static DvppResizeService* g_service = nullptr;
+
+static void OnSignal(int)
+{
+    if (g_service)
+    {
+        g_service->Stop();
+    }
+}
+
+int main(int argc, const char *argv[])
+{
+    // --cpu and --shm_mode may be anywhere, the rest is positional
+    bool use_cpu = false;
+    uint32_t shm_mode = 0600;
+    std::vector<const char*> args;
+    for (int idx = 0; idx < argc; ++idx)
+    {
+        if (0 == std::strcmp(argv[idx], "--cpu"))
+        {
+            use_cpu = true;
+        }
+        else if (0 == std::strncmp(argv[idx], "--shm_mode=", 11))
+        {
+            shm_mode = static_cast<uint32_t>(std::strtoul(argv[idx] + 11, nullptr, 8));
+        }
+        else
+        {
+            args.push_back(argv[idx]);
+        }
+    }
+    int num_args = static_cast<int>(args.size());
+    if (num_args < 5)
+    {
+        std::cout << "Usage: ./resize_daemon batch_size des_width des_height yuv420sp_nv12_resize [--cpu] [--shm_mode=0600] [name(/dvpp_resize)] [lane_num(8)] [channel_num(1)] [max_src_width(1920) max_src_height(1080)] [num_threads(0: all cpus)] [device_id]" << std::endl;
+        std::cout << "       --cpu: CpuResize stands in for the vpc, runs on any linux box" << std::endl;
+        std::cout << "       --shm_mode: octal permissions of the shared memory, 0660 lets clients of the same group connect" << std::endl;
+        return -1;
+    }
+    DVPPResizeServiceConfig config;
+    config.resize_config.batch_size = std::atoi(args[1]);
+    config.resize_config.resized_width = std::atoi(args[2]);
+    config.resize_config.resized_height = std::atoi(args[3]);
+    config.resize_config.input_format = 1 == std::atoi(args[4]) ? 1 : 13;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 0;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.name = num_args > 5 ? args[5] : "/dvpp_resize";
+    config.lane_num = num_args > 6 ? std::atoi(args[6]) : 8;
+    config.channel_num = num_args > 7 ? std::atoi(args[7]) : 1;
+    config.max_src_width = num_args > 9 ? std::atoi(args[8]) : 1920;
+    config.max_src_height = num_args > 9 ? std::atoi(args[9]) : 1080;
+    int num_threads = num_args > 10 ? std::atoi(args[10]) : 0;
+    int32_t deviceId = num_args > 11 ? std::atoi(args[11]) : 0;
+    config.use_cpu = use_cpu ? 1 : 0;
+    config.shm_mode = shm_mode;
+
+    aclrtContext context = nullptr;
+    if (!use_cpu && (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+                     ACL_SUCCESS != aclrtCreateContext(&context, deviceId)))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+    config.resize_config.context = context;
+
+    WorkerPool pool;
+    WorkerPoolConfig pool_config;
+    pool_config.num_threads = num_threads;
+    if (use_cpu && 1 != pool.Init(&pool_config))
+    {
+        return -1;
+    }
+
+    DvppResizeService service;
+    service.Init(&config, use_cpu ? &pool : nullptr);
+    if (!service.HasInit())
+    {
+        return -1;
+    }
+    g_service = &service;
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::printf("serving %s: %d lanes, %d channels on %s, batch_size %d, %dx%d\n", config.name, config.lane_num,
+                config.channel_num, use_cpu ? "cpu" : "vpc", config.resize_config.batch_size,
+                config.resize_config.resized_width, config.resize_config.resized_height);
+    service.Run();
+
+    DVPPResizeServiceStats stats = service.GetStats();
+    std::printf("%ld requests, %ld images, %ld failed, busy %ld us\n", stats.request_count, stats.image_count,
+                stats.failed_count, stats.busy_us);
+    g_service = nullptr;
+    service.DestroyResource();
+    if (use_cpu)
+    {
+        pool.Destroy();
+    }
+    else
+    {
+        aclrtDestroyContext(context);
+        aclrtResetDevice(deviceId);
+        aclFinalize();
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "opencv2/opencv.hpp"
+#include "dvpp_resize_encode.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+
+// baseline of main.cpp: resize, then read back and encode every image on the calling thread
+static long RunReadbackEncode(const DVPPResizeInitConfig& config, const std::vector<DVPPImageData>& frames,
+                              int num_batches, int quality)
+{
+    DvppResize resize;
+    resize.Init(&config);
+    if (!resize.HasInit())
+    {
+        return -1;
+    }
+    std::vector<int> params;
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(quality);
+    std::vector<uint8_t> jpeg;
+    uint64_t bytes = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int batch = 0; batch < num_batches; ++batch)
+    {
+        if (1 != resize.Process(frames.data(), nullptr, static_cast<int>(frames.size())))
+        {
+            std::printf("batch %d failed\n", batch);
+            break;
+        }
+        for (size_t idx = 0; idx < frames.size(); ++idx)
+        {
+            DVPPImageData host_image;
+            if (1 != resize.GetHostData(host_image, static_cast<int>(idx)))
+            {
+                break;
+            }
+            cv::Mat bgr(host_image.height, host_image.width, CV_8UC3, host_image.data, host_image.alignWidth);
+            cv::imencode(".jpg", bgr, jpeg, params);
+            bytes += jpeg.size();
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    uint64_t images = static_cast<uint64_t>(num_batches) * frames.size();
+    std::printf("readback + imencode: %ld images in %ld us, %.1f images/s, %.1f KB/image\n", images, total_us,
+                total_us > 0 ? 1e6 * images / total_us : 0.0, images ? bytes / 1024.0 / images : 0.0);
+    resize.DestroyResource();
+    return total_us;
+}
+
+static long RunResizeEncode(const DVPPResizeEncodeConfig& config, const std::vector<DVPPImageData>& frames,
+                            int num_batches, WorkerPool* pool)
+{
+    DvppResizeEncode encoder;
+    encoder.Init(&config, pool);
+    if (!encoder.HasInit())
+    {
+        return -1;
+    }
+    int img_num = static_cast<int>(frames.size());
+    int pending = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int batch = 0; batch < num_batches; ++batch)
+    {
+        // keep one batch encoding while the next one is resized
+        if (pending == DVPP_ENCODE_SLOT_NUM)
+        {
+            encoder.Collect();
+            pending--;
+        }
+        if (1 != encoder.Process(frames.data(), nullptr, img_num))
+        {
+            std::printf("batch %d failed\n", batch);
+            break;
+        }
+        pending++;
+    }
+    for (; pending > 0; --pending)
+    {
+        encoder.Collect();
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPResizeEncodeStats& stats = encoder.GetStats();
+    uint64_t images = stats.jpege_image_count + stats.host_image_count;
+    std::printf("resize + encode    : %ld images in %ld us, %.1f images/s, %.1f KB/image, %ld by JPEGE, %ld on host, "
+                "%ld failed batches, resize %ld us, encode %ld us, wait %ld us\n", images, total_us,
+                total_us > 0 ? 1e6 * images / total_us : 0.0, images ? stats.encoded_bytes / 1024.0 / images : 0.0,
+                stats.jpege_image_count, stats.host_image_count, stats.failed_count, stats.resize_us, stats.encode_us,
+                stats.wait_us);
+    encoder.DestroyResource();
+    return total_us;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 5)
+    {
+        std::cout << "Usage: ./resize_encode_bench batch_size thumb_width thumb_height num_batches [quality(90)] [use_jpege(1)] [num_threads(0: all cpus)] [device_id]" << std::endl;
+        return -1;
+    }
+    int batch_size = std::atoi(argv[1]);
+    int thumb_width = std::atoi(argv[2]);
+    int thumb_height = std::atoi(argv[3]);
+    int num_batches = std::atoi(argv[4]);
+    int quality = argc > 5 ? std::atoi(argv[5]) : 90;
+    int use_jpege = argc > 6 ? std::atoi(argv[6]) : 1;
+    int num_threads = argc > 7 ? std::atoi(argv[7]) : 0;
+    int32_t deviceId = argc > 8 ? std::atoi(argv[8]) : 0;
+    if (batch_size <= 0 || thumb_width <= 0 || thumb_height <= 0 || num_batches <= 0)
+    {
+        std::printf("bad batch_size, thumbnail size or num_batches\n");
+        return -1;
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // one synthetic nv12 frame for every image of the batch, a gradient so the jpegs have a realistic size
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>((idx % BENCH_FRAME_WIDTH) / 8 + (idx / BENCH_FRAME_WIDTH) / 8);
+    }
+    void* dev_frame = nullptr;
+    if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+        ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+    {
+        std::printf("upload frame failed\n");
+        return -1;
+    }
+    DVPPImageData frame;
+    frame.width = BENCH_FRAME_WIDTH;
+    frame.height = BENCH_FRAME_HEIGHT;
+    frame.alignWidth = BENCH_FRAME_WIDTH;
+    frame.alignHeight = BENCH_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = static_cast<uint8_t*>(dev_frame);
+    std::vector<DVPPImageData> frames(batch_size, frame);
+
+    WorkerPool pool;
+    WorkerPoolConfig pool_config;
+    pool_config.num_threads = num_threads;
+    if (1 != pool.Init(&pool_config))
+    {
+        return -1;
+    }
+
+    DVPPResizeEncodeConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = thumb_width;
+    config.resize_config.resized_height = thumb_height;
+    config.resize_config.is_fix_scale_resize = 0;
+    config.resize_config.is_symmetry_padding = 0;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.quality = quality;
+    config.use_jpege = use_jpege;
+
+    long baseline_us = RunReadbackEncode(config.resize_config, frames, num_batches, quality);
+    long encode_us = RunResizeEncode(config, frames, num_batches, &pool);
+    if (baseline_us > 0 && encode_us > 0)
+    {
+        std::printf("speedup of the encode stage: %.2fx\n", 1.0f * baseline_us / encode_us);
+    }
+
+    pool.Destroy();
+    acldvppFree(dev_frame);
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
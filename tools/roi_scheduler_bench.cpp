@@ -0,0 +1,175 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "roi_scheduler.h"
+
+#define BENCH_FRAME_WIDTH 1920
+#define BENCH_FRAME_HEIGHT 1080
+#define BENCH_FRAME_NUM 8
+
+// crop sides follow a log-normal distribution, most detections are small, a few are close to frame size
+static void GenerateRois(int num_rois, float median_side, float sigma, std::vector<int>& frame_ids,
+                         std::vector<RectInt>& rois)
+{
+    std::mt19937 rng(20261019);
+    std::lognormal_distribution<float> side_dist(std::log(median_side), sigma);
+    std::lognormal_distribution<float> aspect_dist(0.0f, 0.3f);
+    std::uniform_real_distribution<float> pos_dist(0.0f, 1.0f);
+    std::uniform_int_distribution<int> frame_dist(0, BENCH_FRAME_NUM - 1);
+    frame_ids.resize(num_rois);
+    rois.resize(num_rois);
+    for (int idx = 0; idx < num_rois; ++idx)
+    {
+        float side = side_dist(rng);
+        float aspect = aspect_dist(rng);
+        int width = static_cast<int>(side * std::sqrt(aspect));
+        int height = static_cast<int>(side / std::sqrt(aspect));
+        width = std::max(32, std::min(width, BENCH_FRAME_WIDTH));
+        height = std::max(32, std::min(height, BENCH_FRAME_HEIGHT));
+        RectInt& roi = rois[idx];
+        roi.xmin = static_cast<int>(pos_dist(rng) * (BENCH_FRAME_WIDTH - width));
+        roi.ymin = static_cast<int>(pos_dist(rng) * (BENCH_FRAME_HEIGHT - height));
+        roi.xmax = roi.xmin + width - 1;
+        roi.ymax = roi.ymin + height - 1;
+        roi.width = width;
+        roi.height = height;
+        frame_ids[idx] = frame_dist(rng);
+    }
+}
+
+static int RunScheduler(DVPPRoiSchedulerConfig config, const std::vector<DVPPImageData>& frames,
+                        const std::vector<int>& frame_ids, const std::vector<RectInt>& rois)
+{
+    RoiScheduler scheduler;
+    scheduler.Init(&config);
+    if (!scheduler.HasInit())
+    {
+        return -1;
+    }
+    int64_t ticket;
+    int64_t expected = 0;
+    DVPPImageData resized;
+    int out_of_order = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < rois.size(); ++idx)
+    {
+        scheduler.Submit(frames[frame_ids[idx]], rois[idx]);
+        scheduler.Flush(false);
+        while (scheduler.Pop(ticket, resized))
+        {
+            out_of_order += ticket != expected++ ? 1 : 0;
+        }
+    }
+    while (expected < static_cast<int64_t>(rois.size()))
+    {
+        scheduler.Flush(true);
+        while (scheduler.Pop(ticket, resized))
+        {
+            out_of_order += ticket != expected++ ? 1 : 0;
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+
+    const DVPPRoiSchedulerStats& stats = scheduler.GetStats();
+    const DVPPResizeStats& resize_stats = scheduler.Resizer().GetStats();
+    std::printf("%s: %zu rois in %ld us, %.1f rois/s, %ld batches(%ld full), %ld failed, %d out of order, vpc sync %ld us\n",
+                config.use_buckets ? "bucketed" : "fifo    ", rois.size(), total_us,
+                total_us > 0 ? 1e6 * rois.size() / total_us : 0.0, stats.batch_count, stats.full_batch_count,
+                stats.failed_count, out_of_order, resize_stats.sync_us);
+    scheduler.DestroyResource();
+    return static_cast<int>(total_us);
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 5)
+    {
+        std::cout << "Usage: ./roi_scheduler_bench batch_size des_width des_height num_rois [median_side(96)] [sigma(1.0)] [max_delay_us(2000)] [device_id]" << std::endl;
+        return -1;
+    }
+    int batch_size = std::atoi(argv[1]);
+    int des_width = std::atoi(argv[2]);
+    int des_height = std::atoi(argv[3]);
+    int num_rois = std::atoi(argv[4]);
+    float median_side = argc > 5 ? std::atof(argv[5]) : 96.0f;
+    float sigma = argc > 6 ? std::atof(argv[6]) : 1.0f;
+    int max_delay_us = argc > 7 ? std::atoi(argv[7]) : 2000;
+    int32_t deviceId = argc > 8 ? std::atoi(argv[8]) : 0;
+    if (batch_size <= 0 || num_rois <= 0)
+    {
+        std::printf("bad batch_size or num_rois\n");
+        return -1;
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // synthetic nv12 frames, the vpc cost does not depend on pixel values
+    std::vector<DVPPImageData> frames(BENCH_FRAME_NUM);
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    for (int idx = 0; idx < BENCH_FRAME_NUM; ++idx)
+    {
+        void* dev_frame = nullptr;
+        if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+            ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+        {
+            std::printf("upload frame failed\n");
+            return -1;
+        }
+        frames[idx].width = BENCH_FRAME_WIDTH;
+        frames[idx].height = BENCH_FRAME_HEIGHT;
+        frames[idx].alignWidth = BENCH_FRAME_WIDTH;
+        frames[idx].alignHeight = BENCH_FRAME_HEIGHT;
+        frames[idx].size = frame_size;
+        frames[idx].data = static_cast<uint8_t*>(dev_frame);
+    }
+
+    std::vector<int> frame_ids;
+    std::vector<RectInt> rois;
+    GenerateRois(num_rois, median_side, sigma, frame_ids, rois);
+
+    DVPPRoiSchedulerConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = des_width;
+    config.resize_config.resized_height = des_height;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.max_delay_us = max_delay_us;
+
+    config.use_buckets = 0;
+    int fifo_us = RunScheduler(config, frames, frame_ids, rois);
+    config.use_buckets = 1;
+    int bucketed_us = RunScheduler(config, frames, frame_ids, rois);
+    if (fifo_us > 0 && bucketed_us > 0)
+    {
+        std::printf("speedup of bucketed batches: %.2fx\n", 1.0f * fifo_us / bucketed_us);
+    }
+
+    for (int idx = 0; idx < BENCH_FRAME_NUM; ++idx)
+    {
+        acldvppFree(frames[idx].data);
+    }
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
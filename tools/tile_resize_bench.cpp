@@ -0,0 +1,163 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "tile_resize.h"
+
+#define BENCH_FRAME_WIDTH 3840
+#define BENCH_FRAME_HEIGHT 2160
+
+// baseline: every tile and the full view in their own vpc call, as callers slicing by hand do
+static long RunPerTile(const DVPPResizeInitConfig& config, const DVPPImageData& frame, const std::vector<RectInt>& tiles,
+                       bool full_view, int num_frames)
+{
+    DVPPResizeInitConfig single = config;
+    single.batch_size = 1;
+    DvppResize resize;
+    resize.Init(&single);
+    if (!resize.HasInit())
+    {
+        return -1;
+    }
+    RectInt full;
+    full.xmin = 0;
+    full.ymin = 0;
+    full.xmax = static_cast<int>(frame.width) - 1;
+    full.ymax = static_cast<int>(frame.height) - 1;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    for (int idx = 0; idx < num_frames; ++idx)
+    {
+        for (size_t tile = 0; tile < tiles.size(); ++tile)
+        {
+            resize.Process(&frame, &tiles[tile], 1);
+        }
+        if (full_view)
+        {
+            resize.Process(&frame, &full, 1);
+        }
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPResizeStats& stats = resize.GetStats();
+    std::printf("per tile   : %d frames in %ld us, %.1f frames/s, %ld vpc calls, %ld failed, setup %ld us, sync %ld us\n",
+                num_frames, total_us, total_us > 0 ? 1e6 * num_frames / total_us : 0.0, stats.process_count,
+                stats.failed_count, stats.setup_us, stats.sync_us);
+    resize.DestroyResource();
+    return total_us;
+}
+
+static long RunTileResize(const DVPPTileConfig& config, const DVPPImageData& frame, int frames_per_call, int num_frames)
+{
+    TileResize tiler;
+    tiler.Init(&config);
+    if (!tiler.HasInit())
+    {
+        return -1;
+    }
+    std::vector<DVPPImageData> frames(frames_per_call, frame);
+    std::vector<DVPPTileView> views;
+    int done = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTP = std::chrono::steady_clock::now();
+    while (done < num_frames)
+    {
+        int frame_num = std::min(frames_per_call, num_frames - done);
+        if (tiler.Process(frames.data(), frame_num, views) < 0)
+        {
+            std::printf("TileResize failed\n");
+            break;
+        }
+        done += frame_num;
+    }
+    long total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTP).count();
+    const DVPPTileStats& stats = tiler.GetStats();
+    const DVPPResizeStats& resize_stats = tiler.Resizer().GetStats();
+    std::printf("tile resize: %ld frames in %ld us, %.1f frames/s, %ld views, %ld vpc calls, %ld failed, setup %ld us, sync %ld us\n",
+                stats.frame_count, total_us, total_us > 0 ? 1e6 * stats.frame_count / total_us : 0.0, stats.view_count,
+                stats.submit_count, stats.failed_count, resize_stats.setup_us, resize_stats.sync_us);
+    tiler.DestroyResource();
+    return total_us;
+}
+
+int main(int argc, const char *argv[])
+{
+    if (argc < 4)
+    {
+        std::cout << "Usage: ./tile_resize_bench tile_side overlap num_frames [batch_size(32)] [frames_per_call(1)] [full_view(1)] [device_id]" << std::endl;
+        return -1;
+    }
+    int tile_side = std::atoi(argv[1]);
+    float overlap = std::atof(argv[2]);
+    int num_frames = std::atoi(argv[3]);
+    int batch_size = argc > 4 ? std::atoi(argv[4]) : 32;
+    int frames_per_call = argc > 5 ? std::atoi(argv[5]) : 1;
+    int full_view = argc > 6 ? std::atoi(argv[6]) : 1;
+    int32_t deviceId = argc > 7 ? std::atoi(argv[7]) : 0;
+    if (tile_side < 2 || num_frames <= 0 || batch_size <= 0 || frames_per_call <= 0)
+    {
+        std::printf("bad tile_side, num_frames, batch_size or frames_per_call\n");
+        return -1;
+    }
+
+    aclrtContext context;
+    aclrtStream stream;
+    if (ACL_SUCCESS != aclInit(nullptr) || ACL_SUCCESS != aclrtSetDevice(deviceId) ||
+        ACL_SUCCESS != aclrtCreateContext(&context, deviceId) || ACL_SUCCESS != aclrtCreateStream(&stream))
+    {
+        std::printf("acl init on device %d failed\n", deviceId);
+        return -1;
+    }
+
+    // one synthetic 4K nv12 frame, the vpc cost does not depend on pixel values
+    uint32_t frame_size = YUV420SP_SIZE(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT);
+    std::vector<uint8_t> host_frame(frame_size);
+    for (uint32_t idx = 0; idx < frame_size; ++idx)
+    {
+        host_frame[idx] = static_cast<uint8_t>(idx * 2654435761u >> 24);
+    }
+    void* dev_frame = nullptr;
+    if (ACL_SUCCESS != acldvppMalloc(&dev_frame, frame_size) ||
+        ACL_SUCCESS != aclrtMemcpy(dev_frame, frame_size, host_frame.data(), frame_size, ACL_MEMCPY_HOST_TO_DEVICE))
+    {
+        std::printf("upload frame failed\n");
+        return -1;
+    }
+    DVPPImageData frame;
+    frame.width = BENCH_FRAME_WIDTH;
+    frame.height = BENCH_FRAME_HEIGHT;
+    frame.alignWidth = BENCH_FRAME_WIDTH;
+    frame.alignHeight = BENCH_FRAME_HEIGHT;
+    frame.size = frame_size;
+    frame.data = static_cast<uint8_t*>(dev_frame);
+
+    DVPPTileConfig config;
+    config.resize_config.context = context;
+    config.resize_config.stream = stream;
+    config.resize_config.input_format = PIXEL_FORMAT_YUV_SEMIPLANAR_420;
+    config.resize_config.batch_size = batch_size;
+    config.resize_config.resized_width = tile_side;
+    config.resize_config.resized_height = tile_side;
+    config.resize_config.is_fix_scale_resize = 1;
+    config.resize_config.is_symmetry_padding = 1;
+    config.resize_config.resize_scale_factor = 1.0f;
+    config.overlap = overlap;
+    config.full_view = full_view;
+
+    std::vector<RectInt> tiles;
+    int num_tiles = GenerateTileGrid(BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT, tile_side, tile_side, overlap, tiles);
+    std::printf("%dx%d frame, %d tiles of %dx%d, overlap %.2f, full view %d\n", BENCH_FRAME_WIDTH, BENCH_FRAME_HEIGHT,
+                num_tiles, tile_side, tile_side, overlap, full_view);
+
+    long per_tile_us = RunPerTile(config.resize_config, frame, tiles, full_view != 0, num_frames);
+    long tile_us = RunTileResize(config, frame, frames_per_call, num_frames);
+    if (per_tile_us > 0 && tile_us > 0)
+    {
+        std::printf("speedup of batched tiles: %.2fx\n", 1.0f * per_tile_us / tile_us);
+    }
+
+    acldvppFree(dev_frame);
+    aclrtDestroyStream(stream);
+    aclrtDestroyContext(context);
+    aclrtResetDevice(deviceId);
+    aclFinalize();
+    return 0;
+}
@@ -0,0 +1,379 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "worker_pool.h"
+#include "dvpp_timeline.h"
+#include "alg_define.h"
+
+// worker thread of a pool
+static thread_local const WorkerPool* tls_pool = nullptr;
+static thread_local int tls_worker = -1;
+// thread running chunks of its own ParallelFor as worker tls_caller_worker
+static thread_local const WorkerPool* tls_caller_pool = nullptr;
+static thread_local int tls_caller_worker = -1;
+
+static inline uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WorkerPool::WorkerPool()
+        : stop_(false), job_fn_(nullptr), job_begin_(0), job_end_(0), job_grain_(1), job_chunks_(0),
+          next_chunk_(0), done_chunks_(0), job_workers_(0), active_workers_(0), joined_workers_(0),
+          stats_start_ns_(0)
+{
+
+}
+
+WorkerPool::~WorkerPool()
+{
+    Destroy();
+}
+
+int WorkerPool::CpuNumaNode(int cpu)
+{
+    char path[128];
+    for (int node = 0; node < 256; ++node)
+    {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (0 == access(path, F_OK))
+        {
+            return node;
+        }
+    }
+    return -1;
+}
+
+std::vector<int> WorkerPool::NumaNodeCpus(int numa_node)
+{
+    // cpulist looks like "0-23,48-71"
+    std::vector<int> cpus;
+    std::ifstream infile("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+    std::string line;
+    if (!std::getline(infile, line))
+    {
+        return cpus;
+    }
+    std::stringstream ss(line);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        size_t dash = item.find('-');
+        int first = std::atoi(item.c_str());
+        int last = std::string::npos == dash ? first : std::atoi(item.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+int WorkerPool::AllowedCpuCount()
+{
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (0 == sched_getaffinity(0, sizeof(mask), &mask) && CPU_COUNT(&mask) > 0)
+    {
+        return CPU_COUNT(&mask);
+    }
+#endif
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+    return num_cpus > 0 ? num_cpus : 1;
+}
+
+int WorkerPool::Init(const WorkerPoolConfig *config)
+{
+    Destroy();
+    std::vector<int> cpus = config->cpu_list;
+    if (cpus.empty() && config->numa_node >= 0)
+    {
+        cpus = NumaNodeCpus(config->numa_node);
+        if (cpus.empty())
+        {
+            AIALG_ERROR("numa node %d has no cpu\n", config->numa_node);
+            return 0;
+        }
+    }
+    // without given cpus the workers float on the cpus the process may use(taskset, cgroup cpuset),
+    // pinning them to 0..n-1 would stack every pool of every process onto the same cores
+    bool pin_threads = config->pin_threads && !cpus.empty();
+    int num_threads = config->num_threads > 0 ? config->num_threads : static_cast<int>(cpus.size());
+    if (num_threads <= 0)
+    {
+        num_threads = AllowedCpuCount();
+    }
+
+    stop_ = false;
+    stats_start_ns_ = SteadyNowNs();
+    for (int idx = 0; idx < num_threads; ++idx)
+    {
+        Worker* worker = new Worker();
+        if (pin_threads)
+        {
+            worker->cpu = cpus[idx % cpus.size()];
+            worker->numa_node = CpuNumaNode(worker->cpu);
+        }
+        workers_.push_back(worker);
+    }
+    for (int idx = 0; idx < num_threads; ++idx)
+    {
+        workers_[idx]->thread = std::thread(&WorkerPool::WorkerLoop, this, idx);
+    }
+    return 1;
+}
+
+void WorkerPool::Destroy()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    for (size_t idx = 0; idx < workers_.size(); ++idx)
+    {
+        workers_[idx]->cv.notify_one();
+    }
+    for (size_t idx = 0; idx < workers_.size(); ++idx)
+    {
+        if (workers_[idx]->thread.joinable())
+        {
+            workers_[idx]->thread.join();
+        }
+        delete workers_[idx];
+    }
+    workers_.clear();
+}
+
+void WorkerPool::WorkerLoop(int worker)
+{
+    Worker* self = workers_[worker];
+    tls_pool = this;
+    tls_worker = worker;
+#ifdef __linux__
+    if (self->cpu >= 0)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(self->cpu, &cpuset);
+        if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset))
+        {
+            AIALG_ERROR("pin worker %d to cpu %d failed\n", worker, self->cpu);
+        }
+    }
+#endif
+    char thread_name[32];
+    std::snprintf(thread_name, sizeof(thread_name), "worker_%d", worker);
+    DvppTimeline::SetThreadName(thread_name);
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            self->cv.wait(lock, [&] { return stop_ || self->has_job || !self->private_tasks.empty(); });
+            // queued tasks are run even when stopping, their callers are waiting
+            if (!self->private_tasks.empty())
+            {
+                RunPrivateTask(lock, self);
+                continue;
+            }
+            if (stop_)
+            {
+                return;
+            }
+            self->has_job = false;
+            joined_workers_++;
+            active_workers_++;
+        }
+        RunChunks(worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_workers_--;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+void WorkerPool::RunPrivateTask(std::unique_lock<std::mutex> &lock, Worker *self)
+{
+    PrivateTask task = self->private_tasks.front();
+    self->private_tasks.pop_front();
+    lock.unlock();
+    (*task.task)();
+    lock.lock();
+    *task.done = true;
+    task.done_cv->notify_all();
+}
+
+void WorkerPool::RunChunks(int worker)
+{
+    Worker* self = workers_[worker];
+    while (true)
+    {
+        int chunk = next_chunk_.fetch_add(1);
+        if (chunk >= job_chunks_)
+        {
+            return;
+        }
+        int begin = job_begin_ + chunk * job_grain_;
+        int end = begin + job_grain_ < job_end_ ? begin + job_grain_ : job_end_;
+        uint64_t start_ns = SteadyNowNs();
+        (*job_fn_)(begin, end, worker);
+        self->busy_ns += SteadyNowNs() - start_ns;
+        self->tasks++;
+        done_chunks_++;
+    }
+}
+
+void WorkerPool::ParallelFor(int begin, int end, const RangeFunc &fn, int grain)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+    if (workers_.empty() || this == tls_pool || this == tls_caller_pool)
+    {
+        fn(begin, end, this == tls_pool ? tls_worker : (this == tls_caller_pool ? tls_caller_worker : 0));
+        return;
+    }
+    grain = grain > 0 ? grain : 1;
+    int num_chunks = (end - begin + grain - 1) / grain;
+    int num_parts = std::min(num_chunks, NumWorkers());
+
+    std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_fn_ = &fn;
+        job_begin_ = begin;
+        job_end_ = end;
+        job_grain_ = grain;
+        job_chunks_ = num_chunks;
+        next_chunk_ = 0;
+        done_chunks_ = 0;
+        job_workers_ = num_parts - 1;
+        joined_workers_ = 0;
+        for (int worker = 0; worker < job_workers_; ++worker)
+        {
+            workers_[worker]->has_job = true;
+        }
+    }
+    for (int worker = 0; worker < job_workers_; ++worker)
+    {
+        workers_[worker]->cv.notify_one();
+    }
+
+    // the caller takes the place of the last part, whose worker stays asleep
+    const WorkerPool* outer_pool = tls_caller_pool;
+    int outer_worker = tls_caller_worker;
+    tls_caller_pool = this;
+    tls_caller_worker = num_parts - 1;
+    RunChunks(num_parts - 1);
+    tls_caller_pool = outer_pool;
+    tls_caller_worker = outer_worker;
+
+    // wait for the woken workers to join, so none of them picks up this job after it returned
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return joined_workers_ == job_workers_ && 0 == active_workers_; });
+    job_fn_ = nullptr;
+}
+
+void WorkerPool::ParallelForRows(int height, int tile_rows, const RangeFunc &fn)
+{
+    if (tile_rows <= 0)
+    {
+        // a few tiles per worker balances uneven rows
+        int num_tiles = NumWorkers() * 4;
+        tile_rows = num_tiles > 0 ? (height + num_tiles - 1) / num_tiles : height;
+    }
+    ParallelFor(0, height, fn, tile_rows);
+}
+
+void WorkerPool::RunOnWorker(int worker, const std::function<void()> &task)
+{
+    if (worker < 0 || worker >= NumWorkers() || (this == tls_pool && worker == tls_worker))
+    {
+        task();
+        return;
+    }
+    // a worker busy with ParallelFor chunks runs it after them, no submit_mutex_ so chunks may call this
+    Worker* self = this == tls_pool ? workers_[tls_worker] : nullptr;
+    bool done = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    PrivateTask entry = {&task, &done, self ? &self->cv : &done_cv_};
+    workers_[worker]->private_tasks.push_back(entry);
+    workers_[worker]->cv.notify_one();
+    if (!self)
+    {
+        done_cv_.wait(lock, [&] { return done; });
+        return;
+    }
+    // a waiting worker keeps serving its own queue, two workers queuing to each other can not deadlock
+    while (!done)
+    {
+        self->cv.wait(lock, [&] { return done || !self->private_tasks.empty(); });
+        if (!done)
+        {
+            RunPrivateTask(lock, self);
+        }
+    }
+}
+
+void* WorkerPool::AllocLocal(size_t size, int worker)
+{
+    void* ptr = fastMalloc(size);
+    if (!ptr)
+    {
+        return nullptr;
+    }
+    // linux places a page on the node of the cpu that touches it first
+    RunOnWorker(worker, [ptr, size] { std::memset(ptr, 0, size); });
+    return ptr;
+}
+
+void WorkerPool::FreeLocal(void *ptr)
+{
+    fastFree(ptr);
+}
+
+int WorkerPool::WorkerNumaNode(int worker) const
+{
+    return worker >= 0 && worker < NumWorkers() ? workers_[worker]->numa_node : -1;
+}
+
+void WorkerPool::GetStats(std::vector<WorkerStats> &stats) const
+{
+    uint64_t wall_ns = SteadyNowNs() - stats_start_ns_;
+    stats.resize(workers_.size());
+    for (size_t idx = 0; idx < workers_.size(); ++idx)
+    {
+        stats[idx].cpu = workers_[idx]->cpu;
+        stats[idx].numa_node = workers_[idx]->numa_node;
+        stats[idx].tasks = workers_[idx]->tasks;
+        stats[idx].busy_us = workers_[idx]->busy_ns / 1000;
+        stats[idx].utilization = wall_ns > 0 ? 1.0f * workers_[idx]->busy_ns / wall_ns : 0.0f;
+    }
+}
+
+void WorkerPool::ResetStats()
+{
+    for (size_t idx = 0; idx < workers_.size(); ++idx)
+    {
+        workers_[idx]->tasks = 0;
+        workers_[idx]->busy_ns = 0;
+    }
+    stats_start_ns_ = SteadyNowNs();
+}
@@ -0,0 +1,144 @@
+//
+// Created by jnulzl on 2026/10/19.
+//
+
+#ifndef _PICTURE_INC_WORKER_POOL_H
+#define _PICTURE_INC_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef struct{
+    int num_threads = 0;          // 0: one worker per cpu of cpu_list/numa_node, or per cpu of the affinity mask
+    std::vector<int> cpu_list;    // worker i is pinned to cpu_list[i % size], empty: see numa_node
+    int numa_node = -1;           // >= 0 and cpu_list empty: pin workers to the cpus of this node
+    int pin_threads = 1;          // 0: never pin; without cpu_list/numa_node the workers are not pinned either
+} WorkerPoolConfig;
+
+typedef struct{
+    int cpu = -1;                 // pinned cpu, -1 not pinned
+    int numa_node = -1;
+    uint64_t tasks = 0;           // chunks executed
+    uint64_t busy_us = 0;
+    float utilization = 0.0f;     // busy_us / wall time since Init or ResetStats
+} WorkerStats;
+
+/**
+* @brief host side worker pool for color conversion, staging copies, roi geometry and cpu resize,
+*        workers pinned to given cores(cpu_list/numa_node) can allocate buffers local to their numa node
+*/
+class WorkerPool {
+public:
+    typedef std::function<void(int begin, int end, int worker)> RangeFunc;
+
+    WorkerPool();
+
+    ~WorkerPool();
+
+    /**
+    * @brief start the workers
+    * @return 1 success, 0 failed
+    */
+    int Init(const WorkerPoolConfig* config);
+
+    void Destroy();
+
+    inline int NumWorkers() const
+    {
+        return static_cast<int>(workers_.size());
+    }
+
+    /**
+    * @brief run fn over [begin, end) split into chunks of grain, blocks until all chunks are done,
+    *        min(chunks, workers) take part: the caller runs chunks itself as the last of them and only the other
+    *        ones are woken, the worker index fn gets is unique among the parts running at the same time,
+    *        called from inside a worker or a chunk it runs serially there
+    */
+    void ParallelFor(int begin, int end, const RangeFunc& fn, int grain = 1);
+
+    /**
+    * @brief row-tile parallelism inside one large image, fn gets [row_begin, row_end)
+    */
+    void ParallelForRows(int height, int tile_rows, const RangeFunc& fn);
+
+    /**
+    * @brief 64 bytes aligned buffer first touched by the thread of worker(queued to it unless the caller is that
+    *        worker), so its pages live on the worker's numa node
+    */
+    void* AllocLocal(size_t size, int worker);
+
+    void FreeLocal(void* ptr);
+
+    int WorkerNumaNode(int worker) const;
+
+    void GetStats(std::vector<WorkerStats>& stats) const;
+
+    void ResetStats();
+
+    static int CpuNumaNode(int cpu);
+
+    static std::vector<int> NumaNodeCpus(int numa_node);
+
+    /**
+    * @brief cpus in the affinity mask of the process(sched_getaffinity), hardware_concurrency elsewhere
+    */
+    static int AllowedCpuCount();
+
+private:
+    struct PrivateTask {
+        const std::function<void()>* task;
+        bool* done;
+        std::condition_variable* done_cv;   // of the waiting caller
+    };
+
+    struct Worker {
+        std::thread thread;
+        int cpu = -1;
+        int numa_node = -1;
+        std::condition_variable cv;
+        bool has_job = false;                    // woken for the current ParallelFor
+        std::deque<PrivateTask> private_tasks;   // RunOnWorker
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> busy_ns{0};
+    };
+
+    void WorkerLoop(int worker);
+
+    void RunChunks(int worker);
+
+    /**
+    * @brief run the first private task of worker with mutex_ held by lock, unlocked while it runs
+    */
+    void RunPrivateTask(std::unique_lock<std::mutex>& lock, Worker* self);
+
+    void RunOnWorker(int worker, const std::function<void()>& task);
+
+private:
+    std::vector<Worker*> workers_;
+
+    std::mutex submit_mutex_;  // one ParallelFor at a time
+    std::mutex mutex_;
+    std::condition_variable done_cv_;
+    bool stop_;
+
+    const RangeFunc* job_fn_;
+    int job_begin_;
+    int job_end_;
+    int job_grain_;
+    int job_chunks_;
+    std::atomic<int> next_chunk_;
+    std::atomic<int> done_chunks_;
+    int job_workers_;     // workers woken for the job, the caller is not counted
+    int active_workers_;
+    int joined_workers_;
+
+    uint64_t stats_start_ns_;
+};
+
+#endif // _PICTURE_INC_WORKER_POOL_H